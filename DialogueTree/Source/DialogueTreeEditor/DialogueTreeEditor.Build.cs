@@ -40,6 +40,8 @@ public class DialogueTreeEditor : ModuleRules
 			new string[]
 			{
 				"DialogueTreeRuntime",
+				"AssetRegistry",
+				"Json",
                 "Slate",
                 "SlateCore",
                 "AssetTools",
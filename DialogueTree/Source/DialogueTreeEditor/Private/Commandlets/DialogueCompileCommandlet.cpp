@@ -0,0 +1,379 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//Header
+#include "Commandlets/DialogueCompileCommandlet.h"
+//UE
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Dom/JsonObject.h"
+#include "HAL/PlatformTime.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/SavePackage.h"
+#include "UObject/UObjectGlobals.h"
+//Plugin
+#include "Dialogue.h"
+#include "Graph/DialogueEdGraphSchema.h"
+#include "Graph/Nodes/GraphNodeDialogue.h"
+#include "LogDialogueTree.h"
+
+UDialogueCompileCommandlet::UDialogueCompileCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UDialogueCompileCommandlet::Main(const FString& Params)
+{
+	const double RunStart = FPlatformTime::Seconds();
+
+	//Read options
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamValues;
+	ParseCommandLine(*Params, Tokens, Switches, ParamValues);
+
+	bFullCompile = Switches.Contains(TEXT("Full"));
+	bSave = Switches.Contains(TEXT("Save"));
+
+	if (const FString* FoundBatchSize = ParamValues.Find(TEXT("BatchSize")))
+	{
+		BatchSize = FMath::Max(1, FCString::Atoi(**FoundBatchSize));
+	}
+
+	ReportPath = ParamValues.FindRef(TEXT("Report"));
+	if (ReportPath.IsEmpty())
+	{
+		ReportPath = FPaths::ProjectSavedDir()
+			/ TEXT("DialogueCompile")
+			/ TEXT("DialogueCompileReport.json");
+	}
+
+	TArray<FString> Paths;
+	ParamValues.FindRef(TEXT("Paths")).ParseIntoArray(Paths, TEXT(","));
+	if (Paths.IsEmpty())
+	{
+		Paths.Add(TEXT("/Game"));
+	}
+
+	//Find and compile every dialogue, a batch at a time
+	TArray<FAssetData> Assets;
+	FindDialogues(Paths, Assets);
+
+	UE_LOG(
+		LogDialogueTree,
+		Display,
+		TEXT("Compiling %d dialogues in batches of %d."),
+		Assets.Num(),
+		BatchSize
+	);
+
+	TArray<FDialogueCompileReportEntry> Entries;
+	Entries.SetNum(Assets.Num());
+
+	TArray<double> LoadMs;
+	for (int32 BatchStart = 0; BatchStart < Assets.Num();
+		BatchStart += BatchSize)
+	{
+		const int32 NumInBatch =
+			FMath::Min(BatchSize, Assets.Num() - BatchStart);
+		TConstArrayView<FAssetData> Batch(
+			Assets.GetData() + BatchStart,
+			NumInBatch
+		);
+
+		LoadBatch(Batch, LoadMs);
+
+		for (int32 Index = 0; Index < NumInBatch; ++Index)
+		{
+			FDialogueCompileReportEntry& Entry = Entries[BatchStart + Index];
+			Entry.LoadMs = LoadMs[Index];
+			CompileDialogue(Batch[Index], Entry);
+		}
+
+		//Keep memory flat across thousands of assets
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	//Report
+	int32 NumFailed = 0;
+	for (const FDialogueCompileReportEntry& Entry : Entries)
+	{
+		if (Entry.Status != TEXT("Compiled"))
+		{
+			++NumFailed;
+			UE_LOG(
+				LogDialogueTree,
+				Error,
+				TEXT("Dialogue [%s] did not compile: %s"),
+				*Entry.AssetPath,
+				*FString::Join(Entry.Errors, TEXT("; "))
+			);
+		}
+	}
+
+	const double TotalMs = (FPlatformTime::Seconds() - RunStart) * 1000.0;
+	WriteReport(Entries, TotalMs);
+
+	UE_LOG(
+		LogDialogueTree,
+		Display,
+		TEXT("Compiled %d of %d dialogues in %.2f ms. Report written to %s."),
+		Entries.Num() - NumFailed,
+		Entries.Num(),
+		TotalMs,
+		*ReportPath
+	);
+
+	return NumFailed > 0 ? 1 : 0;
+}
+
+void UDialogueCompileCommandlet::FindDialogues(const TArray<FString>& InPaths,
+	TArray<FAssetData>& OutAssets) const
+{
+	IAssetRegistry& AssetRegistry =
+		FModuleManager::LoadModuleChecked<FAssetRegistryModule>(
+			"AssetRegistry"
+		).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.ClassPaths.Add(UDialogue::StaticClass()->GetClassPathName());
+	Filter.bRecursiveClasses = true;
+	Filter.bRecursivePaths = true;
+	for (const FString& Path : InPaths)
+	{
+		Filter.PackagePaths.Add(FName(*Path));
+	}
+
+	OutAssets.Reset();
+	AssetRegistry.GetAssets(Filter, OutAssets);
+
+	OutAssets.Sort(
+		[](const FAssetData& Asset1, const FAssetData& Asset2)
+		{
+			return Asset1.PackageName.LexicalLess(Asset2.PackageName);
+		}
+	);
+}
+
+void UDialogueCompileCommandlet::LoadBatch(
+	TConstArrayView<FAssetData> InAssets, TArray<double>& OutLoadMs) const
+{
+	OutLoadMs.Reset();
+	OutLoadMs.SetNumZeroed(InAssets.Num());
+
+	//Queue every package so the loader can overlap their reads, then wait
+	const double BatchStart = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < InAssets.Num(); ++Index)
+	{
+		LoadPackageAsync(
+			InAssets[Index].PackageName.ToString(),
+			FLoadPackageAsyncDelegate::CreateLambda(
+				[&OutLoadMs, Index, BatchStart](const FName& PackageName,
+					UPackage* LoadedPackage, EAsyncLoadingResult::Type Result)
+				{
+					OutLoadMs[Index] =
+						(FPlatformTime::Seconds() - BatchStart) * 1000.0;
+				}
+			)
+		);
+	}
+
+	FlushAsyncLoading();
+}
+
+void UDialogueCompileCommandlet::CompileDialogue(const FAssetData& InAsset,
+	FDialogueCompileReportEntry& OutEntry) const
+{
+	OutEntry.AssetPath = InAsset.GetObjectPathString();
+	OutEntry.Status = TEXT("Error");
+
+	UDialogue* Dialogue = Cast<UDialogue>(InAsset.GetAsset());
+	if (!Dialogue)
+	{
+		OutEntry.Errors.Add(TEXT("Failed to load the asset."));
+		return;
+	}
+
+	UDialogueEdGraph* Graph = FindOrBuildGraph(Dialogue, OutEntry);
+	if (!Graph)
+	{
+		return;
+	}
+
+	const double CompileStart = FPlatformTime::Seconds();
+	Graph->CompileAsset(bFullCompile);
+	OutEntry.CompileMs = (FPlatformTime::Seconds() - CompileStart) * 1000.0;
+	OutEntry.Stats = Graph->GetLastCompileStats();
+
+	OutEntry.Status =
+		StaticEnum<EDialogueCompileStatus>()->GetNameStringByValue(
+			static_cast<int64>(Dialogue->GetCompileStatus())
+		);
+
+	for (UGraphNodeDialogue* Node : Graph->GetAllNodes())
+	{
+		if (Node->HasError())
+		{
+			OutEntry.Errors.Add(
+				FString::Printf(
+					TEXT("Node [%s] failed validation."),
+					*Node->GetID().ToString()
+				)
+			);
+		}
+	}
+
+	if (bSave && !SaveDialogue(Dialogue))
+	{
+		OutEntry.Errors.Add(TEXT("Failed to save the package."));
+	}
+}
+
+UDialogueEdGraph* UDialogueCompileCommandlet::FindOrBuildGraph(
+	UDialogue* InDialogue, FDialogueCompileReportEntry& OutEntry) const
+{
+	check(InDialogue);
+
+	if (UDialogueEdGraph* ExistingGraph =
+		Cast<UDialogueEdGraph>(InDialogue->GetEdGraph()))
+	{
+		if (ExistingGraph->GetGraphRoot())
+		{
+			return ExistingGraph;
+		}
+	}
+
+	//Same as opening the dialogue in the editor without a graph
+	if (!InDialogue->HasExistingData() || !InDialogue->GetRootNode())
+	{
+		OutEntry.Errors.Add(
+			TEXT("The dialogue has no graph and no nodes to rebuild one from.")
+		);
+		return nullptr;
+	}
+
+	UEdGraph* NewGraph = FBlueprintEditorUtils::CreateNewGraph(
+		InDialogue,
+		NAME_None,
+		UDialogueEdGraph::StaticClass(),
+		UDialogueEdGraphSchema::StaticClass()
+	);
+	check(NewGraph);
+
+	InDialogue->SetEdGraph(NewGraph);
+	NewGraph->bAllowDeletion = false;
+
+	UDialogueEdGraph* DialogueGraph = CastChecked<UDialogueEdGraph>(NewGraph);
+	if (!DialogueGraph->TryBuildGraphFromAsset(InDialogue)
+		|| !DialogueGraph->GetGraphRoot())
+	{
+		OutEntry.Errors.Add(TEXT("Failed to rebuild the dialogue graph."));
+		return nullptr;
+	}
+
+	OutEntry.bRebuiltGraph = true;
+	return DialogueGraph;
+}
+
+bool UDialogueCompileCommandlet::SaveDialogue(UDialogue* InDialogue) const
+{
+	check(InDialogue);
+
+	UPackage* Package = InDialogue->GetPackage();
+	const FString Filename = FPackageName::LongPackageNameToFilename(
+		Package->GetName(),
+		FPackageName::GetAssetPackageExtension()
+	);
+
+	FSavePackageArgs SaveArgs;
+	SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+	SaveArgs.Error = GError;
+
+	return UPackage::SavePackage(Package, InDialogue, *Filename, SaveArgs);
+}
+
+bool UDialogueCompileCommandlet::WriteReport(
+	const TArray<FDialogueCompileReportEntry>& InEntries, double TotalMs) const
+{
+	int32 NumCompiled = 0;
+	TArray<TSharedPtr<FJsonValue>> AssetValues;
+	AssetValues.Reserve(InEntries.Num());
+
+	for (const FDialogueCompileReportEntry& Entry : InEntries)
+	{
+		if (Entry.Status == TEXT("Compiled"))
+		{
+			++NumCompiled;
+		}
+
+		TSharedRef<FJsonObject> AssetObject = MakeShared<FJsonObject>();
+		AssetObject->SetStringField(TEXT("asset"), Entry.AssetPath);
+		AssetObject->SetStringField(TEXT("status"), Entry.Status);
+		AssetObject->SetBoolField(TEXT("rebuiltGraph"), Entry.bRebuiltGraph);
+		AssetObject->SetNumberField(TEXT("nodes"), Entry.Stats.NumNodes);
+		AssetObject->SetNumberField(
+			TEXT("rebuiltNodes"),
+			Entry.Stats.NumRebuiltNodes
+		);
+		AssetObject->SetNumberField(
+			TEXT("unreachableNodes"),
+			Entry.Stats.NumUnreachableNodes
+		);
+		AssetObject->SetNumberField(TEXT("loadMs"), Entry.LoadMs);
+		AssetObject->SetNumberField(TEXT("compileMs"), Entry.CompileMs);
+
+		TSharedRef<FJsonObject> PhaseObject = MakeShared<FJsonObject>();
+		PhaseObject->SetNumberField(TEXT("create"), Entry.Stats.CreateMs);
+		PhaseObject->SetNumberField(TEXT("link"), Entry.Stats.LinkMs);
+		PhaseObject->SetNumberField(TEXT("finalize"), Entry.Stats.FinalizeMs);
+		PhaseObject->SetNumberField(TEXT("snapshot"), Entry.Stats.SnapshotMs);
+		PhaseObject->SetNumberField(TEXT("validate"), Entry.Stats.ValidateMs);
+		PhaseObject->SetNumberField(TEXT("table"), Entry.Stats.TableMs);
+		PhaseObject->SetNumberField(TEXT("commit"), Entry.Stats.CommitMs);
+		AssetObject->SetObjectField(TEXT("phasesMs"), PhaseObject);
+
+		TArray<TSharedPtr<FJsonValue>> ErrorValues;
+		for (const FString& Error : Entry.Errors)
+		{
+			ErrorValues.Add(MakeShared<FJsonValueString>(Error));
+		}
+		AssetObject->SetArrayField(TEXT("errors"), ErrorValues);
+
+		AssetValues.Add(MakeShared<FJsonValueObject>(AssetObject));
+	}
+
+	TSharedRef<FJsonObject> ReportObject = MakeShared<FJsonObject>();
+	ReportObject->SetNumberField(TEXT("total"), InEntries.Num());
+	ReportObject->SetNumberField(TEXT("compiled"), NumCompiled);
+	ReportObject->SetNumberField(
+		TEXT("failed"),
+		InEntries.Num() - NumCompiled
+	);
+	ReportObject->SetNumberField(TEXT("totalMs"), TotalMs);
+	ReportObject->SetArrayField(TEXT("assets"), AssetValues);
+
+	FString ReportText;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ReportText);
+	FJsonSerializer::Serialize(ReportObject, Writer);
+
+	if (!FFileHelper::SaveStringToFile(ReportText, *ReportPath))
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Failed to write dialogue compile report to %s."),
+			*ReportPath
+		);
+		return false;
+	}
+
+	return true;
+}
@@ -355,6 +355,7 @@ void FDialogueGraphConditionCustomization::RefreshEditor()
 	if (TargetGraphNode.IsValid())
 	{
 		TargetGraphNode->UpdateDialogueNode();
+		TargetGraphNode->MarkDialogueDirty();
 	}
 
 	//Refresh the details view
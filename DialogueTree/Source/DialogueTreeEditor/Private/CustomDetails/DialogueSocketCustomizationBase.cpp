@@ -252,5 +252,6 @@ void FDialogueSocketCustomizationBase::RefreshEditor()
 	if (TargetGraphNode.IsValid())
 	{
 		TargetGraphNode->UpdateDialogueNode();
+		TargetGraphNode->MarkDialogueDirty();
 	}
 }
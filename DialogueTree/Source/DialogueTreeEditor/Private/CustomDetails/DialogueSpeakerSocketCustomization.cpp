@@ -98,6 +98,7 @@ void FDialogueSpeakerSocketCustomization::SetUpPropertyChangeEvent(TSharedRef<IP
 			if (TargetGraphNodePtr)
 			{
 				TargetGraphNodePtr->UpdateDialogueNode();
+				TargetGraphNodePtr->MarkDialogueDirty();
 			}
 		}
 	));
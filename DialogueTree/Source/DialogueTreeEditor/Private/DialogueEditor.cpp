@@ -400,6 +400,10 @@ void FDialogueEditor::OnFinishedChangingProperties(const FPropertyChangedEvent&
 
     //Set compile status to uncompiled and clear vis cache
     TargetDialogue->SetCompileStatus(EDialogueCompileStatus::Uncompiled);
+    if (UDialogueEdGraph* DialogueGraph = Cast<UDialogueEdGraph>(TargetGraph))
+    {
+        DialogueGraph->NotifyDialogueEdited();
+    }
     TargetGraph->GetSchema()->ForceVisualizationCacheClear();
 }
 
@@ -475,10 +479,11 @@ void FDialogueEditor::FillToolbarMenu(FToolBarBuilder& ToolbarBuilder)
     //Build up toolbar 
     ToolbarBuilder.BeginSection("DialogueTree");
     {
-        FText CompileLabel = LOCTEXT("CompileLabel", "Compile");
         FUIAction CompileAction = FUIAction(FExecuteAction::CreateSP(this, &FDialogueEditor::OnCompile));
 
-        ToolbarBuilder.AddToolBarButton(CompileAction,NAME_None,CompileLabel,CompileLabel,
+        ToolbarBuilder.AddToolBarButton(CompileAction,NAME_None,
+            TAttribute<FText>(this,&FDialogueEditor::GetCompileLabel),
+            TAttribute<FText>(this,&FDialogueEditor::GetCompileTooltip),
             TAttribute<FSlateIcon>(this,&FDialogueEditor::GetStatusImage));
     }
     
@@ -494,6 +499,14 @@ FSlateIcon FDialogueEditor::GetStatusImage() const
     static const FName CompileStatusCompiled("Blueprint.CompileStatus.Overlay.Good");
     static const FName CompileStatusUncompiled("Blueprint.CompileStatus.Overlay.Unknown");
     static const FName CompileStatusFailed("Blueprint.CompileStatus.Overlay.Error");
+    static const FName CompileStatusWorking("Blueprint.CompileStatus.Overlay.Working");
+
+    //A compile is running in the background
+    UDialogueEdGraph* DialogueGraph = GetDialogueGraph();
+    if (DialogueGraph && DialogueGraph->IsCompiling())
+    {
+        return FSlateIcon(FAppStyle::GetAppStyleSetName(), CompileStatusBackground, NAME_None, CompileStatusWorking);
+    }
 
     //Combine icons and return as appropriate 
     switch (TargetDialogue->GetCompileStatus())
@@ -512,6 +525,39 @@ FSlateIcon FDialogueEditor::GetStatusImage() const
     }
 }
 
+FText FDialogueEditor::GetCompileLabel() const
+{
+    UDialogueEdGraph* DialogueGraph = GetDialogueGraph();
+    if (DialogueGraph && DialogueGraph->IsCompiling())
+    {
+        return FText::Format(
+            LOCTEXT("CompilingLabel", "Compiling {0}"),
+            FText::AsPercent(DialogueGraph->GetCompileProgress())
+        );
+    }
+
+    return LOCTEXT("CompileLabel", "Compile");
+}
+
+FText FDialogueEditor::GetCompileTooltip() const
+{
+    UDialogueEdGraph* DialogueGraph = GetDialogueGraph();
+    if (DialogueGraph && DialogueGraph->IsCompiling())
+    {
+        return LOCTEXT(
+            "CompilingTooltip", 
+            "Validating the dialogue in the background. Compile again to restart."
+        );
+    }
+
+    return LOCTEXT("CompileLabel", "Compile");
+}
+
+UDialogueEdGraph* FDialogueEditor::GetDialogueGraph() const
+{
+    return TargetDialogue ? Cast<UDialogueEdGraph>(TargetDialogue->GetEdGraph()) : nullptr;
+}
+
 void FDialogueEditor::OnCompile()
 {
     check(TargetDialogue);
@@ -519,7 +565,7 @@ void FDialogueEditor::OnCompile()
     check(TargetGraph);
 
     UDialogueEdGraph* TargetDialogueGraph = CastChecked<UDialogueEdGraph>(TargetGraph);
-    TargetDialogueGraph->CompileAsset();
+    TargetDialogueGraph->CompileAssetAsync();
 }
 
 void FDialogueEditor::RegisterCommands()
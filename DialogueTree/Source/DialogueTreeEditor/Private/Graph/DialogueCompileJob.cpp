@@ -0,0 +1,194 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//Header
+#include "Graph/DialogueCompileJob.h"
+//UE
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+
+FDialogueCompileJob::FDialogueCompileJob(FDialogueCompileSnapshot&& InSnapshot)
+	: Snapshot(MoveTemp(InSnapshot))
+{
+}
+
+void FDialogueCompileJob::Run()
+{
+	const double ValidateStart = FPlatformTime::Seconds();
+	const int32 NumNodes = Snapshot.Nodes.Num();
+
+	TMap<FName, int32> IndicesByID;
+	IndicesByID.Reserve(NumNodes);
+	for (int32 NodeIndex = 0; NodeIndex < NumNodes; ++NodeIndex)
+	{
+		IndicesByID.Add(Snapshot.Nodes[NodeIndex].ID, NodeIndex);
+	}
+
+	//Each node only reads the snapshot and writes its own flag
+	NodeErrors.SetNumZeroed(NumNodes);
+	ParallelFor(NumNodes, [this, &IndicesByID](int32 NodeIndex)
+	{
+		const FDialogueNodeCompileFacts& Facts = Snapshot.Nodes[NodeIndex];
+		NodeErrors[NodeIndex] = ValidateNode(Facts, IndicesByID) ? 0 : 1;
+		NumWorkDone.fetch_add(1, std::memory_order_relaxed);
+	});
+
+	NumErrors = 0;
+	for (uint8 bError : NodeErrors)
+	{
+		NumErrors += bError;
+	}
+
+	NumUnreachableNodes = CountUnreachableNodes(IndicesByID);
+
+	const double TableStart = FPlatformTime::Seconds();
+	ValidateMs = (TableStart - ValidateStart) * 1000.0;
+
+	Table.BuildLayout(Snapshot.TableSources);
+	NumWorkDone.fetch_add(
+		Snapshot.TableSources.Num(),
+		std::memory_order_relaxed
+	);
+
+	TableMs = (FPlatformTime::Seconds() - TableStart) * 1000.0;
+
+	bComplete.store(true, std::memory_order_release);
+}
+
+bool FDialogueCompileJob::IsComplete() const
+{
+	return bComplete.load(std::memory_order_acquire);
+}
+
+float FDialogueCompileJob::GetProgress() const
+{
+	const int32 TotalWork =
+		Snapshot.Nodes.Num() + Snapshot.TableSources.Num();
+	if (TotalWork == 0)
+	{
+		return IsComplete() ? 1.f : 0.f;
+	}
+
+	return static_cast<float>(NumWorkDone.load(std::memory_order_relaxed))
+		/ static_cast<float>(TotalWork);
+}
+
+bool FDialogueCompileJob::Succeeded() const
+{
+	check(IsComplete());
+	return NumErrors == 0;
+}
+
+bool FDialogueCompileJob::HasNodeError(int32 NodeIndex) const
+{
+	check(IsComplete());
+	return NodeErrors.IsValidIndex(NodeIndex) && NodeErrors[NodeIndex] != 0;
+}
+
+int32 FDialogueCompileJob::GetNumErrors() const
+{
+	return NumErrors;
+}
+
+int32 FDialogueCompileJob::GetNumUnreachableNodes() const
+{
+	return NumUnreachableNodes;
+}
+
+FDialogueNodeTable& FDialogueCompileJob::GetTable()
+{
+	check(IsComplete());
+	return Table;
+}
+
+FDialogueNodeSlots& FDialogueCompileJob::GetTableSlots()
+{
+	check(IsComplete());
+	return Snapshot.TableSlots;
+}
+
+double FDialogueCompileJob::GetValidateMs() const
+{
+	return ValidateMs;
+}
+
+double FDialogueCompileJob::GetTableMs() const
+{
+	return TableMs;
+}
+
+bool FDialogueCompileJob::ValidateNode(const FDialogueNodeCompileFacts& Facts,
+	const TMap<FName, int32>& IndicesByID) const
+{
+	if (!Facts.bRequirementsMet)
+	{
+		return false;
+	}
+
+	if (Facts.bNeedsSpeaker
+		&& (Facts.SpeakerName.IsNone()
+			|| !Snapshot.SpeakerNames.Contains(Facts.SpeakerName)))
+	{
+		return false;
+	}
+
+	if (Facts.bNeedsTransition
+		&& (!Facts.bHasTransition
+			|| EnumHasAnyFlags(Facts.TransitionClassFlags, CLASS_Abstract)))
+	{
+		return false;
+	}
+
+	if (Facts.bNeedsJumpTarget
+		&& (Facts.JumpTargetID.IsNone()
+			|| Facts.JumpTargetID == Facts.ID
+			|| !IndicesByID.Contains(Facts.JumpTargetID)))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+int32 FDialogueCompileJob::CountUnreachableNodes(
+	const TMap<FName, int32>& IndicesByID) const
+{
+	const int32 NumNodes = Snapshot.Nodes.Num();
+	if (!Snapshot.Nodes.IsValidIndex(Snapshot.RootIndex))
+	{
+		return NumNodes;
+	}
+
+	TBitArray<> Reached(false, NumNodes);
+	TArray<int32> Worklist;
+	Worklist.Reserve(NumNodes);
+
+	auto Reach = [&Reached, &Worklist](int32 NodeIndex)
+	{
+		if (NodeIndex != INDEX_NONE && !Reached[NodeIndex])
+		{
+			Reached[NodeIndex] = true;
+			Worklist.Add(NodeIndex);
+		}
+	};
+
+	int32 NumReached = 0;
+	Reach(Snapshot.RootIndex);
+	while (!Worklist.IsEmpty())
+	{
+		const FDialogueNodeCompileFacts& Facts =
+			Snapshot.Nodes[Worklist.Pop(EAllowShrinking::No)];
+		++NumReached;
+
+		for (int32 Child : Facts.Children)
+		{
+			Reach(Child);
+		}
+
+		if (const int32* Target = IndicesByID.Find(Facts.JumpTargetID))
+		{
+			Reach(*Target);
+		}
+	}
+
+	return NumNodes - NumReached;
+}
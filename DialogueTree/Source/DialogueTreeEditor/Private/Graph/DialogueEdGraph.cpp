@@ -3,11 +3,15 @@
 //Header
 #include "Graph/DialogueEdGraph.h"
 //UE
+#include "Async/Async.h"
 #include "GraphEditAction.h"
+#include "HAL/PlatformTime.h"
 #include "Settings/EditorStyleSettings.h"
+#include "Tasks/Task.h"
 //Plugin
 #include "Dialogue.h"
 #include "DialogueSpeakerSocket.h"
+#include "LogDialogueTree.h"
 #include "Graph/Nodes/GraphNodeDialogue.h"
 #include "Graph/Nodes/GraphNodeDialogueBranch.h"
 #include "Graph/Nodes/GraphNodeDialogueEntry.h"
@@ -57,6 +61,7 @@ bool UDialogueEdGraph::Modify(bool bAlwaysMarkDirty)
 void UDialogueEdGraph::PostEditUndo()
 {
 	Super::PostEditUndo();
+	MarkNeedsFullCompile();
 	NotifyGraphChanged();
 }
 
@@ -101,6 +106,11 @@ void UDialogueEdGraph::SetGraphRoot(UGraphNodeDialogue* InRoot)
 	Root = InRoot;
 }
 
+UGraphNodeDialogue* UDialogueEdGraph::GetGraphRoot() const
+{
+	return Root;
+}
+
 UGraphNodeDialogue* UDialogueEdGraph::GetNode(FName InID) const
 {
 	if (NodeMap.Contains(InID))
@@ -150,54 +160,293 @@ TArray<UDialogueSpeakerSocket*> UDialogueEdGraph::GetAllSpeakers() const
 	return AllSpeakers;
 }
 
-void UDialogueEdGraph::CompileAsset()
+void UDialogueEdGraph::CompileAsset(bool bForceFullCompile)
+{
+	TSharedRef<FDialogueCompileJob> Job = BeginCompile(bForceFullCompile);
+	Job->Run();
+	FinishCompile(Job);
+}
+
+void UDialogueEdGraph::CompileAssetAsync(bool bForceFullCompile)
+{
+	TSharedRef<FDialogueCompileJob> Job = BeginCompile(bForceFullCompile);
+
+	//The job only touches its snapshot, so the graph may be edited or even
+	//destroyed while it runs
+	TWeakObjectPtr<UDialogueEdGraph> WeakGraph(this);
+	UE::Tasks::Launch(
+		UE_SOURCE_LOCATION,
+		[Job, WeakGraph]()
+		{
+			Job->Run();
+
+			AsyncTask(ENamedThreads::GameThread, [Job, WeakGraph]()
+			{
+				if (UDialogueEdGraph* Graph = WeakGraph.Get())
+				{
+					Graph->FinishCompile(Job);
+				}
+			});
+		}
+	);
+}
+
+bool UDialogueEdGraph::IsCompiling() const
+{
+	return PendingCompile.Job.IsValid();
+}
+
+float UDialogueEdGraph::GetCompileProgress() const
+{
+	return PendingCompile.Job.IsValid() 
+		? PendingCompile.Job->GetProgress() 
+		: 0.f;
+}
+
+void UDialogueEdGraph::NotifyDialogueEdited()
+{
+	++EditSerial;
+}
+
+TSharedRef<FDialogueCompileJob> UDialogueEdGraph::BeginCompile(
+	bool bForceFullCompile)
 {
 	//Verify asset and root exist 
 	UDialogue* Asset = GetDialogue();
 	check(Asset && Root);
 
-	//Prepare the dialogue to be compiled
+	//Rebuild every node if the asset has no compiled nodes to reuse 
+	const bool bFullCompile = bForceFullCompile || bNeedsFullCompile
+		|| Asset->GetNodeTable().Entries.IsEmpty();
+
+	LastCompileStats = FDialogueCompileStats();
+	LastCompileStats.bIncremental = !bFullCompile;
+	LastCompileStats.NumNodes = NodeMap.Num();
+
+	double PhaseStart = FPlatformTime::Seconds();
+	auto EndPhase = [&PhaseStart](double& OutPhaseMs)
+	{
+		const double Now = FPlatformTime::Seconds();
+		OutPhaseMs = (Now - PhaseStart) * 1000.0;
+		PhaseStart = Now;
+	};
+
+	//Prepare the dialogue to be compiled. Nodes are staged, so sessions 
+	//keep playing the last compile until this one commits.
 	Asset->PreCompileDialogue();
 
 	//Clear asset nodes
-	ClearAssetNodes();
+	if (bFullCompile)
+	{
+		ClearAssetNodes();
+	}
 
 	//Compile asset tree
-	CreateAssetNodes(Asset);
+	TArray<UGraphNodeDialogue*> RebuiltNodes;
+	CreateAssetNodes(Asset, RebuiltNodes);
 	Asset->SetRootNode(Root->GetAssetNode());
+	LastCompileStats.NumRebuiltNodes = RebuiltNodes.Num();
+	EndPhase(LastCompileStats.CreateMs);
+
+	LinkAssetTree();
+	EndPhase(LastCompileStats.LinkMs);
+
+	FinalizeAssetNodes(RebuiltNodes);
+	ReorderAssetConditions();
+	EndPhase(LastCompileStats.FinalizeMs);
+
+	//Copy out everything validation and the node table need, so that the 
+	//rest of the compile does not touch any objects
+	PendingCompile = FDialoguePendingCompile();
+	PendingCompile.EditSerial = EditSerial;
+	PendingCompile.bFullCompile = bFullCompile;
+
+	FDialogueCompileSnapshot Snapshot;
+	GatherCompileSnapshot(Snapshot, PendingCompile.GraphNodes);
+
+	TArray<TObjectPtr<UDialogueNode>> TableNodes;
+	Asset->GatherNodeTableSources(
+		Snapshot.TableSlots, 
+		TableNodes, 
+		Snapshot.TableSources
+	);
+	PendingCompile.TableNodes.Reserve(TableNodes.Num());
+	for (UDialogueNode* TableNode : TableNodes)
+	{
+		PendingCompile.TableNodes.Add(TableNode);
+	}
+	EndPhase(LastCompileStats.SnapshotMs);
 
-	TSet<UGraphNodeDialogue*> VisitedNodes;
-	UpdateAssetTreeRecursive(Root, VisitedNodes);
-	FinalizeAssetNodes();
+	PendingCompile.Job = 
+		MakeShared<FDialogueCompileJob>(MoveTemp(Snapshot));
+	return PendingCompile.Job.ToSharedRef();
+}
+
+void UDialogueEdGraph::FinishCompile(
+	const TSharedRef<FDialogueCompileJob>& Job)
+{
+	//A later compile replaced this one
+	if (PendingCompile.Job.Get() != &Job.Get())
+	{
+		return;
+	}
+	check(Job->IsComplete());
+
+	const double CommitStart = FPlatformTime::Seconds();
+	FDialoguePendingCompile Finished = MoveTemp(PendingCompile);
+	PendingCompile = FDialoguePendingCompile();
+
+	//Swap the staged nodes and finished node table into the asset in one 
+	//go
+	UDialogue* Asset = GetDialogue();
+	FDialogueNodeTable& Table = Job->GetTable();
+	Table.Nodes.SetNum(Finished.TableNodes.Num());
+	for (int32 Slot = 0; Slot < Finished.TableNodes.Num(); ++Slot)
+	{
+		Table.Nodes[Slot] = Finished.TableNodes[Slot].Get();
+	}
+	Asset->CommitNodeTable(MoveTemp(Job->GetTableSlots()), MoveTemp(Table));
+
+	//Flag any nodes that failed validation
+	for (int32 NodeIndex = 0; NodeIndex < Finished.GraphNodes.Num(); 
+		++NodeIndex)
+	{
+		if (UGraphNodeDialogue* Node = Finished.GraphNodes[NodeIndex].Get())
+		{
+			Node->SetErrorFlag(Job->HasNodeError(NodeIndex));
+		}
+	}
 
-	//Determine if compilation was successful
-	if (CanCompileAsset())
+	LastCompileStats.ValidateMs = Job->GetValidateMs();
+	LastCompileStats.TableMs = Job->GetTableMs();
+	LastCompileStats.NumErrors = Job->GetNumErrors();
+	LastCompileStats.NumUnreachableNodes = Job->GetNumUnreachableNodes();
+
+	if (Finished.EditSerial != EditSerial)
+	{
+		//Edited while compiling: the asset matches the graph as it was
+		Asset->SetCompileStatus(EDialogueCompileStatus::Uncompiled);
+	}
+	else if (Job->Succeeded())
 	{
 		Asset->SetCompileStatus(EDialogueCompileStatus::Compiled);
+
+		//Everything is up to date until the next edit
+		for (auto& Entry : NodeMap)
+		{
+			Entry.Value->ClearAssetNodeDirty();
+		}
+		bNeedsFullCompile = false;
 	}
 	else
 	{
 		Asset->SetCompileStatus(EDialogueCompileStatus::Failed);
 	}
+
+	LastCompileStats.CommitMs = 
+		(FPlatformTime::Seconds() - CommitStart) * 1000.0;
+
+	UE_LOG(
+		LogDialogueTree,
+		Log,
+		TEXT("Compiled dialogue [%s] (%s, %d of %d nodes rebuilt, %d errors, %d unreachable) in %.2f ms: create %.2f ms, link %.2f ms, finalize %.2f ms, snapshot %.2f ms, validate %.2f ms, table %.2f ms, commit %.2f ms."),
+		*Asset->GetName(),
+		Finished.bFullCompile ? TEXT("full") : TEXT("incremental"),
+		LastCompileStats.NumRebuiltNodes,
+		LastCompileStats.NumNodes,
+		LastCompileStats.NumErrors,
+		LastCompileStats.NumUnreachableNodes,
+		LastCompileStats.GetTotalMs(),
+		LastCompileStats.CreateMs,
+		LastCompileStats.LinkMs,
+		LastCompileStats.FinalizeMs,
+		LastCompileStats.SnapshotMs,
+		LastCompileStats.ValidateMs,
+		LastCompileStats.TableMs,
+		LastCompileStats.CommitMs
+	);
+}
+
+const FDialogueCompileStats& UDialogueEdGraph::GetLastCompileStats() const
+{
+	return LastCompileStats;
+}
+
+void UDialogueEdGraph::MarkNeedsFullCompile()
+{
+	bNeedsFullCompile = true;
+	NotifyDialogueEdited();
 }
 
 bool UDialogueEdGraph::CanCompileAsset() const
 {
-	//Get all nodes
-	TArray<UGraphNodeDialogue*> DialogueNodes;
-	GetNodesOfClass<UGraphNodeDialogue>(DialogueNodes);
+	FDialogueCompileSnapshot Snapshot;
+	TArray<TWeakObjectPtr<UGraphNodeDialogue>> SnapshotNodes;
+	GatherCompileSnapshot(Snapshot, SnapshotNodes);
+
+	FDialogueCompileJob Job(MoveTemp(Snapshot));
+	Job.Run();
 
 	//Verify all nodes can compile
-	bool bCanCompile = true;
-	for (UGraphNodeDialogue* Node : DialogueNodes)
+	for (int32 NodeIndex = 0; NodeIndex < SnapshotNodes.Num(); ++NodeIndex)
+	{
+		if (UGraphNodeDialogue* Node = SnapshotNodes[NodeIndex].Get())
+		{
+			Node->SetErrorFlag(Job.HasNodeError(NodeIndex));
+		}
+	}
+
+	return Job.Succeeded();
+}
+
+void UDialogueEdGraph::GatherCompileSnapshot(
+	FDialogueCompileSnapshot& OutSnapshot,
+	TArray<TWeakObjectPtr<UGraphNodeDialogue>>& OutNodes) const
+{
+	OutSnapshot.SpeakerNames.Reset();
+	for (auto& Entry : GetDialogue()->GetSpeakerRoles())
+	{
+		OutSnapshot.SpeakerNames.Add(Entry.Key);
+	}
+
+	//Give every node an index first so that children can refer to them
+	TMap<const UGraphNodeDialogue*, int32> IndicesByNode;
+	IndicesByNode.Reserve(NodeMap.Num());
+	OutNodes.Reset(NodeMap.Num());
+	for (auto& Entry : NodeMap)
 	{
-		if (!Node->CanCompileNode())
+		if (Entry.Value)
 		{
-			bCanCompile = false;
+			IndicesByNode.Add(Entry.Value, OutNodes.Add(Entry.Value.Get()));
 		}
 	}
 
-	return bCanCompile;
+	OutSnapshot.Nodes.Reset();
+	OutSnapshot.Nodes.SetNum(OutNodes.Num());
+	if (const int32* RootIndex = IndicesByNode.Find(Root))
+	{
+		OutSnapshot.RootIndex = *RootIndex;
+	}
+
+	TArray<UGraphNodeDialogue*> Children;
+	for (int32 NodeIndex = 0; NodeIndex < OutNodes.Num(); ++NodeIndex)
+	{
+		UGraphNodeDialogue* Node = OutNodes[NodeIndex].Get();
+		FDialogueNodeCompileFacts& Facts = OutSnapshot.Nodes[NodeIndex];
+		Facts.ID = Node->GetID();
+
+		Node->GetChildren(Children);
+		Facts.Children.Reserve(Children.Num());
+		for (UGraphNodeDialogue* Child : Children)
+		{
+			if (const int32* ChildIndex = IndicesByNode.Find(Child))
+			{
+				Facts.Children.Add(*ChildIndex);
+			}
+		}
+
+		Node->GatherCompileFacts(Facts);
+	}
 }
 
 bool UDialogueEdGraph::TryBuildGraphFromAsset(const UDialogue* InAsset)
@@ -357,53 +606,94 @@ void UDialogueEdGraph::ClearAssetNodes()
 	}
 }
 
-void UDialogueEdGraph::CreateAssetNodes(UDialogue* InAsset)
+void UDialogueEdGraph::CreateAssetNodes(UDialogue* InAsset,
+	TArray<UGraphNodeDialogue*>& OutRebuiltNodes)
 {
+	OutRebuiltNodes.Reset();
+
 	for (auto& Entry : NodeMap)
 	{
-		check(Entry.Value);
-		Entry.Value->CreateAssetNode(InAsset);
-		Entry.Value->AssignAssetNodeID();
-		Entry.Value->AssignAssetNodeCommonData();
-		InAsset->AddNode(Entry.Value->GetAssetNode());
+		UGraphNodeDialogue* Node = Entry.Value;
+		check(Node);
+
+		//Only rebuild nodes that changed since they were last compiled
+		UDialogueNode* ExistingNode = Node->GetAssetNode();
+		if (!ExistingNode || Node->IsAssetNodeDirty() 
+			|| ExistingNode->GetOuter() != InAsset)
+		{
+			Node->CreateAssetNode(InAsset);
+			OutRebuiltNodes.Add(Node);
+		}
+
+		//Links are rebuilt from scratch for every node
+		Node->GetAssetNode()->ClearLinks();
+		Node->AssignAssetNodeID();
+		Node->AssignAssetNodeCommonData();
+		InAsset->AddNode(Node->GetAssetNode());
 	}
 }
 
-void UDialogueEdGraph::FinalizeAssetNodes()
+void UDialogueEdGraph::FinalizeAssetNodes(
+	const TArray<UGraphNodeDialogue*>& InNodes)
 {
-	for (auto& Entry : NodeMap)
+	for (UGraphNodeDialogue* Node : InNodes)
 	{
-		check(Entry.Value);
-		Entry.Value->FinalizeAssetNode();
+		check(Node);
+		Node->FinalizeAssetNode();
 	}
 }
 
-void UDialogueEdGraph::UpdateAssetTreeRecursive(UGraphNodeDialogue* InRoot,
-	TSet<UGraphNodeDialogue*> VisitedNodes)
+void UDialogueEdGraph::ReorderAssetConditions()
 {
-	check(InRoot);
-
-	if (VisitedNodes.Contains(InRoot))
+	//Pass rates measured since the last compile apply to unchanged nodes
+	//too, not just those rebuilt
+	for (const auto& Entry : NodeMap)
 	{
-		return;
-	}
-	else
-	{
-		VisitedNodes.Add(InRoot);
+		UGraphNodeDialogue* Node = Entry.Value;
+		if (Node && Node->GetAssetNode())
+		{
+			Node->GetAssetNode()->ReorderConditions();
+		}
 	}
+}
 
-	//Link the asset root to its parents
-	InRoot->LinkAssetNode();
+void UDialogueEdGraph::LinkAssetTree()
+{
+	check(Root);
 
-	//Retrieve children and order left to right
-	TArray<UGraphNodeDialogue*> OutChildren;
-	InRoot->GetChildren(OutChildren);
-	UGraphNodeDialogue::SortNodesLeftToRight(OutChildren);
+	TSet<UGraphNodeDialogue*> VisitedNodes;
+	VisitedNodes.Reserve(NodeMap.Num());
+
+	TArray<UGraphNodeDialogue*> Worklist;
+	Worklist.Add(Root);
 
-	//Recur over children
-	for (UGraphNodeDialogue* Child : OutChildren)
+	TArray<UGraphNodeDialogue*> Children;
+	while (!Worklist.IsEmpty())
 	{
-		UpdateAssetTreeRecursive(Child, VisitedNodes);
+		UGraphNodeDialogue* Current = Worklist.Pop(EAllowShrinking::No);
+
+		bool bAlreadyVisited = false;
+		VisitedNodes.Add(Current, &bAlreadyVisited);
+		if (bAlreadyVisited)
+		{
+			continue;
+		}
+
+		//Link the asset node to its parents
+		Current->LinkAssetNode();
+
+		//Retrieve children and order left to right. They are pushed in 
+		//reverse so that they are visited depth first, left to right.
+		Current->GetChildren(Children);
+		UGraphNodeDialogue::SortNodesLeftToRight(Children);
+
+		for (int32 Index = Children.Num() - 1; Index >= 0; --Index)
+		{
+			if (!VisitedNodes.Contains(Children[Index]))
+			{
+				Worklist.Add(Children[Index]);
+			}
+		}
 	}
 }
 
@@ -423,11 +713,16 @@ void UDialogueEdGraph::OnDialogueGraphChanged(
 				NodeMap.Remove(RemovedNode->GetID());
 			}
 		}
+
+		//Other nodes may still point at the removed node's asset node
+		MarkNeedsFullCompile();
 	}
 }
 
 void UDialogueEdGraph::OnSpeakerRolesChanged()
 {
+	MarkNeedsFullCompile();
+
 	CanCompileAsset(); //Check for error banners
 	UpdateAllNodeVisuals();
 }
@@ -81,11 +81,6 @@ void UGraphNodeDialogue::SetAssetNode(UDialogueNode* InDialogueNode)
 	AssetNode = InDialogueNode;
 }
 
-bool UGraphNodeDialogue::CanCompileNode()
-{
-	return true;
-}
-
 UDialogueEdGraph* UGraphNodeDialogue::GetDialogueGraph() const
 {
 	return GetTypedOuter<UDialogueEdGraph>();
@@ -212,6 +207,32 @@ void UGraphNodeDialogue::MarkDialogueDirty()
 	DialogueGraph->GetDialogue()->SetCompileStatus(
 		EDialogueCompileStatus::Uncompiled
 	);
+	DialogueGraph->NotifyDialogueEdited();
+	bAssetNodeDirty = true;
+}
+
+bool UGraphNodeDialogue::IsAssetNodeDirty() const
+{
+	return bAssetNodeDirty;
+}
+
+void UGraphNodeDialogue::ClearAssetNodeDirty()
+{
+	bAssetNodeDirty = false;
+}
+
+UDialogueNode* UGraphNodeDialogue::ReuseOrCreateAssetNode(
+	TSubclassOf<UDialogueNode> NodeClass, UDialogue* InAsset)
+{
+	check(NodeClass && InAsset);
+
+	if (!AssetNode || AssetNode->GetClass() != NodeClass 
+		|| AssetNode->GetOuter() != InAsset)
+	{
+		AssetNode = NewObject<UDialogueNode>(InAsset, NodeClass);
+	}
+
+	return AssetNode;
 }
 
 void UGraphNodeDialogue::UpdateDialogueNode()
@@ -274,6 +295,7 @@ void UGraphNodeDialogue::AssignAssetNodeID() const
 {
 	check(AssetNode && !ID.IsNone());
 	AssetNode->SetNodeID(ID);
+	AssetNode->SetNodeGuid(NodeGuid);
 }
 
 void UGraphNodeDialogue::AssignAssetNodeCommonData() const
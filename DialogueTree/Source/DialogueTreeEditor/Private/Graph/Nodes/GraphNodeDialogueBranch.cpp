@@ -6,6 +6,7 @@
 #include "Conditionals/DialogueCondition.h"
 #include "Conditionals/Queries/Base/DialogueQuery.h"
 #include "Dialogue.h"
+#include "Graph/DialogueCompileJob.h"
 #include "Graph/DialogueEdGraph.h"
 #include "Graph/DialogueGraphCondition.h"
 #include "Graph/Nodes/GraphNodeDialogue.h"
@@ -83,7 +84,8 @@ FText UGraphNodeDialogueBranch::GetPinMenuLabel(int32 PinIndex) const
 void UGraphNodeDialogueBranch::CreateAssetNode(UDialogue* InAsset)
 {
     UDialogueBranchNode* NewNode =
-        NewObject<UDialogueBranchNode>(InAsset);
+        CastChecked<UDialogueBranchNode>(
+            ReuseOrCreateAssetNode(UDialogueBranchNode::StaticClass(), InAsset));
 
     SetAssetNode(NewNode);
 }
@@ -125,7 +127,8 @@ void UGraphNodeDialogueBranch::FinalizeAssetNode()
     TargetBranch->InitBranchData(bIfAny, TrueNode, FalseNode, AssetConditions);
 }
 
-bool UGraphNodeDialogueBranch::CanCompileNode()
+void UGraphNodeDialogueBranch::GatherCompileFacts(
+    FDialogueNodeCompileFacts& OutFacts)
 {
     for (UDialogueGraphCondition* GraphCondition : Conditions)
     {
@@ -133,13 +136,10 @@ bool UGraphNodeDialogueBranch::CanCompileNode()
 
         if (!Condition || !Condition->IsValidCondition())
         {
-            SetErrorFlag(true);
-            return false;
+            OutFacts.bRequirementsMet = false;
+            return;
         }
     }
-
-    SetErrorFlag(false);
-    return true;
 }
 
 void UGraphNodeDialogueBranch::LoadNodeData(UDialogueNode* InNode)
@@ -42,7 +42,8 @@ FText UGraphNodeDialogueEntry::GetContextMenuName() const
 void UGraphNodeDialogueEntry::CreateAssetNode(UDialogue* InAsset)
 {
 	UDialogueEntryNode* NewNode = 
-		NewObject<UDialogueEntryNode>(InAsset);
+		CastChecked<UDialogueEntryNode>(
+			ReuseOrCreateAssetNode(UDialogueEntryNode::StaticClass(), InAsset));
 
 	SetAssetNode(NewNode);
 }
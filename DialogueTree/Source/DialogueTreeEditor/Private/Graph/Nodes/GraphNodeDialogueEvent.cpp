@@ -7,6 +7,7 @@
 #include "DialogueNodeSocket.h"
 #include "Events/DialogueEventBase.h"
 #include "Events/ResetNodeVisits.h"
+#include "Graph/DialogueCompileJob.h"
 #include "Graph/DialogueEdGraph.h"
 #include "Nodes/DialogueEventNode.h"
 #include "LogDialogueTree.h"
@@ -75,7 +76,8 @@ void UGraphNodeDialogueEvent::CreateAssetNode(UDialogue* InAsset)
 {
 	//Create asset node 
 	UDialogueEventNode* NewNode = 
-		NewObject<UDialogueEventNode>(InAsset);
+		CastChecked<UDialogueEventNode>(
+			ReuseOrCreateAssetNode(UDialogueEventNode::StaticClass(), InAsset));
 	check(NewNode);
 
 	//Store the completed node as the asset node 
@@ -113,20 +115,18 @@ void UGraphNodeDialogueEvent::FinalizeAssetNode()
 	TargetNode->SetEvents(FinalEvents);
 }
 
-bool UGraphNodeDialogueEvent::CanCompileNode()
+void UGraphNodeDialogueEvent::GatherCompileFacts(
+	FDialogueNodeCompileFacts& OutFacts)
 {
 	for (const FGraphDialogueEvent& Event : Events)
 	{
 		if (!Event.Event 
 			|| !Event.Event->HasAllRequirements())
 		{
-			SetErrorFlag(true);
-			return false;
+			OutFacts.bRequirementsMet = false;
+			return;
 		}
 	}
-
-	SetErrorFlag(false);
-	return true;
 }
 
 FName UGraphNodeDialogueEvent::GetBaseID() const
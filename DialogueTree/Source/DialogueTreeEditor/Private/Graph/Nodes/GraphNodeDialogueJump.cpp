@@ -5,6 +5,7 @@
 //Plugin
 #include "Dialogue.h"
 #include "DialogueNodeSocket.h"
+#include "Graph/DialogueCompileJob.h"
 #include "Graph/DialogueEdGraph.h"
 #include "Nodes/DialogueJumpNode.h"
 #include "LogDialogueTree.h"
@@ -42,7 +43,8 @@ void UGraphNodeDialogueJump::PostPasteNode()
 
 void UGraphNodeDialogueJump::CreateAssetNode(UDialogue* InAsset)
 {
-    UDialogueJumpNode* NewNode = NewObject<UDialogueJumpNode>(InAsset);
+    UDialogueJumpNode* NewNode = CastChecked<UDialogueJumpNode>(
+        ReuseOrCreateAssetNode(UDialogueJumpNode::StaticClass(), InAsset));
     check(NewNode);
 
     SetAssetNode(NewNode);
@@ -68,23 +70,13 @@ void UGraphNodeDialogueJump::FinalizeAssetNode()
     TargetAssetNode->SetJumpTarget(TargetGraphNode->GetAssetNode());
 }
 
-bool UGraphNodeDialogueJump::CanCompileNode()
+void UGraphNodeDialogueJump::GatherCompileFacts(
+    FDialogueNodeCompileFacts& OutFacts)
 {
-    UDialogueEdGraph* Graph = GetDialogueGraph();
-    check(Graph);
-
     UGraphNodeDialogue* TargetNode = GetJumpTarget();
 
-    if (TargetNode
-        && Graph->ContainsNode(TargetNode->GetID())
-        && TargetNode != this)
-    {
-        SetErrorFlag(false);
-        return true;
-    }
-
-    SetErrorFlag(true);
-    return false;
+    OutFacts.bNeedsJumpTarget = true;
+    OutFacts.JumpTargetID = TargetNode ? TargetNode->GetID() : NAME_None;
 }
 
 FName UGraphNodeDialogueJump::GetBaseID() const
@@ -26,7 +26,8 @@ void UGraphNodeDialogueJumpBack::AllocateDefaultPins()
 
 void UGraphNodeDialogueJumpBack::CreateAssetNode(UDialogue* InAsset)
 {
-    UDialogueJumpBackNode* NewNode = NewObject<UDialogueJumpBackNode>(InAsset);
+    UDialogueJumpBackNode* NewNode = CastChecked<UDialogueJumpBackNode>(
+        ReuseOrCreateAssetNode(UDialogueJumpBackNode::StaticClass(), InAsset));
     check(NewNode);
     SetAssetNode(NewNode);
 }
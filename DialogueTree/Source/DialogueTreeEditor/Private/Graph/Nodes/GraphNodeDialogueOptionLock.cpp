@@ -6,6 +6,7 @@
 #include "Conditionals/DialogueCondition.h"
 #include "Conditionals/Queries/Base/DialogueQuery.h"
 #include "Dialogue.h"
+#include "Graph/DialogueCompileJob.h"
 #include "Graph/DialogueEdGraph.h"
 #include "Graph/DialogueGraphCondition.h"
 #include "Nodes/DialogueOptionLockNode.h"
@@ -65,7 +66,8 @@ void UGraphNodeDialogueOptionLock::PostPasteNode()
 void UGraphNodeDialogueOptionLock::CreateAssetNode(UDialogue* InAsset)
 {
     UDialogueOptionLockNode* NewNode =
-        NewObject<UDialogueOptionLockNode>(InAsset);
+        CastChecked<UDialogueOptionLockNode>(
+            ReuseOrCreateAssetNode(UDialogueOptionLockNode::StaticClass(), InAsset));
 
     SetAssetNode(NewNode);
 }
@@ -106,7 +108,8 @@ void UGraphNodeDialogueOptionLock::FinalizeAssetNode()
     );
 }
 
-bool UGraphNodeDialogueOptionLock::CanCompileNode()
+void UGraphNodeDialogueOptionLock::GatherCompileFacts(
+    FDialogueNodeCompileFacts& OutFacts)
 {
     for (UDialogueGraphCondition* GraphCondition : Conditions)
     {
@@ -114,13 +117,10 @@ bool UGraphNodeDialogueOptionLock::CanCompileNode()
 
         if (!Condition || !Condition->IsValidCondition())
         {
-            SetErrorFlag(true);
-            return false;
+            OutFacts.bRequirementsMet = false;
+            return;
         }
     }
-
-    SetErrorFlag(false);
-    return true;
 }
 
 void UGraphNodeDialogueOptionLock::LoadNodeData(UDialogueNode* InNode)
@@ -23,7 +23,8 @@ void UGraphNodeDialogueReroute::AllocateDefaultPins()
 void UGraphNodeDialogueReroute::CreateAssetNode(UDialogue* InAsset)
 {
 	UDialogueRerouteNode* NewNode =
-		NewObject<UDialogueRerouteNode>(InAsset);
+		CastChecked<UDialogueRerouteNode>(
+			ReuseOrCreateAssetNode(UDialogueRerouteNode::StaticClass(), InAsset));
 
 	SetAssetNode(NewNode);
 }
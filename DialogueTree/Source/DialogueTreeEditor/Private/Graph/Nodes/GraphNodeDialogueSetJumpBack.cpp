@@ -5,6 +5,7 @@
 
 #include "Dialogue.h"
 #include "DialogueNodeSocket.h"
+#include "Graph/DialogueCompileJob.h"
 #include "Graph/DialogueEdGraph.h"
 #include "Nodes/DialogueJumpNode.h"
 #include "LogDialogueTree.h"
@@ -46,7 +47,8 @@ void UGraphNodeDialogueSetJumpBack::PostPasteNode()
 
 void UGraphNodeDialogueSetJumpBack::CreateAssetNode(UDialogue* InAsset)
 {
-    UDialogueSetJumpBackNode* NewNode = NewObject<UDialogueSetJumpBackNode>(InAsset);
+    UDialogueSetJumpBackNode* NewNode = CastChecked<UDialogueSetJumpBackNode>(
+        ReuseOrCreateAssetNode(UDialogueSetJumpBackNode::StaticClass(), InAsset));
     check(NewNode);
 
     SetAssetNode(NewNode);
@@ -69,21 +71,13 @@ void UGraphNodeDialogueSetJumpBack::FinalizeAssetNode()
     TargetAssetNode->SetJumpTarget(TargetGraphNode->GetAssetNode());
 }
 
-bool UGraphNodeDialogueSetJumpBack::CanCompileNode()
+void UGraphNodeDialogueSetJumpBack::GatherCompileFacts(
+    FDialogueNodeCompileFacts& OutFacts)
 {
-    UDialogueEdGraph* Graph = GetDialogueGraph();
-    check(Graph);
-
     UGraphNodeDialogue* TargetNode = GetJumpTarget();
 
-    if (TargetNode && Graph->ContainsNode(TargetNode->GetID()) && TargetNode != this)
-    {
-        SetErrorFlag(false);
-        return true;
-    }
-
-    SetErrorFlag(true);
-    return false;
+    OutFacts.bNeedsJumpTarget = true;
+    OutFacts.JumpTargetID = TargetNode ? TargetNode->GetID() : NAME_None;
 }
 
 FName UGraphNodeDialogueSetJumpBack::GetBaseID() const
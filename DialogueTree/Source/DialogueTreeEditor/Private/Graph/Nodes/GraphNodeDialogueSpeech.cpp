@@ -6,6 +6,7 @@
 #include "Dialogue.h"
 #include "DialogueSettings.h"
 #include "DialogueSpeakerSocket.h"
+#include "Graph/DialogueCompileJob.h"
 #include "Graph/DialogueEdGraph.h"
 #include "Graph/DialogueEdGraphSchema.h"
 #include "Nodes/DialogueSpeechNode.h"
@@ -113,7 +114,8 @@ void UGraphNodeDialogueSpeech::CreateAssetNode(UDialogue* InAsset)
 
     //Create node
     UDialogueSpeechNode* NewNode = 
-        NewObject<UDialogueSpeechNode>(InAsset);
+        CastChecked<UDialogueSpeechNode>(
+            ReuseOrCreateAssetNode(UDialogueSpeechNode::StaticClass(), InAsset));
     SetAssetNode(NewNode);
     
     //Init data 
@@ -151,29 +153,20 @@ void UGraphNodeDialogueSpeech::CreateAssetNode(UDialogue* InAsset)
     NewNode->InitSpeechData(SpeechDetails, TransitionType);
 }
 
-bool UGraphNodeDialogueSpeech::CanCompileNode()
+void UGraphNodeDialogueSpeech::GatherCompileFacts(
+    FDialogueNodeCompileFacts& OutFacts)
 {
-    if (!Super::CanCompileNode()) 
+    OutFacts.bNeedsSpeaker = true;
+    OutFacts.SpeakerName = Speaker.Speaker
+        ? Speaker.Speaker->GetSpeakerName()
+        : NAME_None;
+
+    OutFacts.bNeedsTransition = true;
+    OutFacts.bHasTransition = TransitionType != nullptr;
+    if (TransitionType)
     {
-        return false;
+        OutFacts.TransitionClassFlags = TransitionType->GetClassFlags();
     }
-    
-    UDialogueEdGraph* Graph = GetDialogueGraph();
-
-    if (TransitionType 
-        && !TransitionType->HasAnyClassFlags(CLASS_Abstract)
-        && Speaker.Speaker
-        && Graph)
-    {
-        if (Graph->HasSpeaker(Speaker.Speaker->GetSpeakerName()))
-        {
-            SetErrorFlag(false);
-            return true;
-        }
-    }
-
-    SetErrorFlag(true);
-    return false;
 }
 
 void UGraphNodeDialogueSpeech::LoadNodeData(UDialogueNode* InNode)
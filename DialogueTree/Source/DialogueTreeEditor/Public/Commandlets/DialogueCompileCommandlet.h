@@ -0,0 +1,140 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+#pragma once
+
+//UE
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+//Plugin
+#include "Graph/DialogueEdGraph.h"
+//Generated
+#include "DialogueCompileCommandlet.generated.h"
+
+struct FAssetData;
+class UDialogue;
+
+/**
+* Struct holding the outcome of compiling a single dialogue asset.
+*/
+struct FDialogueCompileReportEntry
+{
+	/** The asset's object path */
+	FString AssetPath;
+
+	/** The compile status after compiling, or "Error" if it could not be
+	* compiled at all */
+	FString Status;
+
+	/** Whether the editor graph had to be rebuilt from the asset's nodes */
+	bool bRebuiltGraph = false;
+
+	/** Time from the start of the asset's batch until it finished loading */
+	double LoadMs = 0.0;
+
+	/** Time spent compiling */
+	double CompileMs = 0.0;
+
+	/** Compile phase timings and node counts */
+	FDialogueCompileStats Stats;
+
+	/** Problems found, one per line */
+	TArray<FString> Errors;
+};
+
+/**
+* Commandlet that compiles every dialogue in the project, for build
+* machines to verify that no dialogue ships uncompiled. Writes a JSON
+* report with per-asset compile times, node counts and errors, and exits
+* with 1 if any dialogue failed to compile.
+*
+* Usage: -run=DialogueCompile [-Paths=/Game/A,/Game/B] [-BatchSize=32]
+* [-Report=File.json] [-Full] [-Save]
+*/
+UCLASS()
+class DIALOGUETREEEDITOR_API UDialogueCompileCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	/** Constructor */
+	UDialogueCompileCommandlet();
+
+public:
+	/** UCommandlet Impl. */
+	virtual int32 Main(const FString& Params) override;
+	/** End UCommandlet */
+
+private:
+	/**
+	* Finds every dialogue asset under the given paths.
+	*
+	* @param InPaths - const TArray<FString>&, the package paths to search.
+	* @param OutAssets - TArray<FAssetData>&, filled with the dialogues,
+	* sorted by path.
+	*/
+	void FindDialogues(const TArray<FString>& InPaths,
+		TArray<FAssetData>& OutAssets) const;
+
+	/**
+	* Loads the given assets' packages concurrently and waits for all of
+	* them.
+	*
+	* @param InAssets - TConstArrayView<FAssetData>, the assets to load.
+	* @param OutLoadMs - TArray<double>&, filled with the time each asset
+	* took to finish loading.
+	*/
+	void LoadBatch(TConstArrayView<FAssetData> InAssets,
+		TArray<double>& OutLoadMs) const;
+
+	/**
+	* Compiles a single loaded dialogue, rebuilding its graph if needed.
+	*
+	* @param InAsset - const FAssetData&, the dialogue.
+	* @param OutEntry - FDialogueCompileReportEntry&, filled with the result.
+	*/
+	void CompileDialogue(const FAssetData& InAsset,
+		FDialogueCompileReportEntry& OutEntry) const;
+
+	/**
+	* Retrieves the dialogue's editor graph, rebuilding it from the asset's
+	* nodes if it has none.
+	*
+	* @param InDialogue - UDialogue*, the dialogue.
+	* @param OutEntry - FDialogueCompileReportEntry&, notes the rebuild.
+	* @return UDialogueEdGraph*, the graph. Nullptr if none could be built.
+	*/
+	UDialogueEdGraph* FindOrBuildGraph(UDialogue* InDialogue,
+		FDialogueCompileReportEntry& OutEntry) const;
+
+	/**
+	* Saves the dialogue's package.
+	*
+	* @param InDialogue - UDialogue*, the dialogue.
+	* @return bool - True if saved.
+	*/
+	bool SaveDialogue(UDialogue* InDialogue) const;
+
+	/**
+	* Writes the report as JSON.
+	*
+	* @param InEntries - const TArray<FDialogueCompileReportEntry>&, the
+	* results.
+	* @param TotalMs - double, the time the whole run took.
+	* @return bool - True if written.
+	*/
+	bool WriteReport(const TArray<FDialogueCompileReportEntry>& InEntries,
+		double TotalMs) const;
+
+private:
+	/** Where to write the report */
+	FString ReportPath;
+
+	/** How many dialogues to load at once */
+	int32 BatchSize = 32;
+
+	/** Whether to rebuild every node of every dialogue */
+	bool bFullCompile = false;
+
+	/** Whether to save dialogues after compiling them */
+	bool bSave = false;
+};
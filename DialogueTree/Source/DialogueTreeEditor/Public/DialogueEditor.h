@@ -11,6 +11,7 @@
 
 class IDetailsView;
 class UDialogue;
+class UDialogueEdGraph;
 
 /**
 * Manages core editor features and tabs for the dialogue graph. 
@@ -200,7 +201,29 @@ private:
 	FSlateIcon GetStatusImage() const;
 
 	/**
-	* Attempts to compile the dialogue. 
+	* Gets the label for the compile button, showing the progress of any
+	* compile in flight. 
+	* 
+	* @return FText - the label. 
+	*/
+	FText GetCompileLabel() const;
+
+	/**
+	* Gets the tooltip for the compile button. 
+	* 
+	* @return FText - the tooltip. 
+	*/
+	FText GetCompileTooltip() const;
+
+	/**
+	* Retrieves the dialogue's graph, if it has one. 
+	* 
+	* @return UDialogueEdGraph* - the graph. 
+	*/
+	UDialogueEdGraph* GetDialogueGraph() const;
+
+	/**
+	* Attempts to compile the dialogue. Validation runs in the background.
 	*/
 	void OnCompile();
 
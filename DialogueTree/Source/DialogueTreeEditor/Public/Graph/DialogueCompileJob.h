@@ -0,0 +1,214 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+#pragma once
+
+//UE
+#include "CoreMinimal.h"
+#include <atomic>
+//Plugin
+#include "DialogueNodeTable.h"
+
+/**
+* Struct holding everything needed to validate a single graph node, copied
+* out of the node on the game thread. Anything that has to call into the
+* node's objects (conditions, events) is evaluated while copying.
+*/
+struct DIALOGUETREEEDITOR_API FDialogueNodeCompileFacts
+{
+	/** The node's ID */
+	FName ID;
+
+	/** Indices of the node's children in the snapshot */
+	TArray<int32> Children;
+
+	/** Whether the node must have a speaker from the dialogue's roles */
+	bool bNeedsSpeaker = false;
+
+	/** The node's speaker role. None if it has no speaker. */
+	FName SpeakerName;
+
+	/** Whether the node must have an instantiable transition class */
+	bool bNeedsTransition = false;
+
+	/** Whether the node has a transition class */
+	bool bHasTransition = false;
+
+	/** Flags of the node's transition class */
+	EClassFlags TransitionClassFlags = CLASS_None;
+
+	/** Whether the node must target another node in the graph */
+	bool bNeedsJumpTarget = false;
+
+	/** The ID of the node's target. None if it has no target. */
+	FName JumpTargetID;
+
+	/** Whether the node's conditions, queries and events are valid */
+	bool bRequirementsMet = true;
+};
+
+/**
+* Struct holding a copy of a dialogue graph taken on the game thread. Holds
+* no object references, so it can be validated and laid out on any thread.
+*/
+struct DIALOGUETREEEDITOR_API FDialogueCompileSnapshot
+{
+	/** Every node in the graph */
+	TArray<FDialogueNodeCompileFacts> Nodes;
+
+	/** Index of the graph's root in Nodes */
+	int32 RootIndex = INDEX_NONE;
+
+	/** Names of the dialogue's speaker roles */
+	TSet<FName> SpeakerNames;
+
+	/** The node given every index in the node table to build */
+	FDialogueNodeSlots TableSlots;
+
+	/** The layout sources of every index in the node table to build */
+	TArray<FDialogueNodeTableSource> TableSources;
+};
+
+/**
+* Validates a dialogue graph snapshot and lays out its node table. Can be
+* run on a worker thread while the game thread polls its progress; results
+* must only be read once the job is complete.
+*/
+class DIALOGUETREEEDITOR_API FDialogueCompileJob
+{
+public:
+	/**
+	* Constructor.
+	*
+	* @param InSnapshot - FDialogueCompileSnapshot&&, the graph to compile.
+	*/
+	explicit FDialogueCompileJob(FDialogueCompileSnapshot&& InSnapshot);
+
+	/**
+	* Validates every node in parallel, checks which nodes can be reached
+	* from the root and lays out the node table. Thread safe.
+	*/
+	void Run();
+
+	/**
+	* Checks if the job has finished running. Thread safe.
+	*
+	* @return bool - True if complete.
+	*/
+	bool IsComplete() const;
+
+	/**
+	* Retrieves how much of the job has been done. Thread safe.
+	*
+	* @return float, between 0 and 1.
+	*/
+	float GetProgress() const;
+
+	/**
+	* Checks if every node passed validation.
+	*
+	* @return bool - True if the graph can be compiled.
+	*/
+	bool Succeeded() const;
+
+	/**
+	* Checks if the node at the given snapshot index failed validation.
+	*
+	* @param NodeIndex - int32, the node.
+	* @return bool - True if the node has an error.
+	*/
+	bool HasNodeError(int32 NodeIndex) const;
+
+	/**
+	* Retrieves the number of nodes that failed validation.
+	*
+	* @return int32, the error count.
+	*/
+	int32 GetNumErrors() const;
+
+	/**
+	* Retrieves the number of nodes that can never be played because they
+	* cannot be reached from the root.
+	*
+	* @return int32, the unreachable node count.
+	*/
+	int32 GetNumUnreachableNodes() const;
+
+	/**
+	* Retrieves the laid out node table. Its node objects are left for the
+	* game thread to fill in.
+	*
+	* @return FDialogueNodeTable&, the table.
+	*/
+	FDialogueNodeTable& GetTable();
+
+	/**
+	* Retrieves the node given every index in the laid out node table.
+	*
+	* @return FDialogueNodeSlots&, the nodes by node index.
+	*/
+	FDialogueNodeSlots& GetTableSlots();
+
+	/**
+	* Retrieves the time spent validating, on the thread that ran the job.
+	*
+	* @return double, milliseconds.
+	*/
+	double GetValidateMs() const;
+
+	/**
+	* Retrieves the time spent laying out the node table, on the thread
+	* that ran the job.
+	*
+	* @return double, milliseconds.
+	*/
+	double GetTableMs() const;
+
+private:
+	/**
+	* Checks a single node against the rest of the snapshot.
+	*
+	* @param Facts - const FDialogueNodeCompileFacts&, the node.
+	* @param IndicesByID - const TMap<FName, int32>&, snapshot indices.
+	* @return bool - True if the node can be compiled.
+	*/
+	bool ValidateNode(const FDialogueNodeCompileFacts& Facts,
+		const TMap<FName, int32>& IndicesByID) const;
+
+	/**
+	* Walks the snapshot from its root, following children and jumps.
+	*
+	* @param IndicesByID - const TMap<FName, int32>&, snapshot indices.
+	* @return int32, the number of nodes never reached.
+	*/
+	int32 CountUnreachableNodes(const TMap<FName, int32>& IndicesByID) const;
+
+private:
+	/** The graph being compiled */
+	FDialogueCompileSnapshot Snapshot;
+
+	/** One flag per node, set if the node failed validation. One byte per
+	* node so that validation tasks never share a write. */
+	TArray<uint8> NodeErrors;
+
+	/** Number of nodes that failed validation */
+	int32 NumErrors = 0;
+
+	/** Number of nodes that cannot be reached from the root */
+	int32 NumUnreachableNodes = 0;
+
+	/** The laid out node table */
+	FDialogueNodeTable Table;
+
+	/** Time spent validating */
+	double ValidateMs = 0.0;
+
+	/** Time spent laying out the node table */
+	double TableMs = 0.0;
+
+	/** Units of work done so far: one per node validated and one per
+	* table entry laid out */
+	std::atomic<int32> NumWorkDone { 0 };
+
+	/** Set once the job has finished */
+	std::atomic<bool> bComplete { false };
+};
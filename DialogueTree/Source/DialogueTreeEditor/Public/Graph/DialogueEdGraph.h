@@ -5,6 +5,8 @@
 //UE
 #include "CoreMinimal.h"
 #include "EdGraph/EdGraph.h"
+//Plugin
+#include "Graph/DialogueCompileJob.h"
 //Generated
 #include "DialogueEdGraph.generated.h"
 
@@ -15,8 +17,79 @@ class UGraphNodeDialogue;
 class UGraphNodeDialogueBase;
 
 /**
-* Struct representing default colors in the dialogue graph. 
+* Struct describing how long each phase of the last compile took.
 */
+struct DIALOGUETREEEDITOR_API FDialogueCompileStats
+{
+	/** Whether only changed nodes were rebuilt */
+	bool bIncremental = false;
+
+	/** Number of nodes in the graph */
+	int32 NumNodes = 0;
+
+	/** Number of nodes whose asset nodes were rebuilt */
+	int32 NumRebuiltNodes = 0;
+
+	/** Number of nodes that failed validation */
+	int32 NumErrors = 0;
+
+	/** Number of nodes that cannot be reached from the root */
+	int32 NumUnreachableNodes = 0;
+
+	/** Time spent creating and refreshing asset nodes */
+	double CreateMs = 0.0;
+
+	/** Time spent linking asset nodes to each other */
+	double LinkMs = 0.0;
+
+	/** Time spent finalizing rebuilt asset nodes */
+	double FinalizeMs = 0.0;
+
+	/** Time spent copying the graph for validation and layout */
+	double SnapshotMs = 0.0;
+
+	/** Time spent laying out the runtime node table */
+	double TableMs = 0.0;
+
+	/** Time spent validating the graph */
+	double ValidateMs = 0.0;
+
+	/** Time spent committing the results back to the asset */
+	double CommitMs = 0.0;
+
+	/**
+	* Retrieves the time spent on the whole compile.
+	*
+	* @return double, milliseconds.
+	*/
+	double GetTotalMs() const
+	{
+		return CreateMs + LinkMs + FinalizeMs + SnapshotMs + TableMs 
+			+ ValidateMs + CommitMs;
+	}
+};
+
+/**
+* Struct holding the game thread's side of a compile whose results are 
+* awaited.
+*/
+struct FDialoguePendingCompile
+{
+	/** The job validating and laying out the graph */
+	TSharedPtr<FDialogueCompileJob> Job;
+
+	/** The graph node of every snapshot index */
+	TArray<TWeakObjectPtr<UGraphNodeDialogue>> GraphNodes;
+
+	/** The asset node of every node table index */
+	TArray<TWeakObjectPtr<UDialogueNode>> TableNodes;
+
+	/** The graph's edit serial when the compile started */
+	uint32 EditSerial = 0;
+
+	/** Whether every node was rebuilt */
+	bool bFullCompile = false;
+};
 
 /**
  * The graph the user uses to edit a dialogue. 
@@ -44,6 +117,13 @@ public:
 	*/
 	void SetGraphRoot(UGraphNodeDialogue* InRoot);
 
+	/**
+	* Retrieves the graph's root, where the dialogue starts playing. 
+	* 
+	* @return UGraphNodeDialogue*, the root. Nullptr if none.
+	*/
+	UGraphNodeDialogue* GetGraphRoot() const;
+
 	/**
 	* Retrieves the dialogue associated with this graph. Const.
 	* 
@@ -116,12 +196,61 @@ public:
 	/**
 	* Attempts to compile the dialogue graph into its dialogue asset. Sets
 	* the asset's compile status to compiled if successful and failed otherwise.
+	* Only nodes changed since the last successful compile are rebuilt, 
+	* unless a full compile is needed or requested. Returns once finished.
+	* 
+	* @param bForceFullCompile - bool, if true every node is rebuilt.
 	*/
-	void CompileAsset();
+	void CompileAsset(bool bForceFullCompile = false);
+
+	/**
+	* Compiles the dialogue graph like CompileAsset, but validates the graph 
+	* and lays out the node table on a worker thread. Asset nodes are still
+	* created and linked before returning; the rest is committed back to the
+	* asset on the game thread once the worker is done. Supersedes any 
+	* compile still in flight.
+	* 
+	* @param bForceFullCompile - bool, if true every node is rebuilt.
+	*/
+	void CompileAssetAsync(bool bForceFullCompile = false);
+
+	/**
+	* Checks if a compile started by CompileAssetAsync is still running. 
+	* 
+	* @return bool - True if compiling.
+	*/
+	bool IsCompiling() const;
+
+	/**
+	* Retrieves how far along the running compile is. 
+	* 
+	* @return float, between 0 and 1. 0 if not compiling.
+	*/
+	float GetCompileProgress() const;
+
+	/**
+	* Records that the graph changed, so that a compile already in flight 
+	* does not report the dialogue as up to date when it finishes.
+	*/
+	void NotifyDialogueEdited();
+
+	/**
+	* Retrieves timings and node counts for the last compile. 
+	* 
+	* @return const FDialogueCompileStats&, the stats.
+	*/
+	const FDialogueCompileStats& GetLastCompileStats() const;
+
+	/**
+	* Makes the next compile rebuild every node. Used for changes that may 
+	* affect nodes other than the one edited, such as removing a node.
+	*/
+	void MarkNeedsFullCompile();
 
 	/**
 	* Used to determine successful compilation of the dialogue. Checks if the 
-	* dialogue graph is valid and can therefore be compiled. 
+	* dialogue graph is valid and can therefore be compiled, flagging any
+	* nodes that cannot. 
 	* 
 	* @return bool - True if the dialogue can be compiled without issues, false
 	* otherwise. 
@@ -172,6 +301,33 @@ public:
 	void UpdateAllNodeVisuals();
 
 private: 
+	/**
+	* Runs the game thread half of a compile: creates and links the asset 
+	* nodes, then snapshots the graph and asset for validation and layout.
+	* 
+	* @param bForceFullCompile - bool, if true every node is rebuilt.
+	* @return TSharedRef<FDialogueCompileJob>, the job to run. 
+	*/
+	TSharedRef<FDialogueCompileJob> BeginCompile(bool bForceFullCompile);
+
+	/**
+	* Commits the results of a finished compile job to the asset and flags 
+	* any nodes that failed validation. Ignored if the job was superseded.
+	* 
+	* @param Job - const TSharedRef<FDialogueCompileJob>&, the job.
+	*/
+	void FinishCompile(const TSharedRef<FDialogueCompileJob>& Job);
+
+	/**
+	* Copies everything needed to validate the graph's nodes.
+	* 
+	* @param OutSnapshot - FDialogueCompileSnapshot&, filled with the nodes.
+	* @param OutNodes - TArray<TWeakObjectPtr<UGraphNodeDialogue>>&, filled 
+	* with the graph node of every snapshot index.
+	*/
+	void GatherCompileSnapshot(FDialogueCompileSnapshot& OutSnapshot,
+		TArray<TWeakObjectPtr<UGraphNodeDialogue>>& OutNodes) const;
+
 	/**
 	* Clears the asset nodes for all graph nodes.
 	*/
@@ -179,28 +335,37 @@ private:
 
 	/**
 	* Generates the asset nodes associated with each graph node in the 
-	* dialogue graph. Used during compilation of the dialogue asset. 
+	* dialogue graph. Used during compilation of the dialogue asset. Nodes
+	* that have not changed keep their existing asset node.
 	* 
 	* @param InAsset - UDialogue*, asset to populate. 
+	* @param OutRebuiltNodes - TArray<UGraphNodeDialogue*>&, filled with the
+	* nodes whose asset nodes were (re)created.
 	*/
-	void CreateAssetNodes(UDialogue* InAsset);
+	void CreateAssetNodes(UDialogue* InAsset, 
+		TArray<UGraphNodeDialogue*>& OutRebuiltNodes);
 
 	/**
-	* Performs any final steps associated with compiling the various nodes
-	* in the graph into their asset node equivalents.
+	* Performs any final steps associated with compiling the given nodes
+	* into their asset node equivalents.
+	* 
+	* @param InNodes - const TArray<UGraphNodeDialogue*>&, the nodes to
+	* finalize.
 	*/
-	void FinalizeAssetNodes();
+	void FinalizeAssetNodes(const TArray<UGraphNodeDialogue*>& InNodes);
 
 	/**
-	* Traverse the tree of graph nodes recursively, linking up their asset 
-	* nodes to construct an equivalent tree in the dialogue asset. 
-	* 
-	* @param InRoot - UGraphNodeDialogue*, the root of the current subtree.
-	* @param VisitedNodes - TSet<UGraphNodeDialogue*>, the nodes we have
-	* already visited. 
+	* Reorders the conditions of every asset node, rebuilt or not, by the
+	* query costs and pass rates measured so far.
+	*/
+	void ReorderAssetConditions();
+
+	/**
+	* Walks the graph from the root with a single worklist, linking up each
+	* reachable node's asset node to its parents to construct an equivalent
+	* tree in the dialogue asset. Every node and edge is visited once.
 	*/
-	void UpdateAssetTreeRecursive(UGraphNodeDialogue* InRoot, 
-		TSet<UGraphNodeDialogue*> VisitedNodes);
+	void LinkAssetTree();
 
 	/**
 	* Behaviors to trigger when the graph changes. 
@@ -224,4 +389,17 @@ private:
 	/** The collection of dialogue nodes, keyed to their IDs for easy access */
 	UPROPERTY()
 	TMap<FName, TObjectPtr<UGraphNodeDialogue>> NodeMap;
+
+	/** If true, the next compile rebuilds every node. Set until the first 
+	* successful compile of each editing session. */
+	bool bNeedsFullCompile = true;
+
+	/** Timings and node counts for the last compile */
+	FDialogueCompileStats LastCompileStats;
+
+	/** Bumped on every edit, to tell if a compile went stale while running */
+	uint32 EditSerial = 0;
+
+	/** The compile whose results are awaited, if any */
+	FDialoguePendingCompile PendingCompile;
 };
@@ -13,6 +13,7 @@ DECLARE_DELEGATE(FOnUpdateNode);
 
 class UDialogueEdGraph;
 class UDialogueNode;
+struct FDialogueNodeCompileFacts;
 
 /**
  * Abstract base node for all dialogue graph nodes that contain actual content.
@@ -63,11 +64,14 @@ public:
 	void SetAssetNode(UDialogueNode* InDialogueNode);
 
 	/**
-	* Checks if this node can be compiled without problems. Virtual.
+	* Virtual. Copies out everything needed to check if this node can be 
+	* compiled without problems. The checks themselves run later, possibly
+	* on another thread, so anything that needs the node's objects must be
+	* evaluated here. The ID and children are filled in by the graph.
 	* 
-	* @return bool - True if the node can be compiled. False otherwise. 
+	* @param OutFacts - FDialogueNodeCompileFacts&, the facts to fill in.
 	*/
-	virtual bool CanCompileNode();
+	virtual void GatherCompileFacts(FDialogueNodeCompileFacts& OutFacts) {};
 
 	/**
 	* Retrieves the dialogue graph this node exists within. 
@@ -135,7 +139,7 @@ public:
 
 	/**
 	* Called after creating the asset node. Assigns the unique node ID that 
-	* corrsponds to the node. 
+	* corrsponds to the node, along with the graph node's GUID.
 	*/
 	void AssignAssetNodeID() const;
 
@@ -190,10 +194,24 @@ public:
 		TArray<UGraphNodeDialogue*>& OutNodes) const;
 
 	/**
-	* Marks the dialogue as needing to be compiled. 
+	* Marks the dialogue as needing to be compiled, and this node's asset 
+	* node as needing to be rebuilt. 
 	*/
 	void MarkDialogueDirty();
 
+	/**
+	* Checks if the node has changed since its asset node was last built. 
+	* 
+	* @return bool - True if the asset node needs to be rebuilt. 
+	*/
+	bool IsAssetNodeDirty() const;
+
+	/**
+	* Marks the asset node as up to date. Called once the dialogue has 
+	* compiled successfully. 
+	*/
+	void ClearAssetNodeDirty();
+
 	/**
 	* Notifies subscribers that the node has changed. Used mainly to notify
 	* Slate nodes. 
@@ -215,6 +233,19 @@ public:
 	virtual void RegenerateNodeConnections(UDialogueEdGraph* DialogueGraph);
 
 protected:
+	/**
+	* Retrieves the asset node to fill in when (re)creating it. Reuses the
+	* existing asset node if it is of the given class and belongs to the 
+	* asset, so that other nodes referencing it stay valid; creates a new 
+	* one otherwise. 
+	* 
+	* @param NodeClass - TSubclassOf<UDialogueNode>, the asset node class. 
+	* @param InAsset - UDialogue*, the target dialogue asset. 
+	* @return UDialogueNode*, the asset node, set as this node's asset node.
+	*/
+	UDialogueNode* ReuseOrCreateAssetNode(
+		TSubclassOf<UDialogueNode> NodeClass, UDialogue* InAsset);
+
 	/**
 	* Virtual. Links the asset node to the given parent node.
 	*
@@ -261,6 +292,10 @@ private:
 	UPROPERTY()
 	bool bDialogueError = false;
 
+	/** A flag indicating that the node changed since it was last compiled */
+	UPROPERTY()
+	bool bAssetNodeDirty = true;
+
 	/** The ID of the node within the graph */
 	UPROPERTY()
 	FName ID;
@@ -34,7 +34,8 @@ public:
 	/** UGraphNodeDialogue Implementation */
 	virtual void CreateAssetNode(class UDialogue* InAsset) override;
 	virtual void FinalizeAssetNode() override;
-	virtual bool CanCompileNode() override;
+	virtual void GatherCompileFacts(
+		FDialogueNodeCompileFacts& OutFacts) override;
 	virtual void LoadNodeData(UDialogueNode* InNode) override;
 	virtual void RegenerateNodeConnections(
 		UDialogueEdGraph* DialogueGraph
@@ -34,7 +34,8 @@ public:
 	/** UGraphNodeDialogue Impl. */
 	virtual void CreateAssetNode(class UDialogue* InAsset) override;
 	virtual void FinalizeAssetNode() override;
-	virtual bool CanCompileNode() override;
+	virtual void GatherCompileFacts(
+		FDialogueNodeCompileFacts& OutFacts) override;
 	virtual FName GetBaseID() const override;
 	virtual void RegenerateNodeConnections(UDialogueEdGraph* DialogueGraph) override;
 	/** End UGraphNodeDialogue */
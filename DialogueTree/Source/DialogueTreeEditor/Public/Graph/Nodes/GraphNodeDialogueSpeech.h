@@ -51,7 +51,7 @@ struct FSpeechVariationData
 
 	/** The sound to play as audio for the speech */
 	UPROPERTY(EditAnywhere)
-	USoundCue* SpeechAudio;
+	TSoftObjectPtr<USoundCue> SpeechAudio;
 
 };
 
@@ -94,7 +94,8 @@ public:
 
 	/** UGraphNodeDialogue Implementation */
 	virtual void CreateAssetNode(class UDialogue* InAsset) override;
-	virtual bool CanCompileNode() override;
+	virtual void GatherCompileFacts(
+		FDialogueNodeCompileFacts& OutFacts) override;
 	virtual void LoadNodeData(UDialogueNode* InNode) override;
 	/** End UGraphNodeDialogue */
 
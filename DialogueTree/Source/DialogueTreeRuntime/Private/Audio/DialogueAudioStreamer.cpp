@@ -0,0 +1,261 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//Header
+#include "Audio/DialogueAudioStreamer.h"
+//UE
+#include "Sound/SoundCue.h"
+#include "Sound/SoundNodeWavePlayer.h"
+#include "Sound/SoundWave.h"
+//Plugin
+#include "Dialogue.h"
+#include "DialogueNodeTable.h"
+#include "DialogueSession.h"
+#include "Nodes/DialogueSpeechNode.h"
+
+FDialogueAudioStreamer::~FDialogueAudioStreamer()
+{
+	Reset();
+}
+
+void FDialogueAudioStreamer::PrefetchForSession(
+	const UDialogueSession* Session, int32 Depth)
+{
+	if (!Session || !Session->GetDialogue() || !Session->GetActiveNode())
+	{
+		return;
+	}
+
+	const FDialogueNodeTable& Table = Session->GetDialogue()->GetNodeTable();
+	const int32 StartIndex = Session->GetActiveNode()->GetNodeIndex();
+	if (!Table.IsValidIndex(StartIndex))
+	{
+		return;
+	}
+
+	//Walk outwards from the active node one hop at a time
+	TArray<FSoftObjectPath> Window;
+	TBitArray<> Reached(false, Table.Entries.Num());
+	TArray<int32> Frontier;
+	TArray<int32> NextFrontier;
+
+	Reached[StartIndex] = true;
+	Frontier.Add(StartIndex);
+	for (int32 Hop = 0; Hop <= Depth && !Frontier.IsEmpty(); ++Hop)
+	{
+		NextFrontier.Reset();
+		for (int32 NodeIndex : Frontier)
+		{
+			if (Table.Entries[NodeIndex].Kind == EDialogueNodeKind::Speech)
+			{
+				const UDialogueSpeechNode* SpeechNode =
+					Cast<UDialogueSpeechNode>(Table.GetNode(NodeIndex));
+				if (SpeechNode)
+				{
+					SpeechNode->GetSpeechAudio(Window);
+				}
+			}
+
+			auto Reach = [&Reached, &NextFrontier](int32 Target)
+			{
+				if (Target != INDEX_NONE && !Reached[Target])
+				{
+					Reached[Target] = true;
+					NextFrontier.Add(Target);
+				}
+			};
+
+			for (int32 Child : Table.GetChildren(NodeIndex))
+			{
+				Reach(Child);
+			}
+			for (int32 Payload : Table.GetPayloads(NodeIndex))
+			{
+				Reach(Payload);
+			}
+		}
+		Swap(Frontier, NextFrontier);
+	}
+
+	bRequesting = true;
+	for (const FSoftObjectPath& Path : Window)
+	{
+		Request(Path);
+	}
+	bRequesting = false;
+
+	SessionWindows.Add(Session, MoveTemp(Window));
+	Trim();
+}
+
+TSharedPtr<FStreamableHandle> FDialogueAudioStreamer::RequestAudio(
+	const TSoftObjectPtr<USoundCue>& Audio)
+{
+	if (Audio.IsNull())
+	{
+		return nullptr;
+	}
+
+	bRequesting = true;
+	TSharedPtr<FStreamableHandle> Handle =
+		Request(Audio.ToSoftObjectPath()).Handle;
+	bRequesting = false;
+
+	Trim();
+	return Handle;
+}
+
+void FDialogueAudioStreamer::ForgetSession(const UDialogueSession* Session)
+{
+	SessionWindows.Remove(Session);
+	Trim();
+}
+
+void FDialogueAudioStreamer::SetBudget(int64 InBudgetBytes)
+{
+	BudgetBytes = FMath::Max<int64>(InBudgetBytes, 0);
+	Trim();
+}
+
+int64 FDialogueAudioStreamer::GetResidentBytes() const
+{
+	return ResidentBytes;
+}
+
+void FDialogueAudioStreamer::Reset()
+{
+	for (auto& Entry : Entries)
+	{
+		TSharedPtr<FStreamableHandle>& Handle = Entry.Value.Handle;
+		if (Handle.IsValid() && Handle->IsLoadingInProgress())
+		{
+			Handle->CancelHandle();
+		}
+		else if (Handle.IsValid())
+		{
+			Handle->ReleaseHandle();
+		}
+	}
+
+	Entries.Empty();
+	SessionWindows.Empty();
+	ResidentBytes = 0;
+}
+
+FDialogueAudioStreamer::FAudioEntry& FDialogueAudioStreamer::Request(
+	const FSoftObjectPath& Path)
+{
+	FAudioEntry& Entry = Entries.FindOrAdd(Path);
+	Entry.LastUse = ++UseSerial;
+	if (Entry.Handle.IsValid() && Entry.Handle->IsActive())
+	{
+		return Entry;
+	}
+
+	TSharedPtr<FStreamableHandle> Handle = StreamableManager.RequestAsyncLoad(
+		Path,
+		FStreamableDelegate::CreateRaw(
+			this,
+			&FDialogueAudioStreamer::OnAudioLoaded,
+			Path
+		)
+	);
+
+	//The load may have completed inside the request; find the entry again
+	//in case it moved
+	FAudioEntry& Found = Entries.FindChecked(Path);
+	Found.Handle = Handle;
+	return Found;
+}
+
+void FDialogueAudioStreamer::OnAudioLoaded(FSoftObjectPath Path)
+{
+	FAudioEntry* Entry = Entries.Find(Path);
+	if (!Entry || Entry->SizeBytes != INDEX_NONE)
+	{
+		return;
+	}
+
+	Entry->SizeBytes = GetAudioSize(Cast<USoundCue>(Path.ResolveObject()));
+	ResidentBytes += Entry->SizeBytes;
+
+	if (!bRequesting)
+	{
+		Trim();
+	}
+}
+
+void FDialogueAudioStreamer::Trim()
+{
+	if (BudgetBytes <= 0 || ResidentBytes <= BudgetBytes)
+	{
+		return;
+	}
+
+	//Audio near a playing node is about to be heard; never release it
+	TSet<FSoftObjectPath> Pinned;
+	for (auto It = SessionWindows.CreateIterator(); It; ++It)
+	{
+		if (!It->Key.IsValid())
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+		Pinned.Append(It->Value);
+	}
+
+	while (ResidentBytes > BudgetBytes)
+	{
+		const FSoftObjectPath* Oldest = nullptr;
+		uint64 OldestUse = MAX_uint64;
+		for (const auto& Entry : Entries)
+		{
+			const bool bCanRelease = Entry.Value.SizeBytes != INDEX_NONE
+				&& Entry.Value.LastUse < OldestUse
+				&& !Pinned.Contains(Entry.Key);
+			if (bCanRelease)
+			{
+				Oldest = &Entry.Key;
+				OldestUse = Entry.Value.LastUse;
+			}
+		}
+
+		//Everything left is pinned or still loading
+		if (!Oldest)
+		{
+			break;
+		}
+
+		const FSoftObjectPath Path = *Oldest;
+		FAudioEntry Released;
+		Entries.RemoveAndCopyValue(Path, Released);
+		ResidentBytes -= Released.SizeBytes;
+		if (Released.Handle.IsValid())
+		{
+			Released.Handle->ReleaseHandle();
+		}
+	}
+}
+
+int64 FDialogueAudioStreamer::GetAudioSize(USoundCue* Cue)
+{
+	if (!Cue)
+	{
+		return 0;
+	}
+
+	int64 SizeBytes =
+		Cue->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+
+	TArray<USoundNodeWavePlayer*> WavePlayers;
+	Cue->RecursiveFindNode<USoundNodeWavePlayer>(Cue->FirstNode, WavePlayers);
+	for (const USoundNodeWavePlayer* WavePlayer : WavePlayers)
+	{
+		if (USoundWave* Wave = WavePlayer->GetSoundWave())
+		{
+			SizeBytes +=
+				Wave->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		}
+	}
+
+	return SizeBytes;
+}
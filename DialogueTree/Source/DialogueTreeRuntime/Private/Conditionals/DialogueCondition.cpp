@@ -3,6 +3,7 @@
 //Header
 #include "Conditionals/DialogueCondition.h"
 //Plugin
+#include "Conditionals/DialogueQueryProfile.h"
 #include "LogDialogueTree.h"
 
 void UDialogueCondition::SetQuery(UDialogueQuery* InQuery)
@@ -33,7 +34,7 @@ void UDialogueCondition::SetDialogue(UDialogue* InDialogue)
     );
 }
 
-bool UDialogueCondition::IsMet() const
+bool UDialogueCondition::IsMet(UDialogueSession* Session) const
 {
     UE_LOG(
         LogDialogueTree,
@@ -43,6 +44,28 @@ bool UDialogueCondition::IsMet() const
     return false;
 }
 
+bool UDialogueCondition::Evaluate(UDialogueSession* Session, 
+    const UDialogueNode* Owner) const
+{
+    const bool bMet = IsMet(Session);
+    if (FDialogueQueryProfile::IsEnabled())
+    {
+        FDialogueQueryProfile::Get().RecordCondition(Owner, SourceIndex, bMet);
+    }
+
+    return bMet;
+}
+
+void UDialogueCondition::SetSourceIndex(int32 InIndex)
+{
+    SourceIndex = InIndex;
+}
+
+int32 UDialogueCondition::GetSourceIndex() const
+{
+    return SourceIndex;
+}
+
 FText UDialogueCondition::GetDisplayText(const TMap<FName,
     FText>& ArgTexts, const FText QueryText) const
 {
@@ -17,10 +17,10 @@ void UDialogueConditionBool::PostDuplicate(EDuplicateMode::Type DuplicateMode)
 	Query = DuplicateObject<UDialogueQueryBool>(Query, this);
 }
 
-bool UDialogueConditionBool::IsMet() const
+bool UDialogueConditionBool::IsMet(UDialogueSession* Session) const
 {
 	check(Query);
-	bool bQueryValue = Query->ExecuteQuery();
+	bool bQueryValue = Query->Evaluate(Session);
 	
 	if (QueryTrue)
 	{
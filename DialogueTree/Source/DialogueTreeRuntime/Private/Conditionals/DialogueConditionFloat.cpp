@@ -17,10 +17,10 @@ void UDialogueConditionFloat::PostDuplicate(EDuplicateMode::Type DuplicateMode)
 	Query = DuplicateObject<UDialogueQueryFloat>(Query, this);
 }
 
-bool UDialogueConditionFloat::IsMet() const
+bool UDialogueConditionFloat::IsMet(UDialogueSession* Session) const
 {
 	check(Query);
-	double QueryValue = Query->ExecuteQuery();
+	double QueryValue = Query->Evaluate(Session);
 
 	if (Comparison == EFloatComparison::GreaterThan)
 	{
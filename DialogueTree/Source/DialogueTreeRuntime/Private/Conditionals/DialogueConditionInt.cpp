@@ -17,10 +17,10 @@ void UDialogueConditionInt::PostDuplicate(EDuplicateMode::Type DuplicateMode)
     Query = DuplicateObject<UDialogueQueryInt>(Query, this);
 }
 
-bool UDialogueConditionInt::IsMet() const
+bool UDialogueConditionInt::IsMet(UDialogueSession* Session) const
 {
     check(Query);
-    int32 QueryValue = Query->ExecuteQuery();
+    int32 QueryValue = Query->Evaluate(Session);
 
     switch (Comparison)
     {
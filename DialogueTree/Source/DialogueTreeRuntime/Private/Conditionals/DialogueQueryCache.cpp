@@ -0,0 +1,71 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//Header
+#include "Conditionals/DialogueQueryCache.h"
+//Plugin
+#include "Conditionals/Queries/Base/DialogueQuery.h"
+
+bool FDialogueQueryCache::Find(const UDialogueQuery* Query, 
+	uint32 HistorySerial, double& OutValue) const
+{
+	check(Query);
+
+	const FEntry* Entry = Entries.Find(Query);
+	const bool bValid = Entry
+		&& Entry->Epoch == Epoch
+		&& Entry->HistorySerial == HistorySerial
+		&& (Entry->Step == Step 
+			|| Query->GetCachePolicy() == EDialogueQueryCachePolicy::UntilInvalidated);
+	if (!bValid)
+	{
+		return false;
+	}
+
+	OutValue = Entry->Value;
+	return true;
+}
+
+void FDialogueQueryCache::Add(const UDialogueQuery* Query, 
+	uint32 HistorySerial, double Value)
+{
+	check(Query);
+
+	FEntry& Entry = Entries.FindOrAdd(Query);
+	Entry.Value = Value;
+	Entry.Step = Step;
+	Entry.Epoch = Epoch;
+	Entry.HistorySerial = HistorySerial;
+}
+
+void FDialogueQueryCache::BeginStep()
+{
+	if (bHoldStep)
+	{
+		bHoldStep = false;
+		return;
+	}
+
+	++Step;
+}
+
+void FDialogueQueryCache::HoldStep()
+{
+	bHoldStep = true;
+}
+
+void FDialogueQueryCache::Invalidate()
+{
+	++Epoch;
+}
+
+void FDialogueQueryCache::Invalidate(const FGameplayTag& Dependency)
+{
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		const UDialogueQuery* Query = It->Key.ResolveObjectPtr();
+		if (!Query || Query->GetDependencies().HasTag(Dependency))
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
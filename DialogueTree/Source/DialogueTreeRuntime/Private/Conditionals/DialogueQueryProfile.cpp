@@ -0,0 +1,192 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//Header
+#include "Conditionals/DialogueQueryProfile.h"
+//UE
+#include "HAL/IConsoleManager.h"
+//Plugin
+#include "Conditionals/DialogueCondition.h"
+#include "Conditionals/Queries/Base/DialogueQuery.h"
+#include "DialogueSettings.h"
+#include "Nodes/DialogueNode.h"
+
+namespace
+{
+	/** Lowest chance of settling a set a condition is scored with */
+	constexpr float MinSettleChance = 0.01f;
+
+	TAutoConsoleVariable<bool> CVarProfileQueries(
+		TEXT("DialogueTree.ProfileQueries"),
+		WITH_EDITOR != 0,
+		TEXT("Whether dialogue queries record their run times and conditions their pass rates. Pass rates order condition sets when dialogues compile.")
+	);
+
+	FAutoConsoleCommandWithOutputDevice DumpQueryCostsCommand(
+		TEXT("DialogueTree.DumpQueryCosts"),
+		TEXT("Logs the measured run time of every dialogue query class, slowest overall first."),
+		FConsoleCommandWithOutputDeviceDelegate::CreateLambda(
+			[](FOutputDevice& Ar)
+			{
+				FDialogueQueryProfile::Get().Dump(Ar);
+			}
+		)
+	);
+
+	FAutoConsoleCommand ResetQueryProfileCommand(
+		TEXT("DialogueTree.ResetQueryProfile"),
+		TEXT("Forgets every recorded dialogue query run time and condition pass rate."),
+		FConsoleCommandDelegate::CreateLambda(
+			[]()
+			{
+				FDialogueQueryProfile::Get().Reset();
+			}
+		)
+	);
+}
+
+FDialogueQueryProfile::FScopedQueryTimer::FScopedQueryTimer(
+	const UDialogueQuery* InQuery)
+{
+	if (FDialogueQueryProfile::IsEnabled())
+	{
+		Query = InQuery;
+		StartCycles = FPlatformTime::Cycles64();
+	}
+}
+
+FDialogueQueryProfile::FScopedQueryTimer::~FScopedQueryTimer()
+{
+	if (Query)
+	{
+		FDialogueQueryProfile::Get().RecordQuery(
+			Query,
+			FPlatformTime::Cycles64() - StartCycles
+		);
+	}
+}
+
+FDialogueQueryProfile& FDialogueQueryProfile::Get()
+{
+	static FDialogueQueryProfile Profile;
+	return Profile;
+}
+
+bool FDialogueQueryProfile::IsEnabled()
+{
+	return CVarProfileQueries.GetValueOnGameThread();
+}
+
+void FDialogueQueryProfile::RecordQuery(const UDialogueQuery* Query,
+	uint64 Cycles)
+{
+	check(Query);
+
+	FQueryStats& Stats = QueryStats.FindOrAdd(Query->GetClass());
+	++Stats.NumRuns;
+	Stats.TotalCycles += Cycles;
+	Stats.MaxCycles = FMath::Max(Stats.MaxCycles, Cycles);
+}
+
+void FDialogueQueryProfile::RecordCondition(const UDialogueNode* Node,
+	int32 SourceIndex, bool bPassed)
+{
+	if (!Node || SourceIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	FConditionStats& Stats = ConditionStats.FindOrAdd(
+		TPair<TObjectKey<UDialogueNode>, int32>(Node, SourceIndex)
+	);
+	++Stats.NumChecks;
+	Stats.NumPasses += bPassed ? 1 : 0;
+}
+
+float FDialogueQueryProfile::GetPassRate(const UDialogueNode* Node,
+	int32 SourceIndex) const
+{
+	const FConditionStats* Stats = ConditionStats.Find(
+		TPair<TObjectKey<UDialogueNode>, int32>(Node, SourceIndex)
+	);
+	if (!Stats || Stats->NumChecks == 0)
+	{
+		return 0.5f;
+	}
+
+	return static_cast<float>(Stats->NumPasses) / Stats->NumChecks;
+}
+
+bool FDialogueQueryProfile::ShouldReorderConditions()
+{
+	return GetDefault<UDialogueSettings>()->ReorderConditions;
+}
+
+void FDialogueQueryProfile::Dump(FOutputDevice& Ar) const
+{
+	if (QueryStats.IsEmpty())
+	{
+		Ar.Logf(TEXT("No dialogue queries recorded. Is DialogueTree.ProfileQueries enabled?"));
+		return;
+	}
+
+	TArray<TPair<const UClass*, FQueryStats>> SortedStats;
+	for (const auto& Entry : QueryStats)
+	{
+		if (const UClass* QueryClass = Entry.Key.ResolveObjectPtr())
+		{
+			SortedStats.Emplace(QueryClass, Entry.Value);
+		}
+	}
+	SortedStats.Sort(
+		[](const TPair<const UClass*, FQueryStats>& A,
+			const TPair<const UClass*, FQueryStats>& B)
+		{
+			return A.Value.TotalCycles > B.Value.TotalCycles;
+		}
+	);
+
+	Ar.Logf(TEXT("%-48s %10s %12s %12s %12s %8s"),
+		TEXT("Query"), TEXT("Runs"), TEXT("Avg (us)"), TEXT("Max (us)"),
+		TEXT("Total (ms)"), TEXT("Cost"));
+	for (const auto& Entry : SortedStats)
+	{
+		const FQueryStats& Stats = Entry.Value;
+		const double TotalSeconds = FPlatformTime::ToSeconds64(Stats.TotalCycles);
+		const UDialogueQuery* Defaults =
+			Cast<UDialogueQuery>(Entry.Key->GetDefaultObject());
+
+		Ar.Logf(TEXT("%-48s %10lld %12.2f %12.2f %12.3f %8.2f"),
+			*Entry.Key->GetName(),
+			Stats.NumRuns,
+			TotalSeconds * 1000000.0 / FMath::Max<int64>(Stats.NumRuns, 1),
+			FPlatformTime::ToSeconds64(Stats.MaxCycles) * 1000000.0,
+			TotalSeconds * 1000.0,
+			Defaults ? Defaults->GetRelativeCost() : 0.f
+		);
+	}
+}
+
+void FDialogueQueryProfile::Reset()
+{
+	QueryStats.Reset();
+	ConditionStats.Reset();
+}
+
+float FDialogueQueryProfile::GetConditionScore(const UDialogueNode* Node,
+	const UDialogueCondition* Condition, bool bIfAny) const
+{
+	if (!Condition)
+	{
+		return MAX_flt;
+	}
+
+	const UDialogueQuery* Query = Condition->GetQuery();
+	const float Cost = Query ? Query->GetRelativeCost() : 1.f;
+
+	//A set of "any" settles on the first pass, a set of "all" on the
+	//first failure
+	const float PassRate = GetPassRate(Node, Condition->GetSourceIndex());
+	const float SettleChance = bIfAny ? PassRate : 1.f - PassRate;
+
+	return Cost / FMath::Max(SettleChance, MinSettleChance);
+}
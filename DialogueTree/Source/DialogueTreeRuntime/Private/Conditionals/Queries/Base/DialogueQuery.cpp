@@ -4,8 +4,22 @@
 #include "Conditionals/Queries/Base/DialogueQuery.h"
 //Plugin
 #include "Dialogue.h"
+#include "DialogueController.h"
+#include "DialogueSession.h"
 #include "LogDialogueTree.h"
 
+namespace
+{
+    /** Retrieves the history counter of the session's controller */
+    uint32 GetHistorySerial(const UDialogueSession* Session)
+    {
+        const ADialogueController* Controller = Session->GetController();
+        return Controller 
+            ? Controller->GetHistoryStore().GetChangeSerial() 
+            : 0;
+    }
+}
+
 void UDialogueQuery::SetDialogue(UDialogue* InDialogue)
 {
     check(InDialogue);
@@ -27,3 +41,95 @@ bool UDialogueQuery::IsValidQuery() const
 {
     return true;
 }
+
+EDialogueQueryCachePolicy UDialogueQuery::GetCachePolicy() const
+{
+    return CachePolicy;
+}
+
+const FGameplayTagContainer& UDialogueQuery::GetDependencies() const
+{
+    return Dependencies;
+}
+
+bool UDialogueQuery::DependsOnHistory() const
+{
+    return false;
+}
+
+float UDialogueQuery::GetRelativeCost() const
+{
+    return RelativeCost;
+}
+
+bool UDialogueQuery::IsAsyncQuery() const
+{
+    return false;
+}
+
+void UDialogueQuery::ExecuteQueryAsync(UDialogueSession* Session,
+    FDialogueQueryResultSignature OnResolved)
+{
+    UE_LOG(
+        LogDialogueTree,
+        Error,
+        TEXT("Should not use abstract query directly")
+    );
+    OnResolved.ExecuteIfBound(GetTimeoutResult());
+}
+
+float UDialogueQuery::GetAsyncTimeout() const
+{
+    return AsyncTimeout;
+}
+
+double UDialogueQuery::GetTimeoutResult() const
+{
+    return 0.0;
+}
+
+bool UDialogueQuery::HasCachedResult(UDialogueSession* Session) const
+{
+    double Value = 0.0;
+    return FindCachedResult(Session, Value);
+}
+
+bool UDialogueQuery::FindCachedResult(UDialogueSession* Session, 
+    double& OutValue) const
+{
+    if (!Session)
+    {
+        return false;
+    }
+
+    //Async results resolved at the active node take precedence. Copy them
+    //into the cache so a held step keeps them past the node, if the query 
+    //caches at all.
+    if (Session->FindAsyncResult(this, OutValue))
+    {
+        CacheResult(Session, OutValue);
+        return true;
+    }
+
+    if (CachePolicy == EDialogueQueryCachePolicy::Never)
+    {
+        return false;
+    }
+
+    const uint32 HistorySerial = 
+        DependsOnHistory() ? GetHistorySerial(Session) : 0;
+    return Session->GetQueryCache().Find(this, HistorySerial, OutValue);
+}
+
+void UDialogueQuery::CacheResult(UDialogueSession* Session, 
+    double Value) const
+{
+    if (!Session || CachePolicy == EDialogueQueryCachePolicy::Never)
+    {
+        return;
+    }
+
+    const uint32 HistorySerial = 
+        DependsOnHistory() ? GetHistorySerial(Session) : 0;
+    Session->GetQueryCache().Add(this, HistorySerial, Value);
+}
@@ -3,9 +3,10 @@
 //Header
 #include "Conditionals/Queries/Base/DialogueQueryBool.h"
 //Plugin
+#include "Conditionals/DialogueQueryProfile.h"
 #include "LogDialogueTree.h"
 
-bool UDialogueQueryBool::ExecuteQuery()
+bool UDialogueQueryBool::ExecuteQuery(UDialogueSession* Session)
 {
     UE_LOG(
         LogDialogueTree,
@@ -14,3 +15,43 @@ bool UDialogueQueryBool::ExecuteQuery()
     );
     return false;
 }
+
+bool UDialogueQueryBool::Evaluate(UDialogueSession* Session)
+{
+    double Value = 0.0;
+    if (FindCachedResult(Session, Value))
+    {
+        return Value != 0.0;
+    }
+
+    //Async queries are run ahead of time by whatever reads them
+    if (IsAsyncQuery())
+    {
+        UE_LOG(
+            LogDialogueTree,
+            Warning,
+            TEXT("Async query [%s] was evaluated before it was issued. Using its timeout value."),
+            *GetName()
+        );
+        return bTimeoutValue;
+    }
+
+    bool Result;
+    {
+        FDialogueQueryProfile::FScopedQueryTimer Timer(this);
+        Result = ExecuteQuery(Session);
+    }
+    CacheResult(Session, Result ? 1.0 : 0.0);
+    return Result;
+}
+
+void UDialogueQueryBool::ExecuteQueryAsync(UDialogueSession* Session,
+    FDialogueQueryResultSignature OnResolved)
+{
+    OnResolved.ExecuteIfBound(ExecuteQuery(Session) ? 1.0 : 0.0);
+}
+
+double UDialogueQueryBool::GetTimeoutResult() const
+{
+    return bTimeoutValue ? 1.0 : 0.0;
+}
@@ -3,9 +3,10 @@
 //Header
 #include "Conditionals/Queries/Base/DialogueQueryFloat.h"
 //Plugin
+#include "Conditionals/DialogueQueryProfile.h"
 #include "LogDialogueTree.h"
 
-double UDialogueQueryFloat::ExecuteQuery()
+double UDialogueQueryFloat::ExecuteQuery(UDialogueSession* Session)
 {
     UE_LOG(
         LogDialogueTree,
@@ -14,3 +15,43 @@ double UDialogueQueryFloat::ExecuteQuery()
     );
     return 0.0;
 }
+
+double UDialogueQueryFloat::Evaluate(UDialogueSession* Session)
+{
+    double Value = 0.0;
+    if (FindCachedResult(Session, Value))
+    {
+        return Value;
+    }
+
+    //Async queries are run ahead of time by whatever reads them
+    if (IsAsyncQuery())
+    {
+        UE_LOG(
+            LogDialogueTree,
+            Warning,
+            TEXT("Async query [%s] was evaluated before it was issued. Using its timeout value."),
+            *GetName()
+        );
+        return TimeoutValue;
+    }
+
+    double Result;
+    {
+        FDialogueQueryProfile::FScopedQueryTimer Timer(this);
+        Result = ExecuteQuery(Session);
+    }
+    CacheResult(Session, Result);
+    return Result;
+}
+
+void UDialogueQueryFloat::ExecuteQueryAsync(UDialogueSession* Session,
+    FDialogueQueryResultSignature OnResolved)
+{
+    OnResolved.ExecuteIfBound(ExecuteQuery(Session));
+}
+
+double UDialogueQueryFloat::GetTimeoutResult() const
+{
+    return TimeoutValue;
+}
@@ -3,9 +3,10 @@
 //Header
 #include "Conditionals/Queries/Base/DialogueQueryInt.h"
 //Plugin
+#include "Conditionals/DialogueQueryProfile.h"
 #include "LogDialogueTree.h"
 
-int32 UDialogueQueryInt::ExecuteQuery()
+int32 UDialogueQueryInt::ExecuteQuery(UDialogueSession* Session)
 {
     UE_LOG(
         LogDialogueTree,
@@ -14,3 +15,43 @@ int32 UDialogueQueryInt::ExecuteQuery()
     );
     return 0;
 }
+
+int32 UDialogueQueryInt::Evaluate(UDialogueSession* Session)
+{
+    double Value = 0.0;
+    if (FindCachedResult(Session, Value))
+    {
+        return static_cast<int32>(Value);
+    }
+
+    //Async queries are run ahead of time by whatever reads them
+    if (IsAsyncQuery())
+    {
+        UE_LOG(
+            LogDialogueTree,
+            Warning,
+            TEXT("Async query [%s] was evaluated before it was issued. Using its timeout value."),
+            *GetName()
+        );
+        return TimeoutValue;
+    }
+
+    int32 Result;
+    {
+        FDialogueQueryProfile::FScopedQueryTimer Timer(this);
+        Result = ExecuteQuery(Session);
+    }
+    CacheResult(Session, static_cast<double>(Result));
+    return Result;
+}
+
+void UDialogueQueryInt::ExecuteQueryAsync(UDialogueSession* Session,
+    FDialogueQueryResultSignature OnResolved)
+{
+    OnResolved.ExecuteIfBound(ExecuteQuery(Session));
+}
+
+double UDialogueQueryInt::GetTimeoutResult() const
+{
+    return TimeoutValue;
+}
@@ -9,7 +9,16 @@
 
 #define LOCTEXT_NAMESPACE "NodeVisitedQuery"
 
-bool UNodeVisitedQuery::ExecuteQuery()
+UNodeVisitedQuery::UNodeVisitedQuery()
+{
+	//Only changes with the visit history
+	CachePolicy = EDialogueQueryCachePolicy::UntilInvalidated;
+
+	//A lookup in the visit history
+	RelativeCost = 0.25f;
+}
+
+bool UNodeVisitedQuery::ExecuteQuery(UDialogueSession* Session)
 {
 	if (!TargetNode->GetDialogueNode()) //Should not be possible, close dialogue
 	{
@@ -20,11 +29,14 @@ bool UNodeVisitedQuery::ExecuteQuery()
 				"on a nullptr")
 		);
 		
-		GetDialogue()->EndDialogue();
+		GetDialogue()->EndDialogue(Session);
 		return false;
 	}
 
-	return GetDialogue()->WasNodeVisited(TargetNode->GetDialogueNode());
+	return GetDialogue()->WasNodeVisited(
+		Session, 
+		TargetNode->GetDialogueNode()
+	);
 }
 
 FText UNodeVisitedQuery::GetGraphDescription_Implementation() const
@@ -59,6 +71,11 @@ bool UNodeVisitedQuery::IsValidQuery() const
 	return TargetNode && bGraphNode;
 }
 
+bool UNodeVisitedQuery::DependsOnHistory() const
+{
+	return true;
+}
+
 void UNodeVisitedQuery::PostDuplicate(bool bDuplicateForPIE)
 {
 	Super::PostDuplicate(bDuplicateForPIE);
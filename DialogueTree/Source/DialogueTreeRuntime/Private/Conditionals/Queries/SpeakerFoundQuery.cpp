@@ -4,15 +4,25 @@
 #include "Conditionals/Queries/SpeakerFoundQuery.h"
 //Plugin
 #include "Dialogue.h"
+#include "DialogueSession.h"
 #include "DialogueSpeakerSocket.h"
 
 #define LOCTEXT_NAMESPACE "SpeakerFoundQuery"
 
-bool USpeakerFoundQuery::ExecuteQuery()
+USpeakerFoundQuery::USpeakerFoundQuery()
+{
+	//Only changes with the session's speakers
+	CachePolicy = EDialogueQueryCachePolicy::UntilInvalidated;
+
+	//A lookup in the session's speakers
+	RelativeCost = 0.1f;
+}
+
+bool USpeakerFoundQuery::ExecuteQuery(UDialogueSession* Session)
 {
 	check(Speaker);
 
-	return GetDialogue()->SpeakerIsPresent(Speaker->GetSpeakerName());
+	return Session && Speaker->GetSpeakerEntry(Session) != nullptr;
 }
 
 FText USpeakerFoundQuery::GetGraphDescription_Implementation() const
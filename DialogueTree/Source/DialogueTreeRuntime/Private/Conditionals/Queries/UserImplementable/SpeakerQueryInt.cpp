@@ -4,55 +4,59 @@
 #include "Conditionals/Queries/UserImplementable/SpeakerQueryInt.h"
 //Plugin
 #include "Dialogue.h"
+#include "DialogueSession.h"
 #include "DialogueSpeakerComponent.h"
 #include "DialogueSpeakerSocket.h"
 #include "LogDialogueTree.h"
 
-int32 USpeakerQueryInt::ExecuteQuery()
+USpeakerQueryInt::USpeakerQueryInt()
 {
-    //Try to get the speaker component
-    UDialogueSpeakerComponent* SpeakerComponent =
-        Speaker->GetSpeakerComponent(GetDialogue());
-
-    //End the dialogue if speaker component was not found 
-    if (!SpeakerComponent)
-    {
-        UE_LOG(
-            LogDialogueTree,
-            Warning,
-            TEXT("Query failed to execute because the specified speaker component was not found. Verify that the dialogue name property matches the speaker's role in the dialogue.")
-        );
-
-        GetDialogue()->EndDialogue();
-        return false;
-    }
-
-    //Convert main speaker to entry struct
-    FSpeakerActorEntry TargetSpeaker = SpeakerComponent->ToSpeakerActorEntry();
+    //Implemented in Blueprint, so assume the worst until measured
+    RelativeCost = 10.f;
+}
 
-    //Repeat with any additional speakers
-    TArray<FSpeakerActorEntry> OtherSpeakers;
-    for (UDialogueSpeakerSocket* Socket : AdditionalSpeakers)
+int32 USpeakerQueryInt::ExecuteQuery(UDialogueSession* Session)
+{
+    //Gather the speakers from the session's resolved slots
+    const FSpeakerActorEntry* TargetSpeaker = nullptr;
+    FSpeakerActorEntryList OtherSpeakers;
+    if (!Session->GatherSpeakerEntries(
+        Speaker, AdditionalSpeakers, TargetSpeaker, OtherSpeakers))
     {
-        UDialogueSpeakerComponent* SocketComponent =
-            Socket->GetSpeakerComponent(GetDialogue());
-        if (!SocketComponent)
+        //If the main speaker is not found, end the dialogue
+        if (!TargetSpeaker)
         {
             UE_LOG(
                 LogDialogueTree,
                 Warning,
-                TEXT("Query failed to execute because the specified speaker component was not found. Verify that the dialogue name property matches the speaker's role in the dialogue. Returning false.")
+                TEXT("Query failed to execute because the specified speaker component was not found. Verify that the dialogue name property matches the speaker's role in the dialogue.")
             );
+
+            GetDialogue()->EndDialogue(Session);
             return false;
         }
 
-        FSpeakerActorEntry SocketEntry =
-            SocketComponent->ToSpeakerActorEntry();
-        OtherSpeakers.Add(SocketEntry);
+        UE_LOG(
+            LogDialogueTree,
+            Warning,
+            TEXT("Query failed to execute because the specified speaker component was not found. Verify that the dialogue name property matches the speaker's role in the dialogue. Returning false.")
+        );
+        return false;
     }
 
     //Query the speaker
-    return QuerySpeaker(TargetSpeaker, OtherSpeakers);
+    return NativeQuerySpeaker(*TargetSpeaker, OtherSpeakers);
+}
+
+int32 USpeakerQueryInt::NativeQuerySpeaker(
+    const FSpeakerActorEntry& InSpeaker,
+    TConstArrayView<FSpeakerActorEntry> OtherSpeakers) const
+{
+    //Blueprint implementations take an array, so copy the speakers into one
+    return QuerySpeaker(
+        InSpeaker, 
+        TArray<FSpeakerActorEntry>(OtherSpeakers.GetData(), OtherSpeakers.Num())
+    );
 }
 
 bool USpeakerQueryInt::IsValidQuery() const
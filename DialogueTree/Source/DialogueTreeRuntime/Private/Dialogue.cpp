@@ -5,12 +5,21 @@
 //UE
 #include "EdGraph/EdGraph.h"
 #include "Kismet/GameplayStatics.h"
+#include "UObject/UObjectHash.h"
 //Plugin
+#include "Conditionals/DialogueCondition.h"
 #include "DialogueController.h"
+#include "DialogueCustomVersion.h"
+#include "DialogueManagerSubsystem.h"
+#include "DialogueSession.h"
+#include "DialogueSettings.h"
 #include "DialogueSpeakerComponent.h"
 #include "DialogueSpeakerSocket.h"
 #include "LogDialogueTree.h"
+#include "Nodes/DialogueBranchNode.h"
 #include "Nodes/DialogueEntryNode.h"
+#include "Nodes/DialogueOptionLockNode.h"
+#include "Nodes/DialogueSpeechNode.h"
 
 FColor FDefaultDialogueColors::PopColor()
 {
@@ -27,6 +36,82 @@ UDialogue::UDialogue()
 	AddDefaultSpeakers();
 }
 
+void UDialogue::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	//Loaded dialogues read theirs from disk
+	if (!HasAnyFlags(RF_ClassDefaultObject | RF_NeedLoad | RF_WasLoaded))
+	{
+		DialogueGuid = FGuid::NewGuid();
+	}
+}
+
+void UDialogue::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	Ar.UsingCustomVersion(FDialogueCustomVersion::GUID);
+}
+
+void UDialogue::PostLoad()
+{
+	Super::PostLoad();
+
+	//Dialogues saved before they had a GUID get one derived from their 
+	//path, so that it is the same every run until the asset is resaved
+	if (!DialogueGuid.IsValid())
+	{
+		DialogueGuid = FGuid::NewDeterministicGuid(GetPathName());
+	}
+
+	//Dialogues compiled before speaker roles were listed on compile
+	if (SpeakerRoleNames.IsEmpty() 
+		&& CompileStatus == EDialogueCompileStatus::Compiled)
+	{
+		SpeakerRoles.GetKeys(SpeakerRoleNames);
+	}
+
+	//Dialogues compiled before the node table existed, or before node
+	//indices were kept stable
+	if ((NodeTable.Entries.IsEmpty() || NodeSlotIDs.IsEmpty())
+		&& CompileStatus == EDialogueCompileStatus::Compiled)
+	{
+		for (auto& Entry : DialogueNodes)
+		{
+			if (Entry.Value)
+			{
+				Entry.Value->ConditionalPostLoad();
+			}
+		}
+
+		BuildNodeTable();
+	}
+	else
+	{
+		BuildNodeIndexLookup();
+
+		//Dialogues compiled before speakers were found by slot
+		if (CompileStatus == EDialogueCompileStatus::Compiled
+			&& GetLinkerCustomVersion(FDialogueCustomVersion::GUID) 
+				< FDialogueCustomVersion::SavedSpeakerSlots)
+		{
+			ResolveSpeakerSlots();
+		}
+	}
+}
+
+void UDialogue::PostDuplicate(bool bDuplicateForPIE)
+{
+	Super::PostDuplicate(bDuplicateForPIE);
+
+	//A copied asset is a new dialogue with its own history
+	if (!bDuplicateForPIE)
+	{
+		DialogueGuid = FGuid::NewGuid();
+	}
+}
+
 #if WITH_EDITOR
 
 void UDialogue::PostEditChangeProperty(
@@ -48,42 +133,27 @@ void UDialogue::PostEditChangeProperty(
 
 #endif
 
-void UDialogue::SetSpeaker(FName InName, UDialogueSpeakerComponent* InSpeaker)
+void UDialogue::AddSpeakerEntry(FName InName)
 {
-	if (Speakers.Contains(InName))
-	{
-		Speakers[InName] = InSpeaker;
-	}
+	SpeakerRoleNames.AddUnique(InName);
 }
 
-UDialogueSpeakerComponent* UDialogue::GetSpeaker(FName InName) const
+const TArray<FName>& UDialogue::GetSpeakerRoleNames() const
 {
-	if (Speakers.Contains(InName))
-	{
-		return Speakers[InName];
-	}
-
-	return nullptr;
+	return SpeakerRoleNames;
 }
 
-void UDialogue::AddSpeakerEntry(FName InName)
+const FGuid& UDialogue::GetDialogueGuid() const
 {
-	if (!Speakers.Contains(InName))
-	{
-		Speakers.Add(InName, nullptr);
-	}
+	return DialogueGuid;
 }
 
-UWorld* UDialogue::GetWorld() const
-{
-	return IsValid(DialogueController) ? DialogueController->GetWorld() : nullptr;
-}
-
-void UDialogue::OpenDialogueAt(FName InNodeID, ADialogueController* InController, TMap<FName, UDialogueSpeakerComponent*> InSpeakers)
+void UDialogue::OpenDialogueAt(UDialogueSession* Session, FName InNodeID, 
+	const TMap<FName, UDialogueSpeakerComponent*>& InSpeakers) const
 {
 	//Make sure we can start the dialogue 
 	FString ErrorMessage;
-	if (!CanPlay(InController, ErrorMessage))
+	if (!CanPlay(Session, ErrorMessage))
 	{
 		UE_LOG(
 			LogDialogueTree,
@@ -105,174 +175,703 @@ void UDialogue::OpenDialogueAt(FName InNodeID, ADialogueController* InController
 		return;
 	}
 
-	//Store the controller 
-	DialogueController = InController;
-
-	//Fill the speakers with the provided values 
-	FillSpeakers(InSpeakers);
+	//Fill the session's speakers with the provided values 
+	Session->FillSpeakers(InSpeakers);
 
 	//Traverse the first node 
-	UDialogueNode* StartNode = DialogueNodes[InNodeID];
-	check(StartNode);
-	TraverseNode(StartNode);
+	TraverseNodeAt(Session, FindNodeIndex(InNodeID));
 }
 
-void UDialogue::ClearController()
+void UDialogue::OpenDialogueAtIndex(UDialogueSession* Session, 
+	int32 InNodeIndex, 
+	const TMap<FName, UDialogueSpeakerComponent*>& InSpeakers) const
 {
-	DialogueController = nullptr;
+	//Make sure we can start the dialogue 
+	FString ErrorMessage;
+	if (!CanPlay(Session, ErrorMessage))
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Cannot play dialogue. %s"),
+			*ErrorMessage
+		);
+		return;
+	}
+
+	if (!NodeTable.GetNode(InNodeIndex))
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Cannot play dialogue starting from node index %d. No such node exists."),
+			InNodeIndex
+		);
+		return;
+	}
+
+	//Fill the session's speakers with the provided values 
+	Session->FillSpeakers(InSpeakers);
+
+	//Traverse the first node 
+	TraverseNodeAt(Session, InNodeIndex);
 }
 
-void UDialogue::EndDialogue() const
+void UDialogue::EndDialogue(UDialogueSession* Session) const
 {
-	//End the dialogue
-	if (DialogueController)
+	if (!Session || !Session->IsActive())
 	{
-		DialogueController->EndDialogue();
+		return;
 	}
+
+	//Let the controller close its display if this is its dialogue
+	ADialogueController* Controller = Session->GetController();
+	if (Controller && Controller->GetCurrentSession() == Session)
+	{
+		Controller->EndDialogue();
+		return;
+	}
+
+	Session->EndSession();
 }
 
-void UDialogue::DisplaySpeech(const FSpeechDetails& InDetails, int SpeechVariationIndex) const
+void UDialogue::DisplaySpeech(UDialogueSession* Session, 
+	const FSpeechDetails& InDetails, int SpeechVariationIndex) const
 {
-	if (!Speakers[InDetails.SpeakerName] || !DialogueController)
+	check(Session);
+
+	UDialogueSpeakerComponent* Speaker = 
+		Session->GetSpeakerAt(InDetails.SpeakerSlot);
+	ADialogueController* Controller = Session->GetController();
+	if (!Speaker || !Controller)
 	{
-		EndDialogue();
+		EndDialogue(Session);
 		return;
 	}
 
-	DialogueController->DisplaySpeech(InDetails,Speakers[InDetails.SpeakerName], SpeechVariationIndex);
-	DialogueController->OnDialogueSpeechDisplayed.Broadcast(InDetails, SpeechVariationIndex);
+	//Undisplayed sessions only play through their speakers
+	if (!Session->IsDisplayed())
+	{
+		return;
+	}
+
+	Controller->DisplaySpeech(InDetails, Speaker, SpeechVariationIndex);
+	Controller->OnDialogueSpeechDisplayed.Broadcast(InDetails, SpeechVariationIndex);
 }
 
-void UDialogue::DisplayOptions(TArray<FDialogueOption> InOptions) const
+void UDialogue::DisplayOptions(UDialogueSession* Session, 
+	const TArray<FDialogueOption>& InOptions) const
 {
-	if (!DialogueController)
+	check(Session);
+
+	ADialogueController* Controller = Session->GetController();
+	if (!Controller)
 	{
 		UE_LOG(
 			LogDialogueTree,
 			Error,
 			TEXT("Attempting to display options via missing dialogue controller. Aborting dialogue.")
 		);
+		EndDialogue(Session);
 		return;
 	}
 
-	TArray<FSpeechDetails> AllDetails;
-	for (FDialogueOption Option : InOptions)
+	//Nobody can pick an option in a session that is not on the display
+	if (!Session->IsDisplayed())
 	{
-		AllDetails.Add(Option.Details);
+		UE_LOG(
+			LogDialogueTree,
+			Warning,
+			TEXT("Dialogue [%s] reached player options in an undisplayed session. Ending the session."),
+			*GetName()
+		);
+		EndDialogue(Session);
+		return;
 	}
 
-	DialogueController->DisplayOptions(AllDetails);
+	Controller->DisplayOptionList(InOptions);
 }
 
-void UDialogue::SelectOption(int32 InOptionIndex) const
+bool UDialogue::ResolveOption(UDialogueSession* Session, int32 NodeIndex,
+	FDialogueOption& OutOption) const
 {
-	if (ActiveNode)
+	OutOption = FDialogueOption();
+
+	int32 StepIndex = NodeTable.GetOptionProgram(NodeIndex);
+	if (StepIndex == INDEX_NONE)
 	{
-		ActiveNode->SelectOption(InOptionIndex);
+		if (UDialogueNode* Node = NodeTable.GetNode(NodeIndex))
+		{
+			OutOption = Node->GetAsOption(Session);
+		}
+		return OutOption.IsValid();
 	}
-}
 
-void UDialogue::Skip() const
-{
-	if (ActiveNode)
+	UDialogueNode* Target = 
+		NodeTable.GetNode(NodeTable.Entries[NodeIndex].OptionTarget);
+	while (NodeTable.OptionSteps.IsValidIndex(StepIndex))
 	{
-		ActiveNode->Skip();
+		const FDialogueOptionStep& Step = NodeTable.OptionSteps[StepIndex];
+		UDialogueNode* StepNode = NodeTable.GetNode(Step.Node);
+		switch (Step.Op)
+		{
+		case EDialogueOptionOp::Speech:
+			OutOption.Speech = Cast<UDialogueSpeechNode>(StepNode);
+			OutOption.TargetNode = Target;
+			return OutOption.IsValid();
+
+		case EDialogueOptionOp::Branch:
+		{
+			const UDialogueBranchNode* Branch = 
+				CastChecked<UDialogueBranchNode>(StepNode);
+			StepIndex = Branch->PassesConditions(Session)
+				? StepIndex + 1
+				: Step.FalseStep;
+			break;
+		}
+
+		case EDialogueOptionOp::Lock:
+		{
+			//The lock nearest the option decides
+			if (!OutOption.bOverridesLock)
+			{
+				const UDialogueOptionLockNode* Lock = 
+					CastChecked<UDialogueOptionLockNode>(StepNode);
+				OutOption.bOverridesLock = true;
+				OutOption.bIsLocked = !Lock->PassesConditions(Session);
+				OutOption.OptionMessage = OutOption.bIsLocked
+					? Lock->GetLockedMessage()
+					: Lock->GetUnlockedMessage();
+			}
+			++StepIndex;
+			break;
+		}
+
+		case EDialogueOptionOp::Fallback:
+		{
+			if (!StepNode)
+			{
+				return false;
+			}
+
+			FDialogueOption NodeOption = StepNode->GetAsOption(Session);
+			OutOption.Speech = NodeOption.Speech;
+			OutOption.TargetNode = Target ? Target : NodeOption.TargetNode.Get();
+			if (!OutOption.bOverridesLock)
+			{
+				OutOption.bOverridesLock = NodeOption.bOverridesLock;
+				OutOption.bIsLocked = NodeOption.bIsLocked;
+				OutOption.OptionMessage = MoveTemp(NodeOption.OptionMessage);
+			}
+			return OutOption.IsValid();
+		}
+
+		default:
+			return false;
+		}
 	}
+
+	return false;
 }
 
-void UDialogue::TraverseNode(UDialogueNode* InNode)
+void UDialogue::GetOptionQueries(int32 NodeIndex, 
+	TArray<UDialogueQuery*>& OutQueries) const
 {
-	//return if the dialogue is already closed
-	if (!DialogueController)
+	const int32 FirstStep = NodeTable.GetOptionProgram(NodeIndex);
+	if (FirstStep == INDEX_NONE)
 	{
 		return;
 	}
 
-	//If no node provided, end the dialogue
-	if (!InNode)
+	//Programs only jump forward, so every step is visited once
+	TArray<int32, TInlineAllocator<8>> PendingSteps;
+	PendingSteps.Add(FirstStep);
+	while (!PendingSteps.IsEmpty())
 	{
-		EndDialogue();
-		return;
+		int32 StepIndex = PendingSteps.Pop();
+		while (NodeTable.OptionSteps.IsValidIndex(StepIndex))
+		{
+			const FDialogueOptionStep& Step = NodeTable.OptionSteps[StepIndex];
+			const UDialogueNode* StepNode = NodeTable.GetNode(Step.Node);
+			if (Step.Op == EDialogueOptionOp::Branch)
+			{
+				const UDialogueBranchNode* Branch = 
+					CastChecked<UDialogueBranchNode>(StepNode);
+				for (UDialogueCondition* Condition : Branch->GetConditions())
+				{
+					OutQueries.Add(Condition->GetQuery());
+				}
+				PendingSteps.Add(Step.FalseStep);
+			}
+			else if (Step.Op == EDialogueOptionOp::Lock)
+			{
+				const UDialogueOptionLockNode* Lock = 
+					CastChecked<UDialogueOptionLockNode>(StepNode);
+				for (UDialogueCondition* Condition : Lock->GetConditions())
+				{
+					OutQueries.Add(Condition->GetQuery());
+				}
+			}
+			else
+			{
+				break;
+			}
+			++StepIndex;
+		}
 	}
+}
 
-	//Mark the node visited
-	
-	DialogueController->MarkNodeVisited(this, InNode->GetNodeID());
+void UDialogue::SelectOption(UDialogueSession* Session, 
+	int32 InOptionIndex) const
+{
+	if (Session && Session->IsActive() && Session->GetActiveNode())
+	{
+		Session->GetActiveNode()->SelectOption(Session, InOptionIndex);
+	}
+}
 
-	//Traverse the target node 
-	ActiveNode = InNode;
-	ActiveNode->EnterNode();
+void UDialogue::Skip(UDialogueSession* Session) const
+{
+	if (Session && Session->IsActive() && Session->GetActiveNode())
+	{
+		Session->GetActiveNode()->Skip(Session);
+	}
 }
 
-EDialogueCompileStatus UDialogue::GetCompileStatus() const
+void UDialogue::TraverseNode(UDialogueSession* Session, 
+	UDialogueNode* InNode) const
 {
-	return CompileStatus;
+	TraverseNodeAt(Session, OwnsNode(InNode) 
+		? InNode->GetNodeIndex() 
+		: INDEX_NONE
+	);
 }
 
-const TMap<FName, UDialogueSpeakerComponent*>& UDialogue::GetAllSpeakers() const
+void UDialogue::TraverseNodeAt(UDialogueSession* Session, 
+	int32 InNodeIndex) const
 {
-	return Speakers;
+	//return if the session is already closed
+	if (!Session || !Session->IsActive())
+	{
+		return;
+	}
+
+	//Called while a node is being entered; hand the hop to the running 
+	//loop instead of recursing into the next node
+	if (Session->IsTraversing())
+	{
+		Session->DeferTraversal(InNodeIndex);
+		return;
+	}
+
+	//The session stopped waiting; results from the last step are stale
+	Session->GetQueryCache().BeginStep();
+
+	const int32 MaxHops = GetDefault<UDialogueSettings>()->MaxTraversalHops;
+	int32 NumHops = 0;
+	int32 NextIndex = InNodeIndex;
+
+	UWorld* World = Session->GetWorld();
+	UDialogueManagerSubsystem* Manager = World
+		? World->GetSubsystem<UDialogueManagerSubsystem>()
+		: nullptr;
+
+	Session->SetTraversing(true);
+	while (Session->IsActive())
+	{
+		//If no node provided, end the dialogue
+		UDialogueNode* NextNode = NodeTable.GetNode(NextIndex);
+		if (!NextNode)
+		{
+			EndDialogue(Session);
+			break;
+		}
+
+		if (++NumHops > MaxHops)
+		{
+			UE_LOG(
+				LogDialogueTree,
+				Error,
+				TEXT("Dialogue [%s] passed through %d nodes without waiting, stopping at Node %s. Check for a loop of jumps, branches or zero length speeches. Ending dialogue."),
+				*GetName(),
+				MaxHops,
+				*NextNode->GetNodeID().ToString()
+			);
+			EndDialogue(Session);
+			break;
+		}
+
+		//Leaving the previous node, drop anything its transition was 
+		//waiting on
+		Session->ResetTransitionState();
+
+		//Mark the node visited
+		if (ADialogueController* Controller = Session->GetController())
+		{
+			Controller->MarkNodeVisited(Session, NextIndex);
+		}
+
+		//Enter the target node 
+		Session->SetActiveNode(NextNode);
+		if (Manager)
+		{
+			Manager->PrefetchAudio(Session);
+		}
+		const FDialogueNodeResult Result = NextNode->EnterNode(Session);
+
+		if (!Session->IsActive())
+		{
+			break;
+		}
+
+		//A hop made while entering the node (a transition that finished
+		//straight away, an event that stopped blocking) takes precedence
+		if (Session->ConsumeDeferredTraversal(NextIndex))
+		{
+			continue;
+		}
+
+		if (Result.Type == EDialogueNodeResult::Traverse)
+		{
+			NextIndex = Result.NextNodeIndex;
+			continue;
+		}
+
+		if (Result.Type == EDialogueNodeResult::End)
+		{
+			EndDialogue(Session);
+		}
+
+		break;
+	}
+	Session->SetTraversing(false);
 }
 
-bool UDialogue::SpeakerIsPresent(const FName SpeakerName) const
+EDialogueCompileStatus UDialogue::GetCompileStatus() const
 {
-	return GetSpeaker(SpeakerName) != nullptr;
+	return CompileStatus;
 }
 
-bool UDialogue::WasNodeVisited(UDialogueNode* TargetNode) const
+bool UDialogue::WasNodeVisited(const UDialogueSession* Session, 
+	UDialogueNode* TargetNode) const
 {
-	if (!DialogueController || !TargetNode || !DialogueNodes.Contains(TargetNode->GetNodeID()))
+	if (!Session || !Session->IsActive() || !Session->GetController() 
+		|| !OwnsNode(TargetNode))
 	{
 		return false;
 	}
 
-	return DialogueController->WasNodeVisited(this, TargetNode->GetNodeID());
+	return Session->GetController()->WasNodeVisited(
+		Session, 
+		TargetNode->GetNodeIndex()
+	);
 }
 
-void UDialogue::MarkNodeVisited(UDialogueNode* TargetNode, bool bVisited)
+void UDialogue::MarkNodeVisited(UDialogueSession* Session, 
+	UDialogueNode* TargetNode, bool bVisited) const
 {
-	if (!DialogueController || !TargetNode)
+	if (!Session || !Session->GetController() || !OwnsNode(TargetNode))
 	{
 		return;
 	}
 
 	if (bVisited)
 	{
-		DialogueController->MarkNodeVisited(
-			this,
-			TargetNode->GetNodeID()
+		Session->GetController()->MarkNodeVisited(
+			Session,
+			TargetNode->GetNodeIndex()
 		);
 	}
 	else
 	{
-		DialogueController->MarkNodeUnvisited(
-			this,
-			TargetNode->GetNodeID()
+		Session->GetController()->MarkNodeUnvisited(
+			Session,
+			TargetNode->GetNodeIndex()
 		);
 	}
 }
 
-void UDialogue::ClearAllNodeVisits()
+void UDialogue::ClearAllNodeVisits(UDialogueSession* Session) const
 {
-	if (!DialogueController)
+	if (!Session || !Session->GetController())
 	{
 		return;
 	}
 
-	DialogueController->ClearAllNodeVisitsForDialogue(this);
+	Session->GetController()->ClearAllNodeVisitsForDialogue(Session);
 }
 
 bool UDialogue::HasNode(FName NodeID) const
 {
-	return DialogueNodes.Contains(NodeID);
+	return FindNode(NodeID) != nullptr;
 }
 
-void UDialogue::SetResumeNode(UDialogueNode* InNode)
+bool UDialogue::OwnsNode(const UDialogueNode* InNode) const
 {
-	if (InNode && DialogueNodes.Contains(InNode->GetNodeID())
-		&& DialogueController)
+	if (!InNode)
 	{
-		DialogueController->SetResumeNode(this, InNode->GetNodeID());
+		return false;
+	}
+
+	const int32 NodeIndex = InNode->GetNodeIndex();
+	return NodeTable.IsValidIndex(NodeIndex) 
+		&& NodeTable.Nodes[NodeIndex].Get() == InNode;
+}
+
+UDialogueNode* UDialogue::FindNode(FName NodeID) const
+{
+	return NodeTable.GetNode(FindNodeIndex(NodeID));
+}
+
+int32 UDialogue::FindNodeIndex(FName NodeID) const
+{
+	const int32* Found = NodeIndicesByID.Find(NodeID);
+	return Found ? *Found : INDEX_NONE;
+}
+
+const FDialogueNodeTable& UDialogue::GetNodeTable() const
+{
+	return NodeTable;
+}
+
+void UDialogue::BuildNodeTable()
+{
+	FDialogueNodeSlots Slots;
+	TArray<FDialogueNodeTableSource> Sources;
+	FDialogueNodeTable NewTable;
+	GatherNodeTableSources(Slots, NewTable.Nodes, Sources);
+
+	NewTable.BuildLayout(Sources);
+	CommitNodeTable(MoveTemp(Slots), MoveTemp(NewTable));
+}
+
+void UDialogue::GatherNodeTableSources(FDialogueNodeSlots& OutSlots,
+	TArray<TObjectPtr<UDialogueNode>>& OutNodes,
+	TArray<FDialogueNodeTableSource>& OutSources) const
+{
+	//Nodes keep the index they were first given, so that anything recorded
+	//against an index (visit history in save games) survives recompiles.
+	//Nodes that no longer exist leave an empty slot behind.
+	OutSlots.IDs = NodeSlotIDs;
+	OutSlots.Guids = NodeSlotGuids;
+	OutSlots.Guids.SetNum(OutSlots.IDs.Num());
+	OutSlots.RetiredIDs = RetiredNodeIDs;
+
+	//A compile in progress lays out the nodes it staged, not the live ones
+	const TMap<FName, TObjectPtr<UDialogueNode>>* SourceNodes = &DialogueNodes;
+	UDialogueNode* SourceRoot = RootNode;
+#if WITH_EDITORONLY_DATA
+	if (bCompileStaged)
+	{
+		SourceNodes = &StagedNodes;
+		SourceRoot = StagedRootNode;
+	}
+#endif
+
+	TMap<FName, int32> SlotsByID;
+	TMap<FGuid, int32> SlotsByGuid;
+	SlotsByID.Reserve(OutSlots.IDs.Num());
+	SlotsByGuid.Reserve(OutSlots.IDs.Num());
+	for (int32 Slot = 0; Slot < OutSlots.IDs.Num(); ++Slot)
+	{
+		SlotsByID.Add(OutSlots.IDs[Slot], Slot);
+		if (OutSlots.Guids[Slot].IsValid())
+		{
+			SlotsByGuid.Add(OutSlots.Guids[Slot], Slot);
+		}
+	}
+
+	OutNodes.Reset();
+	OutNodes.SetNum(OutSlots.IDs.Num());
+
+	TMap<const UDialogueNode*, int32> SlotsByNode;
+	SlotsByNode.Reserve(SourceNodes->Num());
+	auto AddTableNode = [&](UDialogueNode* InNode)
+	{
+		const FName NodeID = InNode->GetNodeID();
+		const FGuid& NodeGuid = InNode->GetNodeGuid();
+
+		//Match by GUID first, so that a renamed node keeps its index. IDs
+		//only match slots whose node had no GUID, as another slot's ID may
+		//since have been reused by a new node.
+		int32 Slot = INDEX_NONE;
+		if (const int32* FoundByGuid = SlotsByGuid.Find(NodeGuid))
+		{
+			Slot = *FoundByGuid;
+		}
+		else if (const int32* FoundByID = SlotsByID.Find(NodeID))
+		{
+			const FGuid& SlotGuid = OutSlots.Guids[*FoundByID];
+			if (!SlotGuid.IsValid() || !NodeGuid.IsValid())
+			{
+				Slot = *FoundByID;
+			}
+		}
+
+		if (Slot == INDEX_NONE || OutNodes[Slot] != nullptr)
+		{
+			Slot = OutSlots.IDs.Add(NodeID);
+			OutSlots.Guids.Add(NodeGuid);
+			OutNodes.AddDefaulted();
+		}
+		else if (OutSlots.IDs[Slot] != NodeID)
+		{
+			//Renamed; old records can still find the node by its old ID
+			SlotsByID.Remove(OutSlots.IDs[Slot]);
+			OutSlots.RetiredIDs.Add(OutSlots.IDs[Slot], Slot);
+			OutSlots.IDs[Slot] = NodeID;
+		}
+
+		OutSlots.Guids[Slot] = NodeGuid;
+		OutSlots.RetiredIDs.Remove(NodeID);
+		OutNodes[Slot] = InNode;
+		SlotsByNode.Add(InNode, Slot);
+	};
+
+	if (SourceRoot)
+	{
+		AddTableNode(SourceRoot);
+	}
+	for (auto& Entry : *SourceNodes)
+	{
+		if (Entry.Value && Entry.Value != SourceRoot)
+		{
+			AddTableNode(Entry.Value);
+		}
+	}
+
+	//Resolve each node's references to other nodes to their indices
+	auto GetIndex = [&SlotsByNode](const UDialogueNode* InNode)
+	{
+		const int32* Found = SlotsByNode.Find(InNode);
+		return Found ? *Found : INDEX_NONE;
+	};
+
+	OutSources.Reset();
+	OutSources.SetNum(OutNodes.Num());
+	TArray<UDialogueNode*> PayloadNodes;
+	for (int32 Slot = 0; Slot < OutNodes.Num(); ++Slot)
+	{
+		const UDialogueNode* Node = OutNodes[Slot];
+		if (!Node)
+		{
+			continue;
+		}
+
+		FDialogueNodeTableSource& Source = OutSources[Slot];
+		Source.bHasNode = true;
+		Source.Kind = Node->GetNodeKind();
+		Source.SpeakerSlot = SpeakerRoleNames.IndexOfByKey(
+			Node->GetSpeakerRoleName()
+		);
+
+		const TArray<UDialogueNode*> Children = Node->GetChildren();
+		Source.Children.Reserve(Children.Num());
+		for (UDialogueNode* Child : Children)
+		{
+			Source.Children.Add(GetIndex(Child));
+		}
+
+		PayloadNodes.Reset();
+		Node->GetPayloadNodes(PayloadNodes);
+		Source.Payloads.Reserve(PayloadNodes.Num());
+		for (UDialogueNode* Payload : PayloadNodes)
+		{
+			Source.Payloads.Add(GetIndex(Payload));
+		}
+	}
+}
+
+void UDialogue::CommitNodeTable(FDialogueNodeSlots&& InSlots,
+	FDialogueNodeTable&& InTable)
+{
+	check(InTable.Nodes.Num() == InTable.Entries.Num()
+		&& InTable.Nodes.Num() == InSlots.IDs.Num()
+		&& InSlots.IDs.Num() == InSlots.Guids.Num());
+
+#if WITH_EDITOR
+	CommitStagedNodes();
+#endif
+
+	NodeSlotIDs = MoveTemp(InSlots.IDs);
+	NodeSlotGuids = MoveTemp(InSlots.Guids);
+	RetiredNodeIDs = MoveTemp(InSlots.RetiredIDs);
+	NodeTable = MoveTemp(InTable);
+
+	for (int32 Slot = 0; Slot < NodeTable.Nodes.Num(); ++Slot)
+	{
+		if (UDialogueNode* Node = NodeTable.Nodes[Slot])
+		{
+			Node->SetNodeIndex(Slot);
+		}
+	}
+
+	BuildNodeIndexLookup();
+	ResolveSpeakerSlots();
+}
+
+void UDialogue::ResolveSpeakerSlots()
+{
+	for (UDialogueNode* Node : NodeTable.Nodes)
+	{
+		if (Node)
+		{
+			Node->ResolveSpeakerSlots(SpeakerRoleNames);
+		}
+	}
+
+	//Sockets live on the queries and events held by the nodes, wherever
+	//those were created in the package
+	ForEachObjectWithPackage(
+		GetOutermost(),
+		[this](UObject* Object)
+		{
+			if (UDialogueSpeakerSocket* Socket = 
+				Cast<UDialogueSpeakerSocket>(Object))
+			{
+				Socket->SetSpeakerSlot(
+					SpeakerRoleNames.IndexOfByKey(Socket->GetSpeakerName())
+				);
+			}
+			return true;
+		}
+	);
+}
+
+void UDialogue::BuildNodeIndexLookup()
+{
+	//Retired IDs go in first, so a node that has since taken one of them 
+	//as its current ID wins
+	NodeIndicesByID = RetiredNodeIDs;
+	NodeIndicesByID.Reserve(RetiredNodeIDs.Num() + NodeTable.Nodes.Num());
+	for (int32 Slot = 0; Slot < NodeTable.Nodes.Num(); ++Slot)
+	{
+		if (NodeTable.Nodes[Slot] && NodeSlotIDs.IsValidIndex(Slot))
+		{
+			NodeIndicesByID.Add(NodeSlotIDs[Slot], Slot);
+		}
+	}
+}
+
+const TArray<FName>& UDialogue::GetNodeSlotIDs() const
+{
+	return NodeSlotIDs;
+}
+
+const TMap<FName, int32>& UDialogue::GetRetiredNodeIDs() const
+{
+	return RetiredNodeIDs;
+}
+
+void UDialogue::SetResumeNode(UDialogueSession* Session, 
+	UDialogueNode* InNode) const
+{
+	if (OwnsNode(InNode) && Session && Session->GetController())
+	{
+		Session->GetController()->SetResumeNode(
+			Session, 
+			InNode->GetNodeIndex()
+		);
 	}
 }
 
@@ -322,9 +921,11 @@ const TMap<FName, FSpeakerField>& UDialogue::GetSpeakerRoles() const
 
 void UDialogue::AddNode(UDialogueNode* InNode)
 {
-	if (InNode && !DialogueNodes.Contains(InNode->GetNodeID()))
+	TMap<FName, TObjectPtr<UDialogueNode>>& Nodes = 
+		bCompileStaged ? StagedNodes : DialogueNodes;
+	if (InNode && !Nodes.Contains(InNode->GetNodeID()))
 	{
-		DialogueNodes.Add(InNode->GetNodeID(), InNode);
+		Nodes.Add(InNode->GetNodeID(), InNode);
 		InNode->SetDialogue(this);
 	}
 }
@@ -333,7 +934,9 @@ void UDialogue::RemoveNode(UDialogueNode* InNode)
 {
 	if (InNode)
 	{
-		DialogueNodes.Remove(InNode->GetNodeID());
+		(bCompileStaged ? StagedNodes : DialogueNodes).Remove(
+			InNode->GetNodeID()
+		);
 	}
 }
 
@@ -343,7 +946,7 @@ void UDialogue::SetRootNode(UDialogueNode* InNode)
 		= Cast<UDialogueEntryNode>(InNode))
 	{
 		AddNode(EntryNode);
-		RootNode = EntryNode;
+		(bCompileStaged ? StagedRootNode : RootNode) = EntryNode;
 	}
 }
 
@@ -351,19 +954,47 @@ void UDialogue::ClearDialogue()
 {
 	RootNode = nullptr;
 	DialogueNodes.Empty();
-	Speakers.Empty();
+	NodeTable.Reset();
+	NodeIndicesByID.Empty();
+	SpeakerRoleNames.Empty();
 	CompileStatus = EDialogueCompileStatus::Uncompiled;
+
+	bCompileStaged = false;
+	StagedRootNode = nullptr;
+	StagedNodes.Empty();
+	StagedSpeakerRoleNames.Empty();
 }
 
 void UDialogue::PreCompileDialogue()
 {
-	ClearDialogue();
+	//Build into a staging copy; sessions keep playing the live nodes and 
+	//node table until the compile commits its table
+	bCompileStaged = true;
+	StagedRootNode = nullptr;
+	StagedNodes.Reset();
 
 	//Refresh the accessible speaker component entries from their roles
+	StagedSpeakerRoleNames.Reset();
 	for (auto& Entry : SpeakerRoles)
 	{
-		AddSpeakerEntry(Entry.Key);
+		StagedSpeakerRoleNames.AddUnique(Entry.Key);
+	}
+}
+
+void UDialogue::CommitStagedNodes()
+{
+	if (!bCompileStaged)
+	{
+		return;
 	}
+
+	bCompileStaged = false;
+	RootNode = StagedRootNode;
+	DialogueNodes = MoveTemp(StagedNodes);
+	SpeakerRoleNames = MoveTemp(StagedSpeakerRoleNames);
+	StagedRootNode = nullptr;
+	StagedNodes.Reset();
+	StagedSpeakerRoleNames.Reset();
 }
 
 void UDialogue::SetCompileStatus(EDialogueCompileStatus InStatus)
@@ -459,7 +1090,7 @@ void UDialogue::OnChangeSingleSpeaker()
 	}
 }
 
-bool UDialogue::CanPlay(ADialogueController* InController,
+bool UDialogue::CanPlay(const UDialogueSession* Session,
 	FString& OutErrorMessage) const
 {
 	if (CompileStatus != EDialogueCompileStatus::Compiled)
@@ -467,62 +1098,45 @@ bool UDialogue::CanPlay(ADialogueController* InController,
 		OutErrorMessage = "Dialogue is not compiled.";
 		return false;
 	}
-	if (!InController)
+	if (!Session || !Session->IsActive())
 	{
-		OutErrorMessage = "No valid controller provided.";
+		OutErrorMessage = "No active session provided.";
 		return false;
 	}
-	if (!RootNode)
+	if (Session->GetDialogue() != this)
 	{
-		OutErrorMessage = "Entry node does not exist.";
+		OutErrorMessage = "Session was created for a different dialogue.";
 		return false;
 	}
-
-	return true;
-}
-
-void UDialogue::FillSpeakers(TMap<FName, UDialogueSpeakerComponent*> InSpeakers)
-{
-	//Clear speakers 
-	for (auto& Entry : Speakers)
+	if (!Session->GetController())
 	{
-		Entry.Value = nullptr;
+		OutErrorMessage = "No valid controller provided.";
+		return false;
 	}
-
-	//Set speakers
-	for (auto& Entry : InSpeakers)
+	if (!RootNode)
 	{
-		if (Speakers.Contains(Entry.Key) &&
-			Entry.Value != nullptr)
-		{
-			Speakers[Entry.Key] = Entry.Value;
-		}
+		OutErrorMessage = "Entry node does not exist.";
+		return false;
 	}
 
-	//Verify that no speakers are missing 
-	for (auto& Entry : Speakers)
-	{
-		if (!Entry.Value)
-		{
-			DialogueController->HandleMissingSpeaker(Entry.Key);
-		}
-	}
+	return true;
 }
 
-void UDialogue::SetJumpBackNode(UDialogueNode* DialogueNode)
+void UDialogue::SetJumpBackNode(UDialogueSession* Session, 
+	UDialogueNode* DialogueNode) const
 {
-	if (DialogueNode && DialogueNodes.Contains(DialogueNode->GetNodeID()) && DialogueController)
+	if (Session && OwnsNode(DialogueNode))
 	{
-		DialogueController->SetJumpBackNode(this, DialogueNode->GetNodeID());
+		Session->SetJumpBackNodeIndex(DialogueNode->GetNodeIndex());
 	}
 }
 
-bool UDialogue::JumpBack()
+bool UDialogue::JumpBack(UDialogueSession* Session) const
 {
-	FName JumpBackNodeId = DialogueController->GetJumpBackNode(this);
-	if (JumpBackNodeId.IsNone())
+	const int32 JumpBackIndex = Session->ConsumeJumpBackNodeIndex();
+	if (JumpBackIndex == INDEX_NONE)
 		return false;
 	
-	TraverseNode(DialogueNodes[JumpBackNodeId]);
+	TraverseNodeAt(Session, JumpBackIndex);
 	return true;
 }
@@ -4,15 +4,75 @@
 #include "DialogueController.h"
 //Plugin
 #include "Dialogue.h"
+#include "DialogueManagerSubsystem.h"
+#include "DialogueSession.h"
+#include "DialogueSettings.h"
 #include "DialogueSpeakerComponent.h"
+#include "History/DialogueHistoriesCodec.h"
+#include "History/DialogueHistoryColdStore.h"
+#include "History/DialogueHistoryJournal.h"
 #include "LogDialogueTree.h"
+#include "Nodes/DialogueNode.h"
 //Engine
+#include "Engine/World.h"
 #include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 #include "UObject/UObjectIterator.h"
 
 
+namespace
+{
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice DumpHistoryMemoryCommand(
+		TEXT("DialogueTree.DumpHistoryMemory"),
+		TEXT("Logs the memory held by the current dialogue controller's node visit records, by speaker persistence."),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda(
+			[](const TArray<FString>&, UWorld* World, FOutputDevice& Ar)
+			{
+				UDialogueManagerSubsystem* Subsystem = World 
+					? World->GetSubsystem<UDialogueManagerSubsystem>()
+					: nullptr;
+				ADialogueController* Controller = Subsystem 
+					? Subsystem->GetCurrentController()
+					: nullptr;
+				if (!Controller)
+				{
+					Ar.Logf(TEXT("No active dialogue controller."));
+					return;
+				}
+
+				const FDialogueHistoryMemoryStats Stats = 
+					Controller->GetHistoryStore().GetMemoryStats();
+				const UEnum* PersistenceEnum = 
+					StaticEnum<EDialogueSpeakerPersistence>();
+
+				Ar.Logf(
+					TEXT("%d dialogue records, %llu bytes of overhead, %lld speaker records on disk"),
+					Stats.NumDialogueRecords,
+					static_cast<uint64>(Stats.OverheadBytes),
+					Stats.NumColdSpeakerRecords
+				);
+				for (int32 Class = 0; 
+					Class < FDialogueHistoryMemoryStats::NumClasses; ++Class)
+				{
+					Ar.Logf(
+						TEXT("  %-12s %8d speaker records %10llu bytes"),
+						*PersistenceEnum->GetNameStringByIndex(Class),
+						Stats.NumSpeakerRecords[Class],
+						static_cast<uint64>(Stats.SpeakerBytes[Class])
+					);
+				}
+			}
+		)
+	);
+}
+
 // Sets default values
-ADialogueController::ADialogueController()
+ADialogueController::ADialogueController() :
+	HistoryPublisher(
+		MakeShared<FDialogueHistoryPublisher, ESPMode::ThreadSafe>()
+	)
 {
 	PrimaryActorTick.bCanEverTick = false;
 
@@ -21,19 +81,28 @@ ADialogueController::ADialogueController()
 #endif
 }
 
+void ADialogueController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	HistoryStore.SetMaxEphemeralSpeakers(
+		GetDefault<UDialogueSettings>()->MaxEphemeralSpeakers
+	);
+}
+
 void ADialogueController::SelectOption(int32 InOptionIndex) const
 {
-	if (CurrentDialogue)
+	if (CurrentDialogue && CurrentSession)
 	{
-		CurrentDialogue->SelectOption(InOptionIndex);
+		CurrentDialogue->SelectOption(CurrentSession, InOptionIndex);
 	}
 }
 
 TMap<FName, UDialogueSpeakerComponent*> ADialogueController::GetSpeakers() const
 {
-	if (CurrentDialogue)
+	if (CurrentSession)
 	{
-		return CurrentDialogue->GetAllSpeakers();
+		return CurrentSession->GetAllSpeakers();
 	}
 
 	return TMap<FName, UDialogueSpeakerComponent*>();
@@ -60,27 +129,35 @@ void ADialogueController::StartDialogueWithNames(UDialogue* InDialogue, TMap<FNa
 	}
 
 	//Set the target dialogue 
-	CurrentDialogue = InDialogue;
+	UDialogueSession* Session = BeginSession(InDialogue, InSpeakers);
+	if (!Session)
+	{
+		return;
+	}
 
 	//Get start node 
-	FName StartNodeID = CurrentDialogue->GetRootNode()->GetNodeID();
-	FName DialogueName = CurrentDialogue->GetFName();
-	if (bResume && DialogueHistories.Histories.Contains(DialogueName))
+	int32 StartIndex = CurrentDialogue->GetRootNode()->GetNodeIndex();
+	if (bResume)
 	{
-		const auto& DialogueHistory = DialogueHistories.Histories[DialogueName];
+		const FGuid& DialogueId = CurrentDialogue->GetDialogueGuid();
 		for (const auto& Speaker : InSpeakers)
 		{
-			const auto* CharacterDialogueHistory = DialogueHistory.DialogueNodeHistory.Find(Speaker.Value->GetDialogueSpeakerId());
-			if (CharacterDialogueHistory)
+			if (!Speaker.Value)
 			{
-				if (!CharacterDialogueHistory->ResumeNodeID.IsNone() && CurrentDialogue->HasNode(CharacterDialogueHistory->ResumeNodeID))
-				{
-					StartNodeID = CharacterDialogueHistory->ResumeNodeID;
-					break;
-				}
+				continue;
+			}
+
+			const FGuid SpeakerId = Speaker.Value->GetDialogueSpeakerId();
+			const int32 ResumeIndex = HistoryStore.FindResumeNode(
+				DialogueId, 
+				MakeArrayView(&SpeakerId, 1)
+			);
+			if (CurrentDialogue->GetNodeTable().GetNode(ResumeIndex))
+			{
+				StartIndex = ResumeIndex;
+				break;
 			}
 		}
-		
 	}
 
 	for (auto& DialogueParticipant : InSpeakers)
@@ -92,7 +169,7 @@ void ADialogueController::StartDialogueWithNames(UDialogue* InDialogue, TMap<FNa
 	OpenDisplay();
 
 	OnDialogueStarted.Broadcast();
-	CurrentDialogue->OpenDialogueAt(StartNodeID, this, InSpeakers);
+	CurrentDialogue->OpenDialogueAtIndex(Session, StartIndex, InSpeakers);
 }
 
 void ADialogueController::StartDialogue(UDialogue* InDialogue, TArray<UDialogueSpeakerComponent*> InSpeakers, bool bResume)
@@ -185,10 +262,14 @@ void ADialogueController::StartDialogueWithNamesAt(UDialogue* InDialogue, FName
 		return;
 	}
 
-	CurrentDialogue = InDialogue;
+	UDialogueSession* Session = BeginSession(InDialogue, InSpeakers);
+	if (!Session)
+	{
+		return;
+	}
 
 	OpenDisplay();
-	CurrentDialogue->OpenDialogueAt(NodeID, this, InSpeakers);
+	CurrentDialogue->OpenDialogueAt(Session, NodeID, InSpeakers);
 	OnDialogueStarted.Broadcast();
 }
 
@@ -261,295 +342,676 @@ void ADialogueController::EndDialogue()
 	CloseDisplay();
 	OnDialogueEnded.Broadcast();
 
-	if (CurrentDialogue)
+	//Release the speakers and stop any pending transitions
+	if (CurrentSession)
 	{
-		//Clear any behavior flags from the speakers and stop speaking
-		for (auto& Entry : CurrentDialogue->GetAllSpeakers())
-		{
-			if (Entry.Value)
-			{
-				Entry.Value->OnDialogueEnded(CurrentDialogue);
-				Entry.Value->Stop();
-				Entry.Value->ClearGameplayTags();
-			}
-		}
-
-		CurrentDialogue->ClearController();
-		CurrentDialogue = nullptr;
+		UDialogueSession* EndingSession = CurrentSession;
+		CurrentSession = nullptr;
+		EndingSession->EndSession();
 	}
 
-	ActiveJumpBack.Clear();
+	CurrentDialogue = nullptr;
 }
 
 void ADialogueController::Skip() const
 {
-	if (CurrentDialogue)
+	if (CurrentDialogue && CurrentSession)
 	{
-		CurrentDialogue->Skip();
+		CurrentDialogue->Skip(CurrentSession);
 	}
 }
 
 void ADialogueController::ClearNodeVisits()
 {
-	if (CurrentDialogue)
+	if (CurrentSession)
 	{
-		ClearAllNodeVisitsForDialogue(CurrentDialogue);
+		ClearAllNodeVisitsForDialogue(CurrentSession);
 	}
 }
 
 void ADialogueController::SetSpeaker(FName InName,
 	UDialogueSpeakerComponent* InSpeaker)
 {
-	if (CurrentDialogue && InSpeaker)
+	if (CurrentSession && InSpeaker)
 	{
-		CurrentDialogue->SetSpeaker(InName, InSpeaker);
+		CurrentSession->SetSpeaker(InName, InSpeaker);
 	}
 }
 
 FDialogueHistories ADialogueController::GetDialogueRecords() const
 {
-	return DialogueHistories;
+	FDialogueHistories Records;
+	ExportDialogueRecords(Records);
+	return Records;
+}
+
+void ADialogueController::ExportDialogueRecords(
+	FDialogueHistories& OutRecords) const
+{
+	//Records not yet converted are passed back as they came in
+	OutRecords.Histories = PendingRecords.Histories;
+
+	//Keyed by object path, as dialogues in different folders may share a
+	//name. Paths are built once per dialogue.
+	TMap<FGuid, FName> Keys;
+	auto ExportSpeaker = [this, &OutRecords, &Keys](const FGuid& DialogueId,
+		const FGuid& SpeakerId, const FDialogueSpeakerHistory& Speaker)
+	{
+		//Only persistent speakers are saved
+		const TWeakObjectPtr<const UDialogue>* Found = 
+			KnownDialogues.Find(DialogueId);
+		const UDialogue* Dialogue = Found ? Found->Get() : nullptr;
+		if (!Dialogue || !HistoryStore.IsPersistent(SpeakerId))
+		{
+			return;
+		}
+
+		const FName* Key = Keys.Find(DialogueId);
+		if (!Key)
+		{
+			Key = &Keys.Add(DialogueId, FName(*Dialogue->GetPathName()));
+		}
+
+		const TArray<FName>& NodeIDs = Dialogue->GetNodeSlotIDs();
+		FDialogueHistory& History = OutRecords.Histories.FindOrAdd(*Key);
+		History.DialogueFName = Dialogue->GetFName();
+		History.DialogueGuid = DialogueId;
+
+		FCharacterDialogueHistory& CharacterHistory = 
+			History.DialogueNodeHistory.FindOrAdd(SpeakerId);
+
+		Speaker.VisitedNodes.ForEach(
+			[&NodeIDs, &CharacterHistory](int32 NodeIndex)
+			{
+				if (NodeIDs.IsValidIndex(NodeIndex))
+				{
+					CharacterHistory.VisitedNodeIDs.Add(NodeIDs[NodeIndex]);
+				}
+			}
+		);
+
+		if (NodeIDs.IsValidIndex(Speaker.ResumeNodeIndex))
+		{
+			CharacterHistory.ResumeNodeID = NodeIDs[Speaker.ResumeNodeIndex];
+		}
+	};
+
+	for (const auto& RecordEntry : HistoryStore.Records)
+	{
+		for (const auto& SpeakerEntry : RecordEntry.Value.Speakers)
+		{
+			ExportSpeaker(RecordEntry.Key, SpeakerEntry.Key, SpeakerEntry.Value);
+		}
+	}
+
+	//Records spilled to the cold store are exported as well
+	HistoryStore.ForEachColdSpeaker(ExportSpeaker);
 }
 
 void ADialogueController::ClearDialogueRecords()
 {
-	DialogueHistories.Histories.Empty();
+	HistoryStore.Empty();
+	PendingRecords.Histories.Empty();
+	NotifyAllHistoriesChanged();
 }
 
-void ADialogueController::ImportDialogueRecords(FDialogueHistories InRecords)
+void ADialogueController::ImportDialogueRecords(
+	const FDialogueHistories& InRecords)
 {
-	DialogueHistories = InRecords;
+	AdoptDialogueRecords(CopyTemp(InRecords));
 }
 
-bool ADialogueController::SpeakerInCurrentDialogue(UDialogueSpeakerComponent* TargetSpeaker) const
+void ADialogueController::AdoptDialogueRecords(
+	FDialogueHistories&& InRecords)
 {
-	//If no active dialogue, then automatically false
-	if (!CurrentDialogue)
+	HistoryStore.Empty();
+	PendingRecords = MoveTemp(InRecords);
+
+	//Convert whatever we already can; the rest waits for its dialogue
+	ResolveAllPendingRecords();
+	NotifyAllHistoriesChanged();
+}
+
+void ADialogueController::SaveDialogueRecords(TArray<uint8>& OutBytes) const
+{
+	//Imported records not yet played since follow the store
+	HistoryStore.SaveToBytes(OutBytes);
+	FMemoryWriter Writer(OutBytes, false, true);
+	FDialogueHistoriesCodec::Write(Writer, PendingRecords);
+}
+
+bool ADialogueController::LoadDialogueRecords(const TArray<uint8>& InBytes)
+{
+	PendingRecords.Histories.Empty();
+	HistoryStore.Empty();
+	if (InBytes.IsEmpty())
 	{
-		return false;
+		return true;
 	}
 
-	if (CurrentDialogue->bUseGenericSpeakerNames)
+	FMemoryReader Reader(InBytes);
+	HistoryStore.Serialize(Reader);
+
+	//Saves made before imported records were kept end with the store
+	if (!Reader.IsError() && !Reader.AtEnd())
 	{
-		for (const auto& SpeakerKVP : CurrentDialogue->GetAllSpeakers())
-		{
-			if (SpeakerKVP.Value == TargetSpeaker)
-				return true;
-		}
-		
+		FDialogueHistoriesCodec::Read(Reader, PendingRecords);
+	}
+
+	if (Reader.IsError())
+	{
+		HistoryStore.Empty();
+		PendingRecords.Histories.Empty();
+		NotifyAllHistoriesChanged();
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Could not load dialogue records. The saved data is corrupt or from a newer version.")
+		);
 		return false;
 	}
-	else
+
+	ResolveAllPendingRecords();
+	NotifyAllHistoriesChanged();
+	return true;
+}
+
+bool ADialogueController::SaveDialogueRecordChanges(TArray<uint8>& OutBytes)
+{
+	OutBytes.Reset();
+	FMemoryWriter Writer(OutBytes);
+
+	//Imported records not yet played since only change on import, which
+	//always leads to a full save
+	const bool bFull = HistoryStore.SaveChanges(Writer);
+	if (bFull)
 	{
-		//Retrieve speakers
-		TMap<FName, UDialogueSpeakerComponent*> Speakers = CurrentDialogue->GetAllSpeakers();
-		TArray<FName> SpeakerRoles;
-		Speakers.GetKeys(SpeakerRoles);
+		FDialogueHistoriesCodec::Write(Writer, PendingRecords);
+	}
 
-		//If any one speaker matches the target, true
-		for (FName NextRole : SpeakerRoles)
-		{
-			if (Speakers[NextRole] == TargetSpeaker)
-			{
-				return true;
-			}
-		}	
+	return bFull;
+}
+
+bool ADialogueController::ApplyDialogueRecordChanges(
+	const TArray<uint8>& InBytes)
+{
+	if (!ApplyRecordChanges(InBytes))
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Could not apply dialogue record changes. The saved data is corrupt or from a newer version.")
+		);
+		return false;
 	}
 
-	//No speakers matched the target, false
-	return false;
+	ResolveAllPendingRecords();
+	NotifyAllHistoriesChanged();
+	return true;
 }
 
-void ADialogueController::MarkNodeVisited(UDialogue* TargetDialogue, FName TargetNodeID)
+void ADialogueController::AppendDialogueRecordJournal(TArray<uint8>& Journal)
 {
-	if (!TargetDialogue)
+	//Every journal starts with a snapshot
+	if (Journal.IsEmpty() || FDialogueHistoryJournal::ShouldCompact(Journal))
+	{
+		HistoryStore.MarkAllDirty();
+	}
+	else if (!HistoryStore.HasUnsavedChanges())
 	{
 		return;
 	}
 
-	FName TargetDialogueName = TargetDialogue->GetFName();
+	TArray<uint8> Frame;
+	const bool bFull = SaveDialogueRecordChanges(Frame);
+	FDialogueHistoryJournal::AppendFrame(Journal, Frame, bFull);
+}
 
-	if (TargetDialogueName.IsEqual(NAME_None))
+void ADialogueController::CompactDialogueRecordJournal(TArray<uint8>& Journal)
+{
+	Journal.Reset();
+	AppendDialogueRecordJournal(Journal);
+}
+
+bool ADialogueController::LoadDialogueRecordJournal(
+	const TArray<uint8>& Journal)
+{
+	HistoryStore.Empty();
+	PendingRecords.Histories.Empty();
+
+	const bool bLoaded = FDialogueHistoryJournal::ForEachFrame(
+		Journal,
+		[this](TConstArrayView<uint8> Frame)
+		{
+			return ApplyRecordChanges(Frame);
+		}
+	);
+	if (!bLoaded)
 	{
-		return;
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Could not replay the whole dialogue record journal. The saved data is corrupt or from a newer version.")
+		);
+	}
+
+	ResolveAllPendingRecords();
+	NotifyAllHistoriesChanged();
+	return bLoaded;
+}
+
+bool ADialogueController::WasNodeVisitedBy(const UDialogue* Dialogue, 
+	FName NodeID, FGuid SpeakerId) const
+{
+	if (!Dialogue)
+	{
+		return false;
 	}
 
-	//Create a new record if the target record does not exist
-	if (!DialogueHistories.Histories.Contains(TargetDialogueName))
+	const FDialogueSpeakerHistory* Speaker = HistoryStore.FindSpeaker(
+		Dialogue->GetDialogueGuid(), 
+		SpeakerId
+	);
+	return Speaker 
+		&& Speaker->VisitedNodes.Contains(Dialogue->FindNodeIndex(NodeID));
+}
+
+void ADialogueController::SetSpeakerPersistence(const FGuid& SpeakerId,
+	EDialogueSpeakerPersistence Persistence)
+{
+	const uint32 ChangeSerial = HistoryStore.GetChangeSerial();
+	HistoryStore.SetSpeakerPersistence(SpeakerId, Persistence);
+
+	//Eviction may have dropped other speakers' records
+	if (HistoryStore.GetChangeSerial() != ChangeSerial)
 	{
-		FDialogueHistory NewRecord;
-		NewRecord.DialogueFName = TargetDialogueName;
+		NotifyAllHistoriesChanged();
+	}
+}
 
-		DialogueHistories.Histories.Add(TargetDialogueName, NewRecord);
+bool ADialogueController::OpenColdHistoryStore(const FString& Directory)
+{
+	TSharedPtr<FDialogueHistoryColdStore> ColdStore = 
+		MakeShared<FDialogueHistoryColdStore>();
+	if (!ColdStore->Open(Directory))
+	{
+		return false;
 	}
 
-	//Mark the node visited in the record
-	const auto& SpeakersIds = GetSpeakerIds(TargetDialogue);
-	for (const auto& SpeakerId : SpeakersIds)
+	HistoryStore.SetColdStore(ColdStore);
+	SpillColdRecords();
+	return true;
+}
+
+int32 ADialogueController::PruneDialogueRecords()
+{
+	//Only empty records are dropped, so no visits appear to change
+	return HistoryStore.Prune();
+}
+
+FDialogueHistoryChangedDelegate& ADialogueController::OnDialogueHistoryChanged(
+	const UDialogue* Dialogue)
+{
+	check(Dialogue);
+	return HistoryChangedDelegates.FindOrAdd(Dialogue->GetDialogueGuid());
+}
+
+const FDialogueHistoryStore& ADialogueController::GetHistoryStore() const
+{
+	return HistoryStore;
+}
+
+FDialogueHistorySnapshotRef ADialogueController::GetHistorySnapshot() const
+{
+	return HistoryPublisher->GetSnapshot();
+}
+
+TSharedRef<const FDialogueHistoryPublisher, ESPMode::ThreadSafe> 
+	ADialogueController::GetHistoryPublisher() const
+{
+	return HistoryPublisher;
+}
+
+void ADialogueController::PublishHistorySnapshot()
+{
+	//Does nothing if nothing changed since the last publish
+	HistoryPublisher->Publish(HistoryStore);
+}
+
+void ADialogueController::SpillColdRecords()
+{
+	const int32 MaxResident = 
+		GetDefault<UDialogueSettings>()->MaxResidentSpeakerRecords;
+	if (MaxResident > 0)
 	{
-		auto& CharacterDialogueHistory = DialogueHistories.Histories[TargetDialogueName].DialogueNodeHistory.FindOrAdd(SpeakerId);
-		CharacterDialogueHistory.VisitedNodeIDs.Add(TargetNodeID);
+		//Visits are unchanged, so nobody is notified
+		HistoryStore.SpillToColdStore(MaxResident);
 	}
 }
 
-void ADialogueController::MarkNodeUnvisited(UDialogue* TargetDialogue, FName TargetNodeID)
+void ADialogueController::RegisterDialogue(const UDialogue* InDialogue)
 {
-	if (!TargetDialogue)
+	if (!InDialogue)
 	{
 		return;
 	}
 
-	FName TargetDialogueName = TargetDialogue->GetFName();
+	KnownDialogues.Add(InDialogue->GetDialogueGuid(), InDialogue);
+	HistoryPublisher->RegisterDialogue(InDialogue);
 
-	//If there is no record of that dialogue, do nothing
-	if (!DialogueHistories.Histories.Contains(TargetDialogueName))
+	const uint32 ChangeSerial = HistoryStore.GetChangeSerial();
+	ResolvePendingRecords(InDialogue);
+	if (HistoryStore.GetChangeSerial() != ChangeSerial)
 	{
-		return;
+		NotifyHistoryChanged(InDialogue->GetDialogueGuid());
 	}
+}
+
+UDialogueSession* ADialogueController::GetCurrentSession() const
+{
+	return CurrentSession;
+}
 
-	//If there is a record, remove the target index from the visited nodes
-	const auto& SpeakersIds = GetSpeakerIds(TargetDialogue);
-	for (const auto& SpeakerId : SpeakersIds)
+bool ADialogueController::SpeakerInCurrentDialogue(UDialogueSpeakerComponent* TargetSpeaker) const
+{
+	//If no active dialogue, then automatically false
+	if (!CurrentSession)
 	{
-		auto& CharacterDialogueHistory = DialogueHistories.Histories[TargetDialogueName].DialogueNodeHistory.FindOrAdd(SpeakerId);
-		CharacterDialogueHistory.VisitedNodeIDs.Remove(TargetNodeID);
+		return false;
 	}
+
+	return CurrentSession->HasSpeaker(TargetSpeaker);
 }
 
-void ADialogueController::ClearAllNodeVisitsForDialogue(UDialogue* TargetDialogue)
+void ADialogueController::MarkNodeVisited(const UDialogueSession* Session, int32 NodeIndex)
 {
-	if (!TargetDialogue)
+	if (!Session || !Session->GetDialogue())
 	{
 		return;
 	}
 
-	FName TargetDialogueName = TargetDialogue->GetFName();
+	const FGuid& DialogueId = Session->GetDialogue()->GetDialogueGuid();
+	if (HistoryStore.MarkVisited(
+		DialogueId, GetSpeakerIds(Session), NodeIndex))
+	{
+		NotifyHistoryChanged(DialogueId);
+	}
+}
 
-	//If there is no record of that dialogue, do nothing
-	if (!DialogueHistories.Histories.Contains(TargetDialogueName))
+void ADialogueController::MarkNodeUnvisited(const UDialogueSession* Session, int32 NodeIndex)
+{
+	if (!Session || !Session->GetDialogue())
 	{
 		return;
 	}
 
-	DialogueHistories.Histories[TargetDialogueName].DialogueNodeHistory.Empty();
+	const FGuid& DialogueId = Session->GetDialogue()->GetDialogueGuid();
+	if (HistoryStore.MarkUnvisited(
+		DialogueId, GetSpeakerIds(Session), NodeIndex))
+	{
+		NotifyHistoryChanged(DialogueId);
+	}
 }
 
-bool ADialogueController::WasNodeVisited(const UDialogue* TargetDialogue, FName TargetNodeID) const
+void ADialogueController::ClearAllNodeVisitsForDialogue(const UDialogueSession* Session)
 {
-	if (!TargetDialogue)
+	if (!Session || !Session->GetDialogue())
 	{
-		return false;
+		return;
 	}
 
-	FName TargetDialogueName = TargetDialogue->GetFName();
-
-	if (!DialogueHistories.Histories.Contains(TargetDialogueName))
+	const FGuid& DialogueId = Session->GetDialogue()->GetDialogueGuid();
+	if (HistoryStore.ClearVisits(DialogueId))
 	{
-		return false;
+		NotifyHistoryChanged(DialogueId);
 	}
+}
 
-	const auto& SpeakersIds = GetSpeakerIds(TargetDialogue);
-	for (const auto& SpeakerId : SpeakersIds)
+bool ADialogueController::WasNodeVisited(const UDialogueSession* Session, int32 NodeIndex) const
+{
+	if (!Session || !Session->GetDialogue())
 	{
-		auto CharacterDialogueHistory = DialogueHistories.Histories[TargetDialogueName].DialogueNodeHistory.Find(SpeakerId);
-		if (CharacterDialogueHistory && CharacterDialogueHistory->VisitedNodeIDs.Contains(TargetNodeID))
-			return true;
+		return false;
 	}
 
-	return false;
+	return HistoryStore.WasVisited(
+		Session->GetDialogue()->GetDialogueGuid(),
+		GetSpeakerIds(Session),
+		NodeIndex
+	);
 }
 
-void ADialogueController::SetResumeNode(UDialogue* InDialogue, FName InNodeID)
+void ADialogueController::SetResumeNode(const UDialogueSession* Session, int32 NodeIndex)
 {
-	if (!InDialogue || InNodeID.IsNone())
+	if (!Session || !Session->GetDialogue() || NodeIndex == INDEX_NONE)
 	{
 		return;
 	}
 
-	//Ensure there is a record
-	FName RecordName = InDialogue->GetFName();
-	if (!DialogueHistories.Histories.Contains(RecordName))
+	const FGuid& DialogueId = Session->GetDialogue()->GetDialogueGuid();
+	if (HistoryStore.SetResumeNode(
+		DialogueId, GetSpeakerIds(Session), NodeIndex))
 	{
-		DialogueHistories.Histories.Add(RecordName);
+		NotifyHistoryChanged(DialogueId);
 	}
+}
+
+UDialogueSession* ADialogueController::BeginSession(UDialogue* InDialogue,
+	const TMap<FName, UDialogueSpeakerComponent*>& InSpeakers)
+{
+	check(InDialogue);
 
-	//Set the record's resume node
-	auto SpeakerIds = GetSpeakerIds(InDialogue);
-	for (const auto& SpeakerId : SpeakerIds)
+	//A dialogue started over another one takes over the display
+	if (CurrentSession)
 	{
-		auto& CharacterHistory = DialogueHistories.Histories[RecordName].DialogueNodeHistory.FindOrAdd(SpeakerId);
-		CharacterHistory.ResumeNodeID = InNodeID;
+		UDialogueSession* StaleSession = CurrentSession;
+		CurrentSession = nullptr;
+		StaleSession->EndSession();
 	}
+
+	UDialogueSession* NewSession = NewObject<UDialogueSession>(this);
+	NewSession->InitSession(InDialogue, this);
+	NewSession->SetPriority(EDialogueSessionPriority::Player);
+
+	//Pull the speakers out of any ambient sessions they are playing in
+	UDialogueManagerSubsystem* DialogueSubsystem = 
+		GetWorld()->GetSubsystem<UDialogueManagerSubsystem>();
+	if (DialogueSubsystem 
+		&& !DialogueSubsystem->RegisterSession(NewSession, InSpeakers))
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Could not start dialogue [%s]. A speaker is already reserved by another player dialogue."),
+			*InDialogue->GetName()
+		);
+		NewSession->EndSession();
+		return nullptr;
+	}
+
+	RegisterDialogue(InDialogue);
+	CurrentDialogue = InDialogue;
+	CurrentSession = NewSession;
+
+	return CurrentSession;
 }
 
-TArray<FGuid> ADialogueController::GetSpeakerIds(const UDialogue* Dialogue) const
+TConstArrayView<FGuid> ADialogueController::GetSpeakerIds(const UDialogueSession* Session) const
 {
-	const auto& Speakers = Dialogue->GetAllSpeakers();
-	TArray<FGuid> SpeakerIds;
-	SpeakerIds.Reserve(Speakers.Num());
-	for (const auto& Speaker : Speakers)
-		if (!Speaker.Value->IsPlayer())
-			SpeakerIds.Add(Speaker.Value->GetDialogueSpeakerId());
+	//Gathered by the session whenever its speakers change
+	return Session->GetParticipantIds();
+}
+
+void ADialogueController::ResolvePendingRecords(const UDialogue* InDialogue)
+{
+	check(InDialogue);
+
+	const FName DialogueName = InDialogue->GetFName();
+	const FGuid& DialogueId = InDialogue->GetDialogueGuid();
+	HistoryStore.AdoptLegacyRecord(DialogueName, DialogueId);
 
-	return SpeakerIds;
+	//Histories carrying a GUID only match their own dialogue, so that 
+	//dialogues sharing a name in different folders are told apart. They 
+	//are exported under the dialogue's path, but may have been re-keyed.
+	FName PendingKey = NAME_None;
+	const FName PathKey(*InDialogue->GetPathName());
+	const FDialogueHistory* ByPath = PendingRecords.Histories.Find(PathKey);
+	if (ByPath && ByPath->DialogueGuid == DialogueId)
+	{
+		PendingKey = PathKey;
+	}
+	else
+	{
+		for (const auto& Entry : PendingRecords.Histories)
+		{
+			if (Entry.Value.DialogueGuid == DialogueId)
+			{
+				PendingKey = Entry.Key;
+				break;
+			}
+		}
+	}
+
+	//Only histories exported before dialogues had GUIDs match by name
+	if (PendingKey.IsNone())
+	{
+		const FDialogueHistory* ByName = 
+			PendingRecords.Histories.Find(DialogueName);
+		if (ByName && !ByName->DialogueGuid.IsValid())
+		{
+			PendingKey = DialogueName;
+		}
+	}
+
+	FDialogueHistory History;
+	if (PendingKey.IsNone() 
+		|| !PendingRecords.Histories.RemoveAndCopyValue(PendingKey, History))
+	{
+		return;
+	}
+
+	//Current IDs win over ones retired by renamed nodes
+	const TArray<FName>& NodeIDs = InDialogue->GetNodeSlotIDs();
+	TMap<FName, int32> IndicesByID = InDialogue->GetRetiredNodeIDs();
+	IndicesByID.Reserve(IndicesByID.Num() + NodeIDs.Num());
+	for (int32 NodeIndex = 0; NodeIndex < NodeIDs.Num(); ++NodeIndex)
+	{
+		IndicesByID.Add(NodeIDs[NodeIndex], NodeIndex);
+	}
+
+	//Visits to nodes that no longer exist are dropped
+	for (const auto& SpeakerEntry : History.DialogueNodeHistory)
+	{
+		const FGuid SpeakerId = SpeakerEntry.Key;
+		const FCharacterDialogueHistory& CharacterHistory = SpeakerEntry.Value;
+
+		for (FName NodeID : CharacterHistory.VisitedNodeIDs)
+		{
+			if (const int32* NodeIndex = IndicesByID.Find(NodeID))
+			{
+				HistoryStore.MarkVisited(
+					DialogueId, 
+					MakeArrayView(&SpeakerId, 1),
+					*NodeIndex
+				);
+			}
+		}
+
+		if (const int32* ResumeIndex = 
+			IndicesByID.Find(CharacterHistory.ResumeNodeID))
+		{
+			HistoryStore.SetResumeNode(
+				DialogueId, 
+				MakeArrayView(&SpeakerId, 1),
+				*ResumeIndex
+			);
+		}
+	}
 }
 
-void ADialogueController::OpenDisplay_Implementation()
+void ADialogueController::ResolveAllPendingRecords()
 {
+	for (auto It = KnownDialogues.CreateIterator(); It; ++It)
+	{
+		if (const UDialogue* Dialogue = It->Value.Get())
+		{
+			ResolvePendingRecords(Dialogue);
+		}
+		else
+		{
+			It.RemoveCurrent();
+		}
+	}
 }
 
-void ADialogueController::CloseDisplay_Implementation()
+bool ADialogueController::ApplyRecordChanges(TConstArrayView<uint8> InBytes)
 {
+	FMemoryReaderView Reader(InBytes);
+	bool bFull = false;
+	if (HistoryStore.ApplyChanges(Reader, bFull) && bFull)
+	{
+		PendingRecords.Histories.Empty();
+		FDialogueHistoriesCodec::Read(Reader, PendingRecords);
+	}
+
+	return !Reader.IsError();
 }
 
-void ADialogueController::DisplaySpeech_Implementation(FSpeechDetails InSpeechDetails,
-                                                       UDialogueSpeakerComponent* InSpeaker, int SpeechVariationIndex)
+void ADialogueController::NotifyHistoryChanged(const FGuid& DialogueId)
 {
+	const FDialogueHistoryChangedDelegate* Delegate = 
+		HistoryChangedDelegates.Find(DialogueId);
+	if (Delegate)
+	{
+		Delegate->Broadcast(DialogueId);
+	}
 }
 
-void ADialogueController::DisplayOptions_Implementation(const TArray<FSpeechDetails>& InOptions)
+void ADialogueController::NotifyAllHistoriesChanged()
 {
+	//Copied, as listeners may bind to other dialogues while notified
+	TArray<FGuid> DialogueIds;
+	HistoryChangedDelegates.GetKeys(DialogueIds);
+	for (const FGuid& DialogueId : DialogueIds)
+	{
+		NotifyHistoryChanged(DialogueId);
+	}
 }
 
-bool ADialogueController::CanOpenDisplay_Implementation() const
+void ADialogueController::OpenDisplay_Implementation()
 {
-	return true;
 }
 
-void ADialogueController::HandleMissingSpeaker_Implementation(const FName& MissingName)
+void ADialogueController::CloseDisplay_Implementation()
 {
 }
 
-// G2VS2:
-void ADialogueController::FDialogueJumpBack::Set(UDialogue* InDialogue, FName InNodeId)
+void ADialogueController::DisplaySpeech_Implementation(FSpeechDetails InSpeechDetails,
+                                                       UDialogueSpeakerComponent* InSpeaker, int SpeechVariationIndex)
 {
-	Dialogue = InDialogue;
-	NodeId = InNodeId;
 }
 
-FName ADialogueController::FDialogueJumpBack::Get(UDialogue* InDialogue)
+void ADialogueController::DisplayOptions_Implementation(const TArray<FSpeechDetails>& InOptions)
 {
-	if (Dialogue.IsNull())
-		return NAME_None;
-	
-	FName Result = ensure(InDialogue == Dialogue) ? NodeId : NAME_None;
-	Dialogue.Reset();
-	NodeId = NAME_None;
-	return Result;
 }
 
-void ADialogueController::FDialogueJumpBack::Clear()
+void ADialogueController::DisplayOptionList(
+	TConstArrayView<FDialogueOption> InOptions)
 {
-	Dialogue.Reset();
-	NodeId = NAME_None;
+	OptionDetails.SetNum(InOptions.Num(), EAllowShrinking::No);
+	for (int32 OptionIndex = 0; OptionIndex < InOptions.Num(); ++OptionIndex)
+	{
+		InOptions[OptionIndex].CopyDetails(OptionDetails[OptionIndex]);
+	}
+
+	DisplayOptions(OptionDetails);
 }
 
-void ADialogueController::SetJumpBackNode(UDialogue* Dialogue, FName NodeId)
+bool ADialogueController::CanOpenDisplay_Implementation() const
 {
-	ActiveJumpBack.Set(Dialogue, NodeId);
+	return true;
 }
 
-FName ADialogueController::GetJumpBackNode(UDialogue* Dialogue)
+void ADialogueController::HandleMissingSpeaker_Implementation(const FName& MissingName)
 {
-	return ActiveJumpBack.Get(Dialogue);
 }
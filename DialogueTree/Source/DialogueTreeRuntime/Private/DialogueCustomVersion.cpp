@@ -0,0 +1,15 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//Header
+#include "DialogueCustomVersion.h"
+//UE
+#include "Serialization/CustomVersion.h"
+
+const FGuid FDialogueCustomVersion::GUID(
+	0xBCFD54A8, 0x98EB4E0A, 0x956F8381, 0xD013D535);
+
+FCustomVersionRegistration GRegisterDialogueCustomVersion(
+	FDialogueCustomVersion::GUID, 
+	FDialogueCustomVersion::LatestVersion, 
+	TEXT("DialogueTreeVer")
+);
@@ -6,8 +6,10 @@
 #include "Engine/World.h"
 #include "Kismet/GameplayStatics.h"
 //Plugin
+#include "Dialogue.h"
 #include "DialogueController.h"
 #include "DialogueSettings.h"
+#include "DialogueSpeakerComponent.h"
 #include "LogDialogueTree.h"
 #include "GameFramework/GameModeBase.h"
 #include "Interfaces/DialogueTreeGameMode.h"
@@ -15,10 +17,37 @@
 void UDialogueManagerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
+
+	const float MaxResidentAudioMB = 
+		GetDefault<UDialogueSettings>()->MaxResidentAudioMB;
+	AudioStreamer.SetBudget(
+		static_cast<int64>(MaxResidentAudioMB * 1024.0 * 1024.0)
+	);
 }
 
 void UDialogueManagerSubsystem::Deinitialize()
 {
+	//Stop everything still playing or waiting to play
+	TArray<UDialogueSession*> RemainingSessions(ActiveSessions);
+	for (const FDialogueSessionRequest& Request : PendingRequests)
+	{
+		RemainingSessions.Add(Request.Session);
+	}
+
+	for (UDialogueSession* Session : RemainingSessions)
+	{
+		if (Session)
+		{
+			Session->EndSession();
+		}
+	}
+
+	ActiveSessions.Empty();
+	PendingRequests.Empty();
+	SpeakerReservations.Empty();
+	AudioStreamer.Reset();
+	TransitionScheduler.Reset();
+
 	Super::Deinitialize();
 }
 
@@ -86,3 +115,393 @@ const UDialogueSettings* UDialogueManagerSubsystem::GetSettings()
 {
 	return GetDefault<UDialogueSettings>();
 }
+
+void UDialogueManagerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TransitionScheduler.Tick(DeltaTime);
+
+	//Every history change made since last frame goes out in one snapshot,
+	//after any records spilled are dropped from memory
+	if (DialogueController)
+	{
+		DialogueController->SpillColdRecords();
+		DialogueController->PublishHistorySnapshot();
+	}
+
+	if (PendingRequests.IsEmpty())
+	{
+		return;
+	}
+
+	const UDialogueSettings* Settings = GetDefault<UDialogueSettings>();
+	const double BudgetSeconds = Settings->SchedulerFrameBudgetMs / 1000.0;
+	const double FrameStartTime = FPlatformTime::Seconds();
+	const double WorldTime = GetWorld()->GetTimeSeconds();
+
+	//Highest priority first, then oldest first
+	TArray<FDialogueSessionRequest> Requests = MoveTemp(PendingRequests);
+	PendingRequests.Reset();
+	Requests.Sort(
+		[](const FDialogueSessionRequest& A, const FDialogueSessionRequest& B)
+		{
+			if (A.Session->GetPriority() != B.Session->GetPriority())
+			{
+				return A.Session->GetPriority() > B.Session->GetPriority();
+			}
+			return A.RequestTime < B.RequestTime;
+		}
+	);
+
+	int32 NumStarted = 0;
+	int32 NumScheduled = GetNumScheduledSessions();
+	TArray<UDialogueSession*> DroppedSessions;
+	for (FDialogueSessionRequest& Request : Requests)
+	{
+		UDialogueSession* Session = Request.Session;
+
+		//Skip sessions ended while they were waiting
+		if (!Session || !Session->IsActive())
+		{
+			continue;
+		}
+
+		//Out of budget for this frame; try again next frame
+		const bool bOutOfBudget = NumStarted >= Settings->MaxSessionStartsPerFrame
+			|| (NumStarted > 0 
+				&& FPlatformTime::Seconds() - FrameStartTime > BudgetSeconds);
+		if (bOutOfBudget)
+		{
+			PendingRequests.Add(Request);
+			continue;
+		}
+
+		const bool bAtCapacity = 
+			NumScheduled >= Settings->MaxConcurrentSessions;
+		if (!bAtCapacity && CanReserveSpeakers(Session, Request.Speakers))
+		{
+			StartRequest(Request);
+			++NumStarted;
+			++NumScheduled;
+			continue;
+		}
+
+		//Barks are only worth playing right away
+		const bool bExpired = 
+			Session->GetPriority() == EDialogueSessionPriority::Bark
+			|| WorldTime - Request.RequestTime > Settings->PendingSessionTimeout;
+		if (bExpired)
+		{
+			DroppedSessions.Add(Session);
+		}
+		else
+		{
+			PendingRequests.Add(Request);
+		}
+	}
+
+	for (UDialogueSession* Session : DroppedSessions)
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Verbose,
+			TEXT("Dropping queued session of dialogue [%s]. Its speakers or the scheduler were busy."),
+			*GetNameSafe(Session->GetDialogue())
+		);
+		Session->EndSession();
+	}
+}
+
+TStatId UDialogueManagerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(
+		UDialogueManagerSubsystem, 
+		STATGROUP_Tickables
+	);
+}
+
+UDialogueSession* UDialogueManagerSubsystem::StartAmbientDialogue(
+	UDialogue* InDialogue, TMap<FName, UDialogueSpeakerComponent*> InSpeakers,
+	EDialogueSessionPriority Priority, FName StartNodeID)
+{
+	if (!InDialogue)
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Could not queue dialogue. Provided dialogue null.")
+		);
+		return nullptr;
+	}
+
+	if (InDialogue->GetCompileStatus() != EDialogueCompileStatus::Compiled)
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Could not queue dialogue [%s]. Dialogue not compiled."),
+			*InDialogue->GetName()
+		);
+		return nullptr;
+	}
+
+	if (!StartNodeID.IsNone() && !InDialogue->HasNode(StartNodeID))
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Could not queue dialogue from Node: %s. No such node exists."),
+			*StartNodeID.ToString()
+		);
+		return nullptr;
+	}
+
+	//The controller still keeps the node visit history
+	if (!DialogueController)
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Could not queue dialogue [%s]. No dialogue controller exists."),
+			*InDialogue->GetName()
+		);
+		return nullptr;
+	}
+
+	if (Priority == EDialogueSessionPriority::Player)
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Warning,
+			TEXT("Player priority is reserved for the dialogue controller. Queuing dialogue [%s] as ambient."),
+			*InDialogue->GetName()
+		);
+		Priority = EDialogueSessionPriority::Ambient;
+	}
+
+	DialogueController->RegisterDialogue(InDialogue);
+
+	UDialogueSession* Session = NewObject<UDialogueSession>(this);
+	Session->InitSession(InDialogue, DialogueController);
+	Session->SetPriority(Priority);
+	Session->OnSessionEnded.AddUObject(
+		this, 
+		&UDialogueManagerSubsystem::OnSessionEnded
+	);
+
+	FDialogueSessionRequest& Request = PendingRequests.AddDefaulted_GetRef();
+	Request.Session = Session;
+	Request.Speakers = MoveTemp(InSpeakers);
+	Request.StartNodeID = StartNodeID;
+	Request.RequestTime = GetWorld()->GetTimeSeconds();
+
+	return Session;
+}
+
+bool UDialogueManagerSubsystem::RegisterSession(UDialogueSession* Session,
+	const TMap<FName, UDialogueSpeakerComponent*>& InSpeakers)
+{
+	check(Session);
+
+	if (!CanReserveSpeakers(Session, InSpeakers))
+	{
+		return false;
+	}
+
+	Session->OnSessionEnded.AddUObject(
+		this,
+		&UDialogueManagerSubsystem::OnSessionEnded
+	);
+	ReserveSpeakers(Session, InSpeakers);
+	ActiveSessions.AddUnique(Session);
+
+	return true;
+}
+
+UDialogueSession* UDialogueManagerSubsystem::FindSessionForSpeaker(
+	const UDialogueSpeakerComponent* Speaker) const
+{
+	const TObjectPtr<UDialogueSession>* Found = SpeakerReservations.Find(
+		const_cast<UDialogueSpeakerComponent*>(Speaker)
+	);
+	return Found ? Found->Get() : nullptr;
+}
+
+const TArray<TObjectPtr<UDialogueSession>>& 
+	UDialogueManagerSubsystem::GetActiveSessions() const
+{
+	return ActiveSessions;
+}
+
+void UDialogueManagerSubsystem::EndSessionsBelow(
+	EDialogueSessionPriority Priority)
+{
+	TArray<UDialogueSession*> TargetSessions;
+	for (UDialogueSession* Session : ActiveSessions)
+	{
+		if (Session && Session->GetPriority() < Priority)
+		{
+			TargetSessions.Add(Session);
+		}
+	}
+	for (const FDialogueSessionRequest& Request : PendingRequests)
+	{
+		if (Request.Session && Request.Session->GetPriority() < Priority)
+		{
+			TargetSessions.Add(Request.Session);
+		}
+	}
+
+	for (UDialogueSession* Session : TargetSessions)
+	{
+		Session->GetDialogue()->EndDialogue(Session);
+	}
+}
+
+void UDialogueManagerSubsystem::PrefetchAudio(
+	const UDialogueSession* Session)
+{
+	const int32 Depth = GetDefault<UDialogueSettings>()->AudioPrefetchDepth;
+	AudioStreamer.PrefetchForSession(Session, Depth);
+}
+
+TSharedPtr<FStreamableHandle> UDialogueManagerSubsystem::RequestSpeechAudio(
+	const TSoftObjectPtr<USoundCue>& Audio)
+{
+	return AudioStreamer.RequestAudio(Audio);
+}
+
+void UDialogueManagerSubsystem::InvalidateQueries(FGameplayTag Dependency)
+{
+	for (UDialogueSession* Session : ActiveSessions)
+	{
+		if (Session)
+		{
+			Session->GetQueryCache().Invalidate(Dependency);
+		}
+	}
+}
+
+FDialogueTransitionScheduler& 
+	UDialogueManagerSubsystem::GetTransitionScheduler()
+{
+	return TransitionScheduler;
+}
+
+bool UDialogueManagerSubsystem::CanReserveSpeakers(
+	const UDialogueSession* Session,
+	const TMap<FName, UDialogueSpeakerComponent*>& InSpeakers) const
+{
+	for (const auto& Entry : InSpeakers)
+	{
+		const UDialogueSession* Holder = FindSessionForSpeaker(Entry.Value);
+		if (Holder && Holder != Session
+			&& Holder->GetPriority() >= Session->GetPriority())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void UDialogueManagerSubsystem::ReserveSpeakers(UDialogueSession* Session,
+	const TMap<FName, UDialogueSpeakerComponent*>& InSpeakers)
+{
+	//Take the speakers from any lower priority sessions holding them
+	TArray<UDialogueSession*> PreemptedSessions;
+	for (const auto& Entry : InSpeakers)
+	{
+		UDialogueSession* Holder = FindSessionForSpeaker(Entry.Value);
+		if (Holder && Holder != Session)
+		{
+			PreemptedSessions.AddUnique(Holder);
+		}
+	}
+
+	for (UDialogueSession* Preempted : PreemptedSessions)
+	{
+		Preempted->GetDialogue()->EndDialogue(Preempted);
+	}
+
+	for (const auto& Entry : InSpeakers)
+	{
+		if (Entry.Value)
+		{
+			SpeakerReservations.Add(Entry.Value, Session);
+		}
+	}
+}
+
+void UDialogueManagerSubsystem::StartRequest(FDialogueSessionRequest& Request)
+{
+	UDialogueSession* Session = Request.Session;
+	UDialogue* Dialogue = Session->GetDialogue();
+
+	ReserveSpeakers(Session, Request.Speakers);
+	ActiveSessions.Add(Session);
+
+	//Look the start node up once; traversal runs on node indices
+	int32 StartIndex = INDEX_NONE;
+	if (!Request.StartNodeID.IsNone())
+	{
+		StartIndex = Dialogue->FindNodeIndex(Request.StartNodeID);
+	}
+	else if (Dialogue->GetRootNode())
+	{
+		StartIndex = Dialogue->GetRootNode()->GetNodeIndex();
+	}
+
+	for (auto& Entry : Request.Speakers)
+	{
+		if (Entry.Value)
+		{
+			Entry.Value->OnDialogueStarted(Dialogue);
+		}
+	}
+
+	Dialogue->OpenDialogueAtIndex(Session, StartIndex, Request.Speakers);
+
+	//Opening failed without ending the session; release its speakers
+	if (Session->IsActive() && !Session->GetActiveNode())
+	{
+		Session->EndSession();
+	}
+}
+
+int32 UDialogueManagerSubsystem::GetNumScheduledSessions() const
+{
+	int32 NumScheduled = 0;
+	for (const UDialogueSession* Session : ActiveSessions)
+	{
+		if (Session && Session->GetPriority() < EDialogueSessionPriority::Player)
+		{
+			++NumScheduled;
+		}
+	}
+
+	return NumScheduled;
+}
+
+void UDialogueManagerSubsystem::OnSessionEnded(UDialogueSession* Session)
+{
+	ActiveSessions.Remove(Session);
+	PendingRequests.RemoveAll(
+		[Session](const FDialogueSessionRequest& Request)
+		{
+			return Request.Session == Session;
+		}
+	);
+
+	for (auto It = SpeakerReservations.CreateIterator(); It; ++It)
+	{
+		if (It->Value == Session)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	AudioStreamer.ForgetSession(Session);
+	TransitionScheduler.ForgetSession(Session);
+}
@@ -0,0 +1,219 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//Header
+#include "DialogueNodeTable.h"
+
+namespace DialogueNodeTable
+{
+	/** Longest chain of nodes followed before an option is given up on, 
+	* which also breaks loops of reroutes and jumps */
+	constexpr int32 MaxOptionChainLength = 64;
+
+	/** Most steps a single option program may take up. Branches that 
+	* rejoin are copied into each path, so larger programs fall back to 
+	* resolving at runtime. */
+	constexpr int32 MaxOptionProgramSteps = 256;
+}
+
+int32 FDialogueNodeSlots::FindIndex(FName NodeID) const
+{
+	if (NodeID.IsNone())
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 Index = IDs.IndexOfByKey(NodeID);
+	if (Index != INDEX_NONE)
+	{
+		return Index;
+	}
+
+	const int32* Retired = RetiredIDs.Find(NodeID);
+	return Retired ? *Retired : INDEX_NONE;
+}
+
+void FDialogueNodeTable::BuildLayout(
+	TConstArrayView<FDialogueNodeTableSource> Sources)
+{
+	int32 NumEdges = 0;
+	for (const FDialogueNodeTableSource& Source : Sources)
+	{
+		NumEdges += Source.Children.Num() + Source.Payloads.Num();
+	}
+
+	Entries.Reset(Sources.Num());
+	Edges.Reset(NumEdges);
+
+	for (const FDialogueNodeTableSource& Source : Sources)
+	{
+		FDialogueNodeTableEntry& Entry = Entries.AddDefaulted_GetRef();
+		Entry.FirstChild = Edges.Num();
+		Entry.FirstPayload = Edges.Num();
+
+		//Empty slot left by a deleted node
+		if (!Source.bHasNode)
+		{
+			continue;
+		}
+
+		Entry.Kind = Source.Kind;
+		Entry.SpeakerSlot = Source.SpeakerSlot;
+
+		Edges.Append(Source.Children);
+		Entry.NumChildren = Source.Children.Num();
+
+		Entry.FirstPayload = Edges.Num();
+		Edges.Append(Source.Payloads);
+		Entry.NumPayloads = Source.Payloads.Num();
+	}
+
+	BuildOptionPrograms();
+}
+
+void FDialogueNodeTable::BuildOptionPrograms()
+{
+	OptionSteps.Reset();
+
+	for (int32 SpeechIndex = 0; SpeechIndex < Entries.Num(); ++SpeechIndex)
+	{
+		if (Entries[SpeechIndex].Kind != EDialogueNodeKind::Speech)
+		{
+			continue;
+		}
+
+		for (int32 OptionIndex : GetChildren(SpeechIndex))
+		{
+			if (!IsValidIndex(OptionIndex) 
+				|| Entries[OptionIndex].FirstOptionStep != INDEX_NONE)
+			{
+				continue;
+			}
+
+			//Selecting the option moves to the first node that is not a 
+			//reroute or lock, as those hand over their child's option
+			int32 Target = OptionIndex;
+			for (int32 Depth = 0; 
+				IsValidIndex(Target) && Depth < DialogueNodeTable::MaxOptionChainLength;
+				++Depth)
+			{
+				const FDialogueNodeTableEntry& TargetEntry = Entries[Target];
+				const bool bPassesOn = 
+					TargetEntry.Kind == EDialogueNodeKind::Reroute
+					|| TargetEntry.Kind == EDialogueNodeKind::OptionLock;
+				if (!bPassesOn)
+				{
+					break;
+				}
+				Target = TargetEntry.NumChildren > 0 
+					? GetChildren(Target)[0] 
+					: INDEX_NONE;
+			}
+
+			const int32 FirstStep = OptionSteps.Num();
+			const int32 StepLimit = 
+				FirstStep + DialogueNodeTable::MaxOptionProgramSteps;
+			const bool bFits = EmitOptionChain(OptionIndex, 0, StepLimit);
+
+			FDialogueNodeTableEntry& Entry = Entries[OptionIndex];
+			Entry.FirstOptionStep = FirstStep;
+			Entry.OptionTarget = Target;
+
+			//Resolve the whole chain at runtime instead
+			const bool bFallsBack = !bFits 
+				|| (IsValidIndex(Target) 
+					&& Entries[Target].Kind == EDialogueNodeKind::Other);
+			if (bFallsBack)
+			{
+				OptionSteps.SetNum(FirstStep);
+				EmitOptionStep(EDialogueOptionOp::Fallback, OptionIndex);
+				Entry.OptionTarget = INDEX_NONE;
+			}
+		}
+	}
+}
+
+bool FDialogueNodeTable::EmitOptionChain(int32 NodeIndex, int32 Depth, 
+	int32 StepLimit)
+{
+	for (; Depth < DialogueNodeTable::MaxOptionChainLength; ++Depth)
+	{
+		if (OptionSteps.Num() >= StepLimit)
+		{
+			return false;
+		}
+
+		if (!IsValidIndex(NodeIndex))
+		{
+			EmitOptionStep(EDialogueOptionOp::Fail);
+			return true;
+		}
+
+		const FDialogueNodeTableEntry& Entry = Entries[NodeIndex];
+		const TConstArrayView<int32> Children = GetChildren(NodeIndex);
+		const TConstArrayView<int32> Payloads = GetPayloads(NodeIndex);
+		switch (Entry.Kind)
+		{
+		case EDialogueNodeKind::Speech:
+			EmitOptionStep(EDialogueOptionOp::Speech, NodeIndex);
+			return true;
+
+		case EDialogueNodeKind::Event:
+		case EDialogueNodeKind::Reroute:
+			NodeIndex = Children.IsEmpty() ? INDEX_NONE : Children[0];
+			break;
+
+		case EDialogueNodeKind::OptionLock:
+			EmitOptionStep(EDialogueOptionOp::Lock, NodeIndex);
+			NodeIndex = Children.IsEmpty() ? INDEX_NONE : Children[0];
+			break;
+
+		case EDialogueNodeKind::Jump:
+		case EDialogueNodeKind::SetJumpBack:
+			NodeIndex = Payloads.IsEmpty() ? INDEX_NONE : Payloads[0];
+			break;
+
+		case EDialogueNodeKind::Branch:
+		{
+			const int32 TrueIndex = Payloads.Num() > 0 ? Payloads[0] : INDEX_NONE;
+			const int32 FalseIndex = Payloads.Num() > 1 ? Payloads[1] : INDEX_NONE;
+
+			//Without a true node the conditions cannot change the outcome
+			if (TrueIndex == INDEX_NONE)
+			{
+				NodeIndex = FalseIndex;
+				break;
+			}
+
+			const int32 BranchStep = 
+				EmitOptionStep(EDialogueOptionOp::Branch, NodeIndex);
+			if (!EmitOptionChain(TrueIndex, Depth + 1, StepLimit))
+			{
+				return false;
+			}
+			OptionSteps[BranchStep].FalseStep = OptionSteps.Num();
+			return EmitOptionChain(FalseIndex, Depth + 1, StepLimit);
+		}
+
+		case EDialogueNodeKind::Other:
+			EmitOptionStep(EDialogueOptionOp::Fallback, NodeIndex);
+			return true;
+
+		default:
+			//Entries and jump backs are never options
+			EmitOptionStep(EDialogueOptionOp::Fail);
+			return true;
+		}
+	}
+
+	//Looped through reroutes or jumps without reaching a speech
+	EmitOptionStep(EDialogueOptionOp::Fail);
+	return OptionSteps.Num() <= StepLimit;
+}
+
+int32 FDialogueNodeTable::EmitOptionStep(EDialogueOptionOp Op, int32 Node)
+{
+	FDialogueOptionStep& Step = OptionSteps.AddDefaulted_GetRef();
+	Step.Op = Op;
+	Step.Node = Node;
+	return OptionSteps.Num() - 1;
+}
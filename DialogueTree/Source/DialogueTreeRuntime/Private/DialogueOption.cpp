@@ -0,0 +1,38 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//Header
+#include "DialogueOption.h"
+//Plugin
+#include "Nodes/DialogueSpeechNode.h"
+
+bool FDialogueOption::IsValid() const
+{
+	return Speech && TargetNode
+		&& !Speech->GetDetails().SpeechVariations.IsEmpty();
+}
+
+const FSpeechDetails& FDialogueOption::GetDetails() const
+{
+	check(Speech);
+	return Speech->GetDetails();
+}
+
+bool FDialogueOption::IsLocked() const
+{
+	return bOverridesLock ? bIsLocked : GetDetails().bIsLocked;
+}
+
+const FText& FDialogueOption::GetOptionMessage() const
+{
+	return bOverridesLock ? OptionMessage : GetDetails().OptionMessage;
+}
+
+void FDialogueOption::CopyDetails(FSpeechDetails& OutDetails) const
+{
+	OutDetails = GetDetails();
+	if (bOverridesLock)
+	{
+		OutDetails.bIsLocked = bIsLocked;
+		OutDetails.OptionMessage = OptionMessage;
+	}
+}
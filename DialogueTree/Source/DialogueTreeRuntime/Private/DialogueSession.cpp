@@ -0,0 +1,685 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//Header
+#include "DialogueSession.h"
+//UE
+#include "Engine/World.h"
+#include "TimerManager.h"
+//Plugin
+#include "Conditionals/Queries/Base/DialogueQuery.h"
+#include "Dialogue.h"
+#include "DialogueController.h"
+#include "DialogueManagerSubsystem.h"
+#include "DialogueSpeakerComponent.h"
+#include "DialogueSpeakerSocket.h"
+#include "Events/DialogueEventBase.h"
+#include "Nodes/DialogueNode.h"
+#include "Transitions/DialogueTransition.h"
+#include "LogDialogueTree.h"
+
+UWorld* UDialogueSession::GetWorld() const
+{
+	if (IsValid(DialogueController))
+	{
+		return DialogueController->GetWorld();
+	}
+
+	return Super::GetWorld();
+}
+
+void UDialogueSession::InitSession(UDialogue* InDialogue,
+	ADialogueController* InController)
+{
+	check(InDialogue);
+
+	Dialogue = InDialogue;
+	DialogueController = InController;
+	bActive = true;
+}
+
+void UDialogueSession::SetPriority(EDialogueSessionPriority InPriority)
+{
+	Priority = InPriority;
+}
+
+EDialogueSessionPriority UDialogueSession::GetPriority() const
+{
+	return Priority;
+}
+
+bool UDialogueSession::IsDisplayed() const
+{
+	return DialogueController 
+		&& DialogueController->GetCurrentSession() == this;
+}
+
+void UDialogueSession::EndSession()
+{
+	if (!bActive)
+	{
+		return;
+	}
+
+	bActive = false;
+	ResetTransitionState();
+	CancelAsyncQueries();
+
+	//Clear any behavior flags from the speakers and stop speaking
+	for (auto& Entry : Speakers)
+	{
+		if (Entry.Value)
+		{
+			Entry.Value->UnbindSession(this);
+			Entry.Value->OnDialogueEnded(Dialogue);
+			Entry.Value->Stop();
+			Entry.Value->ClearGameplayTags();
+		}
+	}
+
+	ActiveNode = nullptr;
+	JumpBackNodeIndex = INDEX_NONE;
+
+	OnSessionEnded.Broadcast(this);
+}
+
+bool UDialogueSession::IsActive() const
+{
+	return bActive;
+}
+
+UDialogue* UDialogueSession::GetDialogue() const
+{
+	return Dialogue;
+}
+
+ADialogueController* UDialogueSession::GetController() const
+{
+	return DialogueController;
+}
+
+UDialogueNode* UDialogueSession::GetActiveNode() const
+{
+	return ActiveNode;
+}
+
+void UDialogueSession::SetActiveNode(UDialogueNode* InNode)
+{
+	//Async results only hold for the node they were issued at
+	if (InNode != ActiveNode)
+	{
+		CancelAsyncQueries();
+	}
+
+	ActiveNode = InNode;
+}
+
+bool UDialogueSession::IsTraversing() const
+{
+	return bTraversing;
+}
+
+void UDialogueSession::SetTraversing(bool bInTraversing)
+{
+	bTraversing = bInTraversing;
+
+	if (!bTraversing)
+	{
+		DeferredNodeIndex = INDEX_NONE;
+		bHasDeferredNode = false;
+	}
+}
+
+void UDialogueSession::DeferTraversal(int32 InNodeIndex)
+{
+	DeferredNodeIndex = InNodeIndex;
+	bHasDeferredNode = true;
+}
+
+bool UDialogueSession::ConsumeDeferredTraversal(int32& OutNodeIndex)
+{
+	if (!bHasDeferredNode)
+	{
+		return false;
+	}
+
+	OutNodeIndex = DeferredNodeIndex;
+	DeferredNodeIndex = INDEX_NONE;
+	bHasDeferredNode = false;
+	return true;
+}
+
+void UDialogueSession::SetSpeaker(FName InName,
+	UDialogueSpeakerComponent* InSpeaker)
+{
+	const int32 Slot = FindSpeakerSlot(InName);
+	if (!SpeakerEntries.IsValidIndex(Slot))
+	{
+		return;
+	}
+
+	if (UDialogueSpeakerComponent* Previous = GetSpeakerAt(Slot))
+	{
+		Previous->UnbindSession(this);
+	}
+
+	Speakers.Add(InName, InSpeaker);
+	if (InSpeaker)
+	{
+		InSpeaker->BindSession(this);
+		SpeakerEntries[Slot] = InSpeaker->ToSpeakerActorEntry();
+	}
+	else
+	{
+		SpeakerEntries[Slot] = FSpeakerActorEntry();
+	}
+
+	//Also drops the cached query results
+	RefreshParticipantIds();
+}
+
+UDialogueSpeakerComponent* UDialogueSession::GetSpeaker(FName InName) const
+{
+	return GetSpeakerAt(FindSpeakerSlot(InName));
+}
+
+const TMap<FName, UDialogueSpeakerComponent*>&
+	UDialogueSession::GetAllSpeakers() const
+{
+	return Speakers;
+}
+
+bool UDialogueSession::SpeakerIsPresent(const FName SpeakerName) const
+{
+	return GetSpeaker(SpeakerName) != nullptr;
+}
+
+bool UDialogueSession::HasSpeaker(
+	const UDialogueSpeakerComponent* TargetSpeaker) const
+{
+	if (!TargetSpeaker)
+	{
+		return false;
+	}
+
+	return TargetSpeaker->GetActiveSession() == this;
+}
+
+void UDialogueSession::FillSpeakers(
+	const TMap<FName, UDialogueSpeakerComponent*>& InSpeakers)
+{
+	check(Dialogue);
+
+	//Bind a component into the slot of each role the dialogue expects
+	const TArray<FName>& RoleNames = Dialogue->GetSpeakerRoleNames();
+	TArray<FName, TInlineAllocator<4>> MissingRoles;
+	for (const FSpeakerActorEntry& Entry : SpeakerEntries)
+	{
+		if (Entry.SpeakerComponent)
+		{
+			Entry.SpeakerComponent->UnbindSession(this);
+		}
+	}
+	Speakers.Empty(RoleNames.Num());
+	SpeakerEntries.Reset(RoleNames.Num());
+	for (FName RoleName : RoleNames)
+	{
+		UDialogueSpeakerComponent* const* Found = InSpeakers.Find(RoleName);
+		UDialogueSpeakerComponent* Component = Found ? *Found : nullptr;
+		Speakers.Add(RoleName, Component);
+
+		if (Component)
+		{
+			Component->BindSession(this);
+			SpeakerEntries.Add(Component->ToSpeakerActorEntry());
+		}
+		else
+		{
+			SpeakerEntries.AddDefaulted();
+			MissingRoles.Add(RoleName);
+		}
+	}
+
+	//Also drops the cached query results
+	RefreshParticipantIds();
+
+	//Report any missing speakers once every slot is filled
+	if (DialogueController)
+	{
+		for (FName RoleName : MissingRoles)
+		{
+			DialogueController->HandleMissingSpeaker(RoleName);
+		}
+	}
+}
+
+int32 UDialogueSession::FindSpeakerSlot(FName InName) const
+{
+	if (!Dialogue || InName.IsNone())
+	{
+		return INDEX_NONE;
+	}
+
+	return Dialogue->GetSpeakerRoleNames().IndexOfByKey(InName);
+}
+
+TConstArrayView<FGuid> UDialogueSession::GetParticipantIds() const
+{
+	return ParticipantIds;
+}
+
+void UDialogueSession::RefreshParticipantIds()
+{
+	ParticipantIds.Reset();
+	for (const FSpeakerActorEntry& Entry : SpeakerEntries)
+	{
+		const UDialogueSpeakerComponent* Speaker = Entry.SpeakerComponent;
+		if (Speaker && !Speaker->IsPlayer())
+		{
+			ParticipantIds.AddUnique(Speaker->GetDialogueSpeakerId());
+		}
+	}
+
+	//Queries read the speakers and their history, so cached results are 
+	//stale
+	QueryCache.Invalidate();
+}
+
+UDialogueSpeakerComponent* UDialogueSession::GetSpeakerAt(int32 Slot) const
+{
+	return SpeakerEntries.IsValidIndex(Slot) 
+		? SpeakerEntries[Slot].SpeakerComponent.Get() 
+		: nullptr;
+}
+
+const FSpeakerActorEntry* UDialogueSession::GetSpeakerEntry(int32 Slot) const
+{
+	if (!SpeakerEntries.IsValidIndex(Slot) 
+		|| !SpeakerEntries[Slot].SpeakerComponent)
+	{
+		return nullptr;
+	}
+
+	return &SpeakerEntries[Slot];
+}
+
+bool UDialogueSession::GatherSpeakerEntries(
+	const UDialogueSpeakerSocket* Target,
+	TConstArrayView<TObjectPtr<UDialogueSpeakerSocket>> Others,
+	const FSpeakerActorEntry*& OutTarget, 
+	FSpeakerActorEntryList& OutOthers) const
+{
+	OutTarget = Target ? Target->GetSpeakerEntry(this) : nullptr;
+	if (!OutTarget)
+	{
+		return false;
+	}
+
+	OutOthers.Reset();
+	for (const UDialogueSpeakerSocket* Socket : Others)
+	{
+		const FSpeakerActorEntry* Entry = 
+			Socket ? Socket->GetSpeakerEntry(this) : nullptr;
+		if (!Entry)
+		{
+			return false;
+		}
+
+		OutOthers.Add(*Entry);
+	}
+
+	return true;
+}
+
+FDialogueTransitionState& UDialogueSession::GetTransitionState()
+{
+	return TransitionState;
+}
+
+void UDialogueSession::ResetTransitionState()
+{
+	ClearMinPlayTimer();
+	StopListeningForAudio();
+	TransitionState = FDialogueTransitionState();
+}
+
+void UDialogueSession::StartMinPlayTimer(float MinPlayTime)
+{
+	FDialogueTransitionScheduler* Scheduler = GetTransitionScheduler();
+	if (!ensure(Scheduler))
+	{
+		TransitionState.bMinPlayTimeElapsed = true;
+		return;
+	}
+
+	Scheduler->ScheduleMinPlayTime(this, MinPlayTime);
+	TransitionState.bMinPlayTimeScheduled = true;
+}
+
+void UDialogueSession::ClearMinPlayTimer()
+{
+	if (!TransitionState.bMinPlayTimeScheduled)
+	{
+		return;
+	}
+
+	if (FDialogueTransitionScheduler* Scheduler = GetTransitionScheduler())
+	{
+		Scheduler->CancelMinPlayTime(this);
+	}
+	TransitionState.bMinPlayTimeScheduled = false;
+}
+
+void UDialogueSession::ListenForAudioFinished(
+	UDialogueSpeakerComponent* InSpeaker)
+{
+	check(InSpeaker);
+
+	StopListeningForAudio();
+
+	FDialogueTransitionScheduler* Scheduler = GetTransitionScheduler();
+	if (!ensure(Scheduler))
+	{
+		TransitionState.bAudioFinished = true;
+		return;
+	}
+
+	TransitionState.AudioSpeaker = InSpeaker;
+	Scheduler->WaitForAudio(this, InSpeaker);
+}
+
+void UDialogueSession::StopListeningForAudio()
+{
+	if (!TransitionState.AudioSpeaker)
+	{
+		return;
+	}
+
+	if (FDialogueTransitionScheduler* Scheduler = GetTransitionScheduler())
+	{
+		Scheduler->StopWaitingForAudio(this);
+	}
+	TransitionState.AudioSpeaker = nullptr;
+}
+
+UDialogueEventBase* UDialogueSession::GetEventInstance(
+	UDialogueEventBase* EventTemplate)
+{
+	check(EventTemplate);
+
+	if (UDialogueEventBase* Existing = FindEventInstance(EventTemplate))
+	{
+		return Existing;
+	}
+
+	UDialogueEventBase* Instance = DuplicateObject(EventTemplate, this);
+	Instance->SetSession(this);
+	EventInstances.Add(EventTemplate, Instance);
+
+	return Instance;
+}
+
+UDialogueEventBase* UDialogueSession::FindEventInstance(
+	const UDialogueEventBase* EventTemplate) const
+{
+	const TObjectPtr<UDialogueEventBase>* Found =
+		EventInstances.Find(const_cast<UDialogueEventBase*>(EventTemplate));
+	return Found ? Found->Get() : nullptr;
+}
+
+void UDialogueSession::SetJumpBackNodeIndex(int32 InNodeIndex)
+{
+	JumpBackNodeIndex = InNodeIndex;
+}
+
+int32 UDialogueSession::ConsumeJumpBackNodeIndex()
+{
+	const int32 Result = JumpBackNodeIndex;
+	JumpBackNodeIndex = INDEX_NONE;
+	return Result;
+}
+
+void UDialogueSession::OnMinPlayTimeElapsed()
+{
+	TransitionState.bMinPlayTimeScheduled = false;
+
+	if (bActive && TransitionState.Transition)
+	{
+		TransitionState.Transition->OnMinPlayTimeElapsed(this);
+	}
+}
+
+void UDialogueSession::OnSpeechAudioFinished()
+{
+	TransitionState.AudioSpeaker = nullptr;
+
+	if (bActive && TransitionState.Transition)
+	{
+		TransitionState.Transition->OnDonePlayingContent(this);
+	}
+}
+
+void UDialogueSession::SetPaused(bool bInPaused)
+{
+	if (bPaused == bInPaused)
+	{
+		return;
+	}
+
+	bPaused = bInPaused;
+
+	for (auto& Entry : Speakers)
+	{
+		if (Entry.Value)
+		{
+			Entry.Value->SetPaused(bPaused);
+		}
+	}
+
+	if (FDialogueTransitionScheduler* Scheduler = GetTransitionScheduler())
+	{
+		Scheduler->RefreshClock(this);
+	}
+}
+
+bool UDialogueSession::IsPaused() const
+{
+	return bPaused;
+}
+
+void UDialogueSession::SetTimeDilation(float InTimeDilation)
+{
+	TimeDilation = FMath::Max(InTimeDilation, 0.f);
+
+	if (FDialogueTransitionScheduler* Scheduler = GetTransitionScheduler())
+	{
+		Scheduler->RefreshClock(this);
+	}
+}
+
+float UDialogueSession::GetTimeDilation() const
+{
+	return TimeDilation;
+}
+
+FDialogueTransitionScheduler* UDialogueSession::GetTransitionScheduler() const
+{
+	UWorld* World = GetWorld();
+	UDialogueManagerSubsystem* DialogueSubsystem = 
+		World ? World->GetSubsystem<UDialogueManagerSubsystem>() : nullptr;
+
+	return DialogueSubsystem 
+		? &DialogueSubsystem->GetTransitionScheduler() 
+		: nullptr;
+}
+
+FDialogueQueryCache& UDialogueSession::GetQueryCache()
+{
+	return QueryCache;
+}
+
+void UDialogueSession::InvalidateQueries()
+{
+	QueryCache.Invalidate();
+}
+
+bool UDialogueSession::IssueAsyncQueries(
+	TConstArrayView<UDialogueQuery*> Queries, FSimpleDelegate OnResolved)
+{
+	UWorld* World = GetWorld();
+	const uint32 Serial = AsyncQuerySerial;
+
+	//Issue everything up front so that the queries run side by side
+	bIssuingQueries = true;
+	for (UDialogueQuery* Query : Queries)
+	{
+		if (!Query || !Query->IsAsyncQuery() 
+			|| AsyncQueries.Contains(Query) || Query->HasCachedResult(this))
+		{
+			continue;
+		}
+
+		FDialogueAsyncQueryEntry& Entry = AsyncQueries.Add(Query);
+		++NumPendingQueries;
+
+		const float Timeout = Query->GetAsyncTimeout();
+		if (World && Timeout > 0.f)
+		{
+			World->GetTimerManager().SetTimer(
+				Entry.TimeoutHandle,
+				FTimerDelegate::CreateUObject(
+					this,
+					&UDialogueSession::OnAsyncQueryTimedOut,
+					TWeakObjectPtr<UDialogueQuery>(Query),
+					Serial
+				),
+				Timeout,
+				false
+			);
+		}
+
+		Query->ExecuteQueryAsync(
+			this,
+			FDialogueQueryResultSignature::CreateUObject(
+				this,
+				&UDialogueSession::OnAsyncQueryResolved,
+				TWeakObjectPtr<UDialogueQuery>(Query),
+				Serial
+			)
+		);
+
+		//A query may end the session or move it on while starting
+		if (!bActive || Serial != AsyncQuerySerial)
+		{
+			bIssuingQueries = false;
+			return false;
+		}
+	}
+	bIssuingQueries = false;
+
+	if (NumPendingQueries > 0)
+	{
+		OnAsyncQueriesResolved = MoveTemp(OnResolved);
+		return true;
+	}
+
+	return false;
+}
+
+bool UDialogueSession::FindAsyncResult(const UDialogueQuery* Query, 
+	double& OutValue) const
+{
+	const FDialogueAsyncQueryEntry* Entry = AsyncQueries.Find(Query);
+	if (!Entry || !Entry->bResolved)
+	{
+		return false;
+	}
+
+	OutValue = Entry->Value;
+	return true;
+}
+
+bool UDialogueSession::HasPendingQueries() const
+{
+	return NumPendingQueries > 0;
+}
+
+void UDialogueSession::CancelAsyncQueries()
+{
+	if (AsyncQueries.IsEmpty())
+	{
+		return;
+	}
+
+	if (UWorld* World = GetWorld())
+	{
+		for (auto& Entry : AsyncQueries)
+		{
+			World->GetTimerManager().ClearTimer(Entry.Value.TimeoutHandle);
+		}
+	}
+
+	AsyncQueries.Reset();
+	NumPendingQueries = 0;
+	OnAsyncQueriesResolved.Unbind();
+	++AsyncQuerySerial;
+}
+
+void UDialogueSession::OnAsyncQueryResolved(double Value, 
+	TWeakObjectPtr<UDialogueQuery> Query, uint32 Serial)
+{
+	check(IsInGameThread());
+
+	//Ignore results for queries the session no longer waits on
+	if (!bActive || Serial != AsyncQuerySerial || !Query.IsValid())
+	{
+		return;
+	}
+
+	ResolveAsyncQuery(Query.Get(), Value);
+}
+
+void UDialogueSession::OnAsyncQueryTimedOut(
+	TWeakObjectPtr<UDialogueQuery> Query, uint32 Serial)
+{
+	if (!bActive || Serial != AsyncQuerySerial || !Query.IsValid())
+	{
+		return;
+	}
+
+	UE_LOG(
+		LogDialogueTree,
+		Warning,
+		TEXT("Async query [%s] timed out. Using its timeout value."),
+		*Query->GetName()
+	);
+
+	ResolveAsyncQuery(Query.Get(), Query->GetTimeoutResult());
+}
+
+void UDialogueSession::ResolveAsyncQuery(const UDialogueQuery* Query, 
+	double Value)
+{
+	FDialogueAsyncQueryEntry* Entry = AsyncQueries.Find(Query);
+	if (!Entry || Entry->bResolved)
+	{
+		return;
+	}
+
+	Entry->bResolved = true;
+	Entry->Value = Value;
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(Entry->TimeoutHandle);
+	}
+
+	//Wait for the rest, or for issuing to finish
+	--NumPendingQueries;
+	if (NumPendingQueries > 0 || bIssuingQueries)
+	{
+		return;
+	}
+
+	FSimpleDelegate Callback = MoveTemp(OnAsyncQueriesResolved);
+	OnAsyncQueriesResolved.Unbind();
+	Callback.ExecuteIfBound();
+}
@@ -8,6 +8,8 @@
 #include "Dialogue.h"
 #include "DialogueController.h"
 #include "DialogueManagerSubsystem.h"
+#include "DialogueSession.h"
+#include "DialogueSettings.h"
 #include "LogDialogueTree.h"
 
 UDialogueSpeakerComponent::UDialogueSpeakerComponent()
@@ -24,6 +26,11 @@ void UDialogueSpeakerComponent::BeginPlay()
 		GetWorld()->GetSubsystem<UDialogueManagerSubsystem>();
 	check(DialogueSubsystem);
 
+	OnAudioFinishedNative.AddUObject(
+		this,
+		&UDialogueSpeakerComponent::HandleAudioFinished
+	);
+
 	GlobalDialogueController = DialogueSubsystem->GetCurrentController();
 	if (!GlobalDialogueController)
 	{
@@ -37,7 +44,12 @@ void UDialogueSpeakerComponent::BeginPlay()
 
 	// G2VS2:
 	if (!DialogueSpeakerId.IsValid())
+	{
 		DialogueSpeakerId = FGuid::NewGuid();
+		bGeneratedSpeakerId = true;
+	}
+
+	RegisterHistoryPersistence();
 }
 
 void UDialogueSpeakerComponent::SetDisplayName(FText InDisplayName)
@@ -87,18 +99,62 @@ FGameplayTagContainer UDialogueSpeakerComponent::GetCurrentGameplayTags()
 
 void UDialogueSpeakerComponent::EndCurrentDialogue()
 {
-	if (!GetDialogueController() || !GetDialogueController()->SpeakerInCurrentDialogue(this))
+	UDialogueSession* Session = GetActiveSession();
+	if (!Session)
+	{
 		return;
+	}
 
-	GetDialogueController()->EndDialogue();
+	if (GetDialogueController() && Session->IsDisplayed())
+	{
+		GetDialogueController()->EndDialogue();
+		return;
+	}
+
+	//Otherwise the speaker is playing in an undisplayed session
+	Session->GetDialogue()->EndDialogue(Session);
 }
 
 void UDialogueSpeakerComponent::TrySkipSpeech()
 {
-	if (!GetDialogueController() || !GetDialogueController()->SpeakerInCurrentDialogue(this))
+	UDialogueSession* Session = GetActiveSession();
+	if (!Session)
+	{
 		return;
+	}
 
-	GetDialogueController()->Skip();
+	if (GetDialogueController() && Session->IsDisplayed())
+	{
+		GetDialogueController()->Skip();
+		return;
+	}
+
+	Session->GetDialogue()->Skip(Session);
+}
+
+bool UDialogueSpeakerComponent::IsInDialogue() const
+{
+	return GetActiveSession() != nullptr;
+}
+
+UDialogueSession* UDialogueSpeakerComponent::GetActiveSession() const
+{
+	UDialogueSession* Session = ActiveSession.Get();
+	return Session && Session->IsActive() ? Session : nullptr;
+}
+
+void UDialogueSpeakerComponent::BindSession(UDialogueSession* InSession)
+{
+	ActiveSession = InSession;
+}
+
+void UDialogueSpeakerComponent::UnbindSession(
+	const UDialogueSession* InSession)
+{
+	if (ActiveSession.Get() == InSession)
+	{
+		ActiveSession.Reset();
+	}
 }
 
 void UDialogueSpeakerComponent::PlaySpeechAudioClip_Implementation(
@@ -301,7 +357,60 @@ void UDialogueSpeakerComponent::BroadcastCurrentGameplayTags()
 	OnGameplayTagsChanged.Broadcast(GameplayTags);
 }
 
+void UDialogueSpeakerComponent::HandleAudioFinished(
+	UAudioComponent* AudioComponent)
+{
+	UWorld* World = GetWorld();
+	UDialogueManagerSubsystem* DialogueSubsystem = 
+		World ? World->GetSubsystem<UDialogueManagerSubsystem>() : nullptr;
+
+	if (DialogueSubsystem)
+	{
+		DialogueSubsystem->GetTransitionScheduler().NotifyAudioFinished(this);
+	}
+}
+
+EDialogueSpeakerPersistence 
+	UDialogueSpeakerComponent::GetHistoryPersistence() const
+{
+	if (!bGeneratedSpeakerId)
+	{
+		return HistoryPersistence;
+	}
+
+	//The enum runs from longest to shortest lived
+	return FMath::Max(
+		HistoryPersistence,
+		GetDefault<UDialogueSettings>()->GeneratedSpeakerIdPersistence
+	);
+}
+
+void UDialogueSpeakerComponent::RegisterHistoryPersistence() const
+{
+	if (GlobalDialogueController && DialogueSpeakerId.IsValid())
+	{
+		GlobalDialogueController->SetSpeakerPersistence(
+			DialogueSpeakerId,
+			GetHistoryPersistence()
+		);
+	}
+}
+
 ADialogueController* UDialogueSpeakerComponent::GetDialogueController() const
 {
 	return GlobalDialogueController;
 }
+
+void UDialogueSpeakerComponent::SetDialogueSpeakerId(
+	const FGuid& InDialogueSpeakerId)
+{
+	DialogueSpeakerId = InDialogueSpeakerId;
+	bGeneratedSpeakerId = false;
+	RegisterHistoryPersistence();
+
+	//The session records history under the old ID until told otherwise
+	if (UDialogueSession* Session = GetActiveSession())
+	{
+		Session->RefreshParticipantIds();
+	}
+}
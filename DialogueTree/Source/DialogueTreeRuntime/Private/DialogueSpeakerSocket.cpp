@@ -3,11 +3,15 @@
 //Header
 #include "DialogueSpeakerSocket.h"
 //Plugin
-#include "Dialogue.h"
+#include "DialogueSession.h"
 
 void UDialogueSpeakerSocket::SetSpeakerName(FName InName)
 {
-	SpeakerName = InName;
+	if (SpeakerName != InName)
+	{
+		SpeakerName = InName;
+		SpeakerSlot = INDEX_NONE;
+	}
 }
 
 FName UDialogueSpeakerSocket::GetSpeakerName() const
@@ -15,15 +19,38 @@ FName UDialogueSpeakerSocket::GetSpeakerName() const
 	return SpeakerName;
 }
 
+void UDialogueSpeakerSocket::SetSpeakerSlot(int32 InSlot)
+{
+	SpeakerSlot = InSlot;
+}
+
+int32 UDialogueSpeakerSocket::GetSpeakerSlot() const
+{
+	return SpeakerSlot;
+}
+
 UDialogueSpeakerComponent* UDialogueSpeakerSocket::GetSpeakerComponent(
-	UDialogue* InDialogue) const
+	const UDialogueSession* InSession) const
+{
+	const FSpeakerActorEntry* Entry = GetSpeakerEntry(InSession);
+	return Entry ? Entry->SpeakerComponent.Get() : nullptr;
+}
+
+const FSpeakerActorEntry* UDialogueSpeakerSocket::GetSpeakerEntry(
+	const UDialogueSession* InSession) const
 {
-	if (!InDialogue || SpeakerName.IsNone())
+	if (!InSession || SpeakerName.IsNone())
 	{
 		return nullptr;
 	}
 
-	return InDialogue->GetSpeaker(SpeakerName);
+	//Sockets edited since the dialogue last compiled fall back to a lookup
+	//by name
+	const int32 Slot = SpeakerSlot != INDEX_NONE 
+		? SpeakerSlot 
+		: InSession->FindSpeakerSlot(SpeakerName);
+
+	return InSession->GetSpeakerEntry(Slot);
 }
 
 bool UDialogueSpeakerSocket::IsValidSocket() const
@@ -6,19 +6,22 @@
 #include "Engine/World.h"
 //Plugin
 #include "Dialogue.h"
+#include "DialogueSession.h"
 #include "DialogueSpeakerComponent.h"
 #include "DialogueSpeakerSocket.h"
 #include "LogDialogueTree.h"
 
 void UDialogueEvent::PlayEvent()
 {
-	check(Dialogue && Speaker);
+	check(Dialogue && Session && Speaker);
 
 	bBlocking = false;
-	UDialogueSpeakerComponent* SpeakerComponent =
-		Speaker->GetSpeakerComponent(Dialogue);
 
-	if (!SpeakerComponent)
+	//Gather the speakers from the session's resolved slots
+	const FSpeakerActorEntry* TargetSpeaker = nullptr;
+	FSpeakerActorEntryList OtherSpeakers;
+	if (!Session->GatherSpeakerEntries(
+		Speaker, AdditionalSpeakers, TargetSpeaker, OtherSpeakers))
 	{
 		UE_LOG(
 			LogDialogueTree, 
@@ -28,30 +31,17 @@ void UDialogueEvent::PlayEvent()
 		return;
 	}
 
-	
-	FSpeakerActorEntry TargetSpeaker = SpeakerComponent->ToSpeakerActorEntry();
-	
-	TArray<FSpeakerActorEntry> OtherSpeakers;
-	for (UDialogueSpeakerSocket* Socket : AdditionalSpeakers)
-	{
-		UDialogueSpeakerComponent* SocketComponent = 
-			Socket->GetSpeakerComponent(Dialogue);
-		if (!SocketComponent)
-		{
-			UE_LOG(
-				LogDialogueTree,
-				Warning,
-				TEXT("Failed to play event because the target speaker component was not supplied. Verify that the dialogue name property matches the speaker's role in the dialogue.")
-			);
-			return;
-		}
-
-		FSpeakerActorEntry SocketEntry = 
-			SocketComponent->ToSpeakerActorEntry();
-		OtherSpeakers.Add(SocketEntry);
-	}
+	NativePlayEvent(*TargetSpeaker, OtherSpeakers);
+}
 
-	OnPlayEvent(TargetSpeaker, OtherSpeakers);
+void UDialogueEvent::NativePlayEvent(const FSpeakerActorEntry& InSpeaker,
+	TConstArrayView<FSpeakerActorEntry> OtherSpeakers)
+{
+	//Blueprint implementations take an array, so copy the speakers into one
+	OnPlayEvent(
+		InSpeaker, 
+		TArray<FSpeakerActorEntry>(OtherSpeakers.GetData(), OtherSpeakers.Num())
+	);
 }
 
 bool UDialogueEvent::HasAllRequirements() const
@@ -75,13 +65,13 @@ AActor* UDialogueEvent::SpawnActorToCurrentWorld(
 	AActor* Owner,
 	ESpawnActorCollisionHandlingMethod CollisionHandlingMethod)
 {
-	if (!Speaker || !Dialogue || !ActorClass)
+	if (!Speaker || !Session || !ActorClass)
 	{
 		return nullptr;
 	}
 
 	UDialogueSpeakerComponent* SpeakerComponent = 
-		Speaker->GetSpeakerComponent(Dialogue);
+		Speaker->GetSpeakerComponent(Session);
 	if (!SpeakerComponent)
 	{
 		return nullptr;
@@ -122,7 +112,16 @@ TArray<UDialogueSpeakerSocket*> UDialogueEvent::GetAdditionalSpeakerSockets() co
 
 const FSpeechDetails UDialogueEvent::GetCurrentSpeechDetails() const
 {
-	if (UDialogueSpeechNode* Speech = 
+	//Session instances live on the session, so ask it for the speech
+	if (Session)
+	{
+		if (UDialogueSpeechNode* Speech = 
+			Cast<UDialogueSpeechNode>(Session->GetActiveNode()))
+		{
+			return Speech->GetDetails();
+		}
+	}
+	else if (UDialogueSpeechNode* Speech = 
 		GetTypedOuter<UDialogueSpeechNode>())
 	{
 		return Speech->GetDetails();
@@ -2,6 +2,8 @@
 
 
 #include "Events/DialogueEventBase.h"
+//Plugin
+#include "DialogueSession.h"
 
 bool UDialogueEventBase::HasAllRequirements() const
 {
@@ -48,3 +50,13 @@ void UDialogueEventBase::SetDialogue(UDialogue* InDialogue)
 
 	Dialogue = InDialogue;
 }
+
+void UDialogueEventBase::SetSession(UDialogueSession* InSession)
+{
+	Session = InSession;
+}
+
+UDialogueSession* UDialogueEventBase::GetSession() const
+{
+	return Session;
+}
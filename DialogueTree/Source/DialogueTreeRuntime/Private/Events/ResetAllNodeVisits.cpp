@@ -9,9 +9,9 @@
 
 void UResetAllNodeVisits::PlayEvent()
 {
-	if (Dialogue)
+	if (Dialogue && Session)
 	{
-		Dialogue->ClearAllNodeVisits();
+		Dialogue->ClearAllNodeVisits(Session);
 	}
 }
 
@@ -11,9 +11,13 @@
 
 void UResetNodeVisits::PlayEvent()
 {
-	if (Dialogue && TargetNode && TargetNode->GetDialogueNode())
+	if (Dialogue && Session && TargetNode && TargetNode->GetDialogueNode())
 	{
-		Dialogue->MarkNodeVisited(TargetNode->GetDialogueNode(), false);
+		Dialogue->MarkNodeVisited(
+			Session, 
+			TargetNode->GetDialogueNode(), 
+			false
+		);
 	}
 }
 
@@ -10,7 +10,7 @@
 
 void USetResumeNode::PlayEvent()
 {
-	if (!Dialogue || !TargetNode)
+	if (!Dialogue || !Session || !TargetNode)
 	{
 		return;
 	}
@@ -21,7 +21,7 @@ void USetResumeNode::PlayEvent()
 		return;
 	}
 
-	Dialogue->SetResumeNode(ResumeNode);
+	Dialogue->SetResumeNode(Session, ResumeNode);
 }
 
 bool USetResumeNode::HasAllRequirements() const
@@ -0,0 +1,207 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//Header
+#include "History/DialogueHistoriesCodec.h"
+//UE
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+//Plugin
+#include "DialogueController.h"
+#include "LogDialogueTree.h"
+
+namespace
+{
+	/**
+	* Struct gathering every name written by a single save into a table.
+	*/
+	struct FNameTable
+	{
+		/** Names in the order they were first seen */
+		TArray<FName> Names;
+
+		/** Position of each name in Names */
+		TMap<FName, uint32> Indices;
+
+		/** Adds the name if not seen before, returning its position */
+		uint32 Add(FName InName)
+		{
+			if (const uint32* Found = Indices.Find(InName))
+			{
+				return *Found;
+			}
+
+			const uint32 Index = Names.Add(InName);
+			Indices.Add(InName, Index);
+			return Index;
+		}
+	};
+
+	/** Reads a position in the name table, failing the archive if the
+	* position is out of range */
+	FName ReadName(FArchive& Ar, const TArray<FName>& Names)
+	{
+		uint32 Index = 0;
+		Ar.SerializeIntPacked(Index);
+		if (Index >= static_cast<uint32>(Names.Num()))
+		{
+			Ar.SetError();
+			return NAME_None;
+		}
+
+		return Names[Index];
+	}
+}
+
+void FDialogueHistoriesCodec::Write(FArchive& Ar,
+	const FDialogueHistories& Histories)
+{
+	check(Ar.IsSaving());
+
+	//Lay out the name table up front so that readers can resolve every
+	//position as they come to it
+	FNameTable NameTable;
+	for (const auto& HistoryEntry : Histories.Histories)
+	{
+		NameTable.Add(HistoryEntry.Key);
+		NameTable.Add(HistoryEntry.Value.DialogueFName);
+		for (const auto& SpeakerEntry : HistoryEntry.Value.DialogueNodeHistory)
+		{
+			NameTable.Add(SpeakerEntry.Value.ResumeNodeID);
+			for (FName NodeID : SpeakerEntry.Value.VisitedNodeIDs)
+			{
+				NameTable.Add(NodeID);
+			}
+		}
+	}
+
+	int32 Version = CurrentVersion;
+	Ar << Version;
+
+	uint32 NumNames = NameTable.Names.Num();
+	Ar.SerializeIntPacked(NumNames);
+	for (FName& Name : NameTable.Names)
+	{
+		Ar << Name;
+	}
+
+	uint32 NumHistories = Histories.Histories.Num();
+	Ar.SerializeIntPacked(NumHistories);
+	for (const auto& HistoryEntry : Histories.Histories)
+	{
+		const FDialogueHistory& History = HistoryEntry.Value;
+
+		uint32 KeyIndex = NameTable.Add(HistoryEntry.Key);
+		uint32 NameIndex = NameTable.Add(History.DialogueFName);
+		FGuid DialogueGuid = History.DialogueGuid;
+		Ar.SerializeIntPacked(KeyIndex);
+		Ar.SerializeIntPacked(NameIndex);
+		Ar << DialogueGuid;
+
+		uint32 NumSpeakers = History.DialogueNodeHistory.Num();
+		Ar.SerializeIntPacked(NumSpeakers);
+		for (const auto& SpeakerEntry : History.DialogueNodeHistory)
+		{
+			const FCharacterDialogueHistory& CharacterHistory =
+				SpeakerEntry.Value;
+
+			FGuid SpeakerId = SpeakerEntry.Key;
+			uint32 ResumeIndex = NameTable.Add(CharacterHistory.ResumeNodeID);
+			Ar << SpeakerId;
+			Ar.SerializeIntPacked(ResumeIndex);
+
+			uint32 NumVisited = CharacterHistory.VisitedNodeIDs.Num();
+			Ar.SerializeIntPacked(NumVisited);
+			for (FName NodeID : CharacterHistory.VisitedNodeIDs)
+			{
+				uint32 NodeIndex = NameTable.Add(NodeID);
+				Ar.SerializeIntPacked(NodeIndex);
+			}
+		}
+	}
+}
+
+bool FDialogueHistoriesCodec::Read(FArchive& Ar,
+	FDialogueHistories& OutHistories)
+{
+	check(Ar.IsLoading());
+	OutHistories.Histories.Empty();
+
+	int32 Version = 0;
+	Ar << Version;
+	if (Version > CurrentVersion || Version < 1)
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Dialogue histories were saved with a version (%d) this build cannot read (%d). Discarding them."),
+			Version,
+			CurrentVersion
+		);
+		Ar.SetError();
+		return false;
+	}
+
+	uint32 NumNames = 0;
+	Ar.SerializeIntPacked(NumNames);
+	TArray<FName> Names;
+	for (uint32 NameIndex = 0; NameIndex < NumNames && !Ar.IsError();
+		++NameIndex)
+	{
+		Ar << Names.AddDefaulted_GetRef();
+	}
+
+	uint32 NumHistories = 0;
+	Ar.SerializeIntPacked(NumHistories);
+	for (uint32 HistoryIndex = 0;
+		HistoryIndex < NumHistories && !Ar.IsError(); ++HistoryIndex)
+	{
+		const FName Key = ReadName(Ar, Names);
+		FDialogueHistory& History = OutHistories.Histories.FindOrAdd(Key);
+		History.DialogueFName = ReadName(Ar, Names);
+		Ar << History.DialogueGuid;
+
+		uint32 NumSpeakers = 0;
+		Ar.SerializeIntPacked(NumSpeakers);
+		for (uint32 SpeakerIndex = 0;
+			SpeakerIndex < NumSpeakers && !Ar.IsError(); ++SpeakerIndex)
+		{
+			FGuid SpeakerId;
+			Ar << SpeakerId;
+
+			FCharacterDialogueHistory& CharacterHistory =
+				History.DialogueNodeHistory.FindOrAdd(SpeakerId);
+			CharacterHistory.ResumeNodeID = ReadName(Ar, Names);
+
+			uint32 NumVisited = 0;
+			Ar.SerializeIntPacked(NumVisited);
+			for (uint32 VisitIndex = 0;
+				VisitIndex < NumVisited && !Ar.IsError(); ++VisitIndex)
+			{
+				CharacterHistory.VisitedNodeIDs.Add(ReadName(Ar, Names));
+			}
+		}
+	}
+
+	if (Ar.IsError())
+	{
+		OutHistories.Histories.Empty();
+		return false;
+	}
+
+	return true;
+}
+
+void FDialogueHistoriesCodec::SaveToBytes(const FDialogueHistories& Histories,
+	TArray<uint8>& OutBytes)
+{
+	OutBytes.Reset();
+	FMemoryWriter Writer(OutBytes);
+	Write(Writer, Histories);
+}
+
+bool FDialogueHistoriesCodec::LoadFromBytes(const TArray<uint8>& InBytes,
+	FDialogueHistories& OutHistories)
+{
+	FMemoryReader Reader(InBytes);
+	return Read(Reader, OutHistories);
+}
@@ -0,0 +1,776 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//Header
+#include "History/DialogueHistoryColdStore.h"
+//UE
+#include "Algo/Sort.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+//Plugin
+#include "LogDialogueTree.h"
+
+namespace
+{
+	typedef FDialogueHistoryColdShard::FEntry FEntry;
+
+	/** Orders records by speaker then dialogue, as shard tables are */
+	bool IsKeyLess(const FGuid& SpeakerA, const FGuid& DialogueA,
+		const FGuid& SpeakerB, const FGuid& DialogueB)
+	{
+		if (SpeakerA != SpeakerB)
+		{
+			return SpeakerA < SpeakerB;
+		}
+		return DialogueA < DialogueB;
+	}
+
+	/** Checks if a record holds anything worth keeping */
+	bool IsEmptyRecord(const FDialogueSpeakerHistory& Speaker)
+	{
+		return Speaker.VisitedNodes.IsEmpty()
+			&& Speaker.ResumeNodeIndex == INDEX_NONE;
+	}
+
+	/** Picks the shard a speaker's records are kept in */
+	int32 GetShardIndexOf(const FGuid& SpeakerId, int32 NumShards)
+	{
+		return static_cast<int32>(GetTypeHash(SpeakerId) % NumShards);
+	}
+
+	/** Reads the shard index and generation out of a shard file's name */
+	bool ParseShardFilename(const FString& Name, int32& OutShardIndex,
+		uint32& OutGeneration)
+	{
+		FString Stem = FPaths::GetBaseFilename(Name);
+		FString IndexPart;
+		FString GenerationPart;
+		if (!Stem.RemoveFromStart(TEXT("DialogueHistory_"))
+			|| !Stem.Split(TEXT("_"), &IndexPart, &GenerationPart)
+			|| !IndexPart.IsNumeric() || !GenerationPart.IsNumeric())
+		{
+			return false;
+		}
+
+		LexFromString(OutShardIndex, *IndexPart);
+		LexFromString(OutGeneration, *GenerationPart);
+		return true;
+	}
+}
+
+FDialogueHistoryColdShard::FDialogueHistoryColdShard(uint32 InGeneration) :
+	Generation(InGeneration)
+{
+	static_assert(sizeof(FEntry) == 48, "Shard entries are written as is");
+}
+
+FDialogueHistoryColdShard::~FDialogueHistoryColdShard()
+{
+	Release();
+
+	//Runs on whichever thread lets go last; the file is only deleted
+	if (bRetired && !Filename.IsEmpty())
+	{
+		IFileManager::Get().Delete(*Filename);
+	}
+}
+
+bool FDialogueHistoryColdShard::Open(const FString& InFilename)
+{
+	Release();
+	Filename = InFilename;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	Handle.Reset(PlatformFile.OpenMapped(*Filename));
+	if (Handle && Handle->GetFileSize() > 0)
+	{
+		Region.Reset(Handle->MapRegion(0, Handle->GetFileSize()));
+	}
+
+	if (Region)
+	{
+		Bytes = MakeArrayView(
+			Region->GetMappedPtr(),
+			static_cast<int32>(Region->GetMappedSize())
+		);
+	}
+	else
+	{
+		//Read in whole where the platform cannot map files
+		Handle.Reset();
+		if (!FFileHelper::LoadFileToArray(Loaded, *Filename))
+		{
+			return false;
+		}
+		Bytes = Loaded;
+	}
+
+	uint32 Header[4] = {};
+	if (Bytes.Num() >= HeaderSize)
+	{
+		FMemory::Memcpy(Header, Bytes.GetData(), HeaderSize);
+	}
+
+	const int64 TableEnd =
+		HeaderSize + static_cast<int64>(Header[2]) * sizeof(FEntry);
+	if (Header[0] != Magic || Header[1] != CurrentVersion
+		|| TableEnd > Bytes.Num())
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Dialogue history shard %s could not be read. Discarding it."),
+			*Filename
+		);
+		Release();
+		return false;
+	}
+
+	NumEntries = static_cast<int32>(Header[2]);
+	return true;
+}
+
+void FDialogueHistoryColdShard::Retire()
+{
+	bRetired = true;
+}
+
+int32 FDialogueHistoryColdShard::LowerBound(const FGuid& SpeakerId,
+	const FGuid& DialogueId) const
+{
+	//Only the pages the search touches are read in
+	int32 Low = 0;
+	int32 High = NumEntries;
+	while (Low < High)
+	{
+		const int32 Mid = Low + (High - Low) / 2;
+		const FEntry Entry = ReadEntry(Mid);
+		if (IsKeyLess(Entry.SpeakerId, Entry.DialogueId,
+			SpeakerId, DialogueId))
+		{
+			Low = Mid + 1;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+	return Low;
+}
+
+bool FDialogueHistoryColdShard::FindEntry(const FGuid& DialogueId,
+	const FGuid& SpeakerId, FEntry& OutEntry) const
+{
+	const int32 EntryIndex = LowerBound(SpeakerId, DialogueId);
+	if (EntryIndex == NumEntries)
+	{
+		return false;
+	}
+
+	OutEntry = ReadEntry(EntryIndex);
+	return OutEntry.SpeakerId == SpeakerId && OutEntry.DialogueId == DialogueId;
+}
+
+FEntry FDialogueHistoryColdShard::ReadEntry(int32 EntryIndex) const
+{
+	check(EntryIndex >= 0 && EntryIndex < NumEntries);
+
+	FEntry Entry;
+	FMemory::Memcpy(
+		&Entry,
+		Bytes.GetData() + HeaderSize + EntryIndex * sizeof(FEntry),
+		sizeof(FEntry)
+	);
+	return Entry;
+}
+
+void FDialogueHistoryColdShard::ReadRecord(const FEntry& Entry,
+	FDialogueSpeakerHistory& OutSpeaker) const
+{
+	OutSpeaker.ResumeNodeIndex = Entry.ResumeNodeIndex;
+	OutSpeaker.VisitedNodes.Words.Reset();
+
+	const int64 WordsStart =
+		HeaderSize + static_cast<int64>(NumEntries) * sizeof(FEntry);
+	const int64 Start =
+		WordsStart + static_cast<int64>(Entry.WordOffset) * sizeof(uint32);
+	const int64 Size = static_cast<int64>(Entry.NumWords) * sizeof(uint32);
+	if (Start + Size > Bytes.Num())
+	{
+		return;
+	}
+
+	OutSpeaker.VisitedNodes.Words.SetNumUninitialized(Entry.NumWords);
+	FMemory::Memcpy(
+		OutSpeaker.VisitedNodes.Words.GetData(),
+		Bytes.GetData() + Start,
+		Size
+	);
+}
+
+bool FDialogueHistoryColdShard::WasVisited(const FEntry& Entry,
+	int32 NodeIndex) const
+{
+	//Visits are trimmed of trailing zero words before they are written
+	if (NodeIndex == INDEX_NONE)
+	{
+		return Entry.NumWords > 0;
+	}
+
+	const int32 WordIndex = NodeIndex >> 5;
+	if (NodeIndex < 0 || static_cast<uint32>(WordIndex) >= Entry.NumWords)
+	{
+		return false;
+	}
+
+	const int64 Start = HeaderSize
+		+ static_cast<int64>(NumEntries) * sizeof(FEntry)
+		+ (static_cast<int64>(Entry.WordOffset) + WordIndex) * sizeof(uint32);
+	if (Start + static_cast<int64>(sizeof(uint32)) > Bytes.Num())
+	{
+		return false;
+	}
+
+	uint32 Word = 0;
+	FMemory::Memcpy(&Word, Bytes.GetData() + Start, sizeof(uint32));
+	return (Word & (1u << (NodeIndex & 31))) != 0;
+}
+
+void FDialogueHistoryColdShard::Release()
+{
+	Bytes = TConstArrayView<uint8>();
+	NumEntries = 0;
+	Region.Reset();
+	Handle.Reset();
+	Loaded.Empty();
+}
+
+bool FDialogueHistoryColdView::Find(const FGuid& DialogueId,
+	const FGuid& SpeakerId, FDialogueSpeakerHistory& OutSpeaker) const
+{
+	const FDialogueHistoryColdShard& Shard = GetShard(SpeakerId);
+	FEntry Entry;
+	if (!Shard.FindEntry(DialogueId, SpeakerId, Entry))
+	{
+		return false;
+	}
+
+	Shard.ReadRecord(Entry, OutSpeaker);
+	return true;
+}
+
+bool FDialogueHistoryColdView::WasVisited(const FGuid& DialogueId,
+	const FGuid& SpeakerId, int32 NodeIndex) const
+{
+	const FDialogueHistoryColdShard& Shard = GetShard(SpeakerId);
+	FEntry Entry;
+	return Shard.FindEntry(DialogueId, SpeakerId, Entry)
+		&& Shard.WasVisited(Entry, NodeIndex);
+}
+
+void FDialogueHistoryColdView::FindVisitedDialogues(const FGuid& SpeakerId,
+	TArray<FGuid>& OutDialogueIds) const
+{
+	//A speaker's records sit together, and the zero GUID orders before
+	//every dialogue
+	const FDialogueHistoryColdShard& Shard = GetShard(SpeakerId);
+	for (int32 EntryIndex = Shard.LowerBound(SpeakerId, FGuid());
+		EntryIndex < Shard.Num(); ++EntryIndex)
+	{
+		const FEntry Entry = Shard.ReadEntry(EntryIndex);
+		if (Entry.SpeakerId != SpeakerId)
+		{
+			break;
+		}
+
+		if (Shard.WasVisited(Entry, INDEX_NONE))
+		{
+			OutDialogueIds.Add(Entry.DialogueId);
+		}
+	}
+}
+
+const FDialogueHistoryColdShard& FDialogueHistoryColdView::GetShard(
+	const FGuid& SpeakerId) const
+{
+	return *Shards[GetShardIndexOf(SpeakerId, Shards.Num())];
+}
+
+FDialogueHistoryColdStore::FDialogueHistoryColdStore()
+{
+}
+
+FDialogueHistoryColdStore::~FDialogueHistoryColdStore()
+{
+	Close();
+}
+
+bool FDialogueHistoryColdStore::Open(const FString& InDirectory,
+	int32 InNumShards)
+{
+	Close();
+
+	IFileManager& FileManager = IFileManager::Get();
+	if (InDirectory.IsEmpty() || InNumShards < 1
+		|| !FileManager.MakeDirectory(*InDirectory, true))
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Could not open dialogue history cold store at %s."),
+			*InDirectory
+		);
+		return false;
+	}
+
+	Directory = InDirectory;
+	Shards.Reserve(InNumShards);
+	for (int32 ShardIndex = 0; ShardIndex < InNumShards; ++ShardIndex)
+	{
+		Shards.Add(MakeShared<FDialogueHistoryColdShard, ESPMode::ThreadSafe>());
+	}
+
+	//Writes cut short leave their temporary files behind
+	TArray<FString> Found;
+	FileManager.FindFiles(
+		Found,
+		*FPaths::Combine(Directory, TEXT("DialogueHistory_*.tmp")),
+		true,
+		false
+	);
+	for (const FString& Name : Found)
+	{
+		FileManager.Delete(*FPaths::Combine(Directory, Name));
+	}
+
+	//Only the latest generation of each shard is current. Older ones are
+	//left behind only if the game stopped before their last reader let go.
+	Found.Reset();
+	FileManager.FindFiles(
+		Found,
+		*FPaths::Combine(Directory, TEXT("DialogueHistory_*.shard")),
+		true,
+		false
+	);
+
+	TArray<TPair<int32, uint32>> Parsed;
+	TArray<int64> Latest;
+	Parsed.Reserve(Found.Num());
+	Latest.Init(-1, Shards.Num());
+	for (const FString& Name : Found)
+	{
+		int32 ShardIndex = INDEX_NONE;
+		uint32 Generation = 0;
+		if (!ParseShardFilename(Name, ShardIndex, Generation)
+			|| !Shards.IsValidIndex(ShardIndex))
+		{
+			ShardIndex = INDEX_NONE;
+		}
+		else
+		{
+			Latest[ShardIndex] = FMath::Max<int64>(
+				Latest[ShardIndex],
+				Generation
+			);
+		}
+		Parsed.Emplace(ShardIndex, Generation);
+	}
+
+	for (int32 FileIndex = 0; FileIndex < Found.Num(); ++FileIndex)
+	{
+		const int32 ShardIndex = Parsed[FileIndex].Key;
+		const uint32 Generation = Parsed[FileIndex].Value;
+		if (ShardIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const FString Filename = FPaths::Combine(Directory, Found[FileIndex]);
+		if (Generation != Latest[ShardIndex])
+		{
+			FileManager.Delete(*Filename);
+			continue;
+		}
+
+		//A shard that cannot be read is started over
+		Shards[ShardIndex] =
+			MakeShared<FDialogueHistoryColdShard, ESPMode::ThreadSafe>(
+				Generation
+			);
+		if (!Shards[ShardIndex]->Open(Filename))
+		{
+			FileManager.Delete(*Filename);
+		}
+	}
+
+	return true;
+}
+
+void FDialogueHistoryColdStore::Close()
+{
+	//Views still holding the shards keep them mapped until they let go
+	Shards.Empty();
+	View.Reset();
+	Directory.Empty();
+	SpeakersByDialogue.Empty();
+	bSpeakersByDialogueBuilt = false;
+}
+
+bool FDialogueHistoryColdStore::IsOpen() const
+{
+	return !Shards.IsEmpty();
+}
+
+bool FDialogueHistoryColdStore::Find(const FGuid& DialogueId,
+	const FGuid& SpeakerId, FDialogueSpeakerHistory& OutSpeaker) const
+{
+	if (!IsOpen())
+	{
+		return false;
+	}
+
+	const FDialogueHistoryColdShard& Shard =
+		*Shards[GetShardIndex(SpeakerId)];
+	FEntry Entry;
+	if (!Shard.FindEntry(DialogueId, SpeakerId, Entry))
+	{
+		return false;
+	}
+
+	Shard.ReadRecord(Entry, OutSpeaker);
+	return true;
+}
+
+void FDialogueHistoryColdStore::ForEachSpeaker(const FGuid& DialogueId,
+	TFunctionRef<void(const FGuid&)> Func) const
+{
+	BuildSpeakersByDialogue();
+
+	if (const TSet<FGuid>* Speakers = SpeakersByDialogue.Find(DialogueId))
+	{
+		for (const FGuid& SpeakerId : *Speakers)
+		{
+			Func(SpeakerId);
+		}
+	}
+}
+
+void FDialogueHistoryColdStore::ForEachKey(
+	TFunctionRef<void(const FGuid&, const FGuid&)> Func) const
+{
+	for (const FDialogueHistoryColdShardRef& Shard : Shards)
+	{
+		for (int32 EntryIndex = 0; EntryIndex < Shard->Num(); ++EntryIndex)
+		{
+			const FEntry Entry = Shard->ReadEntry(EntryIndex);
+			Func(Entry.DialogueId, Entry.SpeakerId);
+		}
+	}
+}
+
+bool FDialogueHistoryColdStore::Write(TArray<FDialogueColdRecord>& InRecords)
+{
+	if (!IsOpen() || InRecords.IsEmpty())
+	{
+		return InRecords.IsEmpty();
+	}
+
+	//Grouped by shard, each group in table order
+	Algo::Sort(
+		InRecords,
+		[this](const FDialogueColdRecord& A, const FDialogueColdRecord& B)
+		{
+			const int32 ShardA = GetShardIndex(A.SpeakerId);
+			const int32 ShardB = GetShardIndex(B.SpeakerId);
+			if (ShardA != ShardB)
+			{
+				return ShardA < ShardB;
+			}
+			return IsKeyLess(
+				A.SpeakerId, A.DialogueId, B.SpeakerId, B.DialogueId
+			);
+		}
+	);
+
+	bool bWroteAll = true;
+	int32 First = 0;
+	while (First < InRecords.Num())
+	{
+		const int32 ShardIndex = GetShardIndex(InRecords[First].SpeakerId);
+		int32 Last = First + 1;
+		while (Last < InRecords.Num()
+			&& GetShardIndex(InRecords[Last].SpeakerId) == ShardIndex)
+		{
+			++Last;
+		}
+
+		bWroteAll &= WriteShard(
+			ShardIndex,
+			MakeArrayView(InRecords).Slice(First, Last - First)
+		);
+		First = Last;
+	}
+
+	return bWroteAll;
+}
+
+void FDialogueHistoryColdStore::Reset()
+{
+	SpeakersByDialogue.Empty();
+
+	for (int32 ShardIndex = 0; ShardIndex < Shards.Num(); ++ShardIndex)
+	{
+		ReplaceShard(
+			ShardIndex,
+			MakeShared<FDialogueHistoryColdShard, ESPMode::ThreadSafe>(
+				Shards[ShardIndex]->GetGeneration()
+			)
+		);
+	}
+}
+
+int64 FDialogueHistoryColdStore::Num() const
+{
+	int64 NumEntries = 0;
+	for (const FDialogueHistoryColdShardRef& Shard : Shards)
+	{
+		NumEntries += Shard->Num();
+	}
+	return NumEntries;
+}
+
+FDialogueHistoryColdViewPtr FDialogueHistoryColdStore::GetView() const
+{
+	if (!IsOpen())
+	{
+		return nullptr;
+	}
+
+	//Taking a view copies only the handles to the shards
+	if (!View.IsValid())
+	{
+		TSharedRef<FDialogueHistoryColdView, ESPMode::ThreadSafe> NewView =
+			MakeShared<FDialogueHistoryColdView, ESPMode::ThreadSafe>();
+		NewView->Shards.Reserve(Shards.Num());
+		for (const FDialogueHistoryColdShardRef& Shard : Shards)
+		{
+			NewView->Shards.Add(Shard);
+		}
+		View = NewView;
+	}
+
+	return View;
+}
+
+int32 FDialogueHistoryColdStore::GetShardIndex(const FGuid& SpeakerId) const
+{
+	return GetShardIndexOf(SpeakerId, Shards.Num());
+}
+
+FString FDialogueHistoryColdStore::GetShardFilename(int32 ShardIndex,
+	uint32 Generation) const
+{
+	return FPaths::Combine(
+		Directory,
+		FString::Printf(
+			TEXT("DialogueHistory_%03d_%u.shard"),
+			ShardIndex,
+			Generation
+		)
+	);
+}
+
+void FDialogueHistoryColdStore::ReplaceShard(int32 ShardIndex,
+	const FDialogueHistoryColdShardRef& Shard)
+{
+	Shards[ShardIndex]->Retire();
+	Shards[ShardIndex] = Shard;
+	View.Reset();
+}
+
+bool FDialogueHistoryColdStore::WriteShard(int32 ShardIndex,
+	TConstArrayView<FDialogueColdRecord> InRecords)
+{
+	const FDialogueHistoryColdShard& Shard = *Shards[ShardIndex];
+	const uint32 Generation = Shard.GetGeneration() + 1;
+
+	TArray<FEntry> Entries;
+	TArray<uint32> Words;
+	Entries.Reserve(Shard.Num() + InRecords.Num());
+
+	auto AddEntry = [&Entries, &Words](const FGuid& SpeakerId,
+		const FGuid& DialogueId, const FDialogueSpeakerHistory& Speaker)
+	{
+		if (IsEmptyRecord(Speaker))
+		{
+			return;
+		}
+
+		FEntry& Entry = Entries.AddZeroed_GetRef();
+		Entry.SpeakerId = SpeakerId;
+		Entry.DialogueId = DialogueId;
+		Entry.ResumeNodeIndex = Speaker.ResumeNodeIndex;
+		Entry.WordOffset = static_cast<uint32>(Words.Num());
+		Entry.NumWords = static_cast<uint32>(Speaker.VisitedNodes.Words.Num());
+		Words.Append(Speaker.VisitedNodes.Words);
+	};
+
+	//Keeps the dialogue index in step once the shard is replaced
+	auto UpdateSpeakersByDialogue = [this, InRecords]()
+	{
+		if (!bSpeakersByDialogueBuilt)
+		{
+			return;
+		}
+
+		for (const FDialogueColdRecord& Record : InRecords)
+		{
+			if (!IsEmptyRecord(*Record.Speaker))
+			{
+				SpeakersByDialogue.FindOrAdd(Record.DialogueId)
+					.Add(Record.SpeakerId);
+			}
+			else if (TSet<FGuid>* Speakers = 
+				SpeakersByDialogue.Find(Record.DialogueId))
+			{
+				Speakers->Remove(Record.SpeakerId);
+				if (Speakers->IsEmpty())
+				{
+					SpeakersByDialogue.Remove(Record.DialogueId);
+				}
+			}
+		}
+	};
+
+	//Both lists are in table order, so they merge in one pass. Records
+	//written now replace those kept for the same key.
+	FDialogueSpeakerHistory Kept;
+	int32 KeptIndex = 0;
+	int32 RecordIndex = 0;
+	while (KeptIndex < Shard.Num() || RecordIndex < InRecords.Num())
+	{
+		if (RecordIndex == InRecords.Num())
+		{
+			const FEntry Entry = Shard.ReadEntry(KeptIndex++);
+			Shard.ReadRecord(Entry, Kept);
+			AddEntry(Entry.SpeakerId, Entry.DialogueId, Kept);
+			continue;
+		}
+
+		const FDialogueColdRecord& Record = InRecords[RecordIndex];
+		if (KeptIndex < Shard.Num())
+		{
+			const FEntry Entry = Shard.ReadEntry(KeptIndex);
+			if (IsKeyLess(Entry.SpeakerId, Entry.DialogueId,
+				Record.SpeakerId, Record.DialogueId))
+			{
+				Shard.ReadRecord(Entry, Kept);
+				AddEntry(Entry.SpeakerId, Entry.DialogueId, Kept);
+				++KeptIndex;
+				continue;
+			}
+
+			if (Entry.SpeakerId == Record.SpeakerId
+				&& Entry.DialogueId == Record.DialogueId)
+			{
+				++KeptIndex;
+			}
+		}
+
+		check(Record.Speaker);
+		AddEntry(Record.SpeakerId, Record.DialogueId, *Record.Speaker);
+		++RecordIndex;
+	}
+
+	if (Entries.IsEmpty())
+	{
+		ReplaceShard(
+			ShardIndex,
+			MakeShared<FDialogueHistoryColdShard, ESPMode::ThreadSafe>(
+				Generation
+			)
+		);
+		UpdateSpeakersByDialogue();
+		return true;
+	}
+
+	constexpr int32 HeaderSize = FDialogueHistoryColdShard::HeaderSize;
+	TArray<uint8> Bytes;
+	Bytes.SetNumUninitialized(
+		HeaderSize
+		+ Entries.Num() * sizeof(FEntry)
+		+ Words.Num() * sizeof(uint32)
+	);
+
+	const uint32 Header[4] = {
+		FDialogueHistoryColdShard::Magic,
+		FDialogueHistoryColdShard::CurrentVersion,
+		static_cast<uint32>(Entries.Num()),
+		0
+	};
+	uint8* Cursor = Bytes.GetData();
+	FMemory::Memcpy(Cursor, Header, HeaderSize);
+	Cursor += HeaderSize;
+	FMemory::Memcpy(Cursor, Entries.GetData(), Entries.Num() * sizeof(FEntry));
+	Cursor += Entries.Num() * sizeof(FEntry);
+	FMemory::Memcpy(Cursor, Words.GetData(), Words.Num() * sizeof(uint32));
+
+	//Written aside and moved into place under the next generation's name,
+	//so that a failed write leaves the old shard whole, and views still
+	//reading the old shard keep it mapped until they let go
+	const FString Filename = GetShardFilename(ShardIndex, Generation);
+	const FString TempFilename = Filename + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(Bytes, *TempFilename))
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Could not write dialogue history shard %s."),
+			*TempFilename
+		);
+		return false;
+	}
+
+	IFileManager& FileManager = IFileManager::Get();
+	if (!FileManager.Move(*Filename, *TempFilename))
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Could not replace dialogue history shard %s."),
+			*Filename
+		);
+		FileManager.Delete(*TempFilename);
+		return false;
+	}
+
+	FDialogueHistoryColdShardRef Written =
+		MakeShared<FDialogueHistoryColdShard, ESPMode::ThreadSafe>(Generation);
+	if (!Written->Open(Filename))
+	{
+		FileManager.Delete(*Filename);
+		return false;
+	}
+
+	ReplaceShard(ShardIndex, Written);
+	UpdateSpeakersByDialogue();
+	return true;
+}
+
+void FDialogueHistoryColdStore::BuildSpeakersByDialogue() const
+{
+	if (bSpeakersByDialogueBuilt)
+	{
+		return;
+	}
+
+	bSpeakersByDialogueBuilt = true;
+	SpeakersByDialogue.Reset();
+	ForEachKey(
+		[this](const FGuid& DialogueId, const FGuid& SpeakerId)
+		{
+			SpeakersByDialogue.FindOrAdd(DialogueId).Add(SpeakerId);
+		}
+	);
+}
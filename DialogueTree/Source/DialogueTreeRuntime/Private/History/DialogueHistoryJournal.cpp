@@ -0,0 +1,76 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//Header
+#include "History/DialogueHistoryJournal.h"
+
+namespace
+{
+	/** Reads a little-endian frame length */
+	uint32 ReadFrameSize(const uint8* Bytes)
+	{
+		return static_cast<uint32>(Bytes[0])
+			| static_cast<uint32>(Bytes[1]) << 8
+			| static_cast<uint32>(Bytes[2]) << 16
+			| static_cast<uint32>(Bytes[3]) << 24;
+	}
+}
+
+void FDialogueHistoryJournal::AppendFrame(TArray<uint8>& Journal,
+	TConstArrayView<uint8> Frame, bool bIsFull)
+{
+	if (bIsFull)
+	{
+		Journal.Reset();
+	}
+
+	const uint32 FrameSize = static_cast<uint32>(Frame.Num());
+	Journal.Reserve(Journal.Num() + FrameHeaderSize + Frame.Num());
+	Journal.Add(static_cast<uint8>(FrameSize));
+	Journal.Add(static_cast<uint8>(FrameSize >> 8));
+	Journal.Add(static_cast<uint8>(FrameSize >> 16));
+	Journal.Add(static_cast<uint8>(FrameSize >> 24));
+	Journal.Append(Frame.GetData(), Frame.Num());
+}
+
+bool FDialogueHistoryJournal::ForEachFrame(TConstArrayView<uint8> Journal,
+	TFunctionRef<bool(TConstArrayView<uint8>)> Func)
+{
+	int32 Offset = 0;
+	while (Offset < Journal.Num())
+	{
+		if (Journal.Num() - Offset < FrameHeaderSize)
+		{
+			return false;
+		}
+
+		const uint32 FrameSize = ReadFrameSize(Journal.GetData() + Offset);
+		Offset += FrameHeaderSize;
+		if (static_cast<uint32>(Journal.Num() - Offset) < FrameSize)
+		{
+			return false;
+		}
+
+		if (!Func(Journal.Slice(Offset, FrameSize)))
+		{
+			return false;
+		}
+		Offset += FrameSize;
+	}
+
+	return true;
+}
+
+bool FDialogueHistoryJournal::ShouldCompact(TConstArrayView<uint8> Journal)
+{
+	if (Journal.Num() < FrameHeaderSize)
+	{
+		return false;
+	}
+
+	//The first frame is always the snapshot
+	const int64 SnapshotSize =
+		FrameHeaderSize + ReadFrameSize(Journal.GetData());
+	const int64 ChangesSize = Journal.Num() - SnapshotSize;
+
+	return ChangesSize > FMath::Max(SnapshotSize, MinCompactSize);
+}
@@ -0,0 +1,305 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//Header
+#include "History/DialogueHistorySnapshot.h"
+//Plugin
+#include "Dialogue.h"
+#include "History/DialogueHistoryColdStore.h"
+
+const FDialogueSpeakerHistory* FDialogueHistorySnapshot::FindSpeaker(
+	const FGuid& DialogueId, const FGuid& SpeakerId) const
+{
+	const FRecord* Record = FindRecord(DialogueId);
+	const FSpeakerRef* Speaker = 
+		Record ? Record->Speakers.Find(SpeakerId) : nullptr;
+	return Speaker ? &Speaker->Get() : nullptr;
+}
+
+int32 FDialogueHistorySnapshot::FindNodeIndex(const FGuid& DialogueId,
+	FName NodeID) const
+{
+	const FNodeIndexMapRef* Indices = NodeIndices.Find(DialogueId);
+	if (!Indices)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32* NodeIndex = (*Indices)->Find(NodeID);
+	return NodeIndex ? *NodeIndex : INDEX_NONE;
+}
+
+bool FDialogueHistorySnapshot::WasVisited(const FGuid& DialogueId,
+	TConstArrayView<FGuid> SpeakerIds, int32 NodeIndex) const
+{
+	const FRecord* Record = FindRecord(DialogueId);
+	if (NodeIndex == INDEX_NONE || (!Record && !ColdView.IsValid()))
+	{
+		return false;
+	}
+
+	for (const FGuid& SpeakerId : SpeakerIds)
+	{
+		if (WasSpeakerVisited(Record, DialogueId, SpeakerId, NodeIndex))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FDialogueHistorySnapshot::WasVisited(const FGuid& DialogueId,
+	TConstArrayView<FGuid> SpeakerIds, FName NodeID) const
+{
+	const int32 NodeIndex = FindNodeIndex(DialogueId, NodeID);
+	return NodeIndex != INDEX_NONE
+		&& WasVisited(DialogueId, SpeakerIds, NodeIndex);
+}
+
+bool FDialogueHistorySnapshot::HasVisitedAny(const FGuid& DialogueId,
+	const FGuid& SpeakerId) const
+{
+	return WasSpeakerVisited(
+		FindRecord(DialogueId), 
+		DialogueId, 
+		SpeakerId, 
+		INDEX_NONE
+	);
+}
+
+void FDialogueHistorySnapshot::WasVisited(
+	TConstArrayView<FDialogueVisitQuery> Queries,
+	TArrayView<bool> OutResults) const
+{
+	check(OutResults.Num() == Queries.Num());
+
+	//Batches tend to ask many questions of the same dialogue
+	const FGuid* LastDialogueId = nullptr;
+	const FRecord* Record = nullptr;
+	for (int32 QueryIndex = 0; QueryIndex < Queries.Num(); ++QueryIndex)
+	{
+		const FDialogueVisitQuery& Query = Queries[QueryIndex];
+		if (!LastDialogueId || *LastDialogueId != Query.DialogueId)
+		{
+			LastDialogueId = &Query.DialogueId;
+			Record = FindRecord(Query.DialogueId);
+		}
+
+		OutResults[QueryIndex] = WasSpeakerVisited(
+			Record, 
+			Query.DialogueId, 
+			Query.SpeakerId, 
+			Query.NodeIndex
+		);
+	}
+}
+
+void FDialogueHistorySnapshot::FindVisitedDialogues(const FGuid& SpeakerId,
+	TArray<FGuid>& OutDialogueIds) const
+{
+	OutDialogueIds.Reset();
+	for (const auto& RecordEntry : Records)
+	{
+		const FSpeakerRef* Speaker =
+			RecordEntry.Value->Speakers.Find(SpeakerId);
+		if (Speaker && !(*Speaker)->VisitedNodes.IsEmpty())
+		{
+			OutDialogueIds.Add(RecordEntry.Key);
+		}
+	}
+
+	if (!ColdView.IsValid())
+	{
+		return;
+	}
+
+	//Speakers held in memory were answered for above
+	TArray<FGuid> ColdDialogueIds;
+	ColdView->FindVisitedDialogues(SpeakerId, ColdDialogueIds);
+	for (const FGuid& DialogueId : ColdDialogueIds)
+	{
+		if (!FindSpeaker(DialogueId, SpeakerId))
+		{
+			OutDialogueIds.Add(DialogueId);
+		}
+	}
+}
+
+bool FDialogueHistorySnapshot::WasSpeakerVisited(const FRecord* Record, 
+	const FGuid& DialogueId, const FGuid& SpeakerId, int32 NodeIndex) const
+{
+	const FSpeakerRef* Speaker =
+		Record ? Record->Speakers.Find(SpeakerId) : nullptr;
+	if (Speaker)
+	{
+		return NodeIndex == INDEX_NONE 
+			? !(*Speaker)->VisitedNodes.IsEmpty()
+			: (*Speaker)->VisitedNodes.Contains(NodeIndex);
+	}
+
+	//Records held in memory are newer than the cold store's copies, so it
+	//is only read for the speakers they leave out
+	return ColdView.IsValid() 
+		&& ColdView->WasVisited(DialogueId, SpeakerId, NodeIndex);
+}
+
+const FDialogueHistorySnapshot::FRecord* 
+	FDialogueHistorySnapshot::FindRecord(const FGuid& DialogueId) const
+{
+	const FRecordRef* Record = Records.Find(DialogueId);
+	return Record ? &Record->Get() : nullptr;
+}
+
+FDialogueHistoryPublisher::FDialogueHistoryPublisher() :
+	Snapshot(MakeShared<const FDialogueHistorySnapshot, ESPMode::ThreadSafe>())
+{
+}
+
+FDialogueHistorySnapshotRef FDialogueHistoryPublisher::GetSnapshot() const
+{
+	FReadScopeLock ReadLock(SnapshotLock);
+	return Snapshot;
+}
+
+void FDialogueHistoryPublisher::RegisterDialogue(const UDialogue* Dialogue)
+{
+	check(IsInGameThread());
+	if (!Dialogue)
+	{
+		return;
+	}
+
+	const TArray<FName>& SlotIDs = Dialogue->GetNodeSlotIDs();
+	const TMap<FName, int32>& RetiredIDs = Dialogue->GetRetiredNodeIDs();
+
+	//Only the game thread swaps the snapshot, so it may read it unlocked.
+	//Dialogues are registered every play, but rarely change between them.
+	const FGuid& DialogueId = Dialogue->GetDialogueGuid();
+	const FDialogueHistorySnapshot::FNodeIndexMapRef* Known =
+		NewNodeIndices.Find(DialogueId);
+	if (!Known)
+	{
+		Known = Snapshot->NodeIndices.Find(DialogueId);
+	}
+	if (Known && (*Known)->Num() == SlotIDs.Num() + RetiredIDs.Num())
+	{
+		return;
+	}
+
+	TMap<FName, int32> Indices;
+	Indices.Reserve(SlotIDs.Num() + RetiredIDs.Num());
+	for (const auto& RetiredEntry : RetiredIDs)
+	{
+		Indices.Add(RetiredEntry.Key, RetiredEntry.Value);
+	}
+	for (int32 SlotIndex = 0; SlotIndex < SlotIDs.Num(); ++SlotIndex)
+	{
+		Indices.Add(SlotIDs[SlotIndex], SlotIndex);
+	}
+
+	NewNodeIndices.Add(
+		DialogueId,
+		MakeShared<const TMap<FName, int32>, ESPMode::ThreadSafe>(
+			MoveTemp(Indices)
+		)
+	);
+}
+
+void FDialogueHistoryPublisher::Publish(FDialogueHistoryStore& Store)
+{
+	check(IsInGameThread());
+
+	const bool bAllChanged = Store.TakeUnpublishedChanges(ChangedSpeakers);
+	TSharedPtr<const FDialogueHistoryColdView, ESPMode::ThreadSafe> ColdView =
+		Store.GetColdView();
+	if (!bAllChanged && ChangedSpeakers.IsEmpty() && NewNodeIndices.IsEmpty()
+		&& ColdView == Snapshot->ColdView)
+	{
+		return;
+	}
+
+	//Built off to the side; readers keep the old snapshot until the swap
+	TSharedRef<FDialogueHistorySnapshot, ESPMode::ThreadSafe> Next =
+		MakeShared<FDialogueHistorySnapshot, ESPMode::ThreadSafe>();
+	Next->Version = Snapshot->Version + 1;
+	Next->NodeIndices = Snapshot->NodeIndices;
+	Next->NodeIndices.Append(MoveTemp(NewNodeIndices));
+	NewNodeIndices.Reset();
+
+	//Taken with the records, so that a record spilled since the last
+	//publish is found in one or the other
+	Next->ColdView = MoveTemp(ColdView);
+
+	//Copies the store's record of a dialogue. Speakers not in Changed are
+	//shared with the old record, if it has them.
+	typedef FDialogueHistorySnapshot::FRecord FRecord;
+	auto CopyRecord = [](const FDialogueHistoryRecord& Record,
+		const FRecord* OldRecord, const TSet<FGuid>* Changed)
+	{
+		TSharedRef<FRecord, ESPMode::ThreadSafe> Copy =
+			MakeShared<FRecord, ESPMode::ThreadSafe>();
+		Copy->Speakers.Reserve(Record.Speakers.Num());
+		for (const auto& SpeakerEntry : Record.Speakers)
+		{
+			const FDialogueHistorySnapshot::FSpeakerRef* Shared =
+				OldRecord && Changed && !Changed->Contains(SpeakerEntry.Key)
+					? OldRecord->Speakers.Find(SpeakerEntry.Key)
+					: nullptr;
+			Copy->Speakers.Add(
+				SpeakerEntry.Key,
+				Shared 
+					? *Shared
+					: MakeShared<const FDialogueSpeakerHistory, 
+						ESPMode::ThreadSafe>(SpeakerEntry.Value)
+			);
+		}
+		return FDialogueHistorySnapshot::FRecordRef(Copy);
+	};
+
+	if (bAllChanged)
+	{
+		Next->Records.Reserve(Store.Records.Num());
+		for (const auto& RecordEntry : Store.Records)
+		{
+			Next->Records.Add(
+				RecordEntry.Key, 
+				CopyRecord(RecordEntry.Value, nullptr, nullptr)
+			);
+		}
+	}
+	else
+	{
+		//Unchanged dialogues are shared with the old snapshot
+		Next->Records = Snapshot->Records;
+		for (const auto& ChangedEntry : ChangedSpeakers)
+		{
+			const FGuid& DialogueId = ChangedEntry.Key;
+			if (const FDialogueHistoryRecord* Record =
+				Store.FindRecord(DialogueId))
+			{
+				Next->Records.Add(
+					DialogueId, 
+					CopyRecord(
+						*Record, 
+						Snapshot->FindRecord(DialogueId), 
+						&ChangedEntry.Value
+					)
+				);
+			}
+			else
+			{
+				Next->Records.Remove(DialogueId);
+			}
+		}
+	}
+	ChangedSpeakers.Reset();
+
+	FDialogueHistorySnapshotRef Published = Next;
+	{
+		FWriteScopeLock WriteLock(SnapshotLock);
+		Swap(Snapshot, Published);
+	}
+
+	//The old snapshot is released here, outside the lock, unless a reader
+	//still holds it
+}
@@ -0,0 +1,1265 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//Header
+#include "History/DialogueHistoryStore.h"
+//UE
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Algo/Sort.h"
+//Plugin
+#include "History/DialogueHistoryColdStore.h"
+#include "LogDialogueTree.h"
+
+bool FDialogueVisitBits::Add(int32 NodeIndex)
+{
+	if (NodeIndex < 0)
+	{
+		return false;
+	}
+
+	const int32 WordIndex = NodeIndex >> 5;
+	if (WordIndex >= Words.Num())
+	{
+		Words.SetNumZeroed(WordIndex + 1);
+	}
+
+	const uint32 Mask = 1u << (NodeIndex & 31);
+	const bool bWasSet = (Words[WordIndex] & Mask) != 0;
+	Words[WordIndex] |= Mask;
+	return !bWasSet;
+}
+
+bool FDialogueVisitBits::Remove(int32 NodeIndex)
+{
+	const int32 WordIndex = NodeIndex >> 5;
+	if (NodeIndex < 0 || WordIndex >= Words.Num())
+	{
+		return false;
+	}
+
+	const uint32 Mask = 1u << (NodeIndex & 31);
+	if ((Words[WordIndex] & Mask) == 0)
+	{
+		return false;
+	}
+
+	Words[WordIndex] &= ~Mask;
+	Trim();
+	return true;
+}
+
+void FDialogueVisitBits::Reset()
+{
+	Words.Reset();
+}
+
+bool FDialogueVisitBits::IsEmpty() const
+{
+	//Trailing zero words are trimmed on every clear
+	return Words.IsEmpty();
+}
+
+int32 FDialogueVisitBits::Num() const
+{
+	int32 Count = 0;
+	for (uint32 Word : Words)
+	{
+		Count += FMath::CountBits(Word);
+	}
+	return Count;
+}
+
+void FDialogueVisitBits::Trim()
+{
+	int32 NumWords = Words.Num();
+	while (NumWords > 0 && Words[NumWords - 1] == 0)
+	{
+		--NumWords;
+	}
+	Words.SetNum(NumWords, EAllowShrinking::No);
+}
+
+bool FDialogueHistoryStore::MarkVisited(const FGuid& DialogueId,
+	TConstArrayView<FGuid> SpeakerIds, int32 NodeIndex)
+{
+	if (!DialogueId.IsValid() || NodeIndex == INDEX_NONE
+		|| SpeakerIds.IsEmpty())
+	{
+		return false;
+	}
+
+	//One record lookup for the whole batch of speakers, and one serial 
+	//bump however many of them change
+	FDialogueHistoryRecord& Record = Records.FindOrAdd(DialogueId);
+	bool bChanged = false;
+	for (const FGuid& SpeakerId : SpeakerIds)
+	{
+		FDialogueSpeakerHistory& Speaker = 
+			FindOrPageIn(Record, DialogueId, SpeakerId);
+		if (Speaker.VisitedNodes.Add(NodeIndex))
+		{
+			MarkDirty(DialogueId, SpeakerId);
+			bChanged = true;
+		}
+	}
+
+	//Touched after the batch, as eviction may remove records
+	for (const FGuid& SpeakerId : SpeakerIds)
+	{
+		TouchEphemeral(SpeakerId, DialogueId);
+	}
+
+	if (bChanged)
+	{
+		++ChangeSerial;
+	}
+	return bChanged;
+}
+
+bool FDialogueHistoryStore::MarkUnvisited(const FGuid& DialogueId,
+	TConstArrayView<FGuid> SpeakerIds, int32 NodeIndex)
+{
+	if (!Records.Contains(DialogueId) && !ColdStore.IsValid())
+	{
+		return false;
+	}
+
+	bool bChanged = false;
+	for (const FGuid& SpeakerId : SpeakerIds)
+	{
+		FDialogueSpeakerHistory* Speaker = 
+			FindAndPageIn(DialogueId, SpeakerId);
+		if (Speaker && Speaker->VisitedNodes.Remove(NodeIndex))
+		{
+			MarkDirty(DialogueId, SpeakerId);
+			bChanged = true;
+		}
+	}
+
+	if (bChanged)
+	{
+		++ChangeSerial;
+	}
+	return bChanged;
+}
+
+bool FDialogueHistoryStore::WasVisited(const FGuid& DialogueId,
+	TConstArrayView<FGuid> SpeakerIds, int32 NodeIndex) const
+{
+	if (!Records.Contains(DialogueId) && !ColdStore.IsValid())
+	{
+		return false;
+	}
+
+	FDialogueSpeakerHistory Scratch;
+	for (const FGuid& SpeakerId : SpeakerIds)
+	{
+		const FDialogueSpeakerHistory* Speaker =
+			FindInAnyTier(DialogueId, SpeakerId, Scratch);
+		if (Speaker && Speaker->VisitedNodes.Contains(NodeIndex))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FDialogueHistoryStore::ClearVisits(const FGuid& DialogueId)
+{
+	//Spilled speakers are brought back to be cleared, and dropped from the
+	//cold store on their next spill
+	if (ColdStore.IsValid())
+	{
+		ColdStore->ForEachSpeaker(
+			DialogueId,
+			[this, &DialogueId](const FGuid& SpeakerId)
+			{
+				TMap<FGuid, FDialogueSpeakerHistory>& Speakers = 
+					Records.FindOrAdd(DialogueId).Speakers;
+				if (!Speakers.Contains(SpeakerId))
+				{
+					Speakers.Add(SpeakerId);
+					++NumResidentSpeakers;
+				}
+			}
+		);
+	}
+
+	FDialogueHistoryRecord* Record = Records.Find(DialogueId);
+	if (!Record)
+	{
+		return false;
+	}
+
+	for (auto& Entry : Record->Speakers)
+	{
+		Entry.Value.VisitedNodes.Reset();
+		Entry.Value.ResumeNodeIndex = INDEX_NONE;
+		MarkDirty(DialogueId, Entry.Key);
+	}
+	++ChangeSerial;
+	return true;
+}
+
+bool FDialogueHistoryStore::SetResumeNode(const FGuid& DialogueId,
+	TConstArrayView<FGuid> SpeakerIds, int32 NodeIndex)
+{
+	if (!DialogueId.IsValid() || SpeakerIds.IsEmpty())
+	{
+		return false;
+	}
+
+	FDialogueHistoryRecord& Record = Records.FindOrAdd(DialogueId);
+	bool bChanged = false;
+	for (const FGuid& SpeakerId : SpeakerIds)
+	{
+		int32& ResumeNodeIndex = 
+			FindOrPageIn(Record, DialogueId, SpeakerId).ResumeNodeIndex;
+		if (ResumeNodeIndex != NodeIndex)
+		{
+			ResumeNodeIndex = NodeIndex;
+			MarkDirty(DialogueId, SpeakerId);
+			bChanged = true;
+		}
+	}
+
+	for (const FGuid& SpeakerId : SpeakerIds)
+	{
+		TouchEphemeral(SpeakerId, DialogueId);
+	}
+
+	return bChanged;
+}
+
+int32 FDialogueHistoryStore::FindResumeNode(const FGuid& DialogueId,
+	TConstArrayView<FGuid> SpeakerIds) const
+{
+	if (!Records.Contains(DialogueId) && !ColdStore.IsValid())
+	{
+		return INDEX_NONE;
+	}
+
+	FDialogueSpeakerHistory Scratch;
+	for (const FGuid& SpeakerId : SpeakerIds)
+	{
+		const FDialogueSpeakerHistory* Speaker =
+			FindInAnyTier(DialogueId, SpeakerId, Scratch);
+		if (Speaker && Speaker->ResumeNodeIndex != INDEX_NONE)
+		{
+			return Speaker->ResumeNodeIndex;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+const FDialogueHistoryRecord* FDialogueHistoryStore::FindRecord(
+	const FGuid& DialogueId) const
+{
+	return Records.Find(DialogueId);
+}
+
+const FDialogueSpeakerHistory* FDialogueHistoryStore::FindSpeaker(
+	const FGuid& DialogueId, const FGuid& SpeakerId) const
+{
+	const FDialogueHistoryRecord* Record = Records.Find(DialogueId);
+	return Record ? Record->Speakers.Find(SpeakerId) : nullptr;
+}
+
+void FDialogueHistoryStore::AdoptLegacyRecord(FName DialogueName,
+	const FGuid& DialogueId)
+{
+	FDialogueHistoryRecord Legacy;
+	if (!DialogueId.IsValid() 
+		|| !LegacyRecords.RemoveAndCopyValue(DialogueName, Legacy))
+	{
+		return;
+	}
+
+	for (const auto& SpeakerEntry : Legacy.Speakers)
+	{
+		MarkDirty(DialogueId, SpeakerEntry.Key);
+	}
+
+	FDialogueHistoryRecord* Existing = Records.Find(DialogueId);
+	if (!Existing)
+	{
+		NumResidentSpeakers += Legacy.Speakers.Num();
+		Records.Add(DialogueId, MoveTemp(Legacy));
+		++ChangeSerial;
+		return;
+	}
+
+	//Visits recorded since the load are kept alongside the saved ones
+	for (auto& SpeakerEntry : Legacy.Speakers)
+	{
+		if (!Existing->Speakers.Contains(SpeakerEntry.Key))
+		{
+			++NumResidentSpeakers;
+		}
+
+		FDialogueSpeakerHistory& Speaker = 
+			Existing->Speakers.FindOrAdd(SpeakerEntry.Key);
+		SpeakerEntry.Value.VisitedNodes.ForEach(
+			[&Speaker](int32 NodeIndex)
+			{
+				Speaker.VisitedNodes.Add(NodeIndex);
+			}
+		);
+		if (Speaker.ResumeNodeIndex == INDEX_NONE)
+		{
+			Speaker.ResumeNodeIndex = SpeakerEntry.Value.ResumeNodeIndex;
+		}
+	}
+	++ChangeSerial;
+}
+
+void FDialogueHistoryStore::Empty()
+{
+	Records.Empty();
+	LegacyRecords.Empty();
+	NumResidentSpeakers = 0;
+	ResetEphemeral();
+	if (ColdStore.IsValid())
+	{
+		ColdStore->Reset();
+	}
+	++ChangeSerial;
+	MarkAllDirty();
+	MarkAllUnpublished();
+}
+
+void FDialogueHistoryStore::SetSpeakerPersistence(const FGuid& SpeakerId,
+	EDialogueSpeakerPersistence Persistence)
+{
+	if (!SpeakerId.IsValid() || GetSpeakerPersistence(SpeakerId) == Persistence)
+	{
+		return;
+	}
+
+	TArray<FGuid, TInlineAllocator<4>> Dialogues;
+	for (const auto& RecordEntry : Records)
+	{
+		if (RecordEntry.Value.Speakers.Contains(SpeakerId))
+		{
+			Dialogues.Add(RecordEntry.Key);
+		}
+	}
+
+	//Speakers leaving or joining the saved ones are written either way, 
+	//so that a delta save overrides what was saved before
+	auto MarkSpeakerDirty = [this, &SpeakerId, &Dialogues]()
+	{
+		for (const FGuid& DialogueId : Dialogues)
+		{
+			MarkDirty(DialogueId, SpeakerId);
+		}
+	};
+
+	if (IsPersistent(SpeakerId))
+	{
+		MarkSpeakerDirty();
+	}
+
+	if (Persistence == EDialogueSpeakerPersistence::Persistent)
+	{
+		SpeakerPersistence.Remove(SpeakerId);
+		MarkSpeakerDirty();
+	}
+	else
+	{
+		SpeakerPersistence.Add(SpeakerId, Persistence);
+	}
+
+	if (Persistence != EDialogueSpeakerPersistence::Ephemeral)
+	{
+		EphemeralSpeakers.Remove(SpeakerId);
+	}
+	else if (!Dialogues.IsEmpty())
+	{
+		//Records the speaker already has count towards the limit
+		FDialogueEphemeralSpeaker& Ephemeral = 
+			EphemeralSpeakers.FindOrAdd(SpeakerId);
+		Ephemeral.LastUse = ++EphemeralClock;
+		Ephemeral.Dialogues = MoveTemp(Dialogues);
+
+		if (MaxEphemeralSpeakers > 0 
+			&& EphemeralSpeakers.Num() > MaxEphemeralSpeakers)
+		{
+			EvictEphemeral();
+		}
+	}
+}
+
+EDialogueSpeakerPersistence FDialogueHistoryStore::GetSpeakerPersistence(
+	const FGuid& SpeakerId) const
+{
+	const EDialogueSpeakerPersistence* Found = 
+		SpeakerPersistence.Find(SpeakerId);
+	return Found ? *Found : EDialogueSpeakerPersistence::Persistent;
+}
+
+bool FDialogueHistoryStore::IsPersistent(const FGuid& SpeakerId) const
+{
+	return !SpeakerPersistence.Contains(SpeakerId);
+}
+
+void FDialogueHistoryStore::SetMaxEphemeralSpeakers(int32 InMax)
+{
+	MaxEphemeralSpeakers = FMath::Max(InMax, 0);
+	if (MaxEphemeralSpeakers > 0 
+		&& EphemeralSpeakers.Num() > MaxEphemeralSpeakers)
+	{
+		EvictEphemeral();
+	}
+}
+
+int32 FDialogueHistoryStore::Prune()
+{
+	//Pruned speakers are written empty to the cold store as well, so that
+	//the visits they were cleared of are not read back from it
+	const FDialogueSpeakerHistory EmptySpeaker;
+	TArray<FDialogueColdRecord> ColdPruned;
+
+	int32 NumPruned = 0;
+	for (auto RecordIt = Records.CreateIterator(); RecordIt; ++RecordIt)
+	{
+		TMap<FGuid, FDialogueSpeakerHistory>& Speakers = 
+			RecordIt.Value().Speakers;
+		for (auto SpeakerIt = Speakers.CreateIterator(); SpeakerIt; 
+			++SpeakerIt)
+		{
+			const FDialogueSpeakerHistory& Speaker = SpeakerIt.Value();
+			if (Speaker.VisitedNodes.IsEmpty() 
+				&& Speaker.ResumeNodeIndex == INDEX_NONE)
+			{
+				//Saved as empty so that earlier saves are overridden
+				MarkDirty(RecordIt.Key(), SpeakerIt.Key());
+				if (ColdStore.IsValid())
+				{
+					ColdPruned.Add({ 
+						SpeakerIt.Key(), 
+						RecordIt.Key(), 
+						&EmptySpeaker 
+					});
+				}
+				SpeakerIt.RemoveCurrent();
+				++NumPruned;
+			}
+		}
+
+		if (Speakers.IsEmpty())
+		{
+			RecordIt.RemoveCurrent();
+			continue;
+		}
+
+		Speakers.Compact();
+		Speakers.Shrink();
+		for (auto& SpeakerEntry : Speakers)
+		{
+			SpeakerEntry.Value.VisitedNodes.Words.Shrink();
+		}
+	}
+
+	//Ephemeral speakers forget records that no longer exist
+	for (auto It = EphemeralSpeakers.CreateIterator(); It; ++It)
+	{
+		It.Value().Dialogues.RemoveAll(
+			[this, &It](const FGuid& DialogueId)
+			{
+				const FDialogueHistoryRecord* Record = Records.Find(DialogueId);
+				return !Record || !Record->Speakers.Contains(It.Key());
+			}
+		);
+		if (It.Value().Dialogues.IsEmpty())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	if (!ColdPruned.IsEmpty())
+	{
+		ColdStore->Write(ColdPruned);
+	}
+
+	Records.Compact();
+	Records.Shrink();
+	EphemeralSpeakers.Compact();
+	EphemeralSpeakers.Shrink();
+
+	NumResidentSpeakers -= NumPruned;
+	if (NumPruned > 0)
+	{
+		++ChangeSerial;
+	}
+	return NumPruned;
+}
+
+FDialogueHistoryMemoryStats FDialogueHistoryStore::GetMemoryStats() const
+{
+	FDialogueHistoryMemoryStats Stats;
+	Stats.NumDialogueRecords = Records.Num();
+	Stats.NumColdSpeakerRecords = ColdStore.IsValid() ? ColdStore->Num() : 0;
+	Stats.OverheadBytes = sizeof(*this) 
+		+ Records.GetAllocatedSize()
+		+ LegacyRecords.GetAllocatedSize()
+		+ DirtySpeakers.GetAllocatedSize()
+		+ SpeakerPersistence.GetAllocatedSize()
+		+ EphemeralSpeakers.GetAllocatedSize();
+
+	for (const auto& RecordEntry : Records)
+	{
+		const TMap<FGuid, FDialogueSpeakerHistory>& Speakers = 
+			RecordEntry.Value.Speakers;
+		Stats.OverheadBytes += Speakers.GetAllocatedSize();
+		for (const auto& SpeakerEntry : Speakers)
+		{
+			const int32 Class = 
+				static_cast<int32>(GetSpeakerPersistence(SpeakerEntry.Key));
+			++Stats.NumSpeakerRecords[Class];
+			Stats.SpeakerBytes[Class] += sizeof(FGuid) 
+				+ sizeof(FDialogueSpeakerHistory)
+				+ SpeakerEntry.Value.VisitedNodes.Words.GetAllocatedSize();
+		}
+	}
+
+	for (const auto& RecordEntry : LegacyRecords)
+	{
+		Stats.OverheadBytes += RecordEntry.Value.Speakers.GetAllocatedSize();
+	}
+
+	for (const auto& DirtyEntry : DirtySpeakers)
+	{
+		Stats.OverheadBytes += DirtyEntry.Value.GetAllocatedSize();
+	}
+
+	for (const auto& EphemeralEntry : EphemeralSpeakers)
+	{
+		Stats.OverheadBytes += 
+			EphemeralEntry.Value.Dialogues.GetAllocatedSize();
+	}
+
+	return Stats;
+}
+
+void FDialogueHistoryStore::SetColdStore(
+	TSharedPtr<FDialogueHistoryColdStore> InColdStore)
+{
+	ColdStore = MoveTemp(InColdStore);
+}
+
+TSharedPtr<const FDialogueHistoryColdView, ESPMode::ThreadSafe> 
+	FDialogueHistoryStore::GetColdView() const
+{
+	return ColdStore.IsValid() ? ColdStore->GetView() : nullptr;
+}
+
+int32 FDialogueHistoryStore::GetNumResidentSpeakers() const
+{
+	return NumResidentSpeakers;
+}
+
+int32 FDialogueHistoryStore::SpillToColdStore(int32 MaxResidentSpeakers)
+{
+	if (!ColdStore.IsValid() || !ColdStore->IsOpen())
+	{
+		return 0;
+	}
+
+	if (NumResidentSpeakers <= MaxResidentSpeakers)
+	{
+		return 0;
+	}
+
+	struct FSpillCandidate
+	{
+		uint64 LastUse;
+		FGuid DialogueId;
+		FGuid SpeakerId;
+		const FDialogueSpeakerHistory* Speaker;
+	};
+
+	//Records that are never saved are never spilled either
+	TArray<FSpillCandidate> Candidates;
+	Candidates.Reserve(NumResidentSpeakers);
+	for (const auto& RecordEntry : Records)
+	{
+		for (const auto& SpeakerEntry : RecordEntry.Value.Speakers)
+		{
+			if (IsPersistent(SpeakerEntry.Key))
+			{
+				Candidates.Add({
+					SpeakerEntry.Value.LastUse,
+					RecordEntry.Key,
+					SpeakerEntry.Key,
+					&SpeakerEntry.Value
+				});
+			}
+		}
+	}
+	Algo::SortBy(
+		Candidates, 
+		[](const FSpillCandidate& Candidate) { return Candidate.LastUse; }
+	);
+
+	const int32 Target = MaxResidentSpeakers - MaxResidentSpeakers / 4;
+	const int32 NumToSpill = 
+		FMath::Min(NumResidentSpeakers - Target, Candidates.Num());
+
+	TArray<FDialogueColdRecord> ToWrite;
+	ToWrite.Reserve(NumToSpill);
+	for (int32 Index = 0; Index < NumToSpill; ++Index)
+	{
+		const FSpillCandidate& Candidate = Candidates[Index];
+		ToWrite.Add({ 
+			Candidate.SpeakerId, 
+			Candidate.DialogueId, 
+			Candidate.Speaker 
+		});
+	}
+
+	//Kept in memory if they could not be written
+	if (!ColdStore->Write(ToWrite))
+	{
+		return 0;
+	}
+
+	//Dirty speakers stay dirty; saves read them back from the cold store
+	for (int32 Index = 0; Index < NumToSpill; ++Index)
+	{
+		const FSpillCandidate& Candidate = Candidates[Index];
+		FDialogueHistoryRecord* Record = Records.Find(Candidate.DialogueId);
+		if (!Record)
+		{
+			continue;
+		}
+
+		NumResidentSpeakers -= Record->Speakers.Remove(Candidate.SpeakerId);
+		if (!bAllUnpublished)
+		{
+			UnpublishedSpeakers.FindOrAdd(Candidate.DialogueId)
+				.Add(Candidate.SpeakerId);
+		}
+
+		if (Record->Speakers.IsEmpty())
+		{
+			Records.Remove(Candidate.DialogueId);
+		}
+	}
+
+	return NumToSpill;
+}
+
+void FDialogueHistoryStore::ForEachColdSpeaker(
+	TFunctionRef<void(const FGuid&, const FGuid&,
+		const FDialogueSpeakerHistory&)> Func) const
+{
+	if (!ColdStore.IsValid())
+	{
+		return;
+	}
+
+	FDialogueSpeakerHistory Speaker;
+	ColdStore->ForEachKey(
+		[this, &Func, &Speaker](const FGuid& DialogueId, 
+			const FGuid& SpeakerId)
+		{
+			//Records paged back in are newer than the cold store's copy
+			if (!FindSpeaker(DialogueId, SpeakerId) && IsPersistent(SpeakerId)
+				&& ColdStore->Find(DialogueId, SpeakerId, Speaker))
+			{
+				Func(DialogueId, SpeakerId, Speaker);
+			}
+		}
+	);
+}
+
+uint32 FDialogueHistoryStore::GetChangeSerial() const
+{
+	return ChangeSerial;
+}
+
+bool FDialogueHistoryStore::TakeUnpublishedChanges(
+	TMap<FGuid, TSet<FGuid>>& OutSpeakers)
+{
+	const bool bAll = bAllUnpublished;
+	OutSpeakers = MoveTemp(UnpublishedSpeakers);
+	UnpublishedSpeakers.Reset();
+	bAllUnpublished = false;
+	return bAll;
+}
+
+bool FDialogueHistoryStore::Serialize(FArchive& Ar)
+{
+	if (Ar.IsLoading())
+	{
+		++ChangeSerial;
+		MarkAllUnpublished();
+	}
+
+	int32 Version = CurrentVersion;
+	Ar << Version;
+
+	if (Version > CurrentVersion || Version < 1)
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Error,
+			TEXT("Dialogue history was saved with a version (%d) this build cannot read (%d). Discarding it."),
+			Version,
+			CurrentVersion
+		);
+		Ar.SetError();
+		Records.Empty();
+		LegacyRecords.Empty();
+		NumResidentSpeakers = 0;
+		ResetEphemeral();
+		return true;
+	}
+
+	if (Ar.IsLoading())
+	{
+		Records.Empty();
+		LegacyRecords.Empty();
+		ResetEphemeral();
+
+		//Records spilled after the save was made belong to another 
+		//timeline; those spilled before it are in it
+		if (ColdStore.IsValid())
+		{
+			ColdStore->Reset();
+		}
+
+		//Version 1 named its dialogues. Those records wait for their 
+		//dialogue to be adopted by GUID.
+		if (Version == 1)
+		{
+			int32 NumRecords = 0;
+			Ar << NumRecords;
+			for (int32 RecordIndex = 0;
+				RecordIndex < NumRecords && !Ar.IsError(); ++RecordIndex)
+			{
+				FName DialogueName;
+				Ar << DialogueName;
+				SerializeRecord(
+					Ar, 
+					LegacyRecords.FindOrAdd(DialogueName),
+					Version
+				);
+			}
+		}
+		else
+		{
+			uint32 NumRecords = 0;
+			Ar.SerializeIntPacked(NumRecords);
+			for (uint32 RecordIndex = 0;
+				RecordIndex < NumRecords && !Ar.IsError(); ++RecordIndex)
+			{
+				FGuid DialogueId;
+				Ar << DialogueId;
+				SerializeRecord(Ar, Records.FindOrAdd(DialogueId), Version);
+			}
+
+			uint32 NumLegacyRecords = 0;
+			Ar.SerializeIntPacked(NumLegacyRecords);
+			for (uint32 RecordIndex = 0;
+				RecordIndex < NumLegacyRecords && !Ar.IsError(); 
+				++RecordIndex)
+			{
+				FName DialogueName;
+				Ar << DialogueName;
+				SerializeRecord(
+					Ar, 
+					LegacyRecords.FindOrAdd(DialogueName),
+					Version
+				);
+			}
+		}
+
+		if (Ar.IsError())
+		{
+			Records.Empty();
+			LegacyRecords.Empty();
+		}
+		CountResidentSpeakers();
+
+		//What was just read is what is saved
+		MarkSaved();
+	}
+	else
+	{
+		//Spilled records are saved along with those in memory
+		TMap<FGuid, TArray<FGuid>> ColdSpeakers;
+		GatherColdSpeakers(ColdSpeakers);
+
+		uint32 NumRecords = Records.Num();
+		for (const auto& ColdEntry : ColdSpeakers)
+		{
+			NumRecords += Records.Contains(ColdEntry.Key) ? 0 : 1;
+		}
+
+		Ar.SerializeIntPacked(NumRecords);
+		for (auto& RecordEntry : Records)
+		{
+			Ar << RecordEntry.Key;
+
+			const TArray<FGuid>* Cold = ColdSpeakers.Find(RecordEntry.Key);
+			SerializeRecord(
+				Ar, 
+				RecordEntry.Value, 
+				Version, 
+				RecordEntry.Key,
+				Cold ? TConstArrayView<FGuid>(*Cold) : TConstArrayView<FGuid>()
+			);
+		}
+
+		FDialogueHistoryRecord NoneResident;
+		for (const auto& ColdEntry : ColdSpeakers)
+		{
+			if (!Records.Contains(ColdEntry.Key))
+			{
+				FGuid DialogueId = ColdEntry.Key;
+				Ar << DialogueId;
+				SerializeRecord(
+					Ar, 
+					NoneResident, 
+					Version, 
+					DialogueId, 
+					ColdEntry.Value
+				);
+			}
+		}
+
+		//Records never adopted are carried over to the next save
+		uint32 NumLegacyRecords = LegacyRecords.Num();
+		Ar.SerializeIntPacked(NumLegacyRecords);
+		for (auto& RecordEntry : LegacyRecords)
+		{
+			Ar << RecordEntry.Key;
+			SerializeRecord(Ar, RecordEntry.Value, Version);
+		}
+	}
+
+	return true;
+}
+
+void FDialogueHistoryStore::SaveToBytes(TArray<uint8>& OutBytes) const
+{
+	OutBytes.Reset();
+	FMemoryWriter Writer(OutBytes);
+	const_cast<FDialogueHistoryStore*>(this)->Serialize(Writer);
+}
+
+bool FDialogueHistoryStore::LoadFromBytes(const TArray<uint8>& InBytes)
+{
+	Records.Empty();
+	LegacyRecords.Empty();
+	NumResidentSpeakers = 0;
+	ResetEphemeral();
+	++ChangeSerial;
+	MarkSaved();
+	MarkAllUnpublished();
+	if (InBytes.IsEmpty())
+	{
+		//An empty save holds no records, spilled or not
+		if (ColdStore.IsValid())
+		{
+			ColdStore->Reset();
+		}
+		return true;
+	}
+
+	FMemoryReader Reader(InBytes);
+	Serialize(Reader);
+
+	return !Reader.IsError();
+}
+
+void FDialogueHistoryStore::SerializeRecord(FArchive& Ar,
+	FDialogueHistoryRecord& Record, int32 Version, 
+	const FGuid& ColdDialogueId, TConstArrayView<FGuid> ColdSpeakerIds) const
+{
+	if (Version == 1)
+	{
+		check(Ar.IsLoading());
+
+		int32 NumSpeakers = 0;
+		Ar << NumSpeakers;
+		for (int32 SpeakerIndex = 0;
+			SpeakerIndex < NumSpeakers && !Ar.IsError(); ++SpeakerIndex)
+		{
+			FGuid SpeakerId;
+			Ar << SpeakerId;
+
+			FDialogueSpeakerHistory& Speaker = Record.Speakers.Add(SpeakerId);
+			Ar << Speaker.ResumeNodeIndex;
+			Speaker.VisitedNodes.Words.BulkSerialize(Ar);
+		}
+		return;
+	}
+
+	//Speakers that are not persistent are never written
+	uint32 NumSpeakers = 0;
+	if (Ar.IsSaving())
+	{
+		for (const auto& SpeakerEntry : Record.Speakers)
+		{
+			NumSpeakers += IsPersistent(SpeakerEntry.Key) ? 1 : 0;
+		}
+		NumSpeakers += ColdSpeakerIds.Num();
+	}
+	Ar.SerializeIntPacked(NumSpeakers);
+
+	auto SerializeSpeaker = [&Ar](FDialogueSpeakerHistory& Speaker)
+	{
+		//Offset by one so that INDEX_NONE packs into a single byte
+		uint32 PackedResume = static_cast<uint32>(Speaker.ResumeNodeIndex + 1);
+		Ar.SerializeIntPacked(PackedResume);
+		Speaker.ResumeNodeIndex = static_cast<int32>(PackedResume) - 1;
+
+		Speaker.VisitedNodes.Words.BulkSerialize(Ar);
+	};
+
+	if (Ar.IsLoading())
+	{
+		for (uint32 SpeakerIndex = 0;
+			SpeakerIndex < NumSpeakers && !Ar.IsError(); ++SpeakerIndex)
+		{
+			FGuid SpeakerId;
+			Ar << SpeakerId;
+			SerializeSpeaker(Record.Speakers.FindOrAdd(SpeakerId));
+		}
+	}
+	else
+	{
+		for (auto& SpeakerEntry : Record.Speakers)
+		{
+			if (IsPersistent(SpeakerEntry.Key))
+			{
+				Ar << SpeakerEntry.Key;
+				SerializeSpeaker(SpeakerEntry.Value);
+			}
+		}
+
+		//Read one at a time, so that the cold store is never held in 
+		//memory whole
+		FDialogueSpeakerHistory Cold;
+		for (FGuid SpeakerId : ColdSpeakerIds)
+		{
+			Cold = FDialogueSpeakerHistory();
+			ColdStore->Find(ColdDialogueId, SpeakerId, Cold);
+			Ar << SpeakerId;
+			SerializeSpeaker(Cold);
+		}
+	}
+}
+
+void FDialogueHistoryStore::GatherColdSpeakers(
+	TMap<FGuid, TArray<FGuid>>& OutSpeakers) const
+{
+	OutSpeakers.Reset();
+	if (!ColdStore.IsValid())
+	{
+		return;
+	}
+
+	ColdStore->ForEachKey(
+		[this, &OutSpeakers](const FGuid& DialogueId, const FGuid& SpeakerId)
+		{
+			//Records paged back in are saved as they are in memory
+			if (!FindSpeaker(DialogueId, SpeakerId) && IsPersistent(SpeakerId))
+			{
+				OutSpeakers.FindOrAdd(DialogueId).Add(SpeakerId);
+			}
+		}
+	);
+}
+
+bool FDialogueHistoryStore::HasUnsavedChanges() const
+{
+	return bAllDirty || !DirtySpeakers.IsEmpty();
+}
+
+bool FDialogueHistoryStore::SaveChanges(FArchive& Ar)
+{
+	check(Ar.IsSaving());
+
+	uint8 bFull = bAllDirty ? 1 : 0;
+	Ar << bFull;
+
+	if (bFull)
+	{
+		Serialize(Ar);
+	}
+	else
+	{
+		//Changed speakers are written in the store's own form, leaving out
+		//every speaker of the same dialogue that did not change
+		FDialogueHistoryStore Changes;
+		Changes.Records.Reserve(DirtySpeakers.Num());
+		for (const auto& DirtyEntry : DirtySpeakers)
+		{
+			FDialogueHistoryRecord& Changed = 
+				Changes.Records.Add(DirtyEntry.Key);
+			Changed.Speakers.Reserve(DirtyEntry.Value.Num());
+			for (const FGuid& SpeakerId : DirtyEntry.Value)
+			{
+				FDialogueSpeakerHistory Scratch;
+				const FDialogueSpeakerHistory* Speaker = 
+					FindInAnyTier(DirtyEntry.Key, SpeakerId, Scratch);
+
+				//Pruned speakers, and speakers no longer persistent, are 
+				//written empty so that earlier saves are overridden
+				Changed.Speakers.Add(
+					SpeakerId, 
+					Speaker && IsPersistent(SpeakerId) 
+						? *Speaker 
+						: FDialogueSpeakerHistory()
+				);
+			}
+		}
+		Changes.Serialize(Ar);
+	}
+
+	MarkSaved();
+	return bFull != 0;
+}
+
+bool FDialogueHistoryStore::ApplyChanges(FArchive& Ar, bool& bOutWasFull)
+{
+	check(Ar.IsLoading());
+
+	uint8 bFull = 0;
+	Ar << bFull;
+	bOutWasFull = bFull != 0;
+
+	FDialogueHistoryStore Changes;
+	Changes.Serialize(Ar);
+	if (Ar.IsError())
+	{
+		return false;
+	}
+
+	if (bOutWasFull)
+	{
+		Records = MoveTemp(Changes.Records);
+		LegacyRecords = MoveTemp(Changes.LegacyRecords);
+		CountResidentSpeakers();
+		if (ColdStore.IsValid())
+		{
+			ColdStore->Reset();
+		}
+		ResetEphemeral();
+		MarkAllUnpublished();
+	}
+	else
+	{
+		for (auto& RecordEntry : Changes.Records)
+		{
+			FDialogueHistoryRecord& Record = Records.FindOrAdd(RecordEntry.Key);
+			TSet<FGuid>& Unpublished = 
+				UnpublishedSpeakers.FindOrAdd(RecordEntry.Key);
+			for (auto& SpeakerEntry : RecordEntry.Value.Speakers)
+			{
+				Unpublished.Add(SpeakerEntry.Key);
+				if (!Record.Speakers.Contains(SpeakerEntry.Key))
+				{
+					++NumResidentSpeakers;
+				}
+				Record.Speakers.Add(
+					SpeakerEntry.Key, 
+					MoveTemp(SpeakerEntry.Value)
+				);
+			}
+		}
+	}
+
+	++ChangeSerial;
+	MarkSaved();
+	return true;
+}
+
+void FDialogueHistoryStore::MarkSaved()
+{
+	DirtySpeakers.Reset();
+	bAllDirty = false;
+}
+
+void FDialogueHistoryStore::MarkAllDirty()
+{
+	DirtySpeakers.Empty();
+	bAllDirty = true;
+}
+
+void FDialogueHistoryStore::MarkDirty(const FGuid& DialogueId,
+	const FGuid& SpeakerId)
+{
+	//Readers see every record, saved or not
+	if (!bAllUnpublished)
+	{
+		UnpublishedSpeakers.FindOrAdd(DialogueId).Add(SpeakerId);
+	}
+
+	//Records that are never saved are never dirty
+	if (!bAllDirty && IsPersistent(SpeakerId))
+	{
+		DirtySpeakers.FindOrAdd(DialogueId).Add(SpeakerId);
+	}
+}
+
+FDialogueSpeakerHistory& FDialogueHistoryStore::FindOrPageIn(
+	FDialogueHistoryRecord& Record, const FGuid& DialogueId,
+	const FGuid& SpeakerId)
+{
+	FDialogueSpeakerHistory* Speaker = Record.Speakers.Find(SpeakerId);
+	if (!Speaker)
+	{
+		Speaker = &Record.Speakers.Add(SpeakerId);
+		++NumResidentSpeakers;
+		if (ColdStore.IsValid())
+		{
+			ColdStore->Find(DialogueId, SpeakerId, *Speaker);
+		}
+	}
+
+	Speaker->LastUse = ++ResidentClock;
+	return *Speaker;
+}
+
+FDialogueSpeakerHistory* FDialogueHistoryStore::FindAndPageIn(
+	const FGuid& DialogueId, const FGuid& SpeakerId)
+{
+	FDialogueHistoryRecord* Record = Records.Find(DialogueId);
+	FDialogueSpeakerHistory* Speaker = 
+		Record ? Record->Speakers.Find(SpeakerId) : nullptr;
+
+	FDialogueSpeakerHistory Paged;
+	if (!Speaker && ColdStore.IsValid() 
+		&& ColdStore->Find(DialogueId, SpeakerId, Paged))
+	{
+		Speaker = &Records.FindOrAdd(DialogueId).Speakers.Add(
+			SpeakerId, 
+			MoveTemp(Paged)
+		);
+		++NumResidentSpeakers;
+	}
+
+	if (Speaker)
+	{
+		Speaker->LastUse = ++ResidentClock;
+	}
+	return Speaker;
+}
+
+const FDialogueSpeakerHistory* FDialogueHistoryStore::FindInAnyTier(
+	const FGuid& DialogueId, const FGuid& SpeakerId,
+	FDialogueSpeakerHistory& Scratch) const
+{
+	if (const FDialogueSpeakerHistory* Speaker = 
+		FindSpeaker(DialogueId, SpeakerId))
+	{
+		return Speaker;
+	}
+
+	if (ColdStore.IsValid() && ColdStore->Find(DialogueId, SpeakerId, Scratch))
+	{
+		return &Scratch;
+	}
+
+	return nullptr;
+}
+
+void FDialogueHistoryStore::MarkAllUnpublished()
+{
+	UnpublishedSpeakers.Empty();
+	bAllUnpublished = true;
+}
+
+void FDialogueHistoryStore::CountResidentSpeakers()
+{
+	NumResidentSpeakers = 0;
+	for (const auto& RecordEntry : Records)
+	{
+		NumResidentSpeakers += RecordEntry.Value.Speakers.Num();
+	}
+}
+
+void FDialogueHistoryStore::TouchEphemeral(const FGuid& SpeakerId,
+	const FGuid& DialogueId)
+{
+	if (GetSpeakerPersistence(SpeakerId) 
+		!= EDialogueSpeakerPersistence::Ephemeral)
+	{
+		return;
+	}
+
+	FDialogueEphemeralSpeaker& Ephemeral = 
+		EphemeralSpeakers.FindOrAdd(SpeakerId);
+	Ephemeral.LastUse = ++EphemeralClock;
+	Ephemeral.Dialogues.AddUnique(DialogueId);
+
+	if (MaxEphemeralSpeakers > 0 
+		&& EphemeralSpeakers.Num() > MaxEphemeralSpeakers)
+	{
+		EvictEphemeral();
+	}
+}
+
+void FDialogueHistoryStore::EvictEphemeral()
+{
+	const int32 Target = MaxEphemeralSpeakers - MaxEphemeralSpeakers / 10;
+	const int32 NumToEvict = EphemeralSpeakers.Num() - Target;
+	if (NumToEvict <= 0)
+	{
+		return;
+	}
+
+	//Evicting in batches keeps the sort off the path of every record
+	TArray<TPair<uint64, FGuid>> ByLastUse;
+	ByLastUse.Reserve(EphemeralSpeakers.Num());
+	for (const auto& Entry : EphemeralSpeakers)
+	{
+		ByLastUse.Emplace(Entry.Value.LastUse, Entry.Key);
+	}
+	Algo::SortBy(
+		ByLastUse, 
+		[](const TPair<uint64, FGuid>& Entry) { return Entry.Key; }
+	);
+
+	for (int32 Index = 0; Index < NumToEvict; ++Index)
+	{
+		const FGuid& SpeakerId = ByLastUse[Index].Value;
+
+		FDialogueEphemeralSpeaker Ephemeral;
+		EphemeralSpeakers.RemoveAndCopyValue(SpeakerId, Ephemeral);
+		for (const FGuid& DialogueId : Ephemeral.Dialogues)
+		{
+			FDialogueHistoryRecord* Record = Records.Find(DialogueId);
+			if (!Record)
+			{
+				continue;
+			}
+
+			NumResidentSpeakers -= Record->Speakers.Remove(SpeakerId);
+			if (!bAllUnpublished)
+			{
+				UnpublishedSpeakers.FindOrAdd(DialogueId).Add(SpeakerId);
+			}
+
+			if (Record->Speakers.IsEmpty())
+			{
+				Records.Remove(DialogueId);
+			}
+		}
+	}
+
+	++ChangeSerial;
+}
+
+void FDialogueHistoryStore::ResetEphemeral()
+{
+	EphemeralSpeakers.Empty();
+	EphemeralClock = 0;
+}
@@ -4,32 +4,49 @@
 #include "Nodes/DialogueBranchNode.h"
 //Plugin
 #include "Conditionals/DialogueCondition.h"
+#include "Conditionals/DialogueQueryProfile.h"
 #include "Dialogue.h"
+#include "DialogueSession.h"
 
-FDialogueOption UDialogueBranchNode::GetAsOption()
+FDialogueOption UDialogueBranchNode::GetAsOption(
+    UDialogueSession* Session)
 {
-    if (PassesConditions() && TrueNode)
+    UDialogueNode* OptionNode = PassesConditions(Session) && TrueNode
+        ? TrueNode.Get()
+        : FalseNode.Get();
+    if (OptionNode)
     {
-        FSpeechDetails OptionDetails = TrueNode->GetAsOption().Details;
-        return FDialogueOption{ OptionDetails, this };
-    }
-    else if (FalseNode)
-    {
-        FSpeechDetails OptionDetails = FalseNode->GetAsOption().Details;
-        return FDialogueOption{ OptionDetails, this };
+        FDialogueOption Option = OptionNode->GetAsOption(Session);
+        Option.TargetNode = this;
+        return Option;
     }
 
     return FDialogueOption();
 }
 
-void UDialogueBranchNode::EnterNode()
+FDialogueNodeResult UDialogueBranchNode::EnterNode(
+    UDialogueSession* Session)
 {
     //Call super
-    Super::EnterNode();
+    Super::EnterNode(Session);
+
+    //Wait for any async queries the conditions read
+    const bool bWaiting = IssueAsyncQueries(
+        Session,
+        FSimpleDelegate::CreateUObject(
+            this,
+            &UDialogueBranchNode::OnQueriesResolved,
+            TWeakObjectPtr<UDialogueSession>(Session)
+        )
+    );
+    if (bWaiting)
+    {
+        return FDialogueNodeResult::Wait();
+    }
 
     //Determine the correct next node based on conditions
     UDialogueNode* NextNode;
-    if (PassesConditions())
+    if (PassesConditions(Session))
     {
         NextNode = TrueNode;
     }
@@ -38,14 +55,20 @@ void UDialogueBranchNode::EnterNode()
         NextNode = FalseNode;
     }
 
-    //If next node is nullptr, exit the dialogue
-    if (!NextNode)
-    {
-        GetDialogue()->EndDialogue();
-    }
+    //Transition to the next node, exiting the dialogue if there is none
+    return FDialogueNodeResult::TraverseTo(NextNode);
+}
+
+EDialogueNodeKind UDialogueBranchNode::GetNodeKind() const
+{
+    return EDialogueNodeKind::Branch;
+}
 
-    //Next node found, transition to it 
-    GetDialogue()->TraverseNode(NextNode);
+void UDialogueBranchNode::GetPayloadNodes(
+    TArray<UDialogueNode*>& OutNodes) const
+{
+    OutNodes.Add(TrueNode);
+    OutNodes.Add(FalseNode);
 }
 
 void UDialogueBranchNode::InitBranchData(bool InIfAny, 
@@ -59,8 +82,17 @@ void UDialogueBranchNode::InitBranchData(bool InIfAny,
     Conditions.Empty();
     for (UDialogueCondition* Condition : InConditions)
     {
+        Condition->SetSourceIndex(Conditions.Num());
         Conditions.Add(Condition);
     }
+
+    ReorderConditions();
+}
+
+void UDialogueBranchNode::ReorderConditions()
+{
+    //Check the conditions most likely to settle the set cheaply first
+    FDialogueQueryProfile::Get().SortConditions(this, bIfAny, Conditions);
 }
 
 void UDialogueBranchNode::ClearConditions()
@@ -88,21 +120,57 @@ const TArray<UDialogueCondition*>& UDialogueBranchNode::GetConditions() const
     return Conditions;
 }
 
-bool UDialogueBranchNode::PassesConditions() const
+bool UDialogueBranchNode::PassesConditions(
+    UDialogueSession* Session) const
 {
     if (bIfAny)
     {
-        return AnyConditionsTrue();
+        return AnyConditionsTrue(Session);
+    }
+
+    return AllConditionsTrue(Session);
+}
+
+bool UDialogueBranchNode::IssueAsyncQueries(UDialogueSession* Session,
+    FSimpleDelegate OnResolved) const
+{
+    check(Session);
+
+    TArray<UDialogueQuery*, TInlineAllocator<8>> Queries;
+    for (UDialogueCondition* Condition : Conditions)
+    {
+        if (Condition)
+        {
+            Queries.Add(Condition->GetQuery());
+        }
+    }
+
+    return Session->IssueAsyncQueries(Queries, MoveTemp(OnResolved));
+}
+
+void UDialogueBranchNode::OnQueriesResolved(
+    TWeakObjectPtr<UDialogueSession> WeakSession)
+{
+    //Ignore queries that resolve after the session has moved on
+    UDialogueSession* Session = WeakSession.Get();
+    if (!Session || !Session->IsActive() || Session->GetActiveNode() != this)
+    {
+        return;
     }
 
-    return AllConditionsTrue();
+    //Take the branch, exiting the dialogue if there is no node
+    UDialogueNode* NextNode = PassesConditions(Session) 
+        ? TrueNode.Get() 
+        : FalseNode.Get();
+    Dialogue->TraverseNode(Session, NextNode);
 }
 
-bool UDialogueBranchNode::AnyConditionsTrue() const
+bool UDialogueBranchNode::AnyConditionsTrue(
+    UDialogueSession* Session) const
 {
     for (UDialogueCondition* Condition : Conditions)
     {
-        if (Condition->IsMet())
+        if (Condition->Evaluate(Session, this))
         {
             return true;
         }
@@ -111,11 +179,12 @@ bool UDialogueBranchNode::AnyConditionsTrue() const
     return false;
 }
 
-bool UDialogueBranchNode::AllConditionsTrue() const
+bool UDialogueBranchNode::AllConditionsTrue(
+    UDialogueSession* Session) const
 {
     for (UDialogueCondition* Condition : Conditions)
     {
-        if (!Condition->IsMet())
+        if (!Condition->Evaluate(Session, this))
         {
             return false;
         }
@@ -6,25 +6,30 @@
 #include "Dialogue.h"
 #include "LogDialogueTree.h"
 
-void UDialogueEntryNode::EnterNode()
+FDialogueNodeResult UDialogueEntryNode::EnterNode(
+	UDialogueSession* Session)
 {
 	check(Dialogue);
 
 	//Call super
-	Super::EnterNode();
+	Super::EnterNode(Session);
 
 	//If no children, end dialogue and throw error
-	if (Children.Num() != 1 || Children[0] == nullptr)
+	if (GetNumChildren() != 1 || !GetChild(0))
 	{
 		UE_LOG(
 			LogDialogueTree, 
 			Warning, 
 			TEXT("Exiting dialogue: Entry node has no children...")
 		);
-		Dialogue->EndDialogue();
-		return;
+		return FDialogueNodeResult::End();
 	}
 
 	//Otherwise, get first (only) child and enter that node 
-	Dialogue->TraverseNode(Children[0]);
+	return FDialogueNodeResult::TraverseTo(GetChildNodeIndex(0));
+}
+
+EDialogueNodeKind UDialogueEntryNode::GetNodeKind() const
+{
+	return EDialogueNodeKind::Entry;
 }
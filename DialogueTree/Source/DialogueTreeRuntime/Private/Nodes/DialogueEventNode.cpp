@@ -4,33 +4,56 @@
 #include "Nodes/DialogueEventNode.h"
 //Plugin
 #include "Dialogue.h"
+#include "DialogueSession.h"
 #include "Events/DialogueEventBase.h"
 
-void UDialogueEventNode::EnterNode()
+FDialogueNodeResult UDialogueEventNode::EnterNode(UDialogueSession* Session)
 {
 	//Play all events
-	PlayEvents();
+	PlayEvents(Session);
 
-	//Trigger the next node in line if no event is blocking
-	TransitionIfNotBlocking();
+	//Wait for any blocking events to finish before moving on
+	if (GetIsBlocking(Session))
+	{
+		return FDialogueNodeResult::Wait();
+	}
+
+	if (GetNumChildren() > 0)
+	{
+		return FDialogueNodeResult::TraverseTo(GetChildNodeIndex(0));
+	}
+
+	return FDialogueNodeResult::End();
 }
 
-FDialogueOption UDialogueEventNode::GetAsOption()
+EDialogueNodeKind UDialogueEventNode::GetNodeKind() const
 {
-	if (!Children.IsEmpty() && Children[0] != nullptr)
+	return EDialogueNodeKind::Event;
+}
+
+FDialogueOption UDialogueEventNode::GetAsOption(
+	UDialogueSession* Session)
+{
+	if (GetNumChildren() > 0 && GetChild(0))
 	{
-		FSpeechDetails OptionDetails = Children[0]->GetAsOption().Details;
-		return FDialogueOption{ OptionDetails, this };
+		FDialogueOption Option = GetChild(0)->GetAsOption(Session);
+		Option.TargetNode = this;
+		return Option;
 	}
 
 	return FDialogueOption();
 }
 
-void UDialogueEventNode::Skip()
+void UDialogueEventNode::Skip(UDialogueSession* Session)
 {
+	check(Session);
+
 	for (UDialogueEventBase* Event : Events)
 	{
-		Event->OnSkipped();
+		if (UDialogueEventBase* Instance = Session->FindEventInstance(Event))
+		{
+			Instance->OnSkipped();
+		}
 	}
 }
 
@@ -44,11 +67,14 @@ const TArray<UDialogueEventBase*>& UDialogueEventNode::GetEvents() const
 	return Events;
 }
 
-bool UDialogueEventNode::GetIsBlocking() const
+bool UDialogueEventNode::GetIsBlocking(const UDialogueSession* Session) const
 {
+	check(Session);
+
 	for (UDialogueEventBase* Event : Events)
 	{
-		if (Event->GetIsBlocking())
+		UDialogueEventBase* Instance = Session->FindEventInstance(Event);
+		if (Instance && Instance->GetIsBlocking())
 		{
 			return true;
 		}
@@ -57,34 +83,59 @@ bool UDialogueEventNode::GetIsBlocking() const
 	return false;
 }
 
-void UDialogueEventNode::PlayEvents()
+void UDialogueEventNode::PlayEvents(UDialogueSession* Session)
 {
+	check(Session);
+
 	for (UDialogueEventBase* Event : Events)
 	{
+		UDialogueEventBase* Instance = Session->GetEventInstance(Event);
+
 		// Subscribe to the event's callback for stopping blocking
-		Event->OnStoppedBlocking.BindUFunction(
+		Instance->OnStoppedBlocking.BindUObject(
 			this,
-			"TransitionIfNotBlocking"
+			&UDialogueEventNode::OnEventStoppedBlocking,
+			TWeakObjectPtr<UDialogueSession>(Session)
 		);
 
 		// Play the event
-		Event->PlayEvent();
+		Instance->PlayEvent();
+	}
+
+	// Events may change anything a query reads
+	if (!Events.IsEmpty())
+	{
+		Session->InvalidateQueries();
 	}
 }
 
-void UDialogueEventNode::TransitionIfNotBlocking() const
+void UDialogueEventNode::TransitionIfNotBlocking(
+	UDialogueSession* Session) const
 {
-	if (GetIsBlocking())
+	if (GetIsBlocking(Session))
 	{
 		return;
 	}
 
-	if (!Children.IsEmpty())
+	if (GetNumChildren() > 0)
 	{
-		Dialogue->TraverseNode(Children[0]);
+		Dialogue->TraverseNodeAt(Session, GetChildNodeIndex(0));
 	}
 	else
 	{
-		Dialogue->EndDialogue();
+		Dialogue->EndDialogue(Session);
+	}
+}
+
+void UDialogueEventNode::OnEventStoppedBlocking(
+	TWeakObjectPtr<UDialogueSession> WeakSession) const
+{
+	//Ignore events that finish after the session has moved on
+	UDialogueSession* Session = WeakSession.Get();
+	if (!Session || !Session->IsActive() || Session->GetActiveNode() != this)
+	{
+		return;
 	}
+
+	TransitionIfNotBlocking(Session);
 }
@@ -4,20 +4,24 @@
 #include "Nodes/DialogueJumpBackNode.h"
 
 #include "Dialogue.h"
+#include "DialogueSession.h"
 
-void UDialogueJumpBackNode::EnterNode()
+FDialogueNodeResult UDialogueJumpBackNode::EnterNode(UDialogueSession* Session)
 {
-	Super::EnterNode();
-	bool bJumped = Dialogue->JumpBack();
-	if (bJumped)
-		return;
+	Super::EnterNode(Session);
+	const int32 JumpBackIndex = Session->ConsumeJumpBackNodeIndex();
+	if (JumpBackIndex != INDEX_NONE)
+		return FDialogueNodeResult::TraverseTo(JumpBackIndex);
 	
-	if (!Children.IsEmpty())
+	if (GetNumChildren() > 0)
 	{
-		Dialogue->TraverseNode(Children[0]);
+		return FDialogueNodeResult::TraverseTo(GetChildNodeIndex(0));
 	}
-	else
-	{
-		Dialogue->EndDialogue();
-	}		
+
+	return FDialogueNodeResult::End();
+}
+
+EDialogueNodeKind UDialogueJumpBackNode::GetNodeKind() const
+{
+	return EDialogueNodeKind::JumpBack;
 }
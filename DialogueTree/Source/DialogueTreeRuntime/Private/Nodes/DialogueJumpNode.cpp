@@ -5,18 +5,30 @@
 //Plugin
 #include "Dialogue.h"
 
-void UDialogueJumpNode::EnterNode()
+FDialogueNodeResult UDialogueJumpNode::EnterNode(UDialogueSession* Session)
 {
-	Super::EnterNode();
-	Dialogue->TraverseNode(JumpTarget);
+	Super::EnterNode(Session);
+	return FDialogueNodeResult::TraverseTo(JumpTarget);
 }
 
-FDialogueOption UDialogueJumpNode::GetAsOption()
+EDialogueNodeKind UDialogueJumpNode::GetNodeKind() const
+{
+	return EDialogueNodeKind::Jump;
+}
+
+void UDialogueJumpNode::GetPayloadNodes(TArray<UDialogueNode*>& OutNodes) const
+{
+	OutNodes.Add(JumpTarget);
+}
+
+FDialogueOption UDialogueJumpNode::GetAsOption(
+	UDialogueSession* Session)
 {
 	if (JumpTarget)
 	{
-		FSpeechDetails OptionDetails = JumpTarget->GetAsOption().Details;
-		return FDialogueOption{ OptionDetails, this };
+		FDialogueOption Option = JumpTarget->GetAsOption(Session);
+		Option.TargetNode = this;
+		return Option;
 	}
 
 	return FDialogueOption();
@@ -5,6 +5,12 @@
 //Plugin
 #include "Dialogue.h"
 
+FDialogueNodeResult FDialogueNodeResult::TraverseTo(
+    const UDialogueNode* InNode)
+{
+    return TraverseTo(InNode ? InNode->GetNodeIndex() : INDEX_NONE);
+}
+
 UDialogue* UDialogueNode::GetDialogue() const
 {
     return Dialogue;
@@ -31,6 +37,12 @@ void UDialogueNode::AddChild(UDialogueNode* InChild)
     }
 }
 
+void UDialogueNode::ClearLinks()
+{
+    Parents.Reset();
+    Children.Reset();
+}
+
 TArray<UDialogueNode*> UDialogueNode::GetParents() const
 {
     return Parents;
@@ -41,7 +53,57 @@ TArray<UDialogueNode*> UDialogueNode::GetChildren() const
     return Children;
 }
 
-FDialogueOption UDialogueNode::GetAsOption()
+int32 UDialogueNode::GetNumChildren() const
+{
+    if (Dialogue && Dialogue->GetNodeTable().IsValidIndex(NodeIndex))
+    {
+        return Dialogue->GetNodeTable().Entries[NodeIndex].NumChildren;
+    }
+
+    return Children.Num();
+}
+
+UDialogueNode* UDialogueNode::GetChild(int32 ChildIndex) const
+{
+    if (Dialogue && Dialogue->GetNodeTable().IsValidIndex(NodeIndex))
+    {
+        const FDialogueNodeTable& Table = Dialogue->GetNodeTable();
+        TConstArrayView<int32> ChildIndices = Table.GetChildren(NodeIndex);
+        return ChildIndices.IsValidIndex(ChildIndex) 
+            ? Table.GetNode(ChildIndices[ChildIndex]) 
+            : nullptr;
+    }
+
+    return Children.IsValidIndex(ChildIndex) ? Children[ChildIndex] : nullptr;
+}
+
+int32 UDialogueNode::GetChildNodeIndex(int32 ChildIndex) const
+{
+    if (Dialogue && Dialogue->GetNodeTable().IsValidIndex(NodeIndex))
+    {
+        TConstArrayView<int32> ChildIndices = 
+            Dialogue->GetNodeTable().GetChildren(NodeIndex);
+        return ChildIndices.IsValidIndex(ChildIndex) 
+            ? ChildIndices[ChildIndex] 
+            : INDEX_NONE;
+    }
+
+    const UDialogueNode* Child = GetChild(ChildIndex);
+    return Child ? Child->GetNodeIndex() : INDEX_NONE;
+}
+
+EDialogueNodeKind UDialogueNode::GetNodeKind() const
+{
+    return EDialogueNodeKind::Other;
+}
+
+FName UDialogueNode::GetSpeakerRoleName() const
+{
+    return NAME_None;
+}
+
+FDialogueOption UDialogueNode::GetAsOption(
+    UDialogueSession* Session)
 {
     return FDialogueOption();
 }
@@ -56,6 +118,26 @@ void UDialogueNode::SetNodeID(FName InID)
     NodeID = InID;
 }
 
+const FGuid& UDialogueNode::GetNodeGuid() const
+{
+    return NodeGuid;
+}
+
+void UDialogueNode::SetNodeGuid(const FGuid& InGuid)
+{
+    NodeGuid = InGuid;
+}
+
+int32 UDialogueNode::GetNodeIndex() const
+{
+    return NodeIndex;
+}
+
+void UDialogueNode::SetNodeIndex(int32 InIndex)
+{
+    NodeIndex = InIndex;
+}
+
 void UDialogueNode::SetGraphLocation(FVector2D InLocation)
 {
     GraphLocation = InLocation;
@@ -4,46 +4,49 @@
 #include "Nodes/DialogueOptionLockNode.h"
 //Plugin
 #include "Conditionals/DialogueCondition.h"
+#include "Conditionals/DialogueQueryProfile.h"
 #include "Dialogue.h"
 
-FDialogueOption UDialogueOptionLockNode::GetAsOption()
+FDialogueOption UDialogueOptionLockNode::GetAsOption(
+	UDialogueSession* Session)
 {
-	if (Children.Num() < 1 || Children[0] == nullptr)
+	if (GetNumChildren() < 1 || !GetChild(0))
 	{
 		return FDialogueOption();
 	}
 
-	FDialogueOption Option = Children[0]->GetAsOption();
+	FDialogueOption Option = GetChild(0)->GetAsOption(Session);
 
-	if (!PassesConditions())
-	{
-		Option.Details.bIsLocked = true;
-		Option.Details.OptionMessage = LockedMessage;
-	}
-	else
-	{
-		Option.Details.bIsLocked = false;
-		Option.Details.OptionMessage = UnlockedMessage;
-	}
+	//Overrides any lock further down the chain, as the nearest lock to 
+	//the option decides
+	Option.bOverridesLock = true;
+	Option.bIsLocked = !PassesConditions(Session);
+	Option.OptionMessage = Option.bIsLocked ? LockedMessage : UnlockedMessage;
 
 	return Option;
 }
 
-void UDialogueOptionLockNode::EnterNode()
+FDialogueNodeResult UDialogueOptionLockNode::EnterNode(
+	UDialogueSession* Session)
 {
 	check(Dialogue);
 
 	//Call super
-	Super::EnterNode();
+	Super::EnterNode(Session);
 
 	//If no children, end dialogue 
-	if (Children.Num() < 1 || Children[0] == nullptr)
+	if (GetNumChildren() < 1 || !GetChild(0))
 	{
-		Dialogue->EndDialogue();
+		return FDialogueNodeResult::End();
 	}
 
 	//Otherwise, get first (only) child and enter that node 
-	Dialogue->TraverseNode(Children[0]);
+	return FDialogueNodeResult::TraverseTo(GetChildNodeIndex(0));
+}
+
+EDialogueNodeKind UDialogueOptionLockNode::GetNodeKind() const
+{
+	return EDialogueNodeKind::OptionLock;
 }
 
 void UDialogueOptionLockNode::InitLockNodeData(bool InIfAny, 
@@ -57,25 +60,36 @@ void UDialogueOptionLockNode::InitLockNodeData(bool InIfAny,
 	Conditions.Empty();
 	for (UDialogueCondition* Condition : InConditions)
 	{
+		Condition->SetSourceIndex(Conditions.Num());
 		Conditions.Add(Condition);
 	}
+
+	ReorderConditions();
+}
+
+void UDialogueOptionLockNode::ReorderConditions()
+{
+	//Check the conditions most likely to settle the set cheaply first
+	FDialogueQueryProfile::Get().SortConditions(this, bIfAny, Conditions);
 }
 
-bool UDialogueOptionLockNode::PassesConditions() const
+bool UDialogueOptionLockNode::PassesConditions(
+	UDialogueSession* Session) const
 {
 	if (bIfAny)
 	{
-		return AnyConditionsTrue();
+		return AnyConditionsTrue(Session);
 	}
 
-	return AllConditionsTrue();
+	return AllConditionsTrue(Session);
 }
 
-bool UDialogueOptionLockNode::AnyConditionsTrue() const
+bool UDialogueOptionLockNode::AnyConditionsTrue(
+	UDialogueSession* Session) const
 {
 	for (UDialogueCondition* Condition : Conditions)
 	{
-		if (Condition->IsMet())
+		if (Condition->Evaluate(Session, this))
 		{
 			return true;
 		}
@@ -84,11 +98,12 @@ bool UDialogueOptionLockNode::AnyConditionsTrue() const
 	return false;
 }
 
-bool UDialogueOptionLockNode::AllConditionsTrue() const
+bool UDialogueOptionLockNode::AllConditionsTrue(
+	UDialogueSession* Session) const
 {
 	for (UDialogueCondition* Condition : Conditions)
 	{
-		if (!Condition->IsMet())
+		if (!Condition->Evaluate(Session, this))
 		{
 			return false;
 		}
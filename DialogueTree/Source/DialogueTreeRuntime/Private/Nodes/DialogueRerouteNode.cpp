@@ -6,35 +6,41 @@
 #include "Dialogue.h"
 #include "LogDialogueTree.h"
 
-void UDialogueRerouteNode::EnterNode()
+FDialogueNodeResult UDialogueRerouteNode::EnterNode(
+	UDialogueSession* Session)
 {
 	check(Dialogue);
 
 	//Call super
-	Super::EnterNode();
+	Super::EnterNode(Session);
 
 	//If no children, end dialogue and throw error
-	if (Children.Num() < 1 || Children[0] == nullptr)
+	if (GetNumChildren() < 1 || !GetChild(0))
 	{
 		UE_LOG(
 			LogDialogueTree,
 			Warning,
 			TEXT("Exiting dialogue: Entered a reroute node with no children...")
 		);
-		Dialogue->EndDialogue();
-		return;
+		return FDialogueNodeResult::End();
 	}
 
 	//Otherwise, get first (only) child and enter that node 
-	Dialogue->TraverseNode(Children[0]);
+	return FDialogueNodeResult::TraverseTo(GetChildNodeIndex(0));
 }
 
-FDialogueOption UDialogueRerouteNode::GetAsOption()
+EDialogueNodeKind UDialogueRerouteNode::GetNodeKind() const
 {
-	if (Children.IsEmpty() || Children[0] == nullptr)
+	return EDialogueNodeKind::Reroute;
+}
+
+FDialogueOption UDialogueRerouteNode::GetAsOption(
+	UDialogueSession* Session)
+{
+	if (GetNumChildren() == 0 || !GetChild(0))
 	{
 		return FDialogueOption();
 	}
 
-	return Children[0]->GetAsOption();
+	return GetChild(0)->GetAsOption(Session);
 }
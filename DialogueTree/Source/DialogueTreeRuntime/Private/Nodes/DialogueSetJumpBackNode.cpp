@@ -5,22 +5,35 @@
 
 #include "Dialogue.h"
 
-void UDialogueSetJumpBackNode::EnterNode()
+FDialogueNodeResult UDialogueSetJumpBackNode::EnterNode(UDialogueSession* Session)
 {
-	Super::EnterNode();
-	Dialogue->SetJumpBackNode(JumpTarget);
-	if (!Children.IsEmpty())
-		Dialogue->TraverseNode(Children[0]);
-	else
-		Dialogue->EndDialogue();
+	Super::EnterNode(Session);
+	Dialogue->SetJumpBackNode(Session, JumpTarget);
+	if (GetNumChildren() > 0)
+		return FDialogueNodeResult::TraverseTo(GetChildNodeIndex(0));
+
+	return FDialogueNodeResult::End();
+}
+
+EDialogueNodeKind UDialogueSetJumpBackNode::GetNodeKind() const
+{
+	return EDialogueNodeKind::SetJumpBack;
+}
+
+void UDialogueSetJumpBackNode::GetPayloadNodes(
+	TArray<UDialogueNode*>& OutNodes) const
+{
+	OutNodes.Add(JumpTarget);
 }
 
-FDialogueOption UDialogueSetJumpBackNode::GetAsOption()
+FDialogueOption UDialogueSetJumpBackNode::GetAsOption(
+	UDialogueSession* Session)
 {
 	if (JumpTarget)
 	{
-		FSpeechDetails OptionDetails = JumpTarget->GetAsOption().Details;
-		return FDialogueOption{ OptionDetails, this };
+		FDialogueOption Option = JumpTarget->GetAsOption(Session);
+		Option.TargetNode = this;
+		return Option;
 	}
 
 	return FDialogueOption();
@@ -4,6 +4,9 @@
 #include "Nodes/DialogueSpeechNode.h"
 //Plugin
 #include "Dialogue.h"
+#include "DialogueManagerSubsystem.h"
+#include "DialogueSession.h"
+#include "DialogueSettings.h"
 #include "DialogueSpeakerComponent.h"
 #include "LogDialogueTree.h"
 #include "Interfaces/DialogueCharacter.h"
@@ -19,14 +22,32 @@ void UDialogueSpeechNode::InitSpeechData(FSpeechDetails& InDetails,
 	Transition->SetOwningNode(this);
 }
 
-FSpeechDetails UDialogueSpeechNode::GetDetails() const
+const FSpeechDetails& UDialogueSpeechNode::GetDetails() const
 {
 	return Details;
 }
 
-UDialogueSpeakerComponent* UDialogueSpeechNode::GetSpeaker() const
+UDialogueSpeakerComponent* UDialogueSpeechNode::GetSpeaker(
+	const UDialogueSession* Session) const
 {
-	return Dialogue->GetSpeaker(Details.SpeakerName);
+	return Session ? Session->GetSpeakerAt(Details.SpeakerSlot) : nullptr;
+}
+
+void UDialogueSpeechNode::GetSpeechAudio(
+	TArray<FSoftObjectPath>& OutAudio) const
+{
+	if (Details.bIgnoreContent)
+	{
+		return;
+	}
+
+	for (const FSpeechOptionData& Variation : Details.SpeechVariations)
+	{
+		if (!Variation.SpeechAudio.IsNull())
+		{
+			OutAudio.AddUnique(Variation.SpeechAudio.ToSoftObjectPath());
+		}
+	}
 }
 
 bool UDialogueSpeechNode::GetCanSkip() const
@@ -34,18 +55,20 @@ bool UDialogueSpeechNode::GetCanSkip() const
 	return Details.bCanSkip;
 }
 
-void UDialogueSpeechNode::SelectOption(int32 InOptionIndex)
+void UDialogueSpeechNode::SelectOption(UDialogueSession* Session, 
+	int32 InOptionIndex)
 {
-	Transition->SelectOption(InOptionIndex);
+	Transition->SelectOption(Session, InOptionIndex);
 }
 
-void UDialogueSpeechNode::EnterNode()
+FDialogueNodeResult UDialogueSpeechNode::EnterNode(
+	UDialogueSession* Session)
 {
 	//Play all events
-	PlayEvents();
+	PlayEvents(Session);
 
 	//Verify speaker is actually present
-	if (!Dialogue->SpeakerIsPresent(Details.SpeakerName))
+	if (!GetSpeaker(Session))
 	{
 		UE_LOG(
 			LogDialogueTree,
@@ -53,18 +76,17 @@ void UDialogueSpeechNode::EnterNode()
 			TEXT("Terminating dialogue early: A participant speaker component was not found. Verify that the dialogue name property matches the speaker's role in the dialogue.")
 		);
 
-		Dialogue->EndDialogue();
-		return;
+		return FDialogueNodeResult::End();
 	}
 
 	if (!Details.bIgnoreContent && !Details.SpeechVariations.IsEmpty())
 	{
 		const int SpeechVariationIndex = Details.SpeechVariations.Num() > 1 ? FMath::RandRange(0, Details.SpeechVariations.Num() - 1) : 0;
 		//Display the current speech
-		Dialogue->DisplaySpeech(Details, SpeechVariationIndex);
+		Dialogue->DisplaySpeech(Session, Details, SpeechVariationIndex);
 
 		//Play any audio and set any flags for the speaker
-		StartAudio(SpeechVariationIndex);
+		StartAudio(Session, SpeechVariationIndex);
 	}
 	
 	//If no transition, throw an error and close the dialogue 
@@ -75,12 +97,11 @@ void UDialogueSpeechNode::EnterNode()
 			Error, 
 			TEXT("Speech node is missing transition.")
 		);
-		Dialogue->EndDialogue();
-		return; 
+		return FDialogueNodeResult::End();
 	}
 
 	// G2VS2 start
-	if (auto DialogueCharacter = Cast<IDialogueCharacter>(GetSpeaker()->GetOwner()))
+	if (auto DialogueCharacter = Cast<IDialogueCharacter>(GetSpeaker(Session)->GetOwner()))
 	{
 		DialogueCharacter->StopDialogueGesture();
 		if (Details.GestureTag_Obsolete.IsValid())
@@ -92,7 +113,7 @@ void UDialogueSpeechNode::EnterNode()
 
 	for (const auto& Gesture : Details.Gestures)
 	{
-		auto SpeakerComponent = Dialogue->GetSpeaker(Gesture.SpeakerName);
+		auto SpeakerComponent = Session->GetSpeakerAt(Gesture.SpeakerSlot);
 		if (SpeakerComponent == nullptr)
 			continue;
 
@@ -124,22 +145,45 @@ void UDialogueSpeechNode::EnterNode()
 	}
 	
 	// G2VS2 end
-	//Play the transition 
-	Transition->StartTransition();
+	//Play the transition. Any hop it makes straight away is picked up by 
+	//the dialogue once we return.
+	Transition->StartTransition(Session);
+	return FDialogueNodeResult::Wait();
 }
 
-void UDialogueSpeechNode::Skip()
+EDialogueNodeKind UDialogueSpeechNode::GetNodeKind() const
+{
+	return EDialogueNodeKind::Speech;
+}
+
+FName UDialogueSpeechNode::GetSpeakerRoleName() const
+{
+	return Details.SpeakerName;
+}
+
+void UDialogueSpeechNode::ResolveSpeakerSlots(
+	TConstArrayView<FName> RoleNames)
+{
+	Details.SpeakerSlot = RoleNames.IndexOfByKey(Details.SpeakerName);
+
+	for (FSpeechGestureData& Gesture : Details.Gestures)
+	{
+		Gesture.SpeakerSlot = RoleNames.IndexOfByKey(Gesture.SpeakerName);
+	}
+}
+
+void UDialogueSpeechNode::Skip(UDialogueSession* Session)
 {
 	if (Details.bCanSkip)
 	{
-		Super::Skip();
-		Transition->Skip();
+		Super::Skip(Session);
+		Transition->Skip(Session);
 		// G2VS2
 		// 08.11.2024 @AK: the UDialogueSpeechNode now has events on skip, so now we just gotta do the UDialogueEvent_SkipGesture
 		// to remove redundant intervention into plugins source
 		if (Details.GestureTag_Obsolete.IsValid())
 		{
-			auto DialogueCharacter = Cast<IDialogueCharacter>(GetSpeaker()->GetOwner());
+			auto DialogueCharacter = Cast<IDialogueCharacter>(GetSpeaker(Session)->GetOwner());
 			DialogueCharacter->StopDialogueGesture();
 		}
 		// G2VS2
@@ -151,31 +195,88 @@ TSubclassOf<UDialogueTransition> UDialogueSpeechNode::GetTransitionType() const
 	return Transition->GetClass();
 }
 
-void UDialogueSpeechNode::TransitionIfNotBlocking() const
+void UDialogueSpeechNode::TransitionIfNotBlocking(
+	UDialogueSession* Session) const
 {
-	Transition->CheckTransitionConditions();
+	Transition->CheckTransitionConditions(Session);
 }
 
-FDialogueOption UDialogueSpeechNode::GetAsOption()
+FDialogueOption UDialogueSpeechNode::GetAsOption(
+	UDialogueSession* Session)
 {
-	return FDialogueOption{ Details, this };
+	FDialogueOption Option;
+	Option.Speech = this;
+	Option.TargetNode = this;
+	return Option;
 }
 
-void UDialogueSpeechNode::StartAudio(int SpeechVariationIndex)
+void UDialogueSpeechNode::StartAudio(UDialogueSession* Session, 
+	int SpeechVariationIndex)
 {
-	UDialogueSpeakerComponent* Speaker = GetSpeaker();
+	UDialogueSpeakerComponent* Speaker = GetSpeaker(Session);
 
 	if (Speaker)
 	{
 		//Play any audio
 		Speaker->Stop();
 
-		if (Details.SpeechVariations[SpeechVariationIndex].SpeechAudio)
+		const TSoftObjectPtr<USoundCue>& SpeechAudio = 
+			Details.SpeechVariations[SpeechVariationIndex].SpeechAudio;
+		if (!SpeechAudio.IsNull())
 		{
-			Speaker->PlaySpeechAudioClip(Details.SpeechVariations[SpeechVariationIndex].SpeechAudio);
+			if (USoundCue* LoadedAudio = LoadSpeechAudio(Session, SpeechAudio))
+			{
+				Speaker->PlaySpeechAudioClip(LoadedAudio);
+			}
 		}
 
 		//Set any behavior flags
 		Speaker->SetCurrentGameplayTags(Details.GameplayTags);
 	}
+}
+
+USoundCue* UDialogueSpeechNode::LoadSpeechAudio(UDialogueSession* Session, 
+	const TSoftObjectPtr<USoundCue>& SpeechAudio) const
+{
+	UWorld* World = Session->GetWorld();
+	UDialogueManagerSubsystem* Manager = World 
+		? World->GetSubsystem<UDialogueManagerSubsystem>()
+		: nullptr;
+
+	//Without a manager there is nothing streaming; load it here
+	if (!Manager)
+	{
+		return SpeechAudio.LoadSynchronous();
+	}
+
+	//Request even if already loaded, so that the clip counts as recently
+	//used
+	TSharedPtr<FStreamableHandle> Handle = 
+		Manager->RequestSpeechAudio(SpeechAudio);
+	if (SpeechAudio.IsValid())
+	{
+		return SpeechAudio.Get();
+	}
+
+	//Not prefetched in time. A timeout of 0 would wait forever, so only 
+	//wait when a limit is set.
+	const float Timeout = GetDefault<UDialogueSettings>()->AudioLoadTimeout;
+	if (Handle.IsValid() && Timeout > 0.f)
+	{
+		Handle->WaitUntilComplete(Timeout);
+	}
+
+	if (!SpeechAudio.IsValid())
+	{
+		UE_LOG(
+			LogDialogueTree,
+			Warning,
+			TEXT("Speech audio [%s] in dialogue [%s] did not load in time and will not be played. Consider raising the audio prefetch depth."),
+			*SpeechAudio.ToString(),
+			*GetNameSafe(Dialogue)
+		);
+		return nullptr;
+	}
+
+	return SpeechAudio.Get();
 }
\ No newline at end of file
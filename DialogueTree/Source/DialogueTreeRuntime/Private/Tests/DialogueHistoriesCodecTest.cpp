@@ -0,0 +1,133 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//UE
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+//Plugin
+#include "DialogueController.h"
+#include "History/DialogueHistoriesCodec.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FDialogueHistoriesCodecTest,
+	"DialogueTree.History.HistoriesCodec",
+	EAutomationTestFlags::ApplicationContextMask
+		| EAutomationTestFlags::EngineFilter
+)
+
+bool FDialogueHistoriesCodecTest::RunTest(const FString& Parameters)
+{
+	//Two dialogues with the same asset name in different folders, so that
+	//only their path keys and GUIDs tell them apart
+	const FName FirstKey = TEXT("/Game/Act1/Intro.Intro");
+	const FName SecondKey = TEXT("/Game/Act2/Intro.Intro");
+	const FName DialogueName = TEXT("Intro");
+	const FGuid FirstSpeaker = FGuid::NewGuid();
+	const FGuid SecondSpeaker = FGuid::NewGuid();
+
+	FDialogueHistories Histories;
+
+	FDialogueHistory& First = Histories.Histories.Add(FirstKey);
+	First.DialogueFName = DialogueName;
+	First.DialogueGuid = FGuid::NewGuid();
+	FCharacterDialogueHistory& FirstHistory =
+		First.DialogueNodeHistory.Add(FirstSpeaker);
+	FirstHistory.VisitedNodeIDs.Add(TEXT("Speech_0"));
+	FirstHistory.VisitedNodeIDs.Add(TEXT("Speech_1"));
+	FirstHistory.ResumeNodeID = TEXT("Speech_1");
+
+	FDialogueHistory& Second = Histories.Histories.Add(SecondKey);
+	Second.DialogueFName = DialogueName;
+	Second.DialogueGuid = FGuid::NewGuid();
+	Second.DialogueNodeHistory.Add(FirstSpeaker).VisitedNodeIDs.Add(
+		TEXT("Speech_0")
+	);
+	Second.DialogueNodeHistory.Add(SecondSpeaker);
+
+	TArray<uint8> Bytes;
+	FDialogueHistoriesCodec::SaveToBytes(Histories, Bytes);
+
+	FDialogueHistories Loaded;
+	if (!TestTrue(
+		TEXT("Saved histories load"),
+		FDialogueHistoriesCodec::LoadFromBytes(Bytes, Loaded)
+	))
+	{
+		return false;
+	}
+
+	TestEqual(
+		TEXT("Every history is kept"),
+		Loaded.Histories.Num(),
+		Histories.Histories.Num()
+	);
+	for (const auto& HistoryEntry : Histories.Histories)
+	{
+		const FDialogueHistory& Expected = HistoryEntry.Value;
+		const FDialogueHistory* Actual =
+			Loaded.Histories.Find(HistoryEntry.Key);
+		if (!TestNotNull(TEXT("History is keyed by path"), Actual))
+		{
+			continue;
+		}
+
+		TestEqual(
+			TEXT("History keeps its dialogue name"),
+			Actual->DialogueFName,
+			Expected.DialogueFName
+		);
+		TestEqual(
+			TEXT("History keeps its dialogue GUID"),
+			Actual->DialogueGuid,
+			Expected.DialogueGuid
+		);
+		TestEqual(
+			TEXT("History keeps every speaker"),
+			Actual->DialogueNodeHistory.Num(),
+			Expected.DialogueNodeHistory.Num()
+		);
+
+		for (const auto& SpeakerEntry : Expected.DialogueNodeHistory)
+		{
+			const FCharacterDialogueHistory* ActualSpeaker =
+				Actual->DialogueNodeHistory.Find(SpeakerEntry.Key);
+			if (!TestNotNull(TEXT("Speaker is kept"), ActualSpeaker))
+			{
+				continue;
+			}
+
+			TestEqual(
+				TEXT("Speaker keeps its resume node"),
+				ActualSpeaker->ResumeNodeID,
+				SpeakerEntry.Value.ResumeNodeID
+			);
+			TestTrue(
+				TEXT("Speaker keeps its visited nodes"),
+				ActualSpeaker->VisitedNodeIDs.Num()
+					== SpeakerEntry.Value.VisitedNodeIDs.Num()
+				&& ActualSpeaker->VisitedNodeIDs.Includes(
+					SpeakerEntry.Value.VisitedNodeIDs
+				)
+			);
+		}
+	}
+
+	//Cut short saves are discarded whole
+	TArray<uint8> Truncated = Bytes;
+	Truncated.SetNum(Bytes.Num() / 2);
+	FDialogueHistories Partial;
+	TestFalse(
+		TEXT("Truncated histories do not load"),
+		FDialogueHistoriesCodec::LoadFromBytes(Truncated, Partial)
+	);
+	TestEqual(
+		TEXT("Truncated histories load nothing"),
+		Partial.Histories.Num(),
+		0
+	);
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,244 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//UE
+#include "CoreMinimal.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+//Plugin
+#include "History/DialogueHistoryColdStore.h"
+#include "History/DialogueHistoryStore.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(
+	FDialogueHistoryColdStoreTest,
+	"DialogueTree.History.ColdStore",
+	EAutomationTestFlags::ApplicationContextMask
+		| EAutomationTestFlags::EngineFilter
+)
+
+bool FDialogueHistoryColdStoreTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumSpeakers = 16;
+	constexpr int32 MaxResidentSpeakers = 4;
+	constexpr int32 NumShards = 4;
+
+	IFileManager& FileManager = IFileManager::Get();
+	const FString Directory = FPaths::Combine(
+		FPaths::AutomationTransientDir(),
+		TEXT("DialogueHistoryColdStore")
+	);
+	FileManager.DeleteDirectory(*Directory, false, true);
+
+	const FGuid DialogueId = FGuid::NewGuid();
+	TArray<FGuid> SpeakerIds;
+	for (int32 SpeakerIndex = 0; SpeakerIndex < NumSpeakers; ++SpeakerIndex)
+	{
+		SpeakerIds.Add(FGuid::NewGuid());
+	}
+
+	TSharedPtr<FDialogueHistoryColdStore> ColdStore =
+		MakeShared<FDialogueHistoryColdStore>();
+	if (!TestTrue(
+		TEXT("Cold store opens"),
+		ColdStore->Open(Directory, NumShards)
+	))
+	{
+		return false;
+	}
+
+	//Each speaker visits the node matching its index
+	FDialogueHistoryStore Store;
+	Store.SetColdStore(ColdStore);
+	for (int32 SpeakerIndex = 0; SpeakerIndex < NumSpeakers; ++SpeakerIndex)
+	{
+		Store.MarkVisited(
+			DialogueId,
+			MakeArrayView(&SpeakerIds[SpeakerIndex], 1),
+			SpeakerIndex
+		);
+	}
+
+	//Spill
+	const int32 NumSpilled = Store.SpillToColdStore(MaxResidentSpeakers);
+	TestTrue(TEXT("Records are spilled"), NumSpilled > 0);
+	TestTrue(
+		TEXT("Spilling keeps no more than the limit resident"),
+		Store.GetNumResidentSpeakers() <= MaxResidentSpeakers
+	);
+	TestEqual(
+		TEXT("Every spilled record is in the cold store"),
+		ColdStore->Num(),
+		static_cast<int64>(NumSpilled)
+	);
+
+	TArray<int32> Spilled;
+	for (int32 SpeakerIndex = 0; SpeakerIndex < NumSpeakers; ++SpeakerIndex)
+	{
+		if (!Store.FindSpeaker(DialogueId, SpeakerIds[SpeakerIndex]))
+		{
+			Spilled.Add(SpeakerIndex);
+		}
+	}
+	TestEqual(TEXT("Spilled records leave memory"), Spilled.Num(), NumSpilled);
+
+	//WasVisited through the store and through the cold view
+	TSharedPtr<const FDialogueHistoryColdView, ESPMode::ThreadSafe> View =
+		Store.GetColdView();
+	if (!TestTrue(TEXT("Cold view is available"), View.IsValid()))
+	{
+		return false;
+	}
+
+	for (int32 SpeakerIndex : Spilled)
+	{
+		const TConstArrayView<FGuid> Speaker =
+			MakeArrayView(&SpeakerIds[SpeakerIndex], 1);
+		TestTrue(
+			TEXT("Store reads spilled visits"),
+			Store.WasVisited(DialogueId, Speaker, SpeakerIndex)
+		);
+		TestFalse(
+			TEXT("Store does not invent spilled visits"),
+			Store.WasVisited(DialogueId, Speaker, SpeakerIndex + 1)
+		);
+		TestTrue(
+			TEXT("Cold view reads spilled visits"),
+			View->WasVisited(DialogueId, SpeakerIds[SpeakerIndex], SpeakerIndex)
+		);
+		TestFalse(
+			TEXT("Cold view does not invent spilled visits"),
+			View->WasVisited(
+				DialogueId,
+				SpeakerIds[SpeakerIndex],
+				SpeakerIndex + 1
+			)
+		);
+	}
+	View.Reset();
+
+	//Save/load round trip
+	TArray<uint8> Bytes;
+	Store.SaveToBytes(Bytes);
+
+	FDialogueHistoryStore Loaded;
+	TestTrue(TEXT("Saved store loads"), Loaded.LoadFromBytes(Bytes));
+	TestEqual(
+		TEXT("Saves hold spilled records"),
+		Loaded.GetNumResidentSpeakers(),
+		NumSpeakers
+	);
+	for (int32 SpeakerIndex = 0; SpeakerIndex < NumSpeakers; ++SpeakerIndex)
+	{
+		TestTrue(
+			TEXT("Loaded store keeps every visit"),
+			Loaded.WasVisited(
+				DialogueId,
+				MakeArrayView(&SpeakerIds[SpeakerIndex], 1),
+				SpeakerIndex
+			)
+		);
+	}
+
+	//Loading starts the cold store over
+	TestTrue(TEXT("Store reloads its own save"), Store.LoadFromBytes(Bytes));
+	TestEqual(
+		TEXT("Loading empties the cold store"),
+		ColdStore->Num(),
+		static_cast<int64>(0)
+	);
+
+	//Reopen after a generation bump. Every record is written to the cold
+	//store again, with a second visit, so that each shard is rewritten.
+	const int32 NumRespilled = Store.SpillToColdStore(MaxResidentSpeakers);
+	TestTrue(TEXT("Loaded records are spilled again"), NumRespilled > 0);
+	for (int32 SpeakerIndex = 0; SpeakerIndex < NumSpeakers; ++SpeakerIndex)
+	{
+		Store.MarkVisited(
+			DialogueId,
+			MakeArrayView(&SpeakerIds[SpeakerIndex], 1),
+			NumSpeakers + SpeakerIndex
+		);
+	}
+	Store.SpillToColdStore(MaxResidentSpeakers);
+
+	//Records still resident may have older copies in the cold store, so
+	//only those held nowhere else are checked for the second visit
+	TMap<int32, FDialogueSpeakerHistory> Expected;
+	for (int32 SpeakerIndex = 0; SpeakerIndex < NumSpeakers; ++SpeakerIndex)
+	{
+		FDialogueSpeakerHistory Speaker;
+		if (!Store.FindSpeaker(DialogueId, SpeakerIds[SpeakerIndex])
+			&& TestTrue(
+				TEXT("Cold store finds the spilled record"),
+				ColdStore->Find(DialogueId, SpeakerIds[SpeakerIndex], Speaker)
+			))
+		{
+			Expected.Add(SpeakerIndex, MoveTemp(Speaker));
+		}
+	}
+	TestTrue(TEXT("Records are spilled once more"), Expected.Num() > 0);
+	const int64 NumCold = ColdStore->Num();
+
+	Store.SetColdStore(nullptr);
+	ColdStore.Reset();
+
+	TSharedPtr<FDialogueHistoryColdStore> Reopened =
+		MakeShared<FDialogueHistoryColdStore>();
+	if (!TestTrue(
+		TEXT("Cold store reopens"),
+		Reopened->Open(Directory, NumShards)
+	))
+	{
+		return false;
+	}
+
+	TestEqual(
+		TEXT("Reopened store keeps every record"),
+		Reopened->Num(),
+		NumCold
+	);
+	for (const auto& ExpectedEntry : Expected)
+	{
+		const int32 SpeakerIndex = ExpectedEntry.Key;
+		FDialogueSpeakerHistory Speaker;
+		if (!TestTrue(
+			TEXT("Reopened store finds the record"),
+			Reopened->Find(DialogueId, SpeakerIds[SpeakerIndex], Speaker)
+		))
+		{
+			continue;
+		}
+
+		TestEqual(
+			TEXT("Reopened record keeps its visits"),
+			Speaker.VisitedNodes.Num(),
+			ExpectedEntry.Value.VisitedNodes.Num()
+		);
+		TestTrue(
+			TEXT("Reopened record reads the latest generation"),
+			Speaker.VisitedNodes.Contains(NumSpeakers + SpeakerIndex)
+		);
+	}
+
+	//Only the latest generation of each shard is left behind
+	TArray<FString> Found;
+	FileManager.FindFiles(
+		Found,
+		*FPaths::Combine(Directory, TEXT("DialogueHistory_*.shard")),
+		true,
+		false
+	);
+	TestTrue(
+		TEXT("Older generations are deleted"),
+		Found.Num() <= NumShards
+	);
+
+	Reopened.Reset();
+	FileManager.DeleteDirectory(*Directory, false, true);
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
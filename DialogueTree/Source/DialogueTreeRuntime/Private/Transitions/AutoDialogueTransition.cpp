@@ -18,17 +18,17 @@ FText UAutoDialogueTransition::GetNodeCreationTooltip() const
 		" to the first viable option");
 }
 
-void UAutoDialogueTransition::TransitionOut()
+void UAutoDialogueTransition::TransitionOut(UDialogueSession* Session)
 {
 	//Transition to the first linked node 
-	TArray<UDialogueNode*> Children = OwningNode->GetChildren();
-	if (!Children.IsEmpty() && Children[0])
+	const int32 FirstChild = OwningNode->GetChildNodeIndex(0);
+	if (FirstChild != INDEX_NONE)
 	{
-		OwningNode->GetDialogue()->TraverseNode(Children[0]);
+		OwningNode->GetDialogue()->TraverseNodeAt(Session, FirstChild);
 	}
 	else
 	{
 		//No child to transition to, end dialogue
-		OwningNode->GetDialogue()->EndDialogue();
+		OwningNode->GetDialogue()->EndDialogue(Session);
 	}
 }
@@ -7,27 +7,26 @@
 //Plugin
 #include "Dialogue.h"
 #include "DialogueConnectionLimit.h"
+#include "DialogueSession.h"
 #include "DialogueSpeakerComponent.h"
 #include "Nodes/DialogueNode.h"
 #include "Nodes/DialogueSpeechNode.h"
 #include "LogDialogueTree.h"
 
-UDialogueTransition::UDialogueTransition()
-{
-	OnContentEnd.BindUFunction(this, "OnDonePlayingContent");
-	OnTimerEnd.BindUFunction(this, "OnMinPlayTimeElapsed");
-}
-
 void UDialogueTransition::SetOwningNode(UDialogueSpeechNode* InNode)
 {
 	OwningNode = InNode;
 }
 
-void UDialogueTransition::StartTransition()
+void UDialogueTransition::StartTransition(UDialogueSession* Session)
 {
-	//Reset end marker values
-	bMinPlayTimeElapsed = false;
-	bAudioFinished = false;
+	check(Session);
+
+	//The session may have ended while the node was being entered
+	if (!Session->IsActive())
+	{
+		return;
+	}
 
 	//Verify owning node exists
 	if (!OwningNode)
@@ -37,12 +36,12 @@ void UDialogueTransition::StartTransition()
 			Error,
 			TEXT("Transition failed to find owning node. Ending dialogue early."));
 
-		OwningNode->GetDialogue()->EndDialogue();
+		Session->GetDialogue()->EndDialogue(Session);
 		return;
 	}
 
 	//Get speaker
-	UDialogueSpeakerComponent* Speaker = OwningNode->GetSpeaker();
+	UDialogueSpeakerComponent* Speaker = OwningNode->GetSpeaker(Session);
 	if (!Speaker)
 	{
 		UE_LOG(
@@ -50,66 +49,79 @@ void UDialogueTransition::StartTransition()
 			Error, 
 			TEXT("Transition failed to find speaker component. Ending dialogue early."));
 
-		OwningNode->GetDialogue()->EndDialogue();
+		OwningNode->GetDialogue()->EndDialogue(Session);
 		return;
 	}
 
+	//Reset end marker values, keeping any options already gathered
+	FDialogueTransitionState& State = Session->GetTransitionState();
+	State.Transition = this;
+	State.bMinPlayTimeElapsed = false;
+	State.bAudioFinished = false;
+
 	//Set timer for minimum play time
 	float MinPlayTime = OwningNode->GetDetails().MinimumPlayTime;
 
 	if (MinPlayTime > 0.01f)
 	{
-		Speaker->GetWorld()->GetTimerManager().SetTimer(
-			MinPlayTimeHandle,
-			OnTimerEnd,
-			MinPlayTime,
-			false
-		);
+		Session->StartMinPlayTimer(MinPlayTime);
 	}
 	//No minimum time
 	else
 	{
-		bMinPlayTimeElapsed = true;
+		State.bMinPlayTimeElapsed = true;
 	}
 
 	//Start listening to see when the audio content finishes 
 	if (Speaker->IsPlaying())
 	{
-		Speaker->OnAudioFinished.AddUnique(OnContentEnd);
+		Session->ListenForAudioFinished(Speaker);
 	}
 	//No audio playing 
 	else
 	{
-		bAudioFinished = true;
+		State.bAudioFinished = true;
 	}
 
-	//If no minimum time or audio content, just transition out 
-	if (bMinPlayTimeElapsed && bAudioFinished)
+	//If no minimum time, audio content or pending queries, just 
+	//transition out 
+	if (State.bMinPlayTimeElapsed && State.bAudioFinished 
+		&& !Session->HasPendingQueries())
 	{
-		TransitionOut();
+		TransitionOut(Session);
 	}
 }
 
-void UDialogueTransition::Skip()
+void UDialogueTransition::Skip(UDialogueSession* Session)
 {
-	if (!bAudioFinished)
+	if (!IsActiveIn(Session))
 	{
-		OnDonePlayingContent();
+		return;
+	}
+
+	//Finishing the audio may already move the session on, so read the 
+	//state up front
+	UDialogueSpeakerComponent* Speaker = OwningNode->GetSpeaker(Session);
+	const FDialogueTransitionState& State = Session->GetTransitionState();
+	const bool bWasAudioFinished = State.bAudioFinished;
+	const bool bWasMinPlayTimeElapsed = State.bMinPlayTimeElapsed;
+
+	if (!bWasAudioFinished)
+	{
+		OnDonePlayingContent(Session);
 	}
 
-	if (!bMinPlayTimeElapsed)
+	if (!bWasMinPlayTimeElapsed && IsActiveIn(Session))
 	{
-		auto World = OwningNode->GetSpeaker()->GetWorld();
-		if (ensure(World))
-			GetWorld()->GetTimerManager().ClearTimer(MinPlayTimeHandle);
-		
-		OnMinPlayTimeElapsed();
+		Session->ClearMinPlayTimer();
+		OnMinPlayTimeElapsed(Session);
 	}
 
 	//Let the speaker know we are skipping its speech
-	OwningNode->GetSpeaker()->BroadcastSpeechSkipped(
-		OwningNode->GetDetails()
-	);
+	if (Speaker)
+	{
+		Speaker->BroadcastSpeechSkipped(OwningNode->GetDetails());
+	}
 }
 
 FText UDialogueTransition::GetDisplayName() const
@@ -127,37 +139,62 @@ EDialogueConnectionLimit UDialogueTransition::GetConnectionLimit() const
 	return EDialogueConnectionLimit::Single;
 }
 
-void UDialogueTransition::CheckTransitionConditions()
+void UDialogueTransition::CheckTransitionConditions(UDialogueSession* Session)
 {
-	if (bAudioFinished && bMinPlayTimeElapsed && !OwningNode->GetIsBlocking())
+	if (!IsActiveIn(Session))
 	{
-		TransitionOut();
+		return;
+	}
+
+	const FDialogueTransitionState& State = Session->GetTransitionState();
+	if (State.bAudioFinished && State.bMinPlayTimeElapsed 
+		&& !OwningNode->GetIsBlocking(Session)
+		&& !Session->HasPendingQueries())
+	{
+		TransitionOut(Session);
 	}
 }
 
-void UDialogueTransition::OnDonePlayingContent()
+void UDialogueTransition::OnDonePlayingContent(UDialogueSession* Session)
 {
+	if (!IsActiveIn(Session))
+	{
+		return;
+	}
+
 	//Unbind from audio event 
-	UDialogueSpeakerComponent* Speaker = OwningNode->GetSpeaker();
+	Session->StopListeningForAudio();
 
+	UDialogueSpeakerComponent* Speaker = OwningNode->GetSpeaker(Session);
 	if (Speaker)
 	{
 		Speaker->Stop();
-		Speaker->OnAudioFinished.Remove(OnContentEnd);
 	}
 
 	//Mark audio complete
-	bAudioFinished = true;
+	Session->GetTransitionState().bAudioFinished = true;
 
 	//See if we should transition out
-	CheckTransitionConditions();
+	CheckTransitionConditions(Session);
 }
 
-void UDialogueTransition::OnMinPlayTimeElapsed()
+void UDialogueTransition::OnMinPlayTimeElapsed(UDialogueSession* Session)
 {
+	if (!IsActiveIn(Session))
+	{
+		return;
+	}
+
 	//Mark min play time elapsed
-	bMinPlayTimeElapsed = true;
+	Session->GetTransitionState().bMinPlayTimeElapsed = true;
 
 	//Check if we should transition out
-	CheckTransitionConditions();
+	CheckTransitionConditions(Session);
+}
+
+bool UDialogueTransition::IsActiveIn(const UDialogueSession* Session) const
+{
+	return Session && Session->IsActive() 
+		&& Session->GetActiveNode() == OwningNode
+		&& Session->GetTransitionState().Transition == this;
 }
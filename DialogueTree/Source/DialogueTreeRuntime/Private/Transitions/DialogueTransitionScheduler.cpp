@@ -0,0 +1,284 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+//Header
+#include "Transitions/DialogueTransitionScheduler.h"
+//Plugin
+#include "DialogueSession.h"
+#include "DialogueSpeakerComponent.h"
+
+namespace
+{
+	/** Heap size below which stale entries are never worth compacting */
+	constexpr int32 MinHeapCompactSize = 32;
+}
+
+void FDialogueTransitionScheduler::ScheduleMinPlayTime(
+	UDialogueSession* Session, float Duration)
+{
+	check(Session);
+
+	const TObjectKey<UDialogueSession> Key(Session);
+	FPendingTransition& Entry = Pending.FindOrAdd(Key);
+	Entry.Session = Session;
+
+	StopDeadline(Entry);
+	Entry.bHasDeadline = true;
+	Entry.Remaining = FMath::Max(Duration, 0.f);
+	StartDeadline(Key, Entry);
+}
+
+void FDialogueTransitionScheduler::CancelMinPlayTime(
+	const UDialogueSession* Session)
+{
+	const TObjectKey<UDialogueSession> Key(Session);
+	FPendingTransition* Entry = Pending.Find(Key);
+	if (!Entry)
+	{
+		return;
+	}
+
+	Entry->bRunning = false;
+	Entry->bHasDeadline = false;
+	RemoveIfIdle(Key);
+}
+
+void FDialogueTransitionScheduler::WaitForAudio(UDialogueSession* Session,
+	const UDialogueSpeakerComponent* Speaker)
+{
+	check(Session && Speaker);
+
+	StopWaitingForAudio(Session);
+
+	const TObjectKey<UDialogueSession> Key(Session);
+	FPendingTransition& Entry = Pending.FindOrAdd(Key);
+	Entry.Session = Session;
+	Entry.AudioSpeaker = Speaker;
+	Entry.bWaitingForAudio = true;
+	Entry.bAudioFinished = false;
+
+	AudioWaiters.Add(Speaker, Key);
+}
+
+void FDialogueTransitionScheduler::StopWaitingForAudio(
+	const UDialogueSession* Session)
+{
+	ReleaseAudioWaiter(TObjectKey<UDialogueSession>(Session));
+}
+
+void FDialogueTransitionScheduler::NotifyAudioFinished(
+	const UDialogueSpeakerComponent* Speaker)
+{
+	const TObjectKey<UDialogueSession>* Key = AudioWaiters.Find(Speaker);
+	if (!Key)
+	{
+		return;
+	}
+
+	FPendingTransition* Entry = Pending.Find(*Key);
+	if (Entry && Entry->bWaitingForAudio && !Entry->bAudioFinished)
+	{
+		Entry->bAudioFinished = true;
+		FinishedAudio.Add(*Key);
+	}
+}
+
+void FDialogueTransitionScheduler::RefreshClock(UDialogueSession* Session)
+{
+	check(Session);
+
+	const TObjectKey<UDialogueSession> Key(Session);
+	FPendingTransition* Entry = Pending.Find(Key);
+	if (!Entry)
+	{
+		return;
+	}
+
+	StopDeadline(*Entry);
+	StartDeadline(Key, *Entry);
+
+	//Audio that finished while paused is heard on resume
+	if (Entry->bAudioFinished && !Session->IsPaused())
+	{
+		FinishedAudio.AddUnique(Key);
+	}
+}
+
+void FDialogueTransitionScheduler::Tick(float DeltaTime)
+{
+	Now += DeltaTime;
+
+	if (Pending.IsEmpty())
+	{
+		return;
+	}
+
+	//Gather everything due before notifying anyone, as sessions schedule
+	//their next transition while being notified
+	TArray<TWeakObjectPtr<UDialogueSession>, TInlineAllocator<8>> AudioDone;
+	TArray<TWeakObjectPtr<UDialogueSession>, TInlineAllocator<8>> TimeDone;
+
+	TArray<TObjectKey<UDialogueSession>> Finished = MoveTemp(FinishedAudio);
+	FinishedAudio.Reset();
+	for (const TObjectKey<UDialogueSession>& Key : Finished)
+	{
+		FPendingTransition* Entry = Pending.Find(Key);
+		if (!Entry || !Entry->bAudioFinished)
+		{
+			continue;
+		}
+
+		//Held until the session resumes
+		const UDialogueSession* Session = Entry->Session.Get();
+		if (Session && Session->IsPaused())
+		{
+			continue;
+		}
+
+		AudioDone.Add(Entry->Session);
+		ReleaseAudioWaiter(Key);
+	}
+
+	while (!Heap.IsEmpty() && Heap.HeapTop().Deadline <= Now)
+	{
+		FHeapEntry Top;
+		Heap.HeapPop(Top, EAllowShrinking::No);
+
+		//Skip deadlines that were since moved or cancelled
+		FPendingTransition* Entry = Pending.Find(Top.Session);
+		if (!Entry || !Entry->bRunning || Entry->Serial != Top.Serial)
+		{
+			continue;
+		}
+
+		TimeDone.Add(Entry->Session);
+		Entry->bRunning = false;
+		Entry->bHasDeadline = false;
+		Entry->Remaining = 0.0;
+		RemoveIfIdle(Top.Session);
+	}
+
+	for (const TWeakObjectPtr<UDialogueSession>& Session : AudioDone)
+	{
+		if (Session.IsValid())
+		{
+			Session->OnSpeechAudioFinished();
+		}
+	}
+
+	for (const TWeakObjectPtr<UDialogueSession>& Session : TimeDone)
+	{
+		if (Session.IsValid())
+		{
+			Session->OnMinPlayTimeElapsed();
+		}
+	}
+}
+
+void FDialogueTransitionScheduler::ForgetSession(
+	const UDialogueSession* Session)
+{
+	const TObjectKey<UDialogueSession> Key(Session);
+	ReleaseAudioWaiter(Key);
+	Pending.Remove(Key);
+	FinishedAudio.Remove(Key);
+}
+
+void FDialogueTransitionScheduler::Reset()
+{
+	Pending.Empty();
+	Heap.Empty();
+	AudioWaiters.Empty();
+	FinishedAudio.Empty();
+	Now = 0.0;
+}
+
+void FDialogueTransitionScheduler::StartDeadline(
+	TObjectKey<UDialogueSession> Key, FPendingTransition& Entry)
+{
+	Entry.bRunning = false;
+
+	const UDialogueSession* Session = Entry.Session.Get();
+	if (!Entry.bHasDeadline || !Session || Session->IsPaused())
+	{
+		return;
+	}
+
+	//A stopped clock holds the deadline just like a pause
+	const double Dilation = Session->GetTimeDilation();
+	if (Dilation <= UE_KINDA_SMALL_NUMBER)
+	{
+		return;
+	}
+
+	Entry.Dilation = Dilation;
+	Entry.Deadline = Now + Entry.Remaining / Dilation;
+	Entry.Serial = ++NextSerial;
+	Entry.bRunning = true;
+
+	Heap.HeapPush(FHeapEntry{ Entry.Deadline, Key, Entry.Serial });
+	CompactHeap();
+}
+
+void FDialogueTransitionScheduler::StopDeadline(FPendingTransition& Entry)
+{
+	if (!Entry.bRunning)
+	{
+		return;
+	}
+
+	Entry.Remaining = FMath::Max((Entry.Deadline - Now) * Entry.Dilation, 0.0);
+	Entry.bRunning = false;
+}
+
+void FDialogueTransitionScheduler::ReleaseAudioWaiter(
+	TObjectKey<UDialogueSession> Key)
+{
+	FPendingTransition* Entry = Pending.Find(Key);
+	if (!Entry || !Entry->bWaitingForAudio)
+	{
+		return;
+	}
+
+	//The speaker may have been handed to another session since
+	const TObjectKey<UDialogueSession>* Waiter =
+		AudioWaiters.Find(Entry->AudioSpeaker);
+	if (Waiter && *Waiter == Key)
+	{
+		AudioWaiters.Remove(Entry->AudioSpeaker);
+	}
+
+	Entry->AudioSpeaker = TObjectKey<UDialogueSpeakerComponent>();
+	Entry->bWaitingForAudio = false;
+	Entry->bAudioFinished = false;
+	RemoveIfIdle(Key);
+}
+
+void FDialogueTransitionScheduler::RemoveIfIdle(
+	TObjectKey<UDialogueSession> Key)
+{
+	const FPendingTransition* Entry = Pending.Find(Key);
+	if (Entry && !Entry->bHasDeadline && !Entry->bWaitingForAudio)
+	{
+		Pending.Remove(Key);
+	}
+}
+
+void FDialogueTransitionScheduler::CompactHeap()
+{
+	//Every live entry belongs to a pending session, so a heap this much
+	//larger than the pending set is mostly stale
+	if (Heap.Num() < MinHeapCompactSize || Heap.Num() < Pending.Num() * 2)
+	{
+		return;
+	}
+
+	Heap.RemoveAllSwap(
+		[this](const FHeapEntry& HeapEntry)
+		{
+			const FPendingTransition* Entry = Pending.Find(HeapEntry.Session);
+			return !Entry || !Entry->bRunning
+				|| Entry->Serial != HeapEntry.Serial;
+		}
+	);
+	Heap.Heapify();
+}
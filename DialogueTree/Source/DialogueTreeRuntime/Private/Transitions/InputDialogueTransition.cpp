@@ -4,6 +4,7 @@
 #include "Transitions/InputDialogueTransition.h"
 //Plugin
 #include "Dialogue.h"
+#include "DialogueSession.h"
 #include "DialogueSpeakerComponent.h"
 #include "Nodes/DialogueNode.h"
 #include "Nodes/DialogueSpeechNode.h"
@@ -11,29 +12,32 @@
 
 #define LOCTEXT_NAMESPACE "InputDialogueTransition"
 
-void UInputDialogueTransition::StartTransition()
+void UInputDialogueTransition::StartTransition(UDialogueSession* Session)
 {
-	//Get any options
-	GetOptions();
-
-	//If the node is skippable, show options now
-	if (OwningNode->GetCanSkip())
+	//Get any options, once any async queries they read have resolved
+	if (!IssueOptionQueries(Session))
 	{
-		ShowOptions();
+		GetOptions(Session);
+
+		//If the node is skippable, show options now
+		if (OwningNode->GetCanSkip())
+		{
+			ShowOptions(Session);
+		}
 	}
 
-	Super::StartTransition();
+	Super::StartTransition(Session);
 }
 
-void UInputDialogueTransition::TransitionOut()
+void UInputDialogueTransition::TransitionOut(UDialogueSession* Session)
 {
-	Super::TransitionOut();
+	Super::TransitionOut(Session);
 
 	//If there are no options to transition to, end dialogue
-	if (Options.IsEmpty())
+	if (Session->GetTransitionState().Options.IsEmpty())
 	{
 		//If there is a child to transition to, pick it
-		if (!OwningNode->GetChildren().IsEmpty())
+		if (OwningNode->GetNumChildren() > 0)
 		{
 			UE_LOG(
 				LogDialogueTree,
@@ -42,19 +46,27 @@ void UInputDialogueTransition::TransitionOut()
 			);
 		}
 
-		OwningNode->GetDialogue()->EndDialogue();
+		OwningNode->GetDialogue()->EndDialogue(Session);
 		return;
 	}
 	//If the node is not skippable, display options now 
 	else if (!OwningNode->GetCanSkip())
 	{
-		ShowOptions();
+		ShowOptions(Session);
 	}
 }
 
-void UInputDialogueTransition::SelectOption(int32 InOptionIndex)
+void UInputDialogueTransition::SelectOption(UDialogueSession* Session, 
+	int32 InOptionIndex)
 {
+	if (!Session || !Session->IsActive())
+	{
+		return;
+	}
+
 	//End the dialogue if fed a bad index
+	const TArray<FDialogueOption>& Options = 
+		Session->GetTransitionState().Options;
 	if (!Options.IsValidIndex(InOptionIndex))
 	{
 		UE_LOG(
@@ -66,21 +78,24 @@ void UInputDialogueTransition::SelectOption(int32 InOptionIndex)
 	}
 
 	//If option locked, do nothing more
-	if (Options[InOptionIndex].Details.bIsLocked)
+	if (Options[InOptionIndex].IsLocked())
 	{
 		return;
 	}
 
 	//Stop playing audio 
-	UDialogueSpeakerComponent* Speaker = OwningNode->GetSpeaker();
+	UDialogueSpeakerComponent* Speaker = OwningNode->GetSpeaker(Session);
 	if (Speaker)
 	{
 		Speaker->Stop();
 	}
 
+	//Resolve the chosen option's branches and locks as they were shown
+	Session->GetQueryCache().HoldStep();
+
 	//Transition to the selected node 
 	UDialogueNode* Selected = Options[InOptionIndex].TargetNode;
-	OwningNode->GetDialogue()->TraverseNode(Selected);
+	OwningNode->GetDialogue()->TraverseNode(Session, Selected);
 }
 
 FText UInputDialogueTransition::GetDisplayName() const
@@ -102,31 +117,106 @@ EDialogueConnectionLimit UInputDialogueTransition::GetConnectionLimit() const
 	return EDialogueConnectionLimit::Unlimited;
 }
 
-void UInputDialogueTransition::ShowOptions()
+void UInputDialogueTransition::ShowOptions(UDialogueSession* Session) const
 {
 	//If valid options, display them 
+	const TArray<FDialogueOption>& Options = 
+		Session->GetTransitionState().Options;
 	if (!Options.IsEmpty())
 	{
-		OwningNode->GetDialogue()->DisplayOptions(Options);
+		OwningNode->GetDialogue()->DisplayOptions(Session, Options);
 	}
 }
 
-void UInputDialogueTransition::GetOptions()
+void UInputDialogueTransition::GetOptions(UDialogueSession* Session) const
 {
 	//Retrieve all valid options 
-	Options.Empty();
-	TArray<UDialogueNode*> NodeChildren = OwningNode->GetChildren();
+	TArray<FDialogueOption>& Options = Session->GetTransitionState().Options;
+	Options.Reset();
+
+	//Run each child's compiled option program
+	const UDialogue* Dialogue = OwningNode->GetDialogue();
+	const FDialogueNodeTable& Table = Dialogue->GetNodeTable();
+	const int32 OwnerIndex = OwningNode->GetNodeIndex();
+	if (Table.IsValidIndex(OwnerIndex))
+	{
+		FDialogueOption NodeOption;
+		for (int32 ChildIndex : Table.GetChildren(OwnerIndex))
+		{
+			if (Dialogue->ResolveOption(Session, ChildIndex, NodeOption))
+			{
+				Options.Add(MoveTemp(NodeOption));
+			}
+		}
+		return;
+	}
 
-	for (UDialogueNode* Node : NodeChildren)
+	//No node table; ask each child directly
+	const int32 NumChildren = OwningNode->GetNumChildren();
+	for (int32 ChildIndex = 0; ChildIndex < NumChildren; ++ChildIndex)
 	{
-		FDialogueOption NodeOption = Node->GetAsOption();
+		UDialogueNode* Node = OwningNode->GetChild(ChildIndex);
+		if (!Node)
+		{
+			continue;
+		}
+
+		FDialogueOption NodeOption = Node->GetAsOption(Session);
 
 		//If a valid option
-		if (!NodeOption.Details.SpeechVariations.IsEmpty() && NodeOption.TargetNode)
+		if (NodeOption.IsValid())
 		{
-			Options.Add(NodeOption);
+			Options.Add(MoveTemp(NodeOption));
 		}
 	}
 }
 
+bool UInputDialogueTransition::IssueOptionQueries(UDialogueSession* Session)
+{
+	const UDialogue* Dialogue = OwningNode->GetDialogue();
+	const FDialogueNodeTable& Table = Dialogue->GetNodeTable();
+	const int32 OwnerIndex = OwningNode->GetNodeIndex();
+	if (!Table.IsValidIndex(OwnerIndex))
+	{
+		return false;
+	}
+
+	TArray<UDialogueQuery*> Queries;
+	for (int32 ChildIndex : Table.GetChildren(OwnerIndex))
+	{
+		Dialogue->GetOptionQueries(ChildIndex, Queries);
+	}
+
+	return Session->IssueAsyncQueries(
+		Queries,
+		FSimpleDelegate::CreateUObject(
+			this,
+			&UInputDialogueTransition::OnOptionQueriesResolved,
+			TWeakObjectPtr<UDialogueSession>(Session)
+		)
+	);
+}
+
+void UInputDialogueTransition::OnOptionQueriesResolved(
+	TWeakObjectPtr<UDialogueSession> WeakSession)
+{
+	//Ignore queries that resolve after the session has moved on
+	UDialogueSession* Session = WeakSession.Get();
+	if (!IsActiveIn(Session))
+	{
+		return;
+	}
+
+	GetOptions(Session);
+
+	//If the node is skippable, show options now
+	if (OwningNode->GetCanSkip())
+	{
+		ShowOptions(Session);
+	}
+
+	//The speech may already be done and waiting on the options
+	CheckTransitionConditions(Session);
+}
+
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,139 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+#pragma once
+
+//UE
+#include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+
+class UDialogueSession;
+class USoundCue;
+
+/**
+* Streams speech audio in ahead of the nodes that play it, and releases the
+* least recently used audio once over a memory budget. Owned by the dialogue
+* manager subsystem, one per world.
+*/
+class DIALOGUETREERUNTIME_API FDialogueAudioStreamer
+{
+public:
+	/** Destructor. Cancels any loads still in flight. */
+	~FDialogueAudioStreamer();
+
+	/**
+	* Starts streaming in the audio of every speech within the given number
+	* of hops of the session's active node, following children, jumps and
+	* branches through the dialogue's node table. Audio near the active node
+	* is kept resident until the session moves on.
+	*
+	* @param Session - const UDialogueSession*, the session.
+	* @param Depth - int32, how many hops ahead to look.
+	*/
+	void PrefetchForSession(const UDialogueSession* Session, int32 Depth);
+
+	/**
+	* Requests a single clip, marking it as recently used.
+	*
+	* @param Audio - const TSoftObjectPtr<USoundCue>&, the clip.
+	* @return TSharedPtr<FStreamableHandle>, the handle to wait on. Invalid
+	* if the clip is null.
+	*/
+	TSharedPtr<FStreamableHandle> RequestAudio(
+		const TSoftObjectPtr<USoundCue>& Audio);
+
+	/**
+	* Stops keeping a session's audio resident. Its audio becomes eligible
+	* for release.
+	*
+	* @param Session - const UDialogueSession*, the session.
+	*/
+	void ForgetSession(const UDialogueSession* Session);
+
+	/**
+	* Sets the memory budget for resident audio.
+	*
+	* @param InBudgetBytes - int64, the budget. 0 for no limit.
+	*/
+	void SetBudget(int64 InBudgetBytes);
+
+	/**
+	* Retrieves the estimated memory held by loaded audio.
+	*
+	* @return int64, bytes.
+	*/
+	int64 GetResidentBytes() const;
+
+	/**
+	* Cancels every load and releases all audio.
+	*/
+	void Reset();
+
+private:
+	/**
+	* Struct holding a single requested clip.
+	*/
+	struct FAudioEntry
+	{
+		/** Keeps the clip loaded */
+		TSharedPtr<FStreamableHandle> Handle;
+
+		/** Value of UseSerial when the clip was last requested */
+		uint64 LastUse = 0;
+
+		/** Estimated memory held by the clip. INDEX_NONE until loaded. */
+		int64 SizeBytes = INDEX_NONE;
+	};
+
+	/**
+	* Requests the clip at the given path, marking it as recently used.
+	*
+	* @param Path - const FSoftObjectPath&, the clip.
+	* @return FAudioEntry&, the clip's entry.
+	*/
+	FAudioEntry& Request(const FSoftObjectPath& Path);
+
+	/**
+	* Records a clip's size once it has loaded.
+	*
+	* @param Path - FSoftObjectPath, the clip.
+	*/
+	void OnAudioLoaded(FSoftObjectPath Path);
+
+	/**
+	* Releases the least recently used clips until back under budget.
+	* Clips near a playing node are never released.
+	*/
+	void Trim();
+
+	/**
+	* Estimates the memory a loaded clip holds, including its sound waves.
+	*
+	* @param Cue - USoundCue*, the clip.
+	* @return int64, bytes.
+	*/
+	static int64 GetAudioSize(USoundCue* Cue);
+
+private:
+	/** Loads the clips */
+	FStreamableManager StreamableManager;
+
+	/** Every requested clip, keyed by path */
+	TMap<FSoftObjectPath, FAudioEntry> Entries;
+
+	/** The clips near each session's active node */
+	TMap<TWeakObjectPtr<const UDialogueSession>, TArray<FSoftObjectPath>>
+		SessionWindows;
+
+	/** Bumped on every request, to order clips by use */
+	uint64 UseSerial = 0;
+
+	/** Estimated memory held by loaded clips */
+	int64 ResidentBytes = 0;
+
+	/** Memory loaded clips may hold. 0 for no limit. */
+	int64 BudgetBytes = 0;
+
+	/** True while requesting, so that loads completing straight away do
+	* not trim the entries being requested */
+	bool bRequesting = false;
+};
@@ -9,7 +9,9 @@
 #include "DialogueCondition.generated.h"
 
 class UDialogue;
+class UDialogueNode;
 class UDialogueQuery;
+class UDialogueSession;
 
 /**
 * Abstract base class of dialogue conditions. 
@@ -42,11 +44,37 @@ public:
 	virtual void SetDialogue(UDialogue* InDialogue);
 
 	/**
-	* Determines if the condition is met or not
+	* Determines if the condition is met or not for the given session
 	* 
+	* @param Session - UDialogueSession*, the session to evaluate for.
 	* @return true if the condition is met, false otherwise
 	*/
-	virtual bool IsMet() const;
+	virtual bool IsMet(UDialogueSession* Session) const;
+
+	/**
+	* Checks if the condition is met for the given session, recording the 
+	* outcome in the query profile if enabled.
+	* 
+	* @param Session - UDialogueSession*, the session to evaluate for.
+	* @param Owner - const UDialogueNode*, the node owning the condition.
+	* @return true if the condition is met, false otherwise
+	*/
+	bool Evaluate(UDialogueSession* Session, const UDialogueNode* Owner) const;
+
+	/**
+	* Sets the condition's position in its set as authored, before any 
+	* reordering.
+	* 
+	* @param InIndex - int32, the authored position.
+	*/
+	void SetSourceIndex(int32 InIndex);
+
+	/**
+	* Retrieves the condition's position in its set as authored.
+	* 
+	* @return int32, the authored position. INDEX_NONE if never set.
+	*/
+	int32 GetSourceIndex() const;
 
 	/**
 	* Assembles the display text for the condition
@@ -73,4 +101,9 @@ public:
 	* otherwise.
 	*/
 	virtual bool IsValidCondition();
+
+private:
+	/** The condition's position in its set as authored */
+	UPROPERTY()
+	int32 SourceIndex = INDEX_NONE;
 };
@@ -25,7 +25,7 @@ public:
 	/***/
 
 	/** UDialogueCondition Impl. */
-	virtual bool IsMet() const override;
+	virtual bool IsMet(UDialogueSession* Session) const override;
 	virtual void SetQuery(UDialogueQuery* InQuery) override;
 	virtual void SetDialogue(UDialogue* InDialogue) override;
 	virtual FText GetDisplayText(const TMap<FName, FText>& ArgTexts,
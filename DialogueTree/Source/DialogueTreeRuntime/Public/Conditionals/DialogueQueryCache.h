@@ -0,0 +1,98 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+#pragma once
+
+//UE
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "UObject/ObjectKey.h"
+
+class UDialogueQuery;
+
+/**
+* Per-session store of query results. Results are tagged with the step they
+* were evaluated in and the session's invalidation epoch, and are reused 
+* for as long as the query's cache policy allows. A step lasts from the 
+* moment the session stops waiting until it next waits; selecting one of
+* the options a step displayed continues that step, so the branch an option
+* was shown through resolves the same way when the option is chosen.
+*/
+class DIALOGUETREERUNTIME_API FDialogueQueryCache
+{
+public:
+	/**
+	* Finds a still valid result for the given query.
+	*
+	* @param Query - const UDialogueQuery*, the query.
+	* @param HistorySerial - uint32, the current history counter, for 
+	* queries that read the visit history. 0 otherwise.
+	* @param OutValue - double&, the result.
+	* @return bool - True if found.
+	*/
+	bool Find(const UDialogueQuery* Query, uint32 HistorySerial,
+		double& OutValue) const;
+
+	/**
+	* Stores a result for the given query.
+	*
+	* @param Query - const UDialogueQuery*, the query.
+	* @param HistorySerial - uint32, the current history counter, for 
+	* queries that read the visit history. 0 otherwise.
+	* @param Value - double, the result.
+	*/
+	void Add(const UDialogueQuery* Query, uint32 HistorySerial, 
+		double Value);
+
+	/**
+	* Starts a new step, expiring step results, unless the step was held.
+	*/
+	void BeginStep();
+
+	/**
+	* Makes the next call to BeginStep continue the current step.
+	*/
+	void HoldStep();
+
+	/**
+	* Drops every cached result.
+	*/
+	void Invalidate();
+
+	/**
+	* Drops the results of every query depending on the given tag.
+	*
+	* @param Dependency - const FGameplayTag&, the changed state.
+	*/
+	void Invalidate(const FGameplayTag& Dependency);
+
+private:
+	/**
+	* Struct holding a single cached result.
+	*/
+	struct FEntry
+	{
+		/** The query's result */
+		double Value = 0.0;
+
+		/** The step the result was evaluated in */
+		uint32 Step = 0;
+
+		/** The invalidation epoch the result was evaluated in */
+		uint32 Epoch = 0;
+
+		/** The history counter the result was evaluated with */
+		uint32 HistorySerial = 0;
+	};
+
+	/** Results keyed by query */
+	TMap<TObjectKey<UDialogueQuery>, FEntry> Entries;
+
+	/** The current step */
+	uint32 Step = 0;
+
+	/** Bumped whenever every result is dropped */
+	uint32 Epoch = 0;
+
+	/** Whether the next BeginStep continues the current step */
+	bool bHoldStep = false;
+};
@@ -0,0 +1,191 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+#pragma once
+
+//UE
+#include "Algo/StableSort.h"
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class UDialogueCondition;
+class UDialogueNode;
+class UDialogueQuery;
+
+/**
+* Process-wide record of how long each query class takes to run and how
+* often each condition passes. Used to order condition sets when dialogues
+* compile, so that the conditions most likely to settle a set cheaply are
+* checked first. Recording is toggled by DialogueTree.ProfileQueries, and
+* the measured costs are logged by DialogueTree.DumpQueryCosts.
+*/
+class DIALOGUETREERUNTIME_API FDialogueQueryProfile
+{
+public:
+	/**
+	* Times a single run of a query, recording it on destruction if
+	* profiling is enabled.
+	*/
+	class DIALOGUETREERUNTIME_API FScopedQueryTimer
+	{
+	public:
+		/** Constructor */
+		explicit FScopedQueryTimer(const UDialogueQuery* InQuery);
+
+		/** Destructor */
+		~FScopedQueryTimer();
+
+	private:
+		/** The query being timed. Nullptr if not recording. */
+		const UDialogueQuery* Query = nullptr;
+
+		/** Cycle count at the start of the run */
+		uint64 StartCycles = 0;
+	};
+
+	/**
+	* Retrieves the profile.
+	*
+	* @return FDialogueQueryProfile&, the profile.
+	*/
+	static FDialogueQueryProfile& Get();
+
+	/**
+	* Checks if queries and conditions should currently be recorded.
+	*
+	* @return bool - True if profiling is enabled.
+	*/
+	static bool IsEnabled();
+
+	/**
+	* Records a single run of a query.
+	*
+	* @param Query - const UDialogueQuery*, the query.
+	* @param Cycles - uint64, how long the run took in cycles.
+	*/
+	void RecordQuery(const UDialogueQuery* Query, uint64 Cycles);
+
+	/**
+	* Records the outcome of checking a condition.
+	*
+	* @param Node - const UDialogueNode*, the node owning the condition.
+	* @param SourceIndex - int32, the condition's authored position.
+	* @param bPassed - bool, whether the condition was met.
+	*/
+	void RecordCondition(const UDialogueNode* Node, int32 SourceIndex,
+		bool bPassed);
+
+	/**
+	* Retrieves how often a condition has been met.
+	*
+	* @param Node - const UDialogueNode*, the node owning the condition.
+	* @param SourceIndex - int32, the condition's authored position.
+	* @return float, the pass rate. 0.5 if never recorded.
+	*/
+	float GetPassRate(const UDialogueNode* Node, int32 SourceIndex) const;
+
+	/**
+	* Sorts a node's conditions by their expected cost over the chance of
+	* settling the set, cheapest first. Keeps authored order for ties, 
+	* however often the conditions are sorted, and does nothing if 
+	* reordering is turned off in the project settings.
+	*
+	* @param Node - const UDialogueNode*, the node owning the conditions.
+	* @param bIfAny - bool, whether any passing condition settles the set,
+	* rather than any failing one.
+	* @param Conditions - TArray<ConditionType>&, the conditions, held as 
+	* raw or object pointers, with their authored positions set.
+	*/
+	template<typename ConditionType>
+	void SortConditions(const UDialogueNode* Node, bool bIfAny,
+		TArray<ConditionType>& Conditions) const
+	{
+		if (!ShouldReorderConditions())
+		{
+			return;
+		}
+
+		//Start over from authored order, so that ties do not keep the 
+		//order of an earlier sort
+		Algo::StableSortBy(
+			Conditions,
+			[](const ConditionType& Condition)
+			{
+				return Condition->GetSourceIndex();
+			}
+		);
+
+		Algo::StableSortBy(
+			Conditions,
+			[this, Node, bIfAny](const ConditionType& Condition)
+			{
+				return GetConditionScore(Node, Condition, bIfAny);
+			}
+		);
+	}
+
+	/**
+	* Logs the measured cost of every query class, slowest overall first.
+	*
+	* @param Ar - FOutputDevice&, the device to log to.
+	*/
+	void Dump(FOutputDevice& Ar) const;
+
+	/**
+	* Forgets everything recorded so far.
+	*/
+	void Reset();
+
+private:
+	/**
+	* Checks if reordering is turned on in the project settings.
+	*
+	* @return bool - True if conditions should be reordered.
+	*/
+	static bool ShouldReorderConditions();
+
+	/**
+	* Scores a condition for sorting. Lower scores are checked first.
+	*
+	* @param Node - const UDialogueNode*, the node owning the condition.
+	* @param Condition - const UDialogueCondition*, the condition.
+	* @param bIfAny - bool, whether a pass settles the set.
+	* @return float, the score.
+	*/
+	float GetConditionScore(const UDialogueNode* Node,
+		const UDialogueCondition* Condition, bool bIfAny) const;
+
+private:
+	/**
+	* Struct holding the recorded runs of a query class.
+	*/
+	struct FQueryStats
+	{
+		/** Number of runs */
+		int64 NumRuns = 0;
+
+		/** Total time spent in cycles */
+		uint64 TotalCycles = 0;
+
+		/** Longest single run in cycles */
+		uint64 MaxCycles = 0;
+	};
+
+	/**
+	* Struct holding the recorded outcomes of a condition.
+	*/
+	struct FConditionStats
+	{
+		/** Number of times checked */
+		int32 NumChecks = 0;
+
+		/** Number of times met */
+		int32 NumPasses = 0;
+	};
+
+	/** Runs keyed by query class */
+	TMap<TObjectKey<UClass>, FQueryStats> QueryStats;
+
+	/** Outcomes keyed by owning node and authored position */
+	TMap<TPair<TObjectKey<UDialogueNode>, int32>, FConditionStats>
+		ConditionStats;
+};
@@ -4,11 +4,35 @@
 
 //UE
 #include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
 #include "UObject/NoExportTypes.h"
 //Generated
 #include "DialogueQuery.generated.h"
 
 class UDialogue;
+class UDialogueSession;
+
+/**
+* Delegate used to hand back the result of an async query. Must be executed
+* on the game thread.
+*/
+DECLARE_DELEGATE_OneParam(FDialogueQueryResultSignature, double);
+
+/**
+* Enum naming how long a session may reuse a query's result.
+*/
+UENUM()
+enum class EDialogueQueryCachePolicy : uint8
+{
+	/** Run the query every time it is evaluated */
+	Never,
+	/** Reuse the result until the session moves on from the node it was
+	* evaluated at, or an event plays */
+	Step,
+	/** Reuse the result until the session's speakers change, an event 
+	* plays, or one of the query's dependencies is invalidated */
+	UntilInvalidated
+};
 
 /**
 * Abstract base class for all dialogue queries. 
@@ -51,6 +75,125 @@ public:
 	*/
 	virtual bool IsValidQuery() const;
 
+	/**
+	* Retrieves how long a session may reuse the query's result.
+	*
+	* @return EDialogueQueryCachePolicy, the policy.
+	*/
+	EDialogueQueryCachePolicy GetCachePolicy() const;
+
+	/**
+	* Retrieves the external state the query's result depends on. Cached 
+	* results are dropped when any of these is invalidated through the 
+	* dialogue manager.
+	*
+	* @return const FGameplayTagContainer&, the dependencies.
+	*/
+	const FGameplayTagContainer& GetDependencies() const;
+
+	/**
+	* Checks if the query reads the node visit history, in which case its
+	* cached results are dropped whenever the history changes.
+	*
+	* @return bool - True if the result depends on the history.
+	*/
+	virtual bool DependsOnHistory() const;
+
+	/**
+	* Retrieves how expensive the query is to run compared to others. Used
+	* to order condition sets so that cheap conditions are checked first.
+	*
+	* @return float, the relative cost.
+	*/
+	float GetRelativeCost() const;
+
+	/**
+	* Checks if the query runs asynchronously. Async queries are issued 
+	* ahead of time by the branches and options that read them, and the 
+	* dialogue waits for their results.
+	*
+	* @return bool - True if the query runs asynchronously.
+	*/
+	virtual bool IsAsyncQuery() const;
+
+	/**
+	* Starts the query, handing its result back through the given delegate 
+	* once known. Async queries override this; by default the query runs 
+	* synchronously and resolves straight away.
+	*
+	* @param Session - UDialogueSession*, the session to query for.
+	* @param OnResolved - FDialogueQueryResultSignature, called with the 
+	* result, converted to a double.
+	*/
+	virtual void ExecuteQueryAsync(UDialogueSession* Session,
+		FDialogueQueryResultSignature OnResolved);
+
+	/**
+	* Retrieves how long the dialogue waits for an async query before 
+	* falling back to its timeout result.
+	*
+	* @return float, the timeout in seconds.
+	*/
+	float GetAsyncTimeout() const;
+
+	/**
+	* Retrieves the result used when an async query times out, converted 
+	* to a double.
+	*
+	* @return double, the timeout result.
+	*/
+	virtual double GetTimeoutResult() const;
+
+	/**
+	* Checks if the session already has a result for this query, either 
+	* cached or resolved asynchronously.
+	*
+	* @param Session - UDialogueSession*, the session evaluating the query.
+	* @return bool - True if a valid result was found.
+	*/
+	bool HasCachedResult(UDialogueSession* Session) const;
+
+protected:
+	/**
+	* Retrieves a result the session cached for this query, if still valid.
+	*
+	* @param Session - UDialogueSession*, the session evaluating the query.
+	* @param OutValue - double&, the cached result.
+	* @return bool - True if a valid result was found.
+	*/
+	bool FindCachedResult(UDialogueSession* Session, double& OutValue) const;
+
+	/**
+	* Caches a result on the session, according to the cache policy.
+	*
+	* @param Session - UDialogueSession*, the session evaluating the query.
+	* @param Value - double, the result.
+	*/
+	void CacheResult(UDialogueSession* Session, double Value) const;
+
+protected:
+	/** How long a session may reuse the query's result. Queries run every
+	* time unless they opt in; only opt in queries whose result cannot 
+	* change mid-step, or whose dependencies are invalidated. */
+	UPROPERTY(EditAnywhere, Category = "Caching")
+	EDialogueQueryCachePolicy CachePolicy = EDialogueQueryCachePolicy::Never;
+
+	/** External state the query reads. Invalidating any of these through
+	* the dialogue manager drops the query's cached results. */
+	UPROPERTY(EditAnywhere, Category = "Caching")
+	FGameplayTagContainer Dependencies;
+
+	/** How expensive the query is to run compared to others. Native 
+	* queries that only read the session are well below 1; Blueprint 
+	* queries default above it. */
+	UPROPERTY(EditDefaultsOnly, Category = "Cost", meta = (ClampMin = "0"))
+	float RelativeCost = 1.f;
+
+	/** How long the dialogue waits for the query, if async, before falling
+	* back to its timeout result. Waits indefinitely if zero. */
+	UPROPERTY(EditAnywhere, Category = "Async", meta = (ClampMin = "0"))
+	float AsyncTimeout = 0.5f;
+
 private:
 	UPROPERTY()
 	TObjectPtr<UDialogue> Dialogue;
@@ -21,7 +21,28 @@ public:
 	/**
 	* Executes the bool query.
 	*
+	* @param Session - UDialogueSession*, the session to query for.
 	* @return bool - Value of the query.
 	*/
-	virtual bool ExecuteQuery();
+	virtual bool ExecuteQuery(UDialogueSession* Session);
+
+	/**
+	* Evaluates the query, reusing the session's cached result if the 
+	* query's cache policy allows.
+	*
+	* @param Session - UDialogueSession*, the session to query for.
+	* @return bool - Value of the query.
+	*/
+	bool Evaluate(UDialogueSession* Session);
+
+	/** UDialogueQuery Impl. */
+	virtual void ExecuteQueryAsync(UDialogueSession* Session,
+		FDialogueQueryResultSignature OnResolved) override;
+	virtual double GetTimeoutResult() const override;
+	/** End UDialogueQuery */
+
+protected:
+	/** The value used if the query is async and times out */
+	UPROPERTY(EditAnywhere, Category = "Async")
+	bool bTimeoutValue = false;
 };
@@ -22,7 +22,28 @@ public:
 	/**
 	* Executes the floating point query.
 	*
+	* @param Session - UDialogueSession*, the session to query for.
 	* @return double - Value of the query.
 	*/
-	virtual double ExecuteQuery();
+	virtual double ExecuteQuery(UDialogueSession* Session);
+
+	/**
+	* Evaluates the query, reusing the session's cached result if the 
+	* query's cache policy allows.
+	*
+	* @param Session - UDialogueSession*, the session to query for.
+	* @return double - Value of the query.
+	*/
+	double Evaluate(UDialogueSession* Session);
+
+	/** UDialogueQuery Impl. */
+	virtual void ExecuteQueryAsync(UDialogueSession* Session,
+		FDialogueQueryResultSignature OnResolved) override;
+	virtual double GetTimeoutResult() const override;
+	/** End UDialogueQuery */
+
+protected:
+	/** The value used if the query is async and times out */
+	UPROPERTY(EditAnywhere, Category = "Async")
+	double TimeoutValue = 0.0;
 };
\ No newline at end of file
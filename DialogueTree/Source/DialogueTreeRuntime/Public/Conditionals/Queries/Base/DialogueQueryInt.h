@@ -21,7 +21,28 @@ public:
 	/**
 	* Executes the integer query.
 	*
+	* @param Session - UDialogueSession*, the session to query for.
 	* @return int32 - Value of the query.
 	*/
-	virtual int32 ExecuteQuery();
+	virtual int32 ExecuteQuery(UDialogueSession* Session);
+
+	/**
+	* Evaluates the query, reusing the session's cached result if the 
+	* query's cache policy allows.
+	*
+	* @param Session - UDialogueSession*, the session to query for.
+	* @return int32 - Value of the query.
+	*/
+	int32 Evaluate(UDialogueSession* Session);
+
+	/** UDialogueQuery Impl. */
+	virtual void ExecuteQueryAsync(UDialogueSession* Session,
+		FDialogueQueryResultSignature OnResolved) override;
+	virtual double GetTimeoutResult() const override;
+	/** End UDialogueQuery */
+
+protected:
+	/** The value used if the query is async and times out */
+	UPROPERTY(EditAnywhere, Category = "Async")
+	int32 TimeoutValue = 0;
 };
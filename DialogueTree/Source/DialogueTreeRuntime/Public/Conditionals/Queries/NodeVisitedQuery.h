@@ -22,10 +22,14 @@ class DIALOGUETREERUNTIME_API UNodeVisitedQuery : public UDialogueQueryBool
 	GENERATED_BODY()
 
 public:
+	/** Constructor */
+	UNodeVisitedQuery();
+
 	/** IDialogueQueryBool Impl. */
-	virtual bool ExecuteQuery() override;
+	virtual bool ExecuteQuery(UDialogueSession* Session) override;
 	virtual FText GetGraphDescription_Implementation() const override;
 	virtual bool IsValidQuery() const override;
+	virtual bool DependsOnHistory() const override;
 	/** End IDialogueQueryBool */
 
 	/** UObject Impl. */
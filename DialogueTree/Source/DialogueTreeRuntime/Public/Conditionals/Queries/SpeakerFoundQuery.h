@@ -22,8 +22,11 @@ class DIALOGUETREERUNTIME_API USpeakerFoundQuery : public UDialogueQueryBool
 	GENERATED_BODY()
 	
 public:
+	/** Constructor */
+	USpeakerFoundQuery();
+
 	/** IDialogueQueryBool Impl. */
-	virtual bool ExecuteQuery() override;
+	virtual bool ExecuteQuery(UDialogueSession* Session) override;
 	virtual FText GetGraphDescription_Implementation() const override;
 	virtual bool IsValidQuery() const override;
 	/** End IDialogueQueryBool */
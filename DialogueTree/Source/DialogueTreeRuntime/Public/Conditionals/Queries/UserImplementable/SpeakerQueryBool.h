@@ -23,11 +23,27 @@ class DIALOGUETREERUNTIME_API USpeakerQueryBool : public UDialogueQueryBool
 	GENERATED_BODY()
 	
 public:
+	/** Constructor */
+	USpeakerQueryBool();
+
 	/** IDialogueQueryFloat Impl. */
-	virtual bool ExecuteQuery() override;
+	virtual bool ExecuteQuery(UDialogueSession* Session) override;
 	virtual bool IsValidQuery() const override;
 	/** End IDialogueQueryFloat */
 
+	/**
+	* Native query, called with the speakers resolved from the session's
+	* slots. Override in C++ to query without allocating. By default, copies
+	* the additional speakers into an array for QuerySpeaker.
+	*
+	* @param InSpeaker - const FSpeakerActorEntry&, the target speaker.
+	* @param OtherSpeakers - TConstArrayView<FSpeakerActorEntry>, any 
+	* additional speakers.
+	* @return bool - the value of the query.
+	*/
+	virtual bool NativeQuerySpeaker(const FSpeakerActorEntry& InSpeaker,
+		TConstArrayView<FSpeakerActorEntry> OtherSpeakers) const;
+
 	/**
 	* User specified query. Implemented via blueprint.
 	*
@@ -23,11 +23,27 @@ class DIALOGUETREERUNTIME_API USpeakerQueryFloat : public UDialogueQueryFloat
 	GENERATED_BODY()
 
 public:
+	/** Constructor */
+	USpeakerQueryFloat();
+
 	/** IDialogueQueryFloat Impl. */
-	virtual double ExecuteQuery() override;
+	virtual double ExecuteQuery(UDialogueSession* Session) override;
 	virtual bool IsValidQuery() const override;
 	/** End IDialogueQueryFloat */
 
+	/**
+	* Native query, called with the speakers resolved from the session's
+	* slots. Override in C++ to query without allocating. By default, copies
+	* the additional speakers into an array for QuerySpeaker.
+	*
+	* @param InSpeaker - const FSpeakerActorEntry&, the target speaker.
+	* @param OtherSpeakers - TConstArrayView<FSpeakerActorEntry>, any 
+	* additional speakers.
+	* @return double - the value of the query.
+	*/
+	virtual double NativeQuerySpeaker(const FSpeakerActorEntry& InSpeaker,
+		TConstArrayView<FSpeakerActorEntry> OtherSpeakers) const;
+
 	/**
 	* User specified query. Implemented via blueprint.
 	*
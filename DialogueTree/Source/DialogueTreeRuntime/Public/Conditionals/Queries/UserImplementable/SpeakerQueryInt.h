@@ -23,11 +23,27 @@ class DIALOGUETREERUNTIME_API USpeakerQueryInt : public UDialogueQueryInt
 	GENERATED_BODY()
 
 public:
+	/** Constructor */
+	USpeakerQueryInt();
+
 	/** IDialogueQueryInt Impl. */
-	virtual int32 ExecuteQuery() override;
+	virtual int32 ExecuteQuery(UDialogueSession* Session) override;
 	virtual bool IsValidQuery() const override;
 	/** End IDialogueQueryInt */
 
+	/**
+	* Native query, called with the speakers resolved from the session's
+	* slots. Override in C++ to query without allocating. By default, copies
+	* the additional speakers into an array for QuerySpeaker.
+	*
+	* @param InSpeaker - const FSpeakerActorEntry&, the target speaker.
+	* @param OtherSpeakers - TConstArrayView<FSpeakerActorEntry>, any 
+	* additional speakers.
+	* @return int32 - the value of the query.
+	*/
+	virtual int32 NativeQuerySpeaker(const FSpeakerActorEntry& InSpeaker,
+		TConstArrayView<FSpeakerActorEntry> OtherSpeakers) const;
+
 	/**
 	* User specified query. Implemented via blueprint. 
 	* 
@@ -7,6 +7,7 @@
 #include "UObject/NoExportTypes.h"
 //Plugin
 #include "DialogueNodeSocket.h"
+#include "DialogueNodeTable.h"
 #include "Nodes/DialogueSpeechNode.h"
 //Generated
 #include "Dialogue.generated.h"
@@ -14,6 +15,8 @@
 class ADialogueController;
 class UDialogueEntryNode;
 class UDialogueNode;
+class UDialogueQuery;
+class UDialogueSession;
 class UDialogueSpeakerComponent;
 class UDialogueSpeakerSocket;
 class UEdGraph;
@@ -107,12 +110,16 @@ public:
 	UDialogue();
 
 public: 
-#if WITH_EDITOR
 	/** UObject Impl. */
+	virtual void PostInitProperties() override;
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void PostLoad() override;
+	virtual void PostDuplicate(bool bDuplicateForPIE) override;
+#if WITH_EDITOR
 	virtual void PostEditChangeProperty(
 		struct FPropertyChangedEvent& PropertyChangedEvent) override;
-	/** End UObject */
 #endif
+	/** End UObject */
 
 	// Some dialogues can be held between arbitrary participants. For example - random citizen dialogues on the streets: a merchant can talk to citizen, some unique NPC can talk to citizen, etc
 	// So to be able to have a single dialogue asset that fits all of those cases we can use generic aliases instead of actual UDialogeSpeakerComponent names
@@ -130,149 +137,177 @@ public:
 	FGameplayTagContainer InviteOtherParticipants;
 	
 	/**
-	* Sets the component value associated with the given name 
-	* to the provided speaker component. BlueprintCallable. 
+	* Adds a speaker role name to the compiled list of roles the dialogue 
+	* expects to be filled when it plays. 
 	* 
-	* @param InName - FName, the dialogue's name for the speaker. 
-	* Can differ from the component's display name. 
-	* @param InSpeaker - UDialogueSpeakerComponent*, the component 
-	* associated with the speaker. 
+	* @param InName - FName, name to create an entry for.
 	*/
-	UFUNCTION(BlueprintCallable, Category = "Dialogue")
-	void SetSpeaker(FName InName, UDialogueSpeakerComponent* InSpeaker);
+	void AddSpeakerEntry(FName InName);
 
 	/**
-	* Retrieves the speaker component associated with the given 
-	* name by the dialogue. BlueprintCallable. 
+	* Retrieves the compiled list of speaker role names. 
 	* 
-	* @param InName - FName, name associated with the desired 
-	* speaker
-	* @return UDialogueSpeakerComponent*, component associated with 
-	* the given speaker name. Nullptr if none found. 
+	* @return const TArray<FName>&, the speaker role names. 
 	*/
-	UFUNCTION(BlueprintCallable, Category = "Dialogue")
-	UDialogueSpeakerComponent* GetSpeaker(FName InName) const;
+	const TArray<FName>& GetSpeakerRoleNames() const;
 
 	/**
-	* Adds a speaker entry for the given name with a component value
-	* of nullptr. 
+	* Retrieves the dialogue's persistent identity, which unlike its name
+	* is unique across folders and survives the asset being renamed or 
+	* moved. Used to key the dialogue's visit history.
 	* 
-	* @param InName - FName, name to create an entry for.
+	* @return const FGuid&, the dialogue's GUID.
 	*/
-	void AddSpeakerEntry(FName InName);
-
-	virtual UWorld* GetWorld() const override;
+	const FGuid& GetDialogueGuid() const;
 	
 	/**
-	* Opens the dialogue at the given node ID. 
+	* Opens the dialogue for the given session at the given node ID. 
 	* 
+	* @param Session - UDialogueSession*, the session to play. 
 	* @param InNodeID - FName, the target node to start at. 
-	* @param InController - ADialogueController*, DialogueController
-	* actor. 
-	* @param InSpeakers - TMap<FName, UDialogueSpeakerComponent*>, 
+	* @param InSpeakers - const TMap<FName, UDialogueSpeakerComponent*>&, 
 	* components to associate with expected speaker names. 
 	*/
-	void OpenDialogueAt(FName InNodeID, ADialogueController* InController,
-		TMap<FName, UDialogueSpeakerComponent*> InSpeakers);
+	void OpenDialogueAt(UDialogueSession* Session, FName InNodeID,
+		const TMap<FName, UDialogueSpeakerComponent*>& InSpeakers) const;
 
 	/**
-	* Clears the current dialogue controller. Used when closing 
-	* dialogue. 
+	* Opens the dialogue for the given session at the given node index. 
+	* 
+	* @param Session - UDialogueSession*, the session to play. 
+	* @param InNodeIndex - int32, the node table index to start at. 
+	* @param InSpeakers - const TMap<FName, UDialogueSpeakerComponent*>&, 
+	* components to associate with expected speaker names. 
 	*/
-	void ClearController();
+	void OpenDialogueAtIndex(UDialogueSession* Session, int32 InNodeIndex,
+		const TMap<FName, UDialogueSpeakerComponent*>& InSpeakers) const;
 
 	/**
-	* Calls on the controller to end the dialogue. 
+	* Ends the given session. If the session belongs to a controller, the
+	* controller is asked to end it so that its display closes as well. 
+	* 
+	* @param Session - UDialogueSession*, the session to end. 
 	*/
-	void EndDialogue() const;
+	void EndDialogue(UDialogueSession* Session) const;
 
 	/**
-	* Calls on the controller to display the given speech. 
+	* Calls on the session's controller to display the given speech. 
 	* 
+	* @param Session - UDialogueSession*, the session playing the speech. 
 	* @param InDetails - const FSpeechDetails&, details for the 
 	* target speech.
-	* @param SpeechVariationIndex 
+	* @param SpeechVariationIndex - int, the variation of the speech chosen.
 	*/
-	void DisplaySpeech(const FSpeechDetails& InDetails, int SpeechVariationIndex) const;
+	void DisplaySpeech(UDialogueSession* Session, 
+		const FSpeechDetails& InDetails, int SpeechVariationIndex) const;
 
 	/**
-	* Calls on the controller to display the given dialogue options
-	* for the user to select from. 
+	* Calls on the session's controller to display the given dialogue 
+	* options for the user to select from. 
 	* 
-	* @param InOptions - TArray<FDialogueOption>, options to
+	* @param Session - UDialogueSession*, the session showing the options. 
+	* @param InOptions - const TArray<FDialogueOption>&, options to
 	* display.
 	*/
-	void DisplayOptions(TArray<FDialogueOption> InOptions) const;
+	void DisplayOptions(UDialogueSession* Session, 
+		const TArray<FDialogueOption>& InOptions) const;
 
 	/**
-	* Attempts to select a dialogue option at the given index. 
+	* Resolves the node at the given index as a player option by running 
+	* its compiled option program, evaluating only the branch and lock 
+	* conditions along the way. Nodes without a program are asked for 
+	* their option directly.
 	* 
-	* @param InOptionIndex - int32, index of the selection. 
+	* @param Session - UDialogueSession*, the session to evaluate for.
+	* @param NodeIndex - int32, the node offered as an option.
+	* @param OutOption - FDialogueOption&, overwritten with the option.
+	* @return bool - True if the option is valid.
 	*/
-	void SelectOption(int32 InOptionIndex) const;
+	bool ResolveOption(UDialogueSession* Session, int32 NodeIndex,
+		FDialogueOption& OutOption) const;
 
 	/**
-	* Attempts to skip through the current dialogue node, if and 
-	* to the extent allowable by the node itself. 
+	* Gathers the queries of every branch and lock condition that resolving
+	* the node at the given index as an option may read, down both sides of
+	* every branch. Nodes without a program contribute nothing.
+	* 
+	* @param NodeIndex - int32, the node offered as an option.
+	* @param OutQueries - TArray<UDialogueQuery*>&, appended with the 
+	* queries.
 	*/
-	void Skip() const;
+	void GetOptionQueries(int32 NodeIndex, 
+		TArray<UDialogueQuery*>& OutQueries) const;
 
 	/**
-	* Attempts to traverse the given node. Closes the dialogue if 
-	* anything goes wrong. 
+	* Attempts to select a dialogue option at the given index. 
 	* 
-	* @param InNode - UDialogueNode*, node to traverse. 
+	* @param Session - UDialogueSession*, the session making the selection.
+	* @param InOptionIndex - int32, index of the selection. 
 	*/
-	void TraverseNode(UDialogueNode* InNode);
+	void SelectOption(UDialogueSession* Session, int32 InOptionIndex) const;
 
 	/**
-	* Retrieves the dialogue's current compile status.
+	* Attempts to skip through the session's current dialogue node, if and 
+	* to the extent allowable by the node itself. 
 	* 
-	* @return EDialogueCompileStatus 
+	* @param Session - UDialogueSession*, the session to skip in.
 	*/
-	EDialogueCompileStatus GetCompileStatus() const;
+	void Skip(UDialogueSession* Session) const;
 
 	/**
-	* Retrieves the entire map of expected speaker names to their 
-	* speaker components. 
+	* Attempts to traverse the given node, then keeps following the nodes it
+	* leads on to until one needs to wait. Closes the dialogue if anything 
+	* goes wrong. Calls made while a node is being entered are deferred to
+	* the running traversal rather than recursing. 
 	* 
-	* @return TMap<FName, UDialogueSpeakerComponent*>, the map of 
-	* speaker names to components. 
+	* @param Session - UDialogueSession*, the session traversing. 
+	* @param InNode - UDialogueNode*, node to traverse. 
 	*/
-	UFUNCTION(BlueprintCallable, Category="Dialogue")
-	const TMap<FName, UDialogueSpeakerComponent*>& GetAllSpeakers() const;
+	void TraverseNode(UDialogueSession* Session, UDialogueNode* InNode) const;
 
 	/**
-	* Checks if a speaker with the given name is currently present/valid for 
-	* the dialogue. 
+	* Traverses the node at the given node table index, as TraverseNode. 
+	* INDEX_NONE ends the dialogue.
 	* 
-	* @param SpeakerName - FName, name of the target speaker. 
-	* @return bool - True if the speaker is valid/present; false otherwise. 
+	* @param Session - UDialogueSession*, the session traversing. 
+	* @param InNodeIndex - int32, the index of the node to traverse. 
 	*/
-	UFUNCTION(BlueprintCallable, Category="Dialogue")
-	bool SpeakerIsPresent(const FName SpeakerName) const;
+	void TraverseNodeAt(UDialogueSession* Session, int32 InNodeIndex) const;
+
+	/**
+	* Retrieves the dialogue's current compile status.
+	* 
+	* @return EDialogueCompileStatus 
+	*/
+	EDialogueCompileStatus GetCompileStatus() const;
 	
 	/**
-	* Checks if the given node has already been visited by the dialogue 
-	* controller. If dialogue is inactive, returns false. 
+	* Checks if the given node has already been visited by the session's
+	* participants. If the session is inactive, returns false. 
 	* 
+	* @param Session - const UDialogueSession*, the session to check for. 
 	* @param TargetNode - UDialogueNode*, the node we are interested in. 
 	* @return bool - True if node was visited, False otherwise. 
 	*/
-	bool WasNodeVisited(UDialogueNode* TargetNode) const;
+	bool WasNodeVisited(const UDialogueSession* Session, 
+		UDialogueNode* TargetNode) const;
 
 	/**
 	* Marks the given node visited or unvisited as specified. 
 	* 
+	* @param Session - UDialogueSession*, the session to record for. 
 	* @param TargetNode - UDialogueNode* to change visited status for. 
 	* @param bVisited - bool, True for visited, False for unvisited. 
 	*/
-	void MarkNodeVisited(UDialogueNode* TargetNode, bool bVisited);
+	void MarkNodeVisited(UDialogueSession* Session, UDialogueNode* TargetNode, 
+		bool bVisited) const;
 
 	/**
 	* Marks all nodes in the dialogue unvisited. 
+	* 
+	* @param Session - UDialogueSession*, the session to clear visits for. 
 	*/
-	void ClearAllNodeVisits();
+	void ClearAllNodeVisits(UDialogueSession* Session) const;
 
 	/**
 	* Checks if the given node ID corresponds to a node in the dialogue. 
@@ -282,12 +317,109 @@ public:
 	*/
 	bool HasNode(FName NodeID) const;
 
+	/**
+	* Checks if the given node belongs to this dialogue's compiled node 
+	* table. Constant time; does not look up the node ID.
+	* 
+	* @param InNode - const UDialogueNode*, the node to check. 
+	* @return True if the node is part of the dialogue, False otherwise.
+	*/
+	bool OwnsNode(const UDialogueNode* InNode) const;
+
+	/**
+	* Finds a node by its ID.
+	* 
+	* @param NodeID - FName, the target node id. 
+	* @return UDialogueNode*, the node. Nullptr if none found.
+	*/
+	UDialogueNode* FindNode(FName NodeID) const;
+
+	/**
+	* Finds the index of the node with the given ID in the node table, 
+	* including nodes that have since been renamed away from it.
+	* 
+	* @param NodeID - FName, the target node id.
+	* @return int32, the node's index. INDEX_NONE if none found.
+	*/
+	int32 FindNodeIndex(FName NodeID) const;
+
+	/**
+	* Retrieves the flat node table built when the dialogue was compiled.
+	* 
+	* @return const FDialogueNodeTable&, the node table. 
+	*/
+	const FDialogueNodeTable& GetNodeTable() const;
+
+	/**
+	* Rebuilds the flat node table from the dialogue's nodes. Called when 
+	* compiling the dialogue, once every node has been linked. Nodes keep 
+	* the index they were given by earlier compiles.
+	*/
+	void BuildNodeTable();
+
+	/**
+	* Gathers everything needed to lay out the node table, without changing
+	* the dialogue. Node references are resolved to the indices the nodes 
+	* will be given. Lets the layout itself happen on another thread.
+	* 
+	* @param OutSlots - FDialogueNodeSlots&, the node given every index.
+	* @param OutNodes - TArray<TObjectPtr<UDialogueNode>>&, the node of 
+	* every index. Null for slots left by deleted nodes.
+	* @param OutSources - TArray<FDialogueNodeTableSource>&, the layout 
+	* sources of every index.
+	*/
+	void GatherNodeTableSources(FDialogueNodeSlots& OutSlots,
+		TArray<TObjectPtr<UDialogueNode>>& OutNodes,
+		TArray<FDialogueNodeTableSource>& OutSources) const;
+
+	/**
+	* Replaces the node table with one laid out from gathered sources, and
+	* hands each node its index.
+	* 
+	* @param InSlots - FDialogueNodeSlots&&, the node given every index.
+	* @param InTable - FDialogueNodeTable&&, the finished table.
+	*/
+	void CommitNodeTable(FDialogueNodeSlots&& InSlots, 
+		FDialogueNodeTable&& InTable);
+
+	/**
+	* Resolves every speaker role named by the dialogue's nodes and speaker
+	* sockets to its slot among the speaker roles, so that sessions find 
+	* their speakers by index. Called whenever the node table is committed
+	* and when loading a dialogue saved before slots were saved with it.
+	*/
+	void ResolveSpeakerSlots();
+
+	/**
+	* Rebuilds the lookup from node IDs, current and retired, to node 
+	* indices. Called whenever the node table is committed and when the 
+	* dialogue loads.
+	*/
+	void BuildNodeIndexLookup();
+
+	/**
+	* Retrieves the ID each node index was assigned to, including indices 
+	* of nodes that have since been deleted.
+	* 
+	* @return const TArray<FName>&, node IDs by node index.
+	*/
+	const TArray<FName>& GetNodeSlotIDs() const;
+
+	/**
+	* Retrieves the IDs node indices were given under before their node was
+	* renamed, so that records naming a node by an old ID still find it.
+	* 
+	* @return const TMap<FName, int32>&, node indices by retired node ID.
+	*/
+	const TMap<FName, int32>& GetRetiredNodeIDs() const;
+
 	/**
 	* Marks the given node as the dialogue's resume node if possible.
 	* 
+	* @param Session - UDialogueSession*, the session to record for. 
 	* @param InNode - UDialogueNode* - the node to resume from. 
 	*/
-	void SetResumeNode(UDialogueNode* InNode);
+	void SetResumeNode(UDialogueSession* Session, UDialogueNode* InNode) const;
 
 	/**
 	* Retrieves the dialogue's root node.
@@ -370,7 +502,9 @@ public:
 	void ClearDialogue();
 
 	/**
-	* Functionality to call at the beginning of compiling the dialogue.
+	* Functionality to call at the beginning of compiling the dialogue. 
+	* Nodes added from then on are staged, and only replace the dialogue's
+	* nodes once the compile commits its node table.
 	*/
 	void PreCompileDialogue();
 
@@ -411,28 +545,27 @@ private:
 	*/
 	void OnChangeSingleSpeaker();
 
+#if WITH_EDITOR
+	/**
+	* Swaps the nodes staged by a compile in progress in for the dialogue's
+	* nodes. Called when the compile commits its node table.
+	*/
+	void CommitStagedNodes();
+#endif
+
 	/**
 	* Checks if the dialogue is ready to play. Fills the provided 
 	* error message if not. 
 	* 
-	* @param InController - ADialogueController*, controller that
-	* would interface with the dialogue
+	* @param Session - const UDialogueSession*, session that would
+	* play the dialogue
 	* @param OutErrorMessage - FString&, error message to fill if
 	* the dialogue cannot play. 
 	* @return bool, whether the dialogue can play or not. 
 	*/
-	bool CanPlay(ADialogueController* InController, FString& OutErrorMessage) 
+	bool CanPlay(const UDialogueSession* Session, FString& OutErrorMessage) 
 		const;
 
-	/**
-	* Refreshes the speakers, plugging in the provided components. 
-	* 
-	* @param InSpeakers - TMap<FName, UDialogueSpeakerComponent*>,
-	* the speaker components to enter, matched to their expected
-	* names
-	*/
-	void FillSpeakers(TMap<FName, UDialogueSpeakerComponent*> InSpeakers);
-
 private:
 	/** Editable speaking roles for the graph */
 	UPROPERTY(EditAnywhere, NoClear, Category = "Dialogue", 
@@ -448,17 +581,34 @@ private:
 	UPROPERTY()
 	TObjectPtr<UDialogueEntryNode> RootNode; 
 
-	/** The currently active node in the dialogue */
+	/** Flat, index-addressed copy of the nodes, set on compile */
 	UPROPERTY()
-	TObjectPtr<UDialogueNode> ActiveNode;
+	FDialogueNodeTable NodeTable;
 
-	/** A mapping of speaker names to their found components */
+	/** The node ID each node index has been given. Kept across compiles so
+	* that indices stay stable. */
 	UPROPERTY()
-	TMap<FName, UDialogueSpeakerComponent*> Speakers;
+	TArray<FName> NodeSlotIDs;
 
-	/** The controlling actor for the dialogue */
+	/** The node GUID each node index has been given, matched before IDs 
+	* so that renamed nodes keep their index */
 	UPROPERTY()
-	TObjectPtr<ADialogueController> DialogueController;
+	TArray<FGuid> NodeSlotGuids;
+
+	/** Node indices by the IDs their nodes had before being renamed */
+	UPROPERTY()
+	TMap<FName, int32> RetiredNodeIDs;
+
+	/** Node indices by current and retired node ID, for lookups by ID */
+	TMap<FName, int32> NodeIndicesByID;
+
+	/** Persistent identity of the dialogue asset */
+	UPROPERTY()
+	FGuid DialogueGuid;
+
+	/** The speaker roles to fill when the dialogue plays, set on compile */
+	UPROPERTY()
+	TArray<FName> SpeakerRoleNames;
 
 	/** Thhe current compile status of the dialogue */
 	UPROPERTY()
@@ -474,6 +624,21 @@ private:
 	UPROPERTY()
 	UEdGraph* EdGraph = nullptr;
 
+	/** Whether a compile is building into the staged nodes */
+	bool bCompileStaged = false;
+
+	/** The entry node of the compile in progress */
+	UPROPERTY(Transient)
+	TObjectPtr<UDialogueEntryNode> StagedRootNode;
+
+	/** The nodes of the compile in progress, keyed by ID */
+	UPROPERTY(Transient)
+	TMap<FName, TObjectPtr<UDialogueNode>> StagedNodes;
+
+	/** The speaker roles of the compile in progress */
+	UPROPERTY(Transient)
+	TArray<FName> StagedSpeakerRoleNames;
+
 #endif
 
 public:
@@ -482,6 +647,7 @@ public:
 
 	//g2vs2
 public:
-	void SetJumpBackNode(UDialogueNode* DialogueNode);
-	bool JumpBack();
+	void SetJumpBackNode(UDialogueSession* Session, 
+		UDialogueNode* DialogueNode) const;
+	bool JumpBack(UDialogueSession* Session) const;
 };
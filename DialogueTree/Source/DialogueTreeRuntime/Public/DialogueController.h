@@ -7,18 +7,24 @@
 #include "GameFramework/Actor.h"
 //Plugin
 #include "Dialogue.h"
+#include "History/DialogueHistorySnapshot.h"
+#include "History/DialogueHistoryStore.h"
 //Generated
 #include "DialogueController.generated.h"
 
 class UDialogue;
+class UDialogueSession;
 class UDialogueSpeakerComponent;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FDialogueControllerDelegate);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FDialogueControllerSpeechDelegate, FSpeechDetails, SpeechDetails, int, SpeechVariationIndex);
+DECLARE_MULTICAST_DELEGATE_OneParam(FDialogueHistoryChangedDelegate, const FGuid& /*DialogueId*/);
 
 /**
 * Struct used to extract node visited data for a single dialogue.
-* Primarily useful for saving/loading.
+* Primarily useful for saving/loading. Nodes are named by ID, which is 
+* readable from blueprints but larger than the controller's own 
+* FDialogueHistoryStore. FDialogueHistoriesCodec writes them compactly.
 */
 
 USTRUCT(BlueprintType)
@@ -42,6 +48,13 @@ struct DIALOGUETREERUNTIME_API FDialogueHistory
 	UPROPERTY(BlueprintReadOnly, Category = "Dialogue")
 	FName DialogueFName;
 
+	/** The dialogue's persistent identity. Matched before the name when
+	* the history is imported, so that dialogues sharing a name in 
+	* different folders are told apart. Invalid in histories exported 
+	* before dialogues had GUIDs. */
+	UPROPERTY(BlueprintReadOnly, Category = "Dialogue")
+	FGuid DialogueGuid;
+
 	UPROPERTY(BlueprintReadOnly, Category = "Dialogue")
 	TMap<FGuid, FCharacterDialogueHistory> DialogueNodeHistory;
 };
@@ -55,7 +68,9 @@ struct DIALOGUETREERUNTIME_API FDialogueHistories
 {
 	GENERATED_BODY()
 
-	/** Map of dialogue FNames to their records of visited nodes */
+	/** Map of dialogue object paths to their records of visited nodes,
+	* one per dialogue. Histories exported before dialogues had GUIDs are
+	* keyed by the dialogue's FName instead. */
 	UPROPERTY(BlueprintReadOnly, SaveGame, Category = "Dialogue")
 	TMap<FName, FDialogueHistory> Histories;
 };
@@ -70,23 +85,14 @@ class DIALOGUETREERUNTIME_API ADialogueController : public AActor
 {
 	GENERATED_BODY()
 
-private:
-	struct FDialogueJumpBack
-	{
-		public:
-			void Set(UDialogue* InDialogue, FName InNodeId);
-			FName Get(UDialogue* InDialogue);
-			void Clear();
-		
-		private:
-			TSoftObjectPtr<UDialogue> Dialogue;
-			FName NodeId;
-	};
-	
 public:
 	/** Constructor */
 	ADialogueController();
 
+	/** AActor Impl. */
+	virtual void BeginPlay() override;
+	/** End AActor */
+
 public:
 	/**
 	* Notifies the dialogue that the user is attempting to select
@@ -199,15 +205,27 @@ public:
 
 	/**
 	* Exports a dialogue records struct containing the node visits for
-	* all dialogues in the game. Useful for saving.
+	* all dialogues in the game. Useful for saving. Being pure, the records
+	* are rebuilt for every pin reading them; prefer ExportDialogueRecords.
 	*
 	* @return FDialogueMemory - record of all node visits in the game.
 	*/
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Dialogue")
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Dialogue", 
+		meta = (DeprecatedFunction, DeprecationMessage = "Use ExportDialogueRecords, which builds the records once per call."))
 	FDialogueHistories GetDialogueRecords() const;
 
 	/**
-	* Clears node visitation info from all dialogues.
+	* Fills a dialogue records struct with the node visits for all 
+	* dialogues in the game, reusing its storage. BlueprintCallable.
+	*
+	* @param OutRecords - FDialogueHistories&, replaced with the records.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	void ExportDialogueRecords(FDialogueHistories& OutRecords) const;
+
+	/**
+	* Clears node visitation info from all dialogues, including records 
+	* spilled to the cold history store.
 	*/
 	UFUNCTION(BlueprintCallable, Category = "Dialogue")
 	void ClearDialogueRecords();
@@ -216,10 +234,213 @@ public:
 	* Imports a dialogue records struct, adding any recorded visits to the
 	* appropriate dialogues.
 	*
-	* @param InRecords - const FDialogueRecords&, the records to load.
+	* @param InRecords - const FDialogueHistories&, the records to load.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	void ImportDialogueRecords(const FDialogueHistories& InRecords);
+
+	/**
+	* Imports a dialogue records struct without copying it, taking over its
+	* storage.
+	*
+	* @param InRecords - FDialogueHistories&&, the records to load.
+	*/
+	void AdoptDialogueRecords(FDialogueHistories&& InRecords);
+
+	/**
+	* Writes the node visits for all dialogues in the game to a compact
+	* binary form, including imported records not yet played since. 
+	* Preferred over GetDialogueRecords() for saving. BlueprintCallable.
+	*
+	* @param OutBytes - TArray<uint8>&, filled with the saved records.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	void SaveDialogueRecords(TArray<uint8>& OutBytes) const;
+
+	/**
+	* Replaces the node visits for all dialogues with ones written by
+	* SaveDialogueRecords(). BlueprintCallable.
+	*
+	* @param InBytes - const TArray<uint8>&, the saved records.
+	* @return bool - True if the records could be read.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	bool LoadDialogueRecords(const TArray<uint8>& InBytes);
+
+	/**
+	* Writes only the records of dialogues whose node visits changed since
+	* the last save, in the same compact binary form. Writes everything if
+	* the records were cleared, imported or loaded since. BlueprintCallable.
+	*
+	* @param OutBytes - TArray<uint8>&, filled with the saved changes.
+	* @return bool - True if everything was written, in which case earlier
+	* saves are no longer needed.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	bool SaveDialogueRecordChanges(TArray<uint8>& OutBytes);
+
+	/**
+	* Applies changes written by SaveDialogueRecordChanges(). Applying each
+	* set of changes in the order they were saved rebuilds the records.
+	* BlueprintCallable.
+	*
+	* @param InBytes - const TArray<uint8>&, the saved changes.
+	* @return bool - True if the changes could be read.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	bool ApplyDialogueRecordChanges(const TArray<uint8>& InBytes);
+
+	/**
+	* Appends the node visits changed since the last save to a journal of
+	* saved records, so that autosaves only write what changed. Writes a 
+	* fresh snapshot instead if the journal is empty or its changes have 
+	* outgrown its snapshot. BlueprintCallable.
+	*
+	* @param Journal - TArray<uint8>&, the journal to append to.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	void AppendDialogueRecordJournal(UPARAM(ref) TArray<uint8>& Journal);
+
+	/**
+	* Replaces the journal with a single snapshot of every record. 
+	* BlueprintCallable.
+	*
+	* @param Journal - TArray<uint8>&, the journal to compact.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	void CompactDialogueRecordJournal(UPARAM(ref) TArray<uint8>& Journal);
+
+	/**
+	* Replaces the node visits for all dialogues with ones replayed from a
+	* journal written by AppendDialogueRecordJournal(). BlueprintCallable.
+	*
+	* @param Journal - const TArray<uint8>&, the journal.
+	* @return bool - True if every frame of the journal could be read. 
+	* Frames before a corrupt one are still applied.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	bool LoadDialogueRecordJournal(const TArray<uint8>& Journal);
+
+	/**
+	* Checks if a single speaker has visited the given node, without 
+	* exporting any records. BlueprintPure.
+	*
+	* @param Dialogue - const UDialogue*, the dialogue.
+	* @param NodeID - FName, the node. Nodes renamed since are still found
+	* by their old ID.
+	* @param SpeakerId - FGuid, the speaker's dialogue speaker ID.
+	* @return bool - True if visited.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	bool WasNodeVisitedBy(const UDialogue* Dialogue, FName NodeID, 
+		FGuid SpeakerId) const;
+
+	/**
+	* Sets how long the given speaker's node visits are kept. Only 
+	* persistent visits are saved or exported.
+	*
+	* @param SpeakerId - const FGuid&, the speaker's dialogue speaker ID.
+	* @param Persistence - EDialogueSpeakerPersistence, the persistence.
+	*/
+	void SetSpeakerPersistence(const FGuid& SpeakerId,
+		EDialogueSpeakerPersistence Persistence);
+
+	/**
+	* Opens a store on disk for cold node visit records, so that worlds with
+	* vast numbers of speakers need not keep every record in memory. See 
+	* MaxResidentSpeakerRecords in the project settings. Saves, exports and
+	* history snapshots read spilled records back from it. Loading records
+	* starts it over, as saves hold every record spilled before them.
+	* BlueprintCallable.
+	*
+	* @param Directory - const FString&, the directory to keep records in.
+	* @return bool - True if the store could be opened.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	bool OpenColdHistoryStore(const FString& Directory);
+
+	/**
+	* Drops records left empty by cleared visits and releases the memory
+	* they held. Worth calling after clearing many dialogues. 
+	* BlueprintCallable.
+	*
+	* @return int32, the number of speaker records dropped.
 	*/
 	UFUNCTION(BlueprintCallable, Category = "Dialogue")
-	void ImportDialogueRecords(FDialogueHistories InRecords);
+	int32 PruneDialogueRecords();
+
+	/**
+	* Retrieves the delegate broadcast whenever the given dialogue's node
+	* visits or resume nodes change, including when records are cleared, 
+	* imported or loaded.
+	*
+	* @param Dialogue - const UDialogue*, the dialogue.
+	* @return FDialogueHistoryChangedDelegate&, the delegate.
+	*/
+	FDialogueHistoryChangedDelegate& OnDialogueHistoryChanged(
+		const UDialogue* Dialogue);
+
+	/**
+	* Retrieves the controller's record of node visits.
+	*
+	* @return const FDialogueHistoryStore&, the records.
+	*/
+	const FDialogueHistoryStore& GetHistoryStore() const;
+
+	/**
+	* Retrieves the latest published snapshot of the controller's record of
+	* node visits. Snapshots are published once per frame, so may trail the
+	* game thread's record by a frame. Safe from any thread while the 
+	* controller lives; readers that outlive it should hold the publisher 
+	* instead.
+	*
+	* @return FDialogueHistorySnapshotRef, the snapshot.
+	*/
+	FDialogueHistorySnapshotRef GetHistorySnapshot() const;
+
+	/**
+	* Retrieves the publisher of history snapshots, for readers on other 
+	* threads to hold on to.
+	*
+	* @return TSharedRef<const FDialogueHistoryPublisher, ESPMode::ThreadSafe>,
+	* the publisher.
+	*/
+	TSharedRef<const FDialogueHistoryPublisher, ESPMode::ThreadSafe> 
+		GetHistoryPublisher() const;
+
+	/**
+	* Publishes whatever changed in the record of node visits since the 
+	* last publish as a new snapshot. Called once per frame by the dialogue
+	* manager, so that a traversal's many changes cost one publish.
+	*/
+	void PublishHistorySnapshot();
+
+	/**
+	* Spills the least recently used records to the cold history store if
+	* more are held in memory than the project settings allow. Called once
+	* per frame by the dialogue manager, so that the shards are rewritten 
+	* in batches rather than on every visit.
+	*/
+	void SpillColdRecords();
+
+	/**
+	* Makes the given dialogue known to the controller, so that its records
+	* can be converted to and from node IDs. Called when a session of the
+	* dialogue begins.
+	*
+	* @param InDialogue - const UDialogue*, the dialogue.
+	*/
+	void RegisterDialogue(const UDialogue* InDialogue);
+
+	/**
+	* Retrieves the session for the dialogue currently being played. 
+	* BlueprintPure.
+	*
+	* @return UDialogueSession*, the current session. Nullptr if no dialogue
+	* is playing.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	UDialogueSession* GetCurrentSession() const;
 
 	/**
 	* Checks if the specified speaker is a participant in the current dialogue.
@@ -232,46 +453,49 @@ public:
 		const;
 
 	/**
-	* Marks the given node visited in the controller's memory.
+	* Marks the given node visited in the controller's memory for each of
+	* the session's participants.
 	*
-	* @param TargetDialogue, UDialogue*
-	* @param TargetNodeID, FName
+	* @param Session, const UDialogueSession*
+	* @param NodeIndex, int32, the node's index in the dialogue's node table.
 	*/
-	void MarkNodeVisited(UDialogue* TargetDialogue, FName TargetNodeID);
+	void MarkNodeVisited(const UDialogueSession* Session, int32 NodeIndex);
 
 	/**
-	* Marks the given node unvisited in the controller's memory.
+	* Marks the given node unvisited in the controller's memory for each of
+	* the session's participants.
 	*
-	* @param TargetDialogue, UDialogue*
-	* @param TargetNodeID, FName
+	* @param Session, const UDialogueSession*
+	* @param NodeIndex, int32, the node's index in the dialogue's node table.
 	*/
-	void MarkNodeUnvisited(UDialogue* TargetDialogue, FName TargetNodeID);
+	void MarkNodeUnvisited(const UDialogueSession* Session, int32 NodeIndex);
 
 	/**
-	* Clears all node visits for the given dialogue.
+	* Clears all node visits for the session's dialogue.
 	*
-	* @param TargetDialogue, UDialogue*
+	* @param Session, const UDialogueSession*
 	*/
-	void ClearAllNodeVisitsForDialogue(UDialogue* TargetDialogue);
+	void ClearAllNodeVisitsForDialogue(const UDialogueSession* Session);
 
 	/**
-	* Checks if the given node has already been visited.
+	* Checks if the given node has already been visited by any of the 
+	* session's participants.
 	*
-	* @param TargetDialogue, UDialogue*
-	* @param TargetNodeID, FName
+	* @param Session, const UDialogueSession*
+	* @param NodeIndex, int32, the node's index in the dialogue's node table.
 	* @return bool - True if the node was visited, False otherwise.
 	*/
-	bool WasNodeVisited(const UDialogue* TargetDialogue,
-	                    FName TargetNodeID) const;
+	bool WasNodeVisited(const UDialogueSession* Session, int32 NodeIndex) 
+		const;
 
 	/**
-	* Sets the resume node for the target dialogue to the target node. Called
-	* from the dialogue.
+	* Sets the resume node for the session's dialogue to the target node. 
+	* Called from the dialogue.
 	*
-	* @param InDialogue - UDialogue*, the target dialogue.
-	* @param InNodeID - FName, the target node ID to resume from.
+	* @param Session - const UDialogueSession*, the target session.
+	* @param NodeIndex - int32, the index of the node to resume from.
 	*/
-	void SetResumeNode(UDialogue* InDialogue, FName InNodeID);
+	void SetResumeNode(const UDialogueSession* Session, int32 NodeIndex);
 
 public:
 	/**
@@ -311,6 +535,16 @@ public:
 	UFUNCTION(BlueprintNativeEvent)
 	void DisplayOptions(const TArray<FSpeechDetails>& InOptions);
 
+	/**
+	* Displays the given options. By default copies each option's details,
+	* with any lock overrides applied, and passes them to DisplayOptions.
+	* Native controllers can override this to read the options' details in
+	* place instead.
+	*
+	* @param InOptions - TConstArrayView<FDialogueOption>, the options.
+	*/
+	virtual void DisplayOptionList(TConstArrayView<FDialogueOption> InOptions);
+
 	/**
 	* Checks if we can open the user-defined dialogue display.
 	* BlueprintImplementable.
@@ -333,9 +567,86 @@ protected:
 	UPROPERTY(BlueprintReadOnly, Category = "Dialogue")
 	TObjectPtr<UDialogue> CurrentDialogue = nullptr;
 
+	/** The session playing the current dialogue. */
+	UPROPERTY(BlueprintReadOnly, Category = "Dialogue")
+	TObjectPtr<UDialogueSession> CurrentSession = nullptr;
+
+private:
+	/**
+	* Creates a new session for the given dialogue and makes it the current
+	* one. Any session still left over from a previous dialogue is ended 
+	* first. The speakers are reserved with the dialogue manager, taking them
+	* from any ambient sessions they are playing in.
+	*
+	* @param InDialogue - UDialogue*, the dialogue to play.
+	* @param InSpeakers - const TMap<FName, UDialogueSpeakerComponent*>&,
+	* the speakers the dialogue will be played with.
+	* @return UDialogueSession*, the new session. Nullptr if the speakers
+	* could not be reserved.
+	*/
+	UDialogueSession* BeginSession(UDialogue* InDialogue,
+		const TMap<FName, UDialogueSpeakerComponent*>& InSpeakers);
+
+	/**
+	* Moves any imported records waiting on the given dialogue into the
+	* history store, converting their node IDs to node indices. Nodes 
+	* renamed since the records were made are found by their old ID. Also
+	* moves any records loaded from saves that named the dialogue rather 
+	* than keying it by GUID.
+	*
+	* @param InDialogue - const UDialogue*, the dialogue.
+	*/
+	void ResolvePendingRecords(const UDialogue* InDialogue);
+
+	/**
+	* Resolves the pending records of every known dialogue, forgetting 
+	* dialogues that have since been unloaded.
+	*/
+	void ResolveAllPendingRecords();
+
+	/**
+	* Applies changes written by SaveDialogueRecordChanges(), without 
+	* resolving imported records or notifying anyone.
+	*
+	* @param InBytes - TConstArrayView<uint8>, the saved changes.
+	* @return bool - True if the changes could be read.
+	*/
+	bool ApplyRecordChanges(TConstArrayView<uint8> InBytes);
+
+	/**
+	* Broadcasts the given dialogue's history changed delegate, if bound.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	*/
+	void NotifyHistoryChanged(const FGuid& DialogueId);
+
+	/**
+	* Broadcasts every bound history changed delegate, after the records
+	* were replaced wholesale.
+	*/
+	void NotifyAllHistoriesChanged();
+
 private:
 	/** Controller's memory of visited nodes */
-	FDialogueHistories DialogueHistories;
+	FDialogueHistoryStore HistoryStore;
+
+	/** Imported records for dialogues that have not been played since, 
+	* still keyed by node ID */
+	FDialogueHistories PendingRecords;
+
+	/** Publishes snapshots of HistoryStore to other threads */
+	TSharedRef<FDialogueHistoryPublisher, ESPMode::ThreadSafe> 
+		HistoryPublisher;
+
+	/** Dialogues whose records can be converted to node IDs, by GUID */
+	TMap<FGuid, TWeakObjectPtr<const UDialogue>> KnownDialogues;
+
+	/** Delegates broadcast when a dialogue's history changes, by GUID */
+	TMap<FGuid, FDialogueHistoryChangedDelegate> HistoryChangedDelegates;
+
+	/** Option details handed to DisplayOptions, kept between menus so 
+	* their storage is reused */
+	TArray<FSpeechDetails> OptionDetails;
 
 public:
 	/** Delegate event call for when a new dialogue is started.*/
@@ -353,12 +664,5 @@ public:
 	//G2VS2
 private:
 	// deliberately does not include player because player could have participate in the same dialogue D with NPC A but not with NPC B 
-	TArray<FGuid> GetSpeakerIds(const UDialogue* Dialogue) const;
-
-public:
-	void SetJumpBackNode(UDialogue* Dialogue, FName NodeId);
-	FName GetJumpBackNode(UDialogue* Dialogue);
-
-private:
-	FDialogueJumpBack ActiveJumpBack;
+	TConstArrayView<FGuid> GetSpeakerIds(const UDialogueSession* Session) const;
 };
@@ -0,0 +1,32 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+#pragma once
+
+//UE
+#include "CoreMinimal.h"
+
+/**
+* Custom serialization version for dialogue assets. Lets loading run a 
+* migration only on assets saved before it was needed.
+*/
+struct DIALOGUETREERUNTIME_API FDialogueCustomVersion
+{
+	enum Type
+	{
+		/** Saved before the custom version was added */
+		BeforeCustomVersionWasAdded = 0,
+
+		/** Speaker slots are resolved on compile and saved with the asset */
+		SavedSpeakerSlots,
+
+		//-----<new versions can be added above this line>-----
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	/** The GUID of this custom version */
+	static const FGuid GUID;
+
+private:
+	FDialogueCustomVersion() {}
+};
@@ -6,46 +6,221 @@
 #include "CoreMinimal.h"
 #include "Subsystems/WorldSubsystem.h"
 //Plugin
+#include "Audio/DialogueAudioStreamer.h"
+#include "DialogueSession.h"
 #include "DialogueSettings.h"
+#include "Transitions/DialogueTransitionScheduler.h"
 //Generated
 #include "DialogueManagerSubsystem.generated.h"
 
 class ADialogueController;
+class UDialogue;
+class UDialogueSpeakerComponent;
+
+/**
+* Struct holding a session waiting to be started by the scheduler.
+*/
+USTRUCT()
+struct DIALOGUETREERUNTIME_API FDialogueSessionRequest
+{
+	GENERATED_BODY()
+
+	/** The session to start */
+	UPROPERTY()
+	TObjectPtr<UDialogueSession> Session = nullptr;
+
+	/** The speakers to start the session with */
+	UPROPERTY()
+	TMap<FName, UDialogueSpeakerComponent*> Speakers;
+
+	/** The node to start at. The dialogue's entry node if none. */
+	FName StartNodeID = NAME_None;
+
+	/** World time at which the session was requested */
+	double RequestTime = 0.0;
+};
 
 /**
  * Subsystem used to manage dialogue following a Singleton-like pattern.
- * Lifespan follows the world. Essentially serves as a casing for the
- * polymorphic Dialogue Controller. Abstract to allow Blueprint subclass to
- * handle default values.
+ * Lifespan follows the world. Serves as a casing for the polymorphic
+ * Dialogue Controller, which displays the player's dialogue, and schedules
+ * any number of undisplayed sessions (ambient chatter, barks) alongside it.
+ * Speakers are reserved by the session they play in, so that no speaker
+ * takes part in two sessions at once.
  */
 UCLASS()
-class DIALOGUETREERUNTIME_API UDialogueManagerSubsystem : public UWorldSubsystem
+class DIALOGUETREERUNTIME_API UDialogueManagerSubsystem :
+	public UTickableWorldSubsystem
 {
 	GENERATED_BODY()
 
 public:
-	/** UWorldSubsystem Impl. */
+	/** UTickableWorldSubsystem Impl. */
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
 	virtual void Deinitialize() override;
 	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
-	/** End UWorldSubsystem */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/** End UTickableWorldSubsystem */
 
 	/**
-	* Retrieves the associated dialogue controller actor. 
-	* 
-	* @return ADialogueController*, the dialogue controller. 
+	* Retrieves the associated dialogue controller actor.
+	*
+	* @return ADialogueController*, the dialogue controller.
 	*/
 	UFUNCTION(BlueprintPure, Category = "Dialogue")
 	ADialogueController* GetCurrentController();
 
 	/**
-	* Retrieves the settings for the plugin. 
-	* 
+	* Retrieves the settings for the plugin.
+	*
 	* @return UDialogueSettings*, the settings for the plugin.
 	*/
 	UFUNCTION(BlueprintPure, Category="Dialogue")
 	const UDialogueSettings* GetSettings();
 
+	/**
+	* Queues an undisplayed session of the given dialogue. The session starts
+	* once its speakers are free and the scheduler has room for it. Speakers
+	* held by lower priority sessions are taken from them. BlueprintCallable.
+	*
+	* @param InDialogue - UDialogue*, the dialogue to play.
+	* @param InSpeakers - TMap<FName, UDialogueSpeakerComponent*>, speaker
+	* components mapped to their names in dialogue.
+	* @param Priority - EDialogueSessionPriority, the priority of the
+	* session. Player priority is reserved for the controller's dialogue.
+	* @param StartNodeID - FName, the node to start at. Starts from the
+	* entry node if None.
+	* @return UDialogueSession*, the queued session. Nullptr if the request
+	* was rejected.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	UDialogueSession* StartAmbientDialogue(UDialogue* InDialogue,
+		TMap<FName, UDialogueSpeakerComponent*> InSpeakers,
+		EDialogueSessionPriority Priority = EDialogueSessionPriority::Ambient,
+		FName StartNodeID = NAME_None);
+
+	/**
+	* Registers a session started outside the scheduler (the controller's
+	* dialogue) and reserves its speakers.
+	*
+	* @param Session - UDialogueSession*, the session to register.
+	* @param InSpeakers - const TMap<FName, UDialogueSpeakerComponent*>&,
+	* the speakers the session will play with.
+	* @return bool - True if the speakers could be reserved, False otherwise.
+	*/
+	bool RegisterSession(UDialogueSession* Session,
+		const TMap<FName, UDialogueSpeakerComponent*>& InSpeakers);
+
+	/**
+	* Finds the session the given speaker is currently reserved by.
+	*
+	* @param Speaker - const UDialogueSpeakerComponent*, the speaker.
+	* @return UDialogueSession*, the session. Nullptr if none.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	UDialogueSession* FindSessionForSpeaker(
+		const UDialogueSpeakerComponent* Speaker) const;
+
+	/**
+	* Retrieves all sessions that are currently playing.
+	*
+	* @return const TArray<UDialogueSession*>&, the active sessions.
+	*/
+	const TArray<TObjectPtr<UDialogueSession>>& GetActiveSessions() const;
+
+	/**
+	* Ends every playing and queued session with a priority below the given
+	* one.
+	*
+	* @param Priority - EDialogueSessionPriority, the priority to keep.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	void EndSessionsBelow(EDialogueSessionPriority Priority);
+
+	/**
+	* Starts streaming in the speech audio the given session may play next,
+	* as far ahead as the project settings allow. Called whenever the
+	* session enters a node.
+	*
+	* @param Session - const UDialogueSession*, the session.
+	*/
+	void PrefetchAudio(const UDialogueSession* Session);
+
+	/**
+	* Requests a single speech audio clip, marking it as recently used.
+	*
+	* @param Audio - const TSoftObjectPtr<USoundCue>&, the clip.
+	* @return TSharedPtr<FStreamableHandle>, the handle to wait on. Invalid
+	* if the clip is null.
+	*/
+	TSharedPtr<FStreamableHandle> RequestSpeechAudio(
+		const TSoftObjectPtr<USoundCue>& Audio);
+
+	/**
+	* Drops the cached results of every query that depends on the given 
+	* state, in every playing session. Call when game state that dialogue
+	* conditions read changes mid-dialogue. BlueprintCallable.
+	*
+	* @param Dependency - FGameplayTag, the state that changed.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	void InvalidateQueries(FGameplayTag Dependency);
+
+	/**
+	* Retrieves the scheduler driving the speech transitions of every 
+	* session in the world.
+	*
+	* @return FDialogueTransitionScheduler&, the scheduler.
+	*/
+	FDialogueTransitionScheduler& GetTransitionScheduler();
+
+private:
+	/**
+	* Checks if the given session could reserve all of the given speakers,
+	* taking them from lower priority sessions where needed.
+	*
+	* @param Session - const UDialogueSession*, the session.
+	* @param InSpeakers - const TMap<FName, UDialogueSpeakerComponent*>&,
+	* the speakers.
+	* @return bool - True if every speaker is free or preemptible.
+	*/
+	bool CanReserveSpeakers(const UDialogueSession* Session,
+		const TMap<FName, UDialogueSpeakerComponent*>& InSpeakers) const;
+
+	/**
+	* Reserves the given speakers for the session, ending any lower
+	* priority sessions currently holding them.
+	*
+	* @param Session - UDialogueSession*, the session.
+	* @param InSpeakers - const TMap<FName, UDialogueSpeakerComponent*>&,
+	* the speakers.
+	*/
+	void ReserveSpeakers(UDialogueSession* Session,
+		const TMap<FName, UDialogueSpeakerComponent*>& InSpeakers);
+
+	/**
+	* Starts playing a queued session.
+	*
+	* @param Request - FDialogueSessionRequest&, the request to start.
+	*/
+	void StartRequest(FDialogueSessionRequest& Request);
+
+	/**
+	* Retrieves the number of undisplayed sessions currently playing.
+	*
+	* @return int32, the number of sessions counted against the limit.
+	*/
+	int32 GetNumScheduledSessions() const;
+
+	/**
+	* Called whenever a session known to the scheduler ends. Releases its
+	* speakers and forgets the session.
+	*
+	* @param Session - UDialogueSession*, the session that ended.
+	*/
+	void OnSessionEnded(UDialogueSession* Session);
+
 private:
 	/** The String type of dialogue controller that will be used if none is
 	 * supplied in the project settings for the plugin.
@@ -56,4 +231,23 @@ private:
 	/** The active dialogue controller */
 	UPROPERTY()
 	ADialogueController* DialogueController;
+
+	/** Sessions currently playing, including the controller's */
+	UPROPERTY()
+	TArray<TObjectPtr<UDialogueSession>> ActiveSessions;
+
+	/** Sessions waiting to start, in the order they were requested */
+	UPROPERTY()
+	TArray<FDialogueSessionRequest> PendingRequests;
+
+	/** Which session each busy speaker is reserved by */
+	UPROPERTY()
+	TMap<TObjectPtr<UDialogueSpeakerComponent>, TObjectPtr<UDialogueSession>>
+		SpeakerReservations;
+
+	/** Streams speech audio in ahead of the sessions that play it */
+	FDialogueAudioStreamer AudioStreamer;
+
+	/** Times the speech transitions of every session */
+	FDialogueTransitionScheduler TransitionScheduler;
 };
@@ -0,0 +1,313 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+#pragma once
+
+//UE
+#include "CoreMinimal.h"
+//Generated
+#include "DialogueNodeTable.generated.h"
+
+class UDialogueNode;
+
+/**
+* Enum naming the type of each node in a compiled dialogue's node table.
+*/
+UENUM()
+enum class EDialogueNodeKind : uint8
+{
+	Other,
+	Entry,
+	Speech,
+	Event,
+	Branch,
+	Jump,
+	JumpBack,
+	SetJumpBack,
+	OptionLock,
+	Reroute
+};
+
+/**
+* Enum naming the operation of a single step in an option resolution 
+* program.
+*/
+UENUM()
+enum class EDialogueOptionOp : uint8
+{
+	/** Ends the program with the node's speech as the option */
+	Speech,
+	/** Evaluates the branch node's conditions. Continues with the next 
+	* step if they pass, otherwise with the step's FalseStep. */
+	Branch,
+	/** Applies the lock node's state, unless a lock nearer the option 
+	* already has. Continues with the next step. */
+	Lock,
+	/** Ends the program by asking the node for its option at runtime, for
+	* node types the compiler does not know how to collapse */
+	Fallback,
+	/** Ends the program with no option */
+	Fail
+};
+
+/**
+* Struct describing a single step of an option resolution program.
+*/
+USTRUCT()
+struct DIALOGUETREERUNTIME_API FDialogueOptionStep
+{
+	GENERATED_BODY()
+
+	/** What the step does */
+	UPROPERTY()
+	EDialogueOptionOp Op = EDialogueOptionOp::Fail;
+
+	/** Index of the node the step reads */
+	UPROPERTY()
+	int32 Node = INDEX_NONE;
+
+	/** For branches, the step to continue at if the conditions fail */
+	UPROPERTY()
+	int32 FalseStep = INDEX_NONE;
+};
+
+/**
+* Struct describing a single node in a compiled dialogue's node table. All
+* references to other nodes are indices into the same table.
+*/
+USTRUCT()
+struct DIALOGUETREERUNTIME_API FDialogueNodeTableEntry
+{
+	GENERATED_BODY()
+
+	/** The type of the node */
+	UPROPERTY()
+	EDialogueNodeKind Kind = EDialogueNodeKind::Other;
+
+	/** Offset of the node's first child in the table's edge array */
+	UPROPERTY()
+	int32 FirstChild = 0;
+
+	/** Number of children the node has */
+	UPROPERTY()
+	int32 NumChildren = 0;
+
+	/** Offset of any kind-specific targets (jump target, true/false
+	* branches) in the table's edge array */
+	UPROPERTY()
+	int32 FirstPayload = 0;
+
+	/** Number of kind-specific targets */
+	UPROPERTY()
+	int32 NumPayloads = 0;
+
+	/** Index of the node's speaker in the dialogue's speaker roles.
+	* INDEX_NONE if the node has no speaker. */
+	UPROPERTY()
+	int32 SpeakerSlot = INDEX_NONE;
+
+	/** Offset of the program resolving the node as a player option in the
+	* table's option steps. INDEX_NONE if the node is never offered as an
+	* option. */
+	UPROPERTY()
+	int32 FirstOptionStep = INDEX_NONE;
+
+	/** Index of the node selecting the option moves to. INDEX_NONE if the
+	* program's fallback decides. */
+	UPROPERTY()
+	int32 OptionTarget = INDEX_NONE;
+};
+
+/**
+* Struct describing a single node to lay out in a node table, with its 
+* references to other nodes already resolved to table indices. Holds no 
+* object references, so tables can be laid out off the game thread.
+*/
+struct DIALOGUETREERUNTIME_API FDialogueNodeTableSource
+{
+	/** False for slots left behind by deleted nodes */
+	bool bHasNode = false;
+
+	/** The type of the node */
+	EDialogueNodeKind Kind = EDialogueNodeKind::Other;
+
+	/** Index of the node's speaker in the dialogue's speaker roles */
+	int32 SpeakerSlot = INDEX_NONE;
+
+	/** Indices of the node's children, left to right */
+	TArray<int32> Children;
+
+	/** Indices of the node's kind-specific targets */
+	TArray<int32> Payloads;
+};
+
+/**
+* Struct holding which node each index of a dialogue's node table was given
+* to. Kept across compiles, so that indices survive nodes being renamed and
+* deleted, and so that records naming nodes by an old ID can still find 
+* their index.
+*/
+struct DIALOGUETREERUNTIME_API FDialogueNodeSlots
+{
+	/** The node ID of every index */
+	TArray<FName> IDs;
+
+	/** The node GUID of every index. Invalid for indices given out before
+	* nodes had GUIDs. */
+	TArray<FGuid> Guids;
+
+	/** IDs that indices were given under before their node was renamed */
+	TMap<FName, int32> RetiredIDs;
+
+	/**
+	* Finds the index given to the node with the given ID, checking current
+	* IDs before retired ones.
+	*
+	* @param NodeID - FName, the ID.
+	* @return int32, the index. INDEX_NONE if none.
+	*/
+	int32 FindIndex(FName NodeID) const;
+};
+
+/**
+* Struct holding a flat, index-addressed copy of a dialogue's node graph.
+* Built when the dialogue is compiled so that traversal can step through
+* contiguous arrays rather than hashing node IDs or walking each node's
+* own arrays of parents and children.
+*/
+USTRUCT()
+struct DIALOGUETREERUNTIME_API FDialogueNodeTable
+{
+	GENERATED_BODY()
+
+	/** One entry per node, indexed by the node's index */
+	UPROPERTY()
+	TArray<FDialogueNodeTableEntry> Entries;
+
+	/** Child and payload node indices for every node, back to back. Missing
+	* targets are stored as INDEX_NONE. */
+	UPROPERTY()
+	TArray<int32> Edges;
+
+	/** The node objects, indexed by the node's index */
+	UPROPERTY()
+	TArray<TObjectPtr<UDialogueNode>> Nodes;
+
+	/** Option resolution programs for every node offered as an option, 
+	* back to back. Reroutes, jumps and events are resolved when the table
+	* is built, leaving only the branch and lock conditions to evaluate. */
+	UPROPERTY()
+	TArray<FDialogueOptionStep> OptionSteps;
+
+	/**
+	* Empties the table.
+	*/
+	void Reset()
+	{
+		Entries.Empty();
+		Edges.Empty();
+		Nodes.Empty();
+		OptionSteps.Empty();
+	}
+
+	/**
+	* Fills in the table's entries and edges from the given sources, one 
+	* per node index. Leaves the node objects untouched. Thread safe.
+	* 
+	* @param Sources - TConstArrayView<FDialogueNodeTableSource>, the nodes.
+	*/
+	void BuildLayout(TConstArrayView<FDialogueNodeTableSource> Sources);
+
+	/**
+	* Retrieves the first step of the program resolving the given node as a
+	* player option.
+	*
+	* @param NodeIndex - int32, the node.
+	* @return int32, the index of the first step in the option steps. 
+	* INDEX_NONE if the node has no program.
+	*/
+	int32 GetOptionProgram(int32 NodeIndex) const
+	{
+		return IsValidIndex(NodeIndex) 
+			? Entries[NodeIndex].FirstOptionStep 
+			: INDEX_NONE;
+	}
+
+	/**
+	* Checks if the given index refers to a node in the table.
+	*
+	* @param NodeIndex - int32, the index to check.
+	* @return bool - True if valid.
+	*/
+	bool IsValidIndex(int32 NodeIndex) const
+	{
+		return Entries.IsValidIndex(NodeIndex);
+	}
+
+	/**
+	* Retrieves the indices of the given node's children, left to right.
+	*
+	* @param NodeIndex - int32, the node.
+	* @return TConstArrayView<int32>, the child indices.
+	*/
+	TConstArrayView<int32> GetChildren(int32 NodeIndex) const
+	{
+		const FDialogueNodeTableEntry& Entry = Entries[NodeIndex];
+		return TConstArrayView<int32>(
+			Edges.GetData() + Entry.FirstChild,
+			Entry.NumChildren
+		);
+	}
+
+	/**
+	* Retrieves the indices of the given node's kind-specific targets.
+	*
+	* @param NodeIndex - int32, the node.
+	* @return TConstArrayView<int32>, the payload indices.
+	*/
+	TConstArrayView<int32> GetPayloads(int32 NodeIndex) const
+	{
+		const FDialogueNodeTableEntry& Entry = Entries[NodeIndex];
+		return TConstArrayView<int32>(
+			Edges.GetData() + Entry.FirstPayload,
+			Entry.NumPayloads
+		);
+	}
+
+	/**
+	* Retrieves the node object at the given index.
+	*
+	* @param NodeIndex - int32, the node. May be INDEX_NONE.
+	* @return UDialogueNode*, the node. Nullptr if the index is invalid.
+	*/
+	UDialogueNode* GetNode(int32 NodeIndex) const
+	{
+		return Nodes.IsValidIndex(NodeIndex) ? Nodes[NodeIndex].Get() : nullptr;
+	}
+
+private:
+	/**
+	* Compiles an option resolution program for every child of a speech.
+	*/
+	void BuildOptionPrograms();
+
+	/**
+	* Appends the steps resolving the chain of nodes starting at the given 
+	* node, following reroutes, jumps and events straight to their targets.
+	*
+	* @param NodeIndex - int32, the first node of the chain. May be 
+	* INDEX_NONE.
+	* @param Depth - int32, the number of nodes already followed.
+	* @param StepLimit - int32, the step count the program may not exceed.
+	* @return bool - False if the program grew past the step limit.
+	*/
+	bool EmitOptionChain(int32 NodeIndex, int32 Depth, int32 StepLimit);
+
+	/**
+	* Appends a single option step.
+	*
+	* @param Op - EDialogueOptionOp, the operation.
+	* @param Node - int32, the node the step reads.
+	* @return int32, the index of the new step.
+	*/
+	int32 EmitOptionStep(EDialogueOptionOp Op, int32 Node = INDEX_NONE);
+};
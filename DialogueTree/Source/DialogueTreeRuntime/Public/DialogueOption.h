@@ -10,20 +10,73 @@
 #include "DialogueOption.generated.h"
 
 class UDialogueNode;
+class UDialogueSpeechNode;
 
 /**
-* Struct used for representing a selectable dialogue option. 
+* Struct used for representing a selectable dialogue option. Refers to the
+* speech it shows rather than copying its details, so options can be built
+* and passed around without allocating. Lock nodes between the option and
+* its speech are applied as overrides.
 */
 USTRUCT()
 struct DIALOGUETREERUNTIME_API FDialogueOption
 {
 	GENERATED_BODY()
 
-	/** The speech details associated with the option */
+	/** The speech whose details the option shows */
 	UPROPERTY()
-	FSpeechDetails Details = FSpeechDetails();
+	TObjectPtr<UDialogueSpeechNode> Speech = nullptr;
 
 	/** The node the option transitions to */
 	UPROPERTY()
 	TObjectPtr<UDialogueNode> TargetNode = nullptr;
-};
\ No newline at end of file
+
+	/** Whether a lock node overrides the speech's locked state and message */
+	UPROPERTY()
+	bool bOverridesLock = false;
+
+	/** The locked state set by the lock node, if overridden */
+	UPROPERTY()
+	bool bIsLocked = false;
+
+	/** The message set by the lock node, if overridden */
+	UPROPERTY()
+	FText OptionMessage;
+
+	/**
+	* Checks if the option has a speech to show and a node to go to.
+	*
+	* @return bool - True if the option can be displayed.
+	*/
+	bool IsValid() const;
+
+	/**
+	* Retrieves the details of the option's speech, without any lock
+	* overrides applied. The option must be valid.
+	*
+	* @return const FSpeechDetails&, the speech's details.
+	*/
+	const FSpeechDetails& GetDetails() const;
+
+	/**
+	* Checks if the option is locked, taking any lock override into account.
+	*
+	* @return bool - True if locked.
+	*/
+	bool IsLocked() const;
+
+	/**
+	* Retrieves the message shown with the option, taking any lock override
+	* into account.
+	*
+	* @return const FText&, the message.
+	*/
+	const FText& GetOptionMessage() const;
+
+	/**
+	* Copies the option's speech details with any lock override applied.
+	*
+	* @param OutDetails - FSpeechDetails&, overwritten with the details.
+	*/
+	void CopyDetails(FSpeechDetails& OutDetails) const;
+};
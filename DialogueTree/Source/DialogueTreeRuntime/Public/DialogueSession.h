@@ -0,0 +1,633 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+#pragma once
+
+//UE
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "UObject/NoExportTypes.h"
+//Plugin
+#include "Conditionals/DialogueQueryCache.h"
+#include "DialogueOption.h"
+#include "DialogueSpeakerComponent.h"
+//Generated
+#include "DialogueSession.generated.h"
+
+class ADialogueController;
+class FDialogueTransitionScheduler;
+class UDialogue;
+class UDialogueEventBase;
+class UDialogueNode;
+class UDialogueQuery;
+class UDialogueSpeakerSocket;
+class UDialogueTransition;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FDialogueSessionEndedSignature,
+	UDialogueSession*);
+
+/**
+* Enum used to rank sessions against each other when they compete for 
+* speakers or scheduling slots. Higher values take precedence.
+*/
+UENUM(BlueprintType)
+enum class EDialogueSessionPriority : uint8
+{
+	Bark,
+	Ambient,
+	Player
+};
+
+/**
+* Struct holding the state of the transition out of the session's active
+* speech node. Kept on the session so that a single transition object can
+* serve any number of concurrent playthroughs of the same dialogue.
+*/
+USTRUCT()
+struct DIALOGUETREERUNTIME_API FDialogueTransitionState
+{
+	GENERATED_BODY()
+
+	/** The transition currently waiting to exit, if any */
+	UPROPERTY()
+	TObjectPtr<UDialogueTransition> Transition = nullptr;
+
+	/** The speaker whose audio the transition is waiting on, if any */
+	UPROPERTY()
+	TObjectPtr<UDialogueSpeakerComponent> AudioSpeaker = nullptr;
+
+	/** The available options for the player to choose */
+	UPROPERTY()
+	TArray<FDialogueOption> Options;
+
+	/** Whether the minimum play time is scheduled with the manager */
+	bool bMinPlayTimeScheduled = false;
+
+	/** Whether the min play time has elapsed yet */
+	bool bMinPlayTimeElapsed = false;
+
+	/** Whether the audio content has finished playing yet */
+	bool bAudioFinished = false;
+};
+
+/**
+* Struct holding an async query issued by a session, and its result once
+* resolved.
+*/
+struct FDialogueAsyncQueryEntry
+{
+	/** The query's result, once resolved */
+	double Value = 0.0;
+
+	/** Timer falling back to the query's timeout result */
+	FTimerHandle TimeoutHandle;
+
+	/** Whether the query has resolved or timed out */
+	bool bResolved = false;
+};
+
+/**
+* A single playthrough of a dialogue asset. Holds everything that changes
+* while a dialogue plays: the active node, the bound speakers, the state of
+* the active transition and the instanced events. The dialogue asset and its
+* nodes stay read-only at runtime, so any number of sessions can play the
+* same asset at once.
+*/
+UCLASS(BlueprintType)
+class DIALOGUETREERUNTIME_API UDialogueSession : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/** UObject Impl. */
+	virtual UWorld* GetWorld() const override;
+	/** End UObject */
+
+	/**
+	* Binds the session to the dialogue it plays and the controller that
+	* displays it, and marks the session active.
+	*
+	* @param InDialogue - UDialogue*, the dialogue to play.
+	* @param InController - ADialogueController*, the controller
+	* driving the session's display.
+	*/
+	void InitSession(UDialogue* InDialogue, ADialogueController* InController);
+
+	/**
+	* Sets the priority the session is scheduled with.
+	*
+	* @param InPriority - EDialogueSessionPriority, the new priority.
+	*/
+	void SetPriority(EDialogueSessionPriority InPriority);
+
+	/**
+	* Retrieves the priority the session is scheduled with.
+	*
+	* @return EDialogueSessionPriority, the priority.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	EDialogueSessionPriority GetPriority() const;
+
+	/**
+	* Checks if the session is the one shown on the controller's display. 
+	* Sessions that are not displayed (ambient chatter, barks) play through
+	* their speakers only.
+	*
+	* @return bool - True if the controller is displaying this session.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	bool IsDisplayed() const;
+
+	/**
+	* Ends the session. Stops any pending transition, releases the speakers
+	* and notifies any listeners. Does nothing if already ended.
+	*/
+	void EndSession();
+
+	/**
+	* Checks if the session is still playing.
+	*
+	* @return bool - True if the session has not ended, False otherwise.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	bool IsActive() const;
+
+	/**
+	* Retrieves the dialogue being played by this session.
+	*
+	* @return UDialogue*, the dialogue.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	UDialogue* GetDialogue() const;
+
+	/**
+	* Retrieves the controller driving this session.
+	*
+	* @return ADialogueController*, the controller.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	ADialogueController* GetController() const;
+
+	/**
+	* Retrieves the node the session is currently on.
+	*
+	* @return UDialogueNode*, the active node. Nullptr if none.
+	*/
+	UDialogueNode* GetActiveNode() const;
+
+	/**
+	* Sets the node the session is currently on.
+	*
+	* @param InNode - UDialogueNode*, the new active node.
+	*/
+	void SetActiveNode(UDialogueNode* InNode);
+
+	/**
+	* Checks if the dialogue is currently running its traversal loop for 
+	* this session.
+	*
+	* @return bool - True if mid-traversal.
+	*/
+	bool IsTraversing() const;
+
+	/**
+	* Marks the start or end of the dialogue's traversal loop. Ending the 
+	* loop drops any deferred hop.
+	*
+	* @param bInTraversing - bool, whether the loop is running.
+	*/
+	void SetTraversing(bool bInTraversing);
+
+	/**
+	* Stores a hop requested while a node was being entered, so the running
+	* traversal loop can take it instead of recursing. INDEX_NONE ends the
+	* dialogue.
+	*
+	* @param InNodeIndex - int32, the node table index to hop to.
+	*/
+	void DeferTraversal(int32 InNodeIndex);
+
+	/**
+	* Retrieves and clears the deferred hop, if any.
+	*
+	* @param OutNodeIndex - int32&, the node table index to hop to.
+	* @return bool - True if a hop was deferred, False otherwise.
+	*/
+	bool ConsumeDeferredTraversal(int32& OutNodeIndex);
+
+	/**
+	* Sets the component value associated with the given name
+	* to the provided speaker component. BlueprintCallable.
+	*
+	* @param InName - FName, the dialogue's name for the speaker.
+	* Can differ from the component's display name.
+	* @param InSpeaker - UDialogueSpeakerComponent*, the component
+	* associated with the speaker.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	void SetSpeaker(FName InName, UDialogueSpeakerComponent* InSpeaker);
+
+	/**
+	* Retrieves the speaker component associated with the given
+	* name in this session. BlueprintCallable.
+	*
+	* @param InName - FName, name associated with the desired
+	* speaker
+	* @return UDialogueSpeakerComponent*, component associated with
+	* the given speaker name. Nullptr if none found.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	UDialogueSpeakerComponent* GetSpeaker(FName InName) const;
+
+	/**
+	* Retrieves the entire map of expected speaker names to their
+	* speaker components.
+	*
+	* @return TMap<FName, UDialogueSpeakerComponent*>, the map of
+	* speaker names to components.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	const TMap<FName, UDialogueSpeakerComponent*>& GetAllSpeakers() const;
+
+	/**
+	* Checks if a speaker with the given name is currently present/valid for
+	* the session.
+	*
+	* @param SpeakerName - FName, name of the target speaker.
+	* @return bool - True if the speaker is valid/present; false otherwise.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	bool SpeakerIsPresent(const FName SpeakerName) const;
+
+	/**
+	* Checks if the given speaker component takes part in this session. 
+	* Reads the speaker's own handle to its session, so costs no lookup.
+	*
+	* @param TargetSpeaker - const UDialogueSpeakerComponent*, the speaker.
+	* @return bool - True if the speaker is bound to any role.
+	*/
+	bool HasSpeaker(const UDialogueSpeakerComponent* TargetSpeaker) const;
+
+	/**
+	* Refreshes the speakers, plugging in the provided components for each
+	* of the dialogue's speaker roles. Reports any missing roles to the
+	* controller.
+	*
+	* @param InSpeakers - const TMap<FName, UDialogueSpeakerComponent*>&,
+	* the speaker components to enter, matched to their expected names.
+	*/
+	void FillSpeakers(const TMap<FName, UDialogueSpeakerComponent*>& InSpeakers);
+
+	/**
+	* Finds the slot of the speaker role with the given name. Slots follow
+	* the order of the dialogue's speaker roles.
+	*
+	* @param InName - FName, the dialogue's name for the speaker.
+	* @return int32, the slot. INDEX_NONE if the dialogue has no such role.
+	*/
+	int32 FindSpeakerSlot(FName InName) const;
+
+	/**
+	* Retrieves the speaker component bound to the given slot. Slots are 
+	* resolved when the dialogue compiles, so this is a plain index.
+	*
+	* @param Slot - int32, the speaker's slot.
+	* @return UDialogueSpeakerComponent*, the component. Nullptr if the slot
+	* is invalid or no speaker is bound to it.
+	*/
+	UDialogueSpeakerComponent* GetSpeakerAt(int32 Slot) const;
+
+	/**
+	* Retrieves the entry resolved for the speaker in the given slot.
+	*
+	* @param Slot - int32, the speaker's slot.
+	* @return const FSpeakerActorEntry*, the entry. Nullptr if the slot is
+	* invalid or no speaker is bound to it.
+	*/
+	const FSpeakerActorEntry* GetSpeakerEntry(int32 Slot) const;
+
+	/**
+	* Retrieves the IDs of the session's non-player participants, under 
+	* which their node visit history is recorded. Kept up to date as 
+	* speakers are bound, so history reads and writes cost no gathering.
+	*
+	* @return TConstArrayView<FGuid>, the participant IDs.
+	*/
+	TConstArrayView<FGuid> GetParticipantIds() const;
+
+	/**
+	* Rebuilds the participant IDs from the bound speakers. Called whenever
+	* the speakers change, or a bound speaker's ID does.
+	*/
+	void RefreshParticipantIds();
+
+	/**
+	* Gathers the entries for a target speaker and any additional speakers
+	* from the session's resolved slots, without allocating.
+	*
+	* @param Target - const UDialogueSpeakerSocket*, the target speaker.
+	* @param Others - TConstArrayView<TObjectPtr<UDialogueSpeakerSocket>>,
+	* any additional speakers.
+	* @param OutTarget - const FSpeakerActorEntry*&, set to the target's
+	* entry. Nullptr if the target is missing.
+	* @param OutOthers - FSpeakerActorEntryList&, filled with the additional
+	* speakers' entries in order.
+	* @return bool - True if every speaker was found, False otherwise.
+	*/
+	bool GatherSpeakerEntries(const UDialogueSpeakerSocket* Target,
+		TConstArrayView<TObjectPtr<UDialogueSpeakerSocket>> Others,
+		const FSpeakerActorEntry*& OutTarget,
+		FSpeakerActorEntryList& OutOthers) const;
+
+	/**
+	* Retrieves the state of the session's active transition.
+	*
+	* @return FDialogueTransitionState&, the transition state.
+	*/
+	FDialogueTransitionState& GetTransitionState();
+
+	/**
+	* Stops any pending timers and audio listeners and resets the transition
+	* state. Called whenever the session leaves a node.
+	*/
+	void ResetTransitionState();
+
+	/**
+	* Starts the minimum play time timer for the active transition. Counts
+	* down on the session's clock, so pausing or dilating the session
+	* holds or stretches it.
+	*
+	* @param MinPlayTime - float, the time to wait in seconds.
+	*/
+	void StartMinPlayTimer(float MinPlayTime);
+
+	/**
+	* Clears the minimum play time timer, if running.
+	*/
+	void ClearMinPlayTimer();
+
+	/**
+	* Starts listening for the given speaker to finish its audio.
+	*
+	* @param InSpeaker - UDialogueSpeakerComponent*, the speaker to listen to.
+	*/
+	void ListenForAudioFinished(UDialogueSpeakerComponent* InSpeaker);
+
+	/**
+	* Stops listening for the current speaker's audio to finish.
+	*/
+	void StopListeningForAudio();
+
+	/**
+	* Called by the transition scheduler when the active transition's 
+	* minimum play time elapses.
+	*/
+	void OnMinPlayTimeElapsed();
+
+	/**
+	* Called by the transition scheduler when the speaker the transition 
+	* waits on finishes its audio.
+	*/
+	void OnSpeechAudioFinished();
+
+	/**
+	* Pauses or resumes the session. A paused session's speech audio is
+	* paused, and its transitions wait until it resumes. BlueprintCallable.
+	*
+	* @param bInPaused - bool, whether to pause the session.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	void SetPaused(bool bInPaused);
+
+	/**
+	* Checks if the session is paused. BlueprintPure.
+	*
+	* @return bool - True if paused.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	bool IsPaused() const;
+
+	/**
+	* Sets how fast the session's clock runs. Scales the time each speech
+	* is held on screen for, but not its audio. BlueprintCallable.
+	*
+	* @param InTimeDilation - float, the rate of the session's clock. Zero 
+	* holds the session's transitions like a pause.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	void SetTimeDilation(float InTimeDilation);
+
+	/**
+	* Retrieves how fast the session's clock runs. BlueprintPure.
+	*
+	* @return float, the session's time dilation.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	float GetTimeDilation() const;
+
+	/**
+	* Retrieves this session's instance of the given event, creating it on
+	* first use. Events may hold state (such as blocking), so each session
+	* plays its own copy rather than the template stored on the node.
+	*
+	* @param EventTemplate - UDialogueEventBase*, the event on the node.
+	* @return UDialogueEventBase*, the session's instance of the event.
+	*/
+	UDialogueEventBase* GetEventInstance(UDialogueEventBase* EventTemplate);
+
+	/**
+	* Finds this session's instance of the given event without creating it.
+	*
+	* @param EventTemplate - const UDialogueEventBase*, the event on the node.
+	* @return UDialogueEventBase*, the instance. Nullptr if none yet.
+	*/
+	UDialogueEventBase* FindEventInstance(
+		const UDialogueEventBase* EventTemplate) const;
+
+	/**
+	* Stores the node to return to on the next jump back.
+	*
+	* @param InNodeIndex - int32, the node table index to jump back to.
+	*/
+	void SetJumpBackNodeIndex(int32 InNodeIndex);
+
+	/**
+	* Retrieves and clears the stored jump back node.
+	*
+	* @return int32, the jump back node's table index. INDEX_NONE if none 
+	* set.
+	*/
+	int32 ConsumeJumpBackNodeIndex();
+
+	/**
+	* Retrieves the session's cache of query results.
+	*
+	* @return FDialogueQueryCache&, the cache.
+	*/
+	FDialogueQueryCache& GetQueryCache();
+
+	/**
+	* Drops every query result the session has cached. Call after changing
+	* state that queries read mid-dialogue. BlueprintCallable.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Dialogue")
+	void InvalidateQueries();
+
+	/**
+	* Issues every async query among the given ones that has no result yet,
+	* all at once. Each resolves on its own or falls back to its timeout
+	* result. Results last until the session leaves the active node.
+	*
+	* @param Queries - TConstArrayView<UDialogueQuery*>, the queries about to
+	* be read. Synchronous queries are ignored.
+	* @param OnResolved - FSimpleDelegate, called once every issued query 
+	* has resolved, if any had to be waited on.
+	* @return bool - True if the caller must wait for OnResolved, False if
+	* every result is already known.
+	*/
+	bool IssueAsyncQueries(TConstArrayView<UDialogueQuery*> Queries,
+		FSimpleDelegate OnResolved);
+
+	/**
+	* Finds the result of an async query resolved at the active node.
+	*
+	* @param Query - const UDialogueQuery*, the query.
+	* @param OutValue - double&, the result.
+	* @return bool - True if the query has resolved.
+	*/
+	bool FindAsyncResult(const UDialogueQuery* Query, double& OutValue) const;
+
+	/**
+	* Checks if the session is waiting on any async queries.
+	*
+	* @return bool - True if any issued query has not resolved yet.
+	*/
+	bool HasPendingQueries() const;
+
+	/**
+	* Drops every async query issued at the active node, ignoring any 
+	* results still to come.
+	*/
+	void CancelAsyncQueries();
+
+private:
+	/**
+	* Retrieves the scheduler timing the session's transitions.
+	*
+	* @return FDialogueTransitionScheduler*, the scheduler. Nullptr if the
+	* session's world has no dialogue manager.
+	*/
+	FDialogueTransitionScheduler* GetTransitionScheduler() const;
+
+	/**
+	* Called by an async query with its result.
+	*
+	* @param Value - double, the result.
+	* @param Query - TWeakObjectPtr<UDialogueQuery>, the query.
+	* @param Serial - uint32, the serial the query was issued under.
+	*/
+	void OnAsyncQueryResolved(double Value, 
+		TWeakObjectPtr<UDialogueQuery> Query, uint32 Serial);
+
+	/**
+	* Called when an async query takes longer than its timeout.
+	*
+	* @param Query - TWeakObjectPtr<UDialogueQuery>, the query.
+	* @param Serial - uint32, the serial the query was issued under.
+	*/
+	void OnAsyncQueryTimedOut(TWeakObjectPtr<UDialogueQuery> Query, 
+		uint32 Serial);
+
+	/**
+	* Stores an async query's result, notifying the waiting node once every
+	* issued query has resolved.
+	*
+	* @param Query - const UDialogueQuery*, the query.
+	* @param Value - double, the result.
+	*/
+	void ResolveAsyncQuery(const UDialogueQuery* Query, double Value);
+
+public:
+	/** Called once when the session ends */
+	FDialogueSessionEndedSignature OnSessionEnded;
+
+private:
+	/** The dialogue being played */
+	UPROPERTY()
+	TObjectPtr<UDialogue> Dialogue;
+
+	/** The controller displaying the dialogue */
+	UPROPERTY()
+	TObjectPtr<ADialogueController> DialogueController;
+
+	/** The currently active node in the dialogue */
+	UPROPERTY()
+	TObjectPtr<UDialogueNode> ActiveNode;
+
+	/** A mapping of speaker names to their found components */
+	UPROPERTY()
+	TMap<FName, UDialogueSpeakerComponent*> Speakers;
+
+	/** 
+	* Entries for the bound speakers, one per speaker role in the order of
+	* the dialogue's roles. Every speaker lookup indexes into these.
+	*/
+	UPROPERTY()
+	TArray<FSpeakerActorEntry> SpeakerEntries;
+
+	/** IDs of the bound non-player speakers. The player is left out, as 
+	* their history would otherwise carry over between NPCs. */
+	TArray<FGuid, TInlineAllocator<4>> ParticipantIds;
+
+	/** State of the transition out of the active node */
+	UPROPERTY()
+	FDialogueTransitionState TransitionState;
+
+	/** Per-session copies of the events played so far, keyed by template */
+	UPROPERTY()
+	TMap<TObjectPtr<UDialogueEventBase>, TObjectPtr<UDialogueEventBase>>
+		EventInstances;
+
+	/** Table index of the node to return to on the next jump back */
+	int32 JumpBackNodeIndex = INDEX_NONE;
+
+	/** Table index of a hop requested while a node was being entered */
+	int32 DeferredNodeIndex = INDEX_NONE;
+
+	/** Whether a hop is waiting in DeferredNodeIndex */
+	bool bHasDeferredNode = false;
+
+	/** Query results reused across evaluations */
+	FDialogueQueryCache QueryCache;
+
+	/** Async queries issued at the active node, keyed by query */
+	TMap<TObjectKey<UDialogueQuery>, FDialogueAsyncQueryEntry> AsyncQueries;
+
+	/** Called once every issued async query has resolved */
+	FSimpleDelegate OnAsyncQueriesResolved;
+
+	/** Number of issued async queries yet to resolve */
+	int32 NumPendingQueries = 0;
+
+	/** Bumped whenever async queries are dropped, so late results from 
+	* them are ignored */
+	uint32 AsyncQuerySerial = 0;
+
+	/** Whether async queries are being issued, so that queries resolving 
+	* straight away don't notify before the rest are issued */
+	bool bIssuingQueries = false;
+
+	/** Whether the dialogue's traversal loop is running for the session */
+	bool bTraversing = false;
+
+	/** Whether the session is paused */
+	bool bPaused = false;
+
+	/** How fast the session's clock runs */
+	float TimeDilation = 1.f;
+
+	/** The priority the session is scheduled with */
+	EDialogueSessionPriority Priority = EDialogueSessionPriority::Player;
+
+	/** Whether the session is still playing */
+	bool bActive = false;
+};
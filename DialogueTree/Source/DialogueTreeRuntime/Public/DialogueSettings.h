@@ -93,6 +93,83 @@ public:
 	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "General")
 	float DefaultMinimumPlayTime = 3.f;
 
+	/** The most nodes a dialogue may pass through without stopping to wait
+	* on a speech or event. Guards against endless loops of jumps, branches
+	* or zero length speeches. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "General",
+		meta = (ClampMin = 1))
+	int32 MaxTraversalHops = 1000;
+
+	/** The maximum number of undisplayed sessions (ambient chatter and barks)
+	* that may play at once. The player's dialogue is never counted. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Scheduling",
+		meta = (ClampMin = 0))
+	int32 MaxConcurrentSessions = 64;
+
+	/** The maximum number of queued sessions started in a single frame */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Scheduling",
+		meta = (ClampMin = 1))
+	int32 MaxSessionStartsPerFrame = 4;
+
+	/** Time in milliseconds the scheduler may spend starting queued sessions
+	* each frame. At least one session is started per frame regardless. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Scheduling",
+		meta = (ClampMin = 0.f))
+	float SchedulerFrameBudgetMs = 0.5f;
+
+	/** Time in seconds an ambient session may wait for its speakers to be
+	* free before it is dropped. Barks are dropped straight away. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Scheduling",
+		meta = (ClampMin = 0.f))
+	float PendingSessionTimeout = 10.f;
+
+	/** How many nodes ahead of each playing node to start streaming in 
+	* speech audio. Covers options, transition targets and branch targets.
+	* 0 streams in only the playing node's audio. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Audio",
+		meta = (ClampMin = 0))
+	int32 AudioPrefetchDepth = 2;
+
+	/** Time in seconds a speech may hold up the game waiting for its audio 
+	* to finish streaming in. Audio that is still loading after this is 
+	* skipped. 0 never waits. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Audio",
+		meta = (ClampMin = 0.f))
+	float AudioLoadTimeout = 0.25f;
+
+	/** Memory in megabytes that streamed speech audio may keep resident. 
+	* The least recently used audio beyond this is released, except audio 
+	* near a playing node. 0 keeps everything. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Audio",
+		meta = (ClampMin = 0.f))
+	float MaxResidentAudioMB = 64.f;
+
+	/** Whether to reorder branch and lock conditions when dialogues compile,
+	* checking those most likely to settle the set for the least cost first.
+	* Turn off if conditions rely on being checked in the order authored. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "Conditions")
+	bool ReorderConditions = true;
+
+	/** The most ephemeral speakers whose node visits are kept at once. The
+	* least recently heard beyond this are forgotten. 0 keeps everyone. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "History",
+		meta = (ClampMin = 0))
+	int32 MaxEphemeralSpeakers = 256;
+
+	/** How long the node visits of speakers without a set speaker ID are 
+	* kept. Such speakers are given a new ID every play, so their visits 
+	* cannot be matched to them after a load. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "History")
+	EDialogueSpeakerPersistence GeneratedSpeakerIdPersistence = 
+		EDialogueSpeakerPersistence::Session;
+
+	/** The most speaker records kept in memory once a cold history store is
+	* opened on the controller. The least recently used persistent records
+	* beyond this are spilled to disk. 0 keeps everything in memory. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "History",
+		meta = (ClampMin = 0))
+	int32 MaxResidentSpeakerRecords = 0;
+
 	/** 
 	* The type of dialogue widget used to represent dialogue when using the 
 	* default controller. Defaults to W_BasicDialogueDisplay if none. 
@@ -7,11 +7,13 @@
 #include "CoreMinimal.h"
 #include "GameplayTagContainer.h"
 //Plugin
+#include "History/DialogueHistoryStore.h"
 #include "SpeechDetails.h"
 //Generated
 #include "DialogueSpeakerComponent.generated.h"
 
 class ADialogueController;
+class UDialogueSession;
 
 /**
 * Delegate used to pass data about gameplay tag changes. 
@@ -47,6 +49,12 @@ struct DIALOGUETREERUNTIME_API FSpeakerActorEntry
 	TObjectPtr<UDialogueSpeakerComponent> SpeakerComponent = nullptr;
 };
 
+/** 
+* Speaker entries gathered for a single query or event. Held inline, as
+* queries and events rarely name more than a handful of speakers. 
+*/
+typedef TArray<FSpeakerActorEntry, TInlineAllocator<4>> FSpeakerActorEntryList;
+
 /**
 * A component representing a "speaker" or participant in a dialogue.
 * Serves as a liason between the dialogue and the game world.
@@ -139,6 +147,40 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Dialogue")
 	virtual void TrySkipSpeech();
 
+	/**
+	* Checks if the speaker is bound into a playing session. Cheap enough
+	* to poll every tick. BlueprintPure.
+	* 
+	* @return bool - True if the speaker is in dialogue.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	bool IsInDialogue() const;
+
+	/**
+	* Retrieves the session the speaker is currently bound into. 
+	* BlueprintPure.
+	* 
+	* @return UDialogueSession*, the session. Nullptr if not in dialogue.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Dialogue")
+	UDialogueSession* GetActiveSession() const;
+
+	/**
+	* Records the session the speaker has been bound into. Called by the
+	* session whenever it binds the speaker to a role.
+	* 
+	* @param InSession - UDialogueSession*, the session.
+	*/
+	void BindSession(UDialogueSession* InSession);
+
+	/**
+	* Forgets the given session, if it is the one the speaker is bound 
+	* into. Called by the session whenever it releases the speaker.
+	* 
+	* @param InSession - const UDialogueSession*, the session.
+	*/
+	void UnbindSession(const UDialogueSession* InSession);
+
 	/**
 	* Plays the given audio clip. Exposed to blueprint to be
 	* user-overridable. 
@@ -289,6 +331,14 @@ public:
 private:
 	void BroadcastCurrentGameplayTags();
 
+	/**
+	* Called whenever the speaker's audio finishes. Lets the transition
+	* scheduler know, in case a session is waiting on it.
+	*
+	* @param AudioComponent - UAudioComponent*, the speaker.
+	*/
+	void HandleAudioFinished(UAudioComponent* AudioComponent);
+
 protected:
 	/** The name to display for this speaker in dialogue */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
@@ -305,6 +355,12 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
 	TObjectPtr<UDialogue> OwnedDialogue;
 
+	/** How long the speaker's node visits are kept. Speakers spawned in 
+	* numbers, such as crowds, are best made ephemeral. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
+	EDialogueSpeakerPersistence HistoryPersistence = 
+		EDialogueSpeakerPersistence::Persistent;
+
 	/** Tags associated with a speech in dialogue. Used for animation, etc. 
 	* Set up as maps for ease of access and greater flexibility. */
 	UPROPERTY(BlueprintReadOnly, Category = "Dialogue", 
@@ -330,11 +386,32 @@ public:
 	// G2VS2
 protected:
 	virtual ADialogueController* GetDialogueController() const;
-	void SetDialogueSpeakerId(const FGuid& InDialogueSpeakerId) { DialogueSpeakerId = InDialogueSpeakerId; };
+	void SetDialogueSpeakerId(const FGuid& InDialogueSpeakerId);
 	
 public:
 	const FGuid& GetDialogueSpeakerId() const { return DialogueSpeakerId; }
 
+	/**
+	* Retrieves how long the speaker's node visits are kept. Speakers with a
+	* generated ID are kept no longer than the project settings allow.
+	*
+	* @return EDialogueSpeakerPersistence, the persistence.
+	*/
+	EDialogueSpeakerPersistence GetHistoryPersistence() const;
+
+private:
+	/**
+	* Lets the controller know how long the speaker's node visits are kept.
+	*/
+	void RegisterHistoryPersistence() const;
+
 private:
 	FGuid DialogueSpeakerId;
+
+	/** Whether the speaker ID was generated at begin play */
+	bool bGeneratedSpeakerId = false;
+
+	/** The session the speaker is bound into. The dialogue manager keeps a
+	* speaker to one session at a time. */
+	TWeakObjectPtr<UDialogueSession> ActiveSession;
 };
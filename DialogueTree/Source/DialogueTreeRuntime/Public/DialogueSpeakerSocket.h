@@ -33,16 +33,46 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Dialogue")
 	FName GetSpeakerName() const;
 
+	/**
+	* Sets the slot of the speaker's role among the dialogue's speaker 
+	* roles. Set when the dialogue compiles or loads.
+	* 
+	* @param InSlot - int32, the slot. INDEX_NONE if the role is unknown.
+	*/
+	void SetSpeakerSlot(int32 InSlot);
+
+	/**
+	* Retrieves the slot of the speaker's role among the dialogue's speaker
+	* roles.
+	* 
+	* @return int32, the slot. INDEX_NONE if not resolved.
+	*/
+	int32 GetSpeakerSlot() const;
+
 	/**
 	* Retrieve the component associated with this speaker from 
-	* the provided dialogue. 
+	* the provided session. 
 	* 
-	* @param InDialogue*, UDialogue* to get the speaker component from.
+	* @param InSession - const UDialogueSession*, session to get the speaker 
+	* component from.
 	* @return UDialogueSpeakerComponent*, the component for the speaker in the 
-	* given dialogue or nullptr if none found.
+	* given session or nullptr if none found.
 	*/
 	class UDialogueSpeakerComponent* GetSpeakerComponent(
-		class UDialogue* InDialogue) const;
+		const class UDialogueSession* InSession) const;
+
+	/**
+	* Retrieve the entry resolved for this speaker by the provided session.
+	* Reads the session's speaker slots rather than looking up the 
+	* component by name.
+	* 
+	* @param InSession - const UDialogueSession*, session to get the entry
+	* from.
+	* @return const FSpeakerActorEntry*, the entry for the speaker in the 
+	* given session or nullptr if none found.
+	*/
+	const struct FSpeakerActorEntry* GetSpeakerEntry(
+		const class UDialogueSession* InSession) const;
 
 	/**
 	* Checks to see if the socket's value is valid. 
@@ -55,4 +85,8 @@ private:
 	/** Name of the speaker */
 	UPROPERTY(EditAnywhere, Category = "Dialogue")
 	FName SpeakerName;
+
+	/** Slot of the speaker's role, resolved from its name */
+	UPROPERTY()
+	int32 SpeakerSlot = INDEX_NONE;
 };
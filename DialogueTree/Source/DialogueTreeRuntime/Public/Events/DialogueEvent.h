@@ -74,6 +74,18 @@ public:
 	const FSpeechDetails GetCurrentSpeechDetails() const;
 
 protected:
+	/**
+	* Native behavior for the event, called with the speakers resolved from
+	* the session's slots. Override in C++ to play without allocating. By 
+	* default, copies the additional speakers into an array for OnPlayEvent.
+	*
+	* @param InSpeaker - const FSpeakerActorEntry&, the target speaker.
+	* @param OtherSpeakers - TConstArrayView<FSpeakerActorEntry>, any 
+	* additional speakers.
+	*/
+	virtual void NativePlayEvent(const FSpeakerActorEntry& InSpeaker,
+		TConstArrayView<FSpeakerActorEntry> OtherSpeakers);
+
 	/**
 	* User specified behavior for the event.
 	* 
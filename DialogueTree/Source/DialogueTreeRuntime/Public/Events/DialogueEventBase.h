@@ -7,6 +7,7 @@
 #include "DialogueEventBase.generated.h"
 
 class UDialogue;
+class UDialogueSession;
 
 DECLARE_DELEGATE(FDialogueEventSignature);
 
@@ -78,11 +79,32 @@ public:
 	*/
 	void SetDialogue(UDialogue* InDialogue);
 
+	/**
+	* Sets the session this instance of the event plays for. Only set on 
+	* the per-session copies of the event, never on the dialogue's own.
+	*
+	* @param InSession - UDialogueSession*, the playing session.
+	*/
+	void SetSession(UDialogueSession* InSession);
+
+	/**
+	* Retrieves the session this instance of the event plays for.
+	*
+	* @return UDialogueSession*, the session. Nullptr on the dialogue's own
+	* copy of the event.
+	*/
+	UFUNCTION(BlueprintPure, Category = "DialogueEvent")
+	UDialogueSession* GetSession() const;
+
 protected:
 	/** Dialogue owning this event */
 	UPROPERTY()
 	TObjectPtr<UDialogue> Dialogue;
 
+	/** Session this instance of the event plays for */
+	UPROPERTY(Transient)
+	TObjectPtr<UDialogueSession> Session;
+
 	/** Whether or not the event is still in progress/the dialogue should 
 	* wait for it. */
 	UPROPERTY()
@@ -0,0 +1,60 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+#pragma once
+
+//UE
+#include "CoreMinimal.h"
+
+struct FDialogueHistories;
+
+/**
+* Reads and writes FDialogueHistories in a compact, versioned binary form.
+* Every dialogue name and node ID is written once to a name table and
+* referred to by its position from then on, so that the node IDs repeated
+* across speakers and dialogues cost a few bytes each.
+*/
+class DIALOGUETREERUNTIME_API FDialogueHistoriesCodec
+{
+public:
+	/**
+	* Writes the histories to the archive.
+	*
+	* @param Ar - FArchive&, the archive. Must be saving.
+	* @param Histories - const FDialogueHistories&, the histories.
+	*/
+	static void Write(FArchive& Ar, const FDialogueHistories& Histories);
+
+	/**
+	* Reads histories previously written by Write().
+	*
+	* @param Ar - FArchive&, the archive. Must be loading.
+	* @param OutHistories - FDialogueHistories&, replaced with the histories
+	* read. Left empty if they could not be read.
+	* @return bool - True if the histories could be read.
+	*/
+	static bool Read(FArchive& Ar, FDialogueHistories& OutHistories);
+
+	/**
+	* Writes the histories to a byte array.
+	*
+	* @param Histories - const FDialogueHistories&, the histories.
+	* @param OutBytes - TArray<uint8>&, filled with the written histories.
+	*/
+	static void SaveToBytes(const FDialogueHistories& Histories,
+		TArray<uint8>& OutBytes);
+
+	/**
+	* Reads histories previously written by SaveToBytes().
+	*
+	* @param InBytes - const TArray<uint8>&, the written histories.
+	* @param OutHistories - FDialogueHistories&, replaced with the histories
+	* read. Left empty if they could not be read.
+	* @return bool - True if the histories could be read.
+	*/
+	static bool LoadFromBytes(const TArray<uint8>& InBytes,
+		FDialogueHistories& OutHistories);
+
+private:
+	/** Version written at the head of the binary form */
+	static constexpr int32 CurrentVersion = 1;
+};
@@ -0,0 +1,428 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+#pragma once
+
+//UE
+#include "CoreMinimal.h"
+#include "Async/MappedFileHandle.h"
+//Plugin
+#include "History/DialogueHistoryStore.h"
+
+/**
+* Struct naming a single speaker record handed to the cold store to write.
+*/
+struct DIALOGUETREERUNTIME_API FDialogueColdRecord
+{
+	/** The speaker's dialogue speaker ID */
+	FGuid SpeakerId;
+
+	/** The dialogue's GUID */
+	FGuid DialogueId;
+
+	/** The record. Records with no visits and no resume node are dropped
+	* from the store. */
+	const FDialogueSpeakerHistory* Speaker = nullptr;
+};
+
+/**
+* A single shard of a cold store: a sorted table of speaker records held in
+* one file, memory mapped so that a lookup pages in only the parts of the
+* table it touches. Never changes once opened; writing a shard replaces it
+* with a new one. Shared by the store and any views taken of it, and kept
+* mapped until the last of them lets go.
+*/
+class FDialogueHistoryColdShard
+{
+public:
+	/**
+	* Struct laying out a single record's entry in the table.
+	*/
+	struct FEntry
+	{
+		FGuid SpeakerId;
+		FGuid DialogueId;
+		int32 ResumeNodeIndex;
+		uint32 WordOffset;
+		uint32 NumWords;
+		uint32 Padding;
+	};
+
+public:
+	/**
+	* Constructor. The shard starts out empty, with no file.
+	*
+	* @param InGeneration - uint32, the generation of the shard's file.
+	*/
+	explicit FDialogueHistoryColdShard(uint32 InGeneration = 0);
+
+	/** Destructor. Deletes the shard's file if it was retired. */
+	~FDialogueHistoryColdShard();
+
+	FDialogueHistoryColdShard(const FDialogueHistoryColdShard&) = delete;
+	FDialogueHistoryColdShard& operator=(
+		const FDialogueHistoryColdShard&) = delete;
+
+	/**
+	* Maps or loads the given file.
+	*
+	* @param InFilename - const FString&, the file.
+	* @return bool - True if the file could be read.
+	*/
+	bool Open(const FString& InFilename);
+
+	/**
+	* Marks the shard's file to be deleted once the shard is released,
+	* after a newer generation replaced it. Called by the store only.
+	*/
+	void Retire();
+
+	/**
+	* Retrieves the generation of the shard's file.
+	*
+	* @return uint32, the generation.
+	*/
+	uint32 GetGeneration() const { return Generation; }
+
+	/**
+	* Retrieves the number of entries in the table.
+	*
+	* @return int32, the number of entries.
+	*/
+	int32 Num() const { return NumEntries; }
+
+	/**
+	* Finds the first entry not ordered before the given key.
+	*
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @return int32, the entry's position. Num() if none.
+	*/
+	int32 LowerBound(const FGuid& SpeakerId, const FGuid& DialogueId) const;
+
+	/**
+	* Looks up a single speaker record's entry.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @param OutEntry - FEntry&, filled with the entry if found.
+	* @return bool - True if found.
+	*/
+	bool FindEntry(const FGuid& DialogueId, const FGuid& SpeakerId,
+		FEntry& OutEntry) const;
+
+	/**
+	* Reads the entry at the given position in the table.
+	*
+	* @param EntryIndex - int32, the position.
+	* @return FEntry, the entry.
+	*/
+	FEntry ReadEntry(int32 EntryIndex) const;
+
+	/**
+	* Reads an entry's record.
+	*
+	* @param Entry - const FEntry&, the entry.
+	* @param OutSpeaker - FDialogueSpeakerHistory&, filled with the record.
+	*/
+	void ReadRecord(const FEntry& Entry,
+		FDialogueSpeakerHistory& OutSpeaker) const;
+
+	/**
+	* Checks if an entry's record has the given node visited, reading only
+	* the word that holds it.
+	*
+	* @param Entry - const FEntry&, the entry.
+	* @param NodeIndex - int32, the node. INDEX_NONE asks whether any node
+	* was visited.
+	* @return bool - True if visited.
+	*/
+	bool WasVisited(const FEntry& Entry, int32 NodeIndex) const;
+
+public:
+	/** Tag at the head of every shard file */
+	static constexpr uint32 Magic = 0x43485444;
+
+	/** Version written at the head of every shard file */
+	static constexpr uint32 CurrentVersion = 1;
+
+	/** Bytes taken up by a shard file's header: magic, version, number of
+	* entries and padding */
+	static constexpr int32 HeaderSize = 4 * sizeof(uint32);
+
+private:
+	/**
+	* Releases the shard's contents.
+	*/
+	void Release();
+
+private:
+	/** The shard's file. Empty if the shard has none. */
+	FString Filename;
+
+	/** The generation of the shard's file, bumped with every write */
+	uint32 Generation = 0;
+
+	/** Whether the file is deleted once the shard is released. Only read
+	* once the last reference is gone. */
+	bool bRetired = false;
+
+	/** The mapped file, if mapped */
+	TUniquePtr<IMappedFileHandle> Handle;
+
+	/** The mapped contents. Released before the handle. */
+	TUniquePtr<IMappedFileRegion> Region;
+
+	/** The contents, if the platform could not map the file */
+	TArray<uint8> Loaded;
+
+	/** The contents, however they are held */
+	TConstArrayView<uint8> Bytes;
+
+	/** Number of entries in the table */
+	int32 NumEntries = 0;
+};
+
+/** Shard shared between a cold store and its views */
+typedef TSharedRef<FDialogueHistoryColdShard, ESPMode::ThreadSafe>
+	FDialogueHistoryColdShardRef;
+
+/**
+* A read-only view of a cold store's shards as they were when it was taken,
+* safe to read from any thread. Shards rewritten since stay mapped for as
+* long as the view holds them.
+*/
+class DIALOGUETREERUNTIME_API FDialogueHistoryColdView
+{
+public:
+	/**
+	* Looks up a single speaker record.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @param OutSpeaker - FDialogueSpeakerHistory&, filled with the record
+	* if found.
+	* @return bool - True if found.
+	*/
+	bool Find(const FGuid& DialogueId, const FGuid& SpeakerId,
+		FDialogueSpeakerHistory& OutSpeaker) const;
+
+	/**
+	* Checks if the speaker's record has the given node visited.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @param NodeIndex - int32, the node. INDEX_NONE asks whether any node
+	* was visited.
+	* @return bool - True if visited.
+	*/
+	bool WasVisited(const FGuid& DialogueId, const FGuid& SpeakerId,
+		int32 NodeIndex) const;
+
+	/**
+	* Adds every dialogue the speaker has visited a node in.
+	*
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @param OutDialogueIds - TArray<FGuid>&, added to.
+	*/
+	void FindVisitedDialogues(const FGuid& SpeakerId,
+		TArray<FGuid>& OutDialogueIds) const;
+
+private:
+	friend class FDialogueHistoryColdStore;
+
+	/**
+	* Retrieves the shard a speaker's records are kept in.
+	*
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @return const FDialogueHistoryColdShard&, the shard.
+	*/
+	const FDialogueHistoryColdShard& GetShard(const FGuid& SpeakerId) const;
+
+	/** The shards, as they were when the view was taken */
+	TArray<TSharedRef<const FDialogueHistoryColdShard, ESPMode::ThreadSafe>>
+		Shards;
+};
+
+/** Shared handle to a cold store view */
+typedef TSharedPtr<const FDialogueHistoryColdView, ESPMode::ThreadSafe>
+	FDialogueHistoryColdViewPtr;
+
+/**
+* Keeps cold speaker records on disk, for worlds with far more speakers than
+* are worth keeping resident. Records are split across shard files by
+* speaker, each a sorted table of records that is memory mapped, so that a
+* lookup pages in only the parts of the table it touches. Writing rewrites
+* the shards written to, so records are best written in batches.
+*
+* Each write of a shard goes to a file of the next generation, so that the
+* old file stays mapped for views still reading it, and is deleted once they
+* let go. Only the latest generation of each shard is read when opened.
+*
+* The shard files are a local cache in the platform's byte order, not a
+* save format. They hold only what was spilled since the last load.
+*/
+class DIALOGUETREERUNTIME_API FDialogueHistoryColdStore
+{
+public:
+	/** Constructor */
+	FDialogueHistoryColdStore();
+
+	/** Destructor */
+	~FDialogueHistoryColdStore();
+
+	FDialogueHistoryColdStore(const FDialogueHistoryColdStore&) = delete;
+	FDialogueHistoryColdStore& operator=(
+		const FDialogueHistoryColdStore&) = delete;
+
+	/**
+	* Opens the shards kept in the given directory, creating it if needed.
+	*
+	* @param InDirectory - const FString&, the directory.
+	* @param InNumShards - int32, the number of shards to split records
+	* across. Must match the number the directory was written with.
+	* @return bool - True if the directory could be opened.
+	*/
+	bool Open(const FString& InDirectory,
+		int32 InNumShards = DefaultNumShards);
+
+	/**
+	* Closes the shards, keeping their files.
+	*/
+	void Close();
+
+	/**
+	* Checks if the store is open.
+	*
+	* @return bool - True if open.
+	*/
+	bool IsOpen() const;
+
+	/**
+	* Looks up a single speaker record.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @param OutSpeaker - FDialogueSpeakerHistory&, filled with the record
+	* if found.
+	* @return bool - True if found.
+	*/
+	bool Find(const FGuid& DialogueId, const FGuid& SpeakerId,
+		FDialogueSpeakerHistory& OutSpeaker) const;
+
+	/**
+	* Calls the given function with every speaker that has a record in the
+	* given dialogue. The first call walks every shard to index the records
+	* by dialogue; the index is kept up to date from then on.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param Func - TFunctionRef<void(const FGuid&)>, called with each
+	* speaker's ID.
+	*/
+	void ForEachSpeaker(const FGuid& DialogueId,
+		TFunctionRef<void(const FGuid&)> Func) const;
+
+	/**
+	* Calls the given function with the key of every record kept. Walks
+	* every shard.
+	*
+	* @param Func - TFunctionRef<void(const FGuid&, const FGuid&)>, called
+	* with each record's dialogue ID, then speaker ID.
+	*/
+	void ForEachKey(TFunctionRef<void(const FGuid&, const FGuid&)> Func) const;
+
+	/**
+	* Writes the given records over any kept for the same speaker and
+	* dialogue.
+	*
+	* @param InRecords - TArray<FDialogueColdRecord>&, the records. Sorted
+	* in place.
+	* @return bool - True if every shard written to could be saved.
+	*/
+	bool Write(TArray<FDialogueColdRecord>& InRecords);
+
+	/**
+	* Forgets every record, deleting the shard files once no view holds
+	* them.
+	*/
+	void Reset();
+
+	/**
+	* Counts the records kept.
+	*
+	* @return int64, the number of records.
+	*/
+	int64 Num() const;
+
+	/**
+	* Retrieves a view of the shards as they are now, for readers on other
+	* threads. The same view is handed out until the shards next change.
+	* Game thread only.
+	*
+	* @return FDialogueHistoryColdViewPtr, the view. Null if closed.
+	*/
+	FDialogueHistoryColdViewPtr GetView() const;
+
+public:
+	/** Shards used unless told otherwise */
+	static constexpr int32 DefaultNumShards = 64;
+
+private:
+	/**
+	* Retrieves the shard a speaker's records are kept in.
+	*
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @return int32, the shard's index.
+	*/
+	int32 GetShardIndex(const FGuid& SpeakerId) const;
+
+	/**
+	* Retrieves the file a generation of a shard is kept in.
+	*
+	* @param ShardIndex - int32, the shard.
+	* @param Generation - uint32, the generation.
+	* @return FString, the file's path.
+	*/
+	FString GetShardFilename(int32 ShardIndex, uint32 Generation) const;
+
+	/**
+	* Replaces a shard, retiring the one it replaces.
+	*
+	* @param ShardIndex - int32, the shard.
+	* @param Shard - const FDialogueHistoryColdShardRef&, the replacement.
+	*/
+	void ReplaceShard(int32 ShardIndex,
+		const FDialogueHistoryColdShardRef& Shard);
+
+	/**
+	* Rewrites a shard with the given records merged in.
+	*
+	* @param ShardIndex - int32, the shard.
+	* @param InRecords - TConstArrayView<FDialogueColdRecord>, the records,
+	* sorted by speaker then dialogue.
+	* @return bool - True if the shard could be saved.
+	*/
+	bool WriteShard(int32 ShardIndex,
+		TConstArrayView<FDialogueColdRecord> InRecords);
+
+	/**
+	* Indexes the speakers of every record kept by dialogue, if not done 
+	* already.
+	*/
+	void BuildSpeakersByDialogue() const;
+
+private:
+	/** The directory holding the shards. Empty if closed. */
+	FString Directory;
+
+	/** The open shards */
+	TArray<FDialogueHistoryColdShardRef> Shards;
+
+	/** The view handed out since the shards last changed, if any */
+	mutable FDialogueHistoryColdViewPtr View;
+
+	/** Speakers with a record kept, by dialogue. Built on first use. */
+	mutable TMap<FGuid, TSet<FGuid>> SpeakersByDialogue;
+
+	/** Whether SpeakersByDialogue has been built */
+	mutable bool bSpeakersByDialogueBuilt = false;
+};
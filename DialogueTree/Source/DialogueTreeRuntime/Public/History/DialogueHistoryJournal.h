@@ -0,0 +1,55 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+#pragma once
+
+//UE
+#include "CoreMinimal.h"
+
+/**
+* Lays out a journal of saved dialogue history: a full snapshot followed by
+* the changes saved since, each as a length-prefixed frame. Saving appends
+* a frame rather than rewriting the whole history, and loading replays the
+* frames in order. A full frame replaces everything before it, which is how
+* the journal is compacted once its changes outgrow the snapshot.
+*/
+class DIALOGUETREERUNTIME_API FDialogueHistoryJournal
+{
+public:
+	/**
+	* Appends a frame to the journal. A full frame replaces the journal.
+	*
+	* @param Journal - TArray<uint8>&, the journal.
+	* @param Frame - TConstArrayView<uint8>, the frame's contents.
+	* @param bIsFull - bool, whether the frame holds the whole history.
+	*/
+	static void AppendFrame(TArray<uint8>& Journal,
+		TConstArrayView<uint8> Frame, bool bIsFull);
+
+	/**
+	* Calls the given function with every frame in the journal, in order.
+	*
+	* @param Journal - TConstArrayView<uint8>, the journal.
+	* @param Func - TFunctionRef<bool(TConstArrayView<uint8>)>, called with
+	* each frame's contents. Returning false stops the walk.
+	* @return bool - True if every frame was walked, False if the function
+	* stopped early or the journal is malformed.
+	*/
+	static bool ForEachFrame(TConstArrayView<uint8> Journal,
+		TFunctionRef<bool(TConstArrayView<uint8>)> Func);
+
+	/**
+	* Checks if the changes appended to the journal have outgrown its
+	* snapshot, so that writing a new snapshot would be smaller.
+	*
+	* @param Journal - TConstArrayView<uint8>, the journal.
+	* @return bool - True if the journal should be compacted.
+	*/
+	static bool ShouldCompact(TConstArrayView<uint8> Journal);
+
+private:
+	/** Bytes taken up by each frame's length prefix */
+	static constexpr int32 FrameHeaderSize = sizeof(uint32);
+
+	/** Bytes of changes below which a journal is never compacted */
+	static constexpr int64 MinCompactSize = 16 * 1024;
+};
@@ -0,0 +1,237 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+#pragma once
+
+//UE
+#include "CoreMinimal.h"
+#include "Misc/ScopeRWLock.h"
+//Plugin
+#include "History/DialogueHistoryStore.h"
+
+class FDialogueHistoryColdView;
+class UDialogue;
+
+/**
+* Struct describing a single question asked of a history snapshot in bulk:
+* whether the speaker has visited the node in the dialogue.
+*/
+struct DIALOGUETREERUNTIME_API FDialogueVisitQuery
+{
+	/** The dialogue's GUID */
+	FGuid DialogueId;
+
+	/** The speaker's dialogue speaker ID */
+	FGuid SpeakerId;
+
+	/** The node's index. INDEX_NONE asks whether the speaker has visited
+	* any node in the dialogue. */
+	int32 NodeIndex = INDEX_NONE;
+};
+
+/**
+* An immutable copy of the node visit history, safe to read from any
+* thread. Speaker records that did not change between two snapshots are 
+* shared by both, so publishing a snapshot copies only the speakers that
+* changed, plus the table of shared speakers of each dialogue they are in.
+* Speakers spilled to a cold store are read from a view of its shards 
+* taken at publish, so the visit queries see every record.
+*/
+class DIALOGUETREERUNTIME_API FDialogueHistorySnapshot
+{
+public:
+	/**
+	* Retrieves the snapshot's version, bumped with every publish.
+	*
+	* @return uint32, the version.
+	*/
+	uint32 GetVersion() const { return Version; }
+
+	/**
+	* Retrieves the speaker's record for the given dialogue, if kept in 
+	* memory. Speakers spilled to a cold store are left out; the visit 
+	* queries find them.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @return const FDialogueSpeakerHistory*, the record, or nullptr if none.
+	*/
+	const FDialogueSpeakerHistory* FindSpeaker(const FGuid& DialogueId,
+		const FGuid& SpeakerId) const;
+
+	/**
+	* Looks up the index of the given node in the given dialogue. Nodes
+	* renamed since are still found by their old ID.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param NodeID - FName, the node.
+	* @return int32, the node's index, or INDEX_NONE if not found or the
+	* dialogue was never played.
+	*/
+	int32 FindNodeIndex(const FGuid& DialogueId, FName NodeID) const;
+
+	/**
+	* Checks if any of the given speakers visited the given node.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerIds - TConstArrayView<FGuid>, the speakers.
+	* @param NodeIndex - int32, the node.
+	* @return bool - True if visited.
+	*/
+	bool WasVisited(const FGuid& DialogueId,
+		TConstArrayView<FGuid> SpeakerIds, int32 NodeIndex) const;
+
+	/**
+	* Checks if any of the given speakers visited the given node.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerIds - TConstArrayView<FGuid>, the speakers.
+	* @param NodeID - FName, the node.
+	* @return bool - True if visited.
+	*/
+	bool WasVisited(const FGuid& DialogueId,
+		TConstArrayView<FGuid> SpeakerIds, FName NodeID) const;
+
+	/**
+	* Checks if the speaker has visited any node in the dialogue, i.e. has
+	* had the conversation at all.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @return bool - True if any node was visited.
+	*/
+	bool HasVisitedAny(const FGuid& DialogueId, const FGuid& SpeakerId) const;
+
+	/**
+	* Answers a batch of visit queries.
+	*
+	* @param Queries - TConstArrayView<FDialogueVisitQuery>, the queries.
+	* @param OutResults - TArrayView<bool>, filled with each query's answer.
+	* Must be as long as Queries.
+	*/
+	void WasVisited(TConstArrayView<FDialogueVisitQuery> Queries,
+		TArrayView<bool> OutResults) const;
+
+	/**
+	* Gathers every dialogue the speaker has visited a node in.
+	*
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @param OutDialogueIds - TArray<FGuid>&, filled with the dialogues.
+	*/
+	void FindVisitedDialogues(const FGuid& SpeakerId,
+		TArray<FGuid>& OutDialogueIds) const;
+
+private:
+	friend class FDialogueHistoryPublisher;
+
+	/** Record of a single speaker, shared between snapshots */
+	typedef TSharedRef<const FDialogueSpeakerHistory, ESPMode::ThreadSafe>
+		FSpeakerRef;
+
+	/**
+	* Struct holding every speaker's record for a single dialogue.
+	*/
+	struct FRecord
+	{
+		/** Records keyed by speaker ID */
+		TMap<FGuid, FSpeakerRef> Speakers;
+	};
+
+	/**
+	* Checks if the speaker visited the given node, reading the cold store
+	* for speakers the record does not hold.
+	*
+	* @param Record - const FRecord*, the dialogue's record, if any.
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @param NodeIndex - int32, the node. INDEX_NONE asks whether any node
+	* was visited.
+	* @return bool - True if visited.
+	*/
+	bool WasSpeakerVisited(const FRecord* Record, const FGuid& DialogueId, 
+		const FGuid& SpeakerId, int32 NodeIndex) const;
+
+	/**
+	* Retrieves the record kept in memory for the given dialogue.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @return const FRecord*, the record, or nullptr if none.
+	*/
+	const FRecord* FindRecord(const FGuid& DialogueId) const;
+
+	/** Record of a single dialogue, shared between snapshots */
+	typedef TSharedRef<const FRecord, ESPMode::ThreadSafe> FRecordRef;
+
+	/** Node indices of a single dialogue by node ID, shared between
+	* snapshots */
+	typedef TSharedRef<const TMap<FName, int32>, ESPMode::ThreadSafe>
+		FNodeIndexMapRef;
+
+	/** Bumped with every publish */
+	uint32 Version = 0;
+
+	/** Records keyed by dialogue GUID */
+	TMap<FGuid, FRecordRef> Records;
+
+	/** Node indices of every dialogue played, keyed by dialogue GUID */
+	TMap<FGuid, FNodeIndexMapRef> NodeIndices;
+
+	/** The cold store's shards as they were at publish. Null if none. */
+	TSharedPtr<const FDialogueHistoryColdView, ESPMode::ThreadSafe> ColdView;
+};
+
+/** Shared handle to a history snapshot */
+typedef TSharedRef<const FDialogueHistorySnapshot, ESPMode::ThreadSafe>
+	FDialogueHistorySnapshotRef;
+
+/**
+* Publishes snapshots of the node visit history for readers on other
+* threads, such as AI scoring and Mass processors. The game thread
+* publishes a new snapshot at most once per frame, covering every change
+* made since the last; readers take the latest and may keep reading it for
+* as long as they hold it, never waiting on the game thread. A snapshot is
+* freed once its last reader lets go.
+*/
+class DIALOGUETREERUNTIME_API FDialogueHistoryPublisher
+{
+public:
+	/** Constructor */
+	FDialogueHistoryPublisher();
+
+	/**
+	* Retrieves the latest snapshot. Safe from any thread.
+	*
+	* @return FDialogueHistorySnapshotRef, the snapshot.
+	*/
+	FDialogueHistorySnapshotRef GetSnapshot() const;
+
+	/**
+	* Makes the given dialogue's node IDs known to readers. Game thread
+	* only.
+	*
+	* @param Dialogue - const UDialogue*, the dialogue.
+	*/
+	void RegisterDialogue(const UDialogue* Dialogue);
+
+	/**
+	* Publishes whatever changed in the store since the last publish. Does
+	* nothing if nothing changed. Game thread only.
+	*
+	* @param Store - FDialogueHistoryStore&, the store.
+	*/
+	void Publish(FDialogueHistoryStore& Store);
+
+private:
+	/** Guards the handle to the latest snapshot. Held only to copy or
+	* swap the handle, never while a snapshot is built or read. */
+	mutable FRWLock SnapshotLock;
+
+	/** The latest snapshot */
+	FDialogueHistorySnapshotRef Snapshot;
+
+	/** Node indices registered since the last publish */
+	TMap<FGuid, FDialogueHistorySnapshot::FNodeIndexMapRef> NewNodeIndices;
+
+	/** Speakers changed since the last publish by dialogue, reused between
+	* publishes */
+	TMap<FGuid, TSet<FGuid>> ChangedSpeakers;
+};
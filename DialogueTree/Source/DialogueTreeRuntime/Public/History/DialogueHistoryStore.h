@@ -0,0 +1,653 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+#pragma once
+
+//UE
+#include "CoreMinimal.h"
+//Generated
+#include "DialogueHistoryStore.generated.h"
+
+class FDialogueHistoryColdStore;
+class FDialogueHistoryColdView;
+
+/**
+* Enum describing how long a speaker's node visits are kept. Ordered from
+* longest lived to shortest.
+*/
+UENUM(BlueprintType)
+enum class EDialogueSpeakerPersistence : uint8
+{
+	/** Saved with the game and kept until cleared */
+	Persistent,
+	/** Kept until the world ends, but never saved */
+	Session,
+	/** Kept only while among the most recently heard ephemeral speakers, 
+	* and never saved. For crowds of spawned speakers. */
+	Ephemeral
+};
+
+/**
+* Struct holding a packed set of visited node indices, one bit per node in
+* a dialogue's node table. Membership tests are a single word lookup.
+*/
+USTRUCT()
+struct DIALOGUETREERUNTIME_API FDialogueVisitBits
+{
+	GENERATED_BODY()
+
+	/** Bit N of word N / 32 is set if the node at index N was visited */
+	UPROPERTY(SaveGame)
+	TArray<uint32> Words;
+
+	/**
+	* Checks if the given node index is set.
+	*
+	* @param NodeIndex - int32, the node to check.
+	* @return bool - True if set.
+	*/
+	bool Contains(int32 NodeIndex) const
+	{
+		const int32 WordIndex = NodeIndex >> 5;
+		return NodeIndex >= 0 && WordIndex < Words.Num()
+			&& (Words[WordIndex] & (1u << (NodeIndex & 31))) != 0;
+	}
+
+	/**
+	* Sets the given node index, growing the set if needed.
+	*
+	* @param NodeIndex - int32, the node to set.
+	* @return bool - True if the index was not already set.
+	*/
+	bool Add(int32 NodeIndex);
+
+	/**
+	* Clears the given node index.
+	*
+	* @param NodeIndex - int32, the node to clear.
+	* @return bool - True if the index was set.
+	*/
+	bool Remove(int32 NodeIndex);
+
+	/**
+	* Clears every index, keeping the allocation.
+	*/
+	void Reset();
+
+	/**
+	* Checks if no index is set.
+	*
+	* @return bool - True if empty.
+	*/
+	bool IsEmpty() const;
+
+	/**
+	* Counts the indices that are set.
+	*
+	* @return int32, the number of visited nodes.
+	*/
+	int32 Num() const;
+
+	/**
+	* Calls the given function with every set index, in ascending order.
+	*
+	* @param Func - callable taking an int32 node index.
+	*/
+	template<typename FuncType>
+	void ForEach(FuncType&& Func) const
+	{
+		for (int32 WordIndex = 0; WordIndex < Words.Num(); ++WordIndex)
+		{
+			uint32 Word = Words[WordIndex];
+			while (Word != 0)
+			{
+				const int32 Bit = FMath::CountTrailingZeros(Word);
+				Func((WordIndex << 5) + Bit);
+				Word &= Word - 1;
+			}
+		}
+	}
+
+private:
+	/** Drops zero words from the end so that saves stay small */
+	void Trim();
+};
+
+/**
+* Struct holding one speaker's record for a single dialogue.
+*/
+USTRUCT()
+struct DIALOGUETREERUNTIME_API FDialogueSpeakerHistory
+{
+	GENERATED_BODY()
+
+	/** The nodes the speaker has visited */
+	UPROPERTY(SaveGame)
+	FDialogueVisitBits VisitedNodes;
+
+	/** The node to resume the dialogue from. INDEX_NONE if none. */
+	UPROPERTY(SaveGame)
+	int32 ResumeNodeIndex = INDEX_NONE;
+
+	/** When the record was last read or written, in store ticks, for 
+	* spilling to the cold store. Not saved. */
+	uint64 LastUse = 0;
+};
+
+/**
+* Struct holding every speaker's record for a single dialogue.
+*/
+USTRUCT()
+struct DIALOGUETREERUNTIME_API FDialogueHistoryRecord
+{
+	GENERATED_BODY()
+
+	/** Records keyed by speaker ID */
+	UPROPERTY(SaveGame)
+	TMap<FGuid, FDialogueSpeakerHistory> Speakers;
+};
+
+/**
+* Struct holding an estimate of the memory a history store takes up, split
+* by speaker persistence.
+*/
+struct DIALOGUETREERUNTIME_API FDialogueHistoryMemoryStats
+{
+	/** Number of persistence classes */
+	static constexpr int32 NumClasses = 
+		static_cast<int32>(EDialogueSpeakerPersistence::Ephemeral) + 1;
+
+	/** Number of speaker records of each class */
+	int32 NumSpeakerRecords[NumClasses] = {};
+
+	/** Bytes held by the speaker records of each class */
+	SIZE_T SpeakerBytes[NumClasses] = {};
+
+	/** Number of dialogue records */
+	int32 NumDialogueRecords = 0;
+
+	/** Number of speaker records spilled to the cold store */
+	int64 NumColdSpeakerRecords = 0;
+
+	/** Bytes held by the store's own containers */
+	SIZE_T OverheadBytes = 0;
+};
+
+/**
+* Struct holding what a history store knows about a single ephemeral 
+* speaker.
+*/
+struct FDialogueEphemeralSpeaker
+{
+	/** When the speaker was last recorded, in store ticks */
+	uint64 LastUse = 0;
+
+	/** The dialogues the speaker has records in */
+	TArray<FGuid, TInlineAllocator<4>> Dialogues;
+};
+
+/**
+* Struct holding the node visit "memory" of every dialogue in the game,
+* keyed by dialogue GUID and speaker, with nodes addressed by their index in
+* the dialogue's node table. Serializes itself to a compact, versioned 
+* binary form, so it can be dropped straight into a SaveGame object.
+*/
+USTRUCT(BlueprintType)
+struct DIALOGUETREERUNTIME_API FDialogueHistoryStore
+{
+	GENERATED_BODY()
+
+	/** Records keyed by dialogue GUID */
+	UPROPERTY(SaveGame)
+	TMap<FGuid, FDialogueHistoryRecord> Records;
+
+	/** Records read from saves that keyed dialogues by name, waiting for 
+	* their dialogue to be adopted by GUID */
+	UPROPERTY(SaveGame)
+	TMap<FName, FDialogueHistoryRecord> LegacyRecords;
+
+	/**
+	* Marks the node visited for each of the given speakers.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerIds - TConstArrayView<FGuid>, the speakers.
+	* @param NodeIndex - int32, the node.
+	* @return bool - True if any of the speakers had not visited it yet.
+	*/
+	bool MarkVisited(const FGuid& DialogueId,
+		TConstArrayView<FGuid> SpeakerIds, int32 NodeIndex);
+
+	/**
+	* Marks the node unvisited for each of the given speakers.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerIds - TConstArrayView<FGuid>, the speakers.
+	* @param NodeIndex - int32, the node.
+	* @return bool - True if any of the speakers had visited it.
+	*/
+	bool MarkUnvisited(const FGuid& DialogueId,
+		TConstArrayView<FGuid> SpeakerIds, int32 NodeIndex);
+
+	/**
+	* Checks if any of the given speakers visited the node.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerIds - TConstArrayView<FGuid>, the speakers.
+	* @param NodeIndex - int32, the node.
+	* @return bool - True if visited.
+	*/
+	bool WasVisited(const FGuid& DialogueId,
+		TConstArrayView<FGuid> SpeakerIds, int32 NodeIndex) const;
+
+	/**
+	* Clears every visit and resume node recorded for the dialogue, for
+	* every speaker, keeping the allocations.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @return bool - True if the dialogue had a record.
+	*/
+	bool ClearVisits(const FGuid& DialogueId);
+
+	/**
+	* Sets the resume node for each of the given speakers.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerIds - TConstArrayView<FGuid>, the speakers.
+	* @param NodeIndex - int32, the node to resume from.
+	* @return bool - True if any of the speakers' resume node changed.
+	*/
+	bool SetResumeNode(const FGuid& DialogueId,
+		TConstArrayView<FGuid> SpeakerIds, int32 NodeIndex);
+
+	/**
+	* Finds the resume node of the first of the given speakers that has one.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerIds - TConstArrayView<FGuid>, the speakers, in order.
+	* @return int32, the node to resume from. INDEX_NONE if none.
+	*/
+	int32 FindResumeNode(const FGuid& DialogueId,
+		TConstArrayView<FGuid> SpeakerIds) const;
+
+	/**
+	* Retrieves the dialogue's record in place.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @return const FDialogueHistoryRecord*, the record. Nullptr if none.
+	*/
+	const FDialogueHistoryRecord* FindRecord(const FGuid& DialogueId) const;
+
+	/**
+	* Retrieves a single speaker's record for the dialogue in place. 
+	* Records spilled to the cold store are not found.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @return const FDialogueSpeakerHistory*, the record. Nullptr if none.
+	*/
+	const FDialogueSpeakerHistory* FindSpeaker(const FGuid& DialogueId,
+		const FGuid& SpeakerId) const;
+
+	/**
+	* Moves any record read from an older save under the given dialogue 
+	* name to the dialogue's GUID, merging it with any record already kept
+	* there.
+	*
+	* @param DialogueName - FName, the name the dialogue was saved under.
+	* @param DialogueId - const FGuid&, the dialogue.
+	*/
+	void AdoptLegacyRecord(FName DialogueName, const FGuid& DialogueId);
+
+	/**
+	* Forgets every record, including those spilled to the cold store.
+	*/
+	void Empty();
+
+	/**
+	* Retrieves a counter bumped whenever a visit is added or removed, so
+	* that anything derived from the history can tell when it is stale.
+	*
+	* @return uint32, the counter.
+	*/
+	uint32 GetChangeSerial() const;
+
+	/**
+	* Hands over the speakers whose records changed since the last call,
+	* for publishing to readers on other threads.
+	*
+	* @param OutSpeakers - TMap<FGuid, TSet<FGuid>>&, replaced with the 
+	* speakers, by dialogue.
+	* @return bool - True if the records were replaced wholesale, in which
+	* case every record should be treated as changed.
+	*/
+	bool TakeUnpublishedChanges(TMap<FGuid, TSet<FGuid>>& OutSpeakers);
+
+	/**
+	* Writes or reads the store in its compact binary form.
+	*
+	* @param Ar - FArchive&, the archive.
+	* @return bool - True, the store always serializes itself.
+	*/
+	bool Serialize(FArchive& Ar);
+
+	/**
+	* Writes the store to a byte array, for saving outside of the UObject
+	* serialization path.
+	*
+	* @param OutBytes - TArray<uint8>&, filled with the saved store.
+	*/
+	void SaveToBytes(TArray<uint8>& OutBytes) const;
+
+	/**
+	* Replaces the store with one previously written by SaveToBytes.
+	*
+	* @param InBytes - const TArray<uint8>&, the saved store.
+	* @return bool - True if the bytes could be read, False otherwise, in
+	* which case the store is left empty.
+	*/
+	bool LoadFromBytes(const TArray<uint8>& InBytes);
+
+	/**
+	* Checks if any record changed since the store was last saved with 
+	* SaveChanges, loaded, or marked saved.
+	*
+	* @return bool - True if there are unsaved changes.
+	*/
+	bool HasUnsavedChanges() const;
+
+	/**
+	* Writes only the speaker records that changed since the last save, 
+	* then marks the store saved. Writes every record instead if the store
+	* was emptied or marked all dirty since. Applying each written set of
+	* changes in order, on top of the last full save, rebuilds the store.
+	*
+	* @param Ar - FArchive&, the archive. Must be saving.
+	* @return bool - True if every record was written.
+	*/
+	bool SaveChanges(FArchive& Ar);
+
+	/**
+	* Applies changes previously written by SaveChanges. Speaker records 
+	* written replace the store's own for the same dialogue and speaker.
+	*
+	* @param Ar - FArchive&, the archive. Must be loading.
+	* @param bOutWasFull - bool&, set to whether every record was written,
+	* in which case the store was replaced outright.
+	* @return bool - True if the changes could be read, False otherwise, in
+	* which case the store is left untouched.
+	*/
+	bool ApplyChanges(FArchive& Ar, bool& bOutWasFull);
+
+	/**
+	* Marks every record as saved, so that the next SaveChanges only 
+	* writes what changes from here on.
+	*/
+	void MarkSaved();
+
+	/**
+	* Marks every record as changed, so that the next SaveChanges writes 
+	* the whole store. Used to compact a journal of changes.
+	*/
+	void MarkAllDirty();
+
+	/**
+	* Sets how long the given speaker's records are kept. Speakers are 
+	* persistent until told otherwise. Only persistent records are saved.
+	*
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @param Persistence - EDialogueSpeakerPersistence, the class.
+	*/
+	void SetSpeakerPersistence(const FGuid& SpeakerId,
+		EDialogueSpeakerPersistence Persistence);
+
+	/**
+	* Retrieves how long the given speaker's records are kept.
+	*
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @return EDialogueSpeakerPersistence, the class.
+	*/
+	EDialogueSpeakerPersistence GetSpeakerPersistence(
+		const FGuid& SpeakerId) const;
+
+	/**
+	* Checks if the given speaker's records are saved.
+	*
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @return bool - True if persistent.
+	*/
+	bool IsPersistent(const FGuid& SpeakerId) const;
+
+	/**
+	* Sets how many ephemeral speakers keep their records at once. The 
+	* least recently recorded beyond this are forgotten.
+	*
+	* @param InMax - int32, the most ephemeral speakers. 0 for no limit.
+	*/
+	void SetMaxEphemeralSpeakers(int32 InMax);
+
+	/**
+	* Drops speaker records left empty by cleared or removed visits, and 
+	* dialogue records left without speakers, then releases the slack in 
+	* the store's containers.
+	*
+	* @return int32, the number of speaker records dropped.
+	*/
+	int32 Prune();
+
+	/**
+	* Estimates the memory taken up by the store.
+	*
+	* @return FDialogueHistoryMemoryStats, the estimate.
+	*/
+	FDialogueHistoryMemoryStats GetMemoryStats() const;
+
+	/**
+	* Keeps cold persistent records in the given store on disk, rather than
+	* in memory. Records spilled to it are paged back in when written, and
+	* read from it in place otherwise, including by saves and snapshots. 
+	* Saves hold every record spilled before them, so loading starts the 
+	* cold store over; what was cold is loaded back and spilled again.
+	*
+	* @param InColdStore - TSharedPtr<FDialogueHistoryColdStore>, the store.
+	* Null keeps every record in memory.
+	*/
+	void SetColdStore(TSharedPtr<FDialogueHistoryColdStore> InColdStore);
+
+	/**
+	* Retrieves a view of the cold store's records as they are now, for 
+	* readers on other threads. Records held in memory are newer than the
+	* view's copies of them.
+	*
+	* @return TSharedPtr<const FDialogueHistoryColdView, ESPMode::ThreadSafe>,
+	* the view. Null if no cold store is open.
+	*/
+	TSharedPtr<const FDialogueHistoryColdView, ESPMode::ThreadSafe> 
+		GetColdView() const;
+
+	/**
+	* Retrieves the number of speaker records held in memory.
+	*
+	* @return int32, the number of records.
+	*/
+	int32 GetNumResidentSpeakers() const;
+
+	/**
+	* Writes the least recently used persistent records to the cold store
+	* and drops them from memory, if more than the given number are held.
+	* Spills down to three quarters of the limit, so that the cold store is
+	* not rewritten on every record. Rewrites the shards written to, so is
+	* best called at most once a frame rather than on every change.
+	*
+	* @param MaxResidentSpeakers - int32, the most records to hold.
+	* @return int32, the number of records spilled.
+	*/
+	int32 SpillToColdStore(int32 MaxResidentSpeakers);
+
+	/**
+	* Calls the given function with every persistent speaker record held
+	* only in the cold store, i.e. every record saved that FindRecord does
+	* not find.
+	*
+	* @param Func - TFunctionRef<void(const FGuid&, const FGuid&, 
+	* const FDialogueSpeakerHistory&)>, called with each record's dialogue
+	* ID, speaker ID and record.
+	*/
+	void ForEachColdSpeaker(TFunctionRef<void(const FGuid&, const FGuid&,
+		const FDialogueSpeakerHistory&)> Func) const;
+
+private:
+	/**
+	* Writes or reads a single dialogue's record.
+	*
+	* @param Ar - FArchive&, the archive.
+	* @param Record - FDialogueHistoryRecord&, the record.
+	* @param Version - int32, the version of the binary form.
+	* @param ColdDialogueId - const FGuid&, the dialogue, if saving any of
+	* its speakers from the cold store.
+	* @param ColdSpeakerIds - TConstArrayView<FGuid>, speakers held only in
+	* the cold store, saved after the record's own. Saving only.
+	*/
+	void SerializeRecord(FArchive& Ar, FDialogueHistoryRecord& Record,
+		int32 Version, const FGuid& ColdDialogueId = FGuid(),
+		TConstArrayView<FGuid> ColdSpeakerIds = {}) const;
+
+	/**
+	* Gathers the persistent speakers held only in the cold store, by
+	* dialogue.
+	*
+	* @param OutSpeakers - TMap<FGuid, TArray<FGuid>>&, filled with the
+	* speakers keyed by dialogue GUID.
+	*/
+	void GatherColdSpeakers(TMap<FGuid, TArray<FGuid>>& OutSpeakers) const;
+
+	/**
+	* Notes that a speaker's record changed since the last save.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerId - const FGuid&, the speaker.
+	*/
+	void MarkDirty(const FGuid& DialogueId, const FGuid& SpeakerId);
+
+	/**
+	* Retrieves the speaker's record for writing, paging it in from the 
+	* cold store or adding it if not held in memory.
+	*
+	* @param Record - FDialogueHistoryRecord&, the dialogue's record.
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @return FDialogueSpeakerHistory&, the speaker's record.
+	*/
+	FDialogueSpeakerHistory& FindOrPageIn(FDialogueHistoryRecord& Record,
+		const FGuid& DialogueId, const FGuid& SpeakerId);
+
+	/**
+	* Retrieves the speaker's record for writing, paging it in from the 
+	* cold store if not held in memory.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @return FDialogueSpeakerHistory*, the record. Nullptr if none.
+	*/
+	FDialogueSpeakerHistory* FindAndPageIn(const FGuid& DialogueId,
+		const FGuid& SpeakerId);
+
+	/**
+	* Retrieves the speaker's record for reading, from memory or else the
+	* cold store.
+	*
+	* @param DialogueId - const FGuid&, the dialogue.
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @param Scratch - FDialogueSpeakerHistory&, filled from the cold store 
+	* if the record is read from there.
+	* @return const FDialogueSpeakerHistory*, the record. Nullptr if none.
+	*/
+	const FDialogueSpeakerHistory* FindInAnyTier(const FGuid& DialogueId,
+		const FGuid& SpeakerId, FDialogueSpeakerHistory& Scratch) const;
+
+	/**
+	* Notes that every record was replaced since the last save and the 
+	* last publish.
+	*/
+	void MarkAllUnpublished();
+
+	/**
+	* Recounts the speaker records held in memory, after the records were
+	* replaced wholesale.
+	*/
+	void CountResidentSpeakers();
+
+	/**
+	* Notes that an ephemeral speaker was just recorded in the dialogue,
+	* forgetting the least recently recorded ones if over the limit.
+	*
+	* @param SpeakerId - const FGuid&, the speaker.
+	* @param DialogueId - const FGuid&, the dialogue.
+	*/
+	void TouchEphemeral(const FGuid& SpeakerId, const FGuid& DialogueId);
+
+	/**
+	* Forgets the least recently recorded ephemeral speakers until a tenth
+	* of the limit is free, so that eviction is not run on every record.
+	*/
+	void EvictEphemeral();
+
+	/**
+	* Forgets every record kept of the ephemeral speakers, after the 
+	* records were replaced wholesale.
+	*/
+	void ResetEphemeral();
+
+private:
+	/** Version written at the head of the binary form. Version 1 keyed 
+	* dialogues by name, and wrote counts and indices at full width. */
+	static constexpr int32 CurrentVersion = 2;
+
+	/** Bumped whenever a visit is added or removed. Not saved. */
+	uint32 ChangeSerial = 0;
+
+	/** Speakers whose record changed since the last save, by dialogue. 
+	* Not saved. */
+	TMap<FGuid, TSet<FGuid>> DirtySpeakers;
+
+	/** Whether the store was emptied or replaced since the last save, so
+	* that only a full save can capture it. Not saved. */
+	bool bAllDirty = false;
+
+	/** Speakers whose record changed since the last publish, by dialogue.
+	* Not saved. */
+	TMap<FGuid, TSet<FGuid>> UnpublishedSpeakers;
+
+	/** Whether the store was emptied or replaced since the last publish.
+	* Not saved. */
+	bool bAllUnpublished = true;
+
+	/** Speakers that are not persistent. Not saved. */
+	TMap<FGuid, EDialogueSpeakerPersistence> SpeakerPersistence;
+
+	/** Ephemeral speakers with records, for eviction. Not saved. */
+	TMap<FGuid, FDialogueEphemeralSpeaker> EphemeralSpeakers;
+
+	/** Source of ephemeral speaker use times */
+	uint64 EphemeralClock = 0;
+
+	/** Most ephemeral speakers kept at once. 0 for no limit. */
+	int32 MaxEphemeralSpeakers = 256;
+
+	/** Store on disk that cold records are spilled to, if any */
+	TSharedPtr<FDialogueHistoryColdStore> ColdStore;
+
+	/** Source of speaker record use times */
+	uint64 ResidentClock = 0;
+
+	/** Number of speaker records held in memory. Not saved. */
+	int32 NumResidentSpeakers = 0;
+};
+
+template<>
+struct TStructOpsTypeTraits<FDialogueHistoryStore> :
+	public TStructOpsTypeTraitsBase2<FDialogueHistoryStore>
+{
+	enum
+	{
+		WithSerializer = true
+	};
+};
@@ -22,8 +22,14 @@ class DIALOGUETREERUNTIME_API UDialogueBranchNode : public UDialogueNode
 
 public:
 	/** UDialogueNode Implementation */
-	virtual FDialogueOption GetAsOption() override;
-	virtual void EnterNode() override;
+	virtual FDialogueOption GetAsOption(
+		UDialogueSession* Session) override;
+	virtual FDialogueNodeResult EnterNode(
+		UDialogueSession* Session) override;
+	virtual EDialogueNodeKind GetNodeKind() const override;
+	virtual void GetPayloadNodes(TArray<UDialogueNode*>& OutNodes) const 
+		override;
+	virtual void ReorderConditions() override;
 	/** End UDialogueNode */
 
 	/**
@@ -75,28 +81,50 @@ public:
 	*/
 	const TArray<UDialogueCondition*>& GetConditions() const;
 
-private: 
 	/**
 	* Determines if the branch node passes its conditions to 
 	* transition to the "true" node. 
 	* 
+	* @param Session - UDialogueSession*, the session to evaluate for.
 	* @return bool - true if conditions are passed, false otherwise.
 	*/
-	bool PassesConditions() const;
+	bool PassesConditions(UDialogueSession* Session) const;
+
+	/**
+	* Issues any async queries the branch's conditions read.
+	* 
+	* @param Session - UDialogueSession*, the session to evaluate for.
+	* @param OnResolved - FSimpleDelegate, called once they have resolved,
+	* if any had to be waited on.
+	* @return bool - True if the caller must wait for OnResolved.
+	*/
+	bool IssueAsyncQueries(UDialogueSession* Session, 
+		FSimpleDelegate OnResolved) const;
+
+private: 
+	/**
+	* Called once the async queries the branch waited on have resolved.
+	* Takes the branch, if the session is still waiting on it.
+	* 
+	* @param WeakSession - TWeakObjectPtr<UDialogueSession>, the session.
+	*/
+	void OnQueriesResolved(TWeakObjectPtr<UDialogueSession> WeakSession);
 
 	/**
 	* Determines if any condition in the conditions list is true. 
 	* 
+	* @param Session - UDialogueSession*, the session to evaluate for.
 	* @return bool - true if any condition is true, else false. 
 	*/
-	bool AnyConditionsTrue() const;
+	bool AnyConditionsTrue(UDialogueSession* Session) const;
 
 	/**
 	* Determines if all conditions in the conditions list are true. 
 	* 
+	* @param Session - UDialogueSession*, the session to evaluate for.
 	* @return bool - true if all conditions are true, else false. 
 	*/
-	bool AllConditionsTrue() const;
+	bool AllConditionsTrue(UDialogueSession* Session) const;
 
 private:
 	/** Conditions which govern branching */
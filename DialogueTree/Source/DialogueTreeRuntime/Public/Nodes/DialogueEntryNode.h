@@ -19,6 +19,8 @@ class DIALOGUETREERUNTIME_API UDialogueEntryNode : public UDialogueNode
 
 public:
 	/** UDialogueNode Impl. */
-	virtual void EnterNode() override;
+	virtual FDialogueNodeResult EnterNode(
+		UDialogueSession* Session) override;
+	virtual EDialogueNodeKind GetNodeKind() const override;
 	/** End UDialogueNode */
 };
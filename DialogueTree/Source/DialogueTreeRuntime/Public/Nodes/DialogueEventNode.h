@@ -22,9 +22,12 @@ class DIALOGUETREERUNTIME_API UDialogueEventNode : public UDialogueNode
 
 public:
 	/** UDialogueNode Implementation */
-	virtual void EnterNode() override;
-	virtual FDialogueOption GetAsOption() override;
-	virtual void Skip() override;
+	virtual FDialogueNodeResult EnterNode(
+		UDialogueSession* Session) override;
+	virtual EDialogueNodeKind GetNodeKind() const override;
+	virtual FDialogueOption GetAsOption(
+		UDialogueSession* Session) override;
+	virtual void Skip(UDialogueSession* Session) override;
 	/** End UDialogueNode */
 
 	/**
@@ -42,23 +45,37 @@ public:
 	const TArray<UDialogueEventBase*>& GetEvents() const;
 
 	/**
-	* Checks if there an ongoing event is blocking. 
+	* Checks if there an ongoing event is blocking in the given session. 
 	* 
+	* @param Session - const UDialogueSession*, the session to check.
 	* @return bool - True if an event is blocking; False otherwise.
 	*/
-	bool GetIsBlocking() const;
+	bool GetIsBlocking(const UDialogueSession* Session) const;
 
 protected: 
 	/**
-	* Plays the node's events. 
+	* Plays the session's instances of the node's events. 
+	* 
+	* @param Session - UDialogueSession*, the session playing the events.
 	*/
-	void PlayEvents();
+	void PlayEvents(UDialogueSession* Session);
 
 	/**
 	* Transitions out of the node if all of its events have completed.
+	* 
+	* @param Session - UDialogueSession*, the session to transition.
+	*/
+	virtual void TransitionIfNotBlocking(UDialogueSession* Session) const;
+
+private:
+	/**
+	* Called when one of the session's event instances stops blocking.
+	* 
+	* @param WeakSession - TWeakObjectPtr<UDialogueSession>, the session 
+	* the event was played for.
 	*/
-	UFUNCTION()
-	virtual void TransitionIfNotBlocking() const;
+	void OnEventStoppedBlocking(
+		TWeakObjectPtr<UDialogueSession> WeakSession) const;
 
 private:
 	/** Events to play */
@@ -15,5 +15,7 @@ class DIALOGUETREERUNTIME_API UDialogueJumpBackNode : public UDialogueNode
 	GENERATED_BODY()
 
 public:
-	virtual void EnterNode() override;
+	virtual FDialogueNodeResult EnterNode(
+		UDialogueSession* Session) override;
+	virtual EDialogueNodeKind GetNodeKind() const override;
 };
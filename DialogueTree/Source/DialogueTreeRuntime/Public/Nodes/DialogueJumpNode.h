@@ -20,8 +20,13 @@ class DIALOGUETREERUNTIME_API UDialogueJumpNode : public UDialogueNode
 	
 public:
 	/** UDialogueNode Implementation */
-	virtual void EnterNode() override;
-	virtual FDialogueOption GetAsOption() override;
+	virtual FDialogueNodeResult EnterNode(
+		UDialogueSession* Session) override;
+	virtual EDialogueNodeKind GetNodeKind() const override;
+	virtual void GetPayloadNodes(TArray<UDialogueNode*>& OutNodes) const 
+		override;
+	virtual FDialogueOption GetAsOption(
+		UDialogueSession* Session) override;
 	/** End UDialogueNode */
 
 	/**
@@ -6,11 +6,85 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 //Plugin
+#include "DialogueNodeTable.h"
 #include "DialogueOption.h"
 //Generated
 #include "DialogueNode.generated.h"
 
 class UDialogue;
+class UDialogueNode;
+class UDialogueSession;
+
+/**
+* Enum describing what the dialogue should do once a node has been entered.
+*/
+enum class EDialogueNodeResult : uint8
+{
+	/** Move straight on to the result's next node */
+	Traverse,
+	/** Stay on the node until something outside the dialogue moves it on */
+	Wait,
+	/** End the dialogue */
+	End
+};
+
+/**
+* Struct returned by a node when it is entered, telling the dialogue where
+* to go next. Lets the dialogue drive traversal from a loop rather than 
+* each node recursing into the next, so the stack stays flat however many
+* pass-through nodes are chained together.
+*/
+struct DIALOGUETREERUNTIME_API FDialogueNodeResult
+{
+	/** What to do next */
+	EDialogueNodeResult Type = EDialogueNodeResult::Wait;
+
+	/** The node table index to enter next when traversing */
+	int32 NextNodeIndex = INDEX_NONE;
+
+	/**
+	* Creates a result moving on to the node at the given table index. Ends
+	* the dialogue if the index is INDEX_NONE.
+	*
+	* @param InNodeIndex - int32, the index of the node to enter next.
+	* @return FDialogueNodeResult, the result.
+	*/
+	static FDialogueNodeResult TraverseTo(int32 InNodeIndex)
+	{
+		return InNodeIndex != INDEX_NONE
+			? FDialogueNodeResult{ EDialogueNodeResult::Traverse, InNodeIndex }
+			: End();
+	}
+
+	/**
+	* Creates a result moving on to the given node. Ends the dialogue if 
+	* the node is null or not compiled into a node table.
+	*
+	* @param InNode - const UDialogueNode*, the node to enter next.
+	* @return FDialogueNodeResult, the result.
+	*/
+	static FDialogueNodeResult TraverseTo(const UDialogueNode* InNode);
+
+	/**
+	* Creates a result that stays on the current node.
+	*
+	* @return FDialogueNodeResult, the result.
+	*/
+	static FDialogueNodeResult Wait()
+	{
+		return FDialogueNodeResult{ EDialogueNodeResult::Wait, INDEX_NONE };
+	}
+
+	/**
+	* Creates a result that ends the dialogue.
+	*
+	* @return FDialogueNodeResult, the result.
+	*/
+	static FDialogueNodeResult End()
+	{
+		return FDialogueNodeResult{ EDialogueNodeResult::End, INDEX_NONE };
+	}
+};
 
 /**
  * Abstract base class for all runtime dialogue nodes. 
@@ -50,6 +124,12 @@ public:
 	*/
 	void AddChild(UDialogueNode* InChild);
 
+	/**
+	* Removes all links to parent and child nodes. Used when recompiling
+	* the dialogue without recreating the node.
+	*/
+	void ClearLinks();
+
 	/**
 	* Retrieves a TArray of all parents for this node. 
 	* 
@@ -64,32 +144,115 @@ public:
 	*/
 	TArray<UDialogueNode*> GetChildren() const;
 
+	/**
+	* Retrieves the number of children the node has. Reads the dialogue's 
+	* node table once compiled.
+	* 
+	* @return int32, the number of children.
+	*/
+	int32 GetNumChildren() const;
+
+	/**
+	* Retrieves the child at the given position, counting left to right. 
+	* Reads the dialogue's node table once compiled.
+	* 
+	* @param ChildIndex - int32, the position of the child.
+	* @return UDialogueNode*, the child. Nullptr if out of range.
+	*/
+	UDialogueNode* GetChild(int32 ChildIndex) const;
+
+	/**
+	* Retrieves the node table index of the child at the given position, 
+	* counting left to right.
+	* 
+	* @param ChildIndex - int32, the position of the child.
+	* @return int32, the child's index. INDEX_NONE if out of range.
+	*/
+	int32 GetChildNodeIndex(int32 ChildIndex) const;
+
+	/**
+	* Retrieves the type of the node for the dialogue's node table.
+	* 
+	* @return EDialogueNodeKind, the type of node.
+	*/
+	virtual EDialogueNodeKind GetNodeKind() const;
+
+	/**
+	* Retrieves the name of the speaker role the node plays out through, if
+	* any. Stored as a speaker slot in the dialogue's node table.
+	* 
+	* @return FName, the speaker role. None if the node has no speaker.
+	*/
+	virtual FName GetSpeakerRoleName() const;
+
+	/**
+	* Gathers any nodes the node targets other than its children, such as 
+	* a jump target. Stored as payload in the dialogue's node table.
+	* 
+	* @param OutNodes - TArray<UDialogueNode*>&, the targeted nodes. May 
+	* contain nullptr for unset targets.
+	*/
+	virtual void GetPayloadNodes(TArray<UDialogueNode*>& OutNodes) const {}
+
+	/**
+	* Resolves any speaker roles the node names to their slots among the 
+	* dialogue's speaker roles. Called whenever the dialogue compiles or 
+	* loads.
+	* 
+	* @param RoleNames - TConstArrayView<FName>, the dialogue's speaker 
+	* roles in slot order.
+	*/
+	virtual void ResolveSpeakerSlots(TConstArrayView<FName> RoleNames) {}
+
+	/**
+	* Orders any conditions the node checks by their measured cost and pass
+	* rate. Called on every node whenever the dialogue compiles, so that 
+	* profiles gathered since the last compile apply to unchanged nodes.
+	*/
+	virtual void ReorderConditions() {}
+
 	/**
 	* Gets an FDialogueOption struct representing this node as a
 	* selectable option. 
 	* 
+	* @param Session - UDialogueSession*, the session the option is 
+	* being gathered for.
 	* @return FDialogueOption, option struct. 
 	*/
-	virtual FDialogueOption GetAsOption();
+	virtual FDialogueOption GetAsOption(UDialogueSession* Session);
 
 	/**
-	* Plays standard behavior for the given node. 
+	* Plays standard behavior for the given node. Nodes are shared by every
+	* playthrough of the dialogue, so any per-playthrough state must be 
+	* stored on the session rather than on the node. Nodes should not 
+	* traverse to their children themselves; they return where to go next
+	* and the dialogue takes it from there.
+	* 
+	* @param Session - UDialogueSession*, the session entering the node. 
+	* @return FDialogueNodeResult, where the dialogue should go next.
 	*/
-	virtual void EnterNode() {};
+	virtual FDialogueNodeResult EnterNode(UDialogueSession* Session) 
+	{
+		return FDialogueNodeResult::Wait();
+	}
 
 	/**
 	* Attempts to select the option at the given index, if 
 	* applicable. 
 	* 
+	* @param Session - UDialogueSession*, the session making the selection.
 	* @param InOptionIndex - int32, selection index. 
 	*/
-	virtual void SelectOption(int32 InOptionIndex) {};
+	virtual void SelectOption(UDialogueSession* Session, 
+		int32 InOptionIndex) {};
 
 	/**
 	* If allowable, attempts to skip some or all of the node's 
 	* content. 
+	* 
+	* @param Session - UDialogueSession*, the session requesting the skip.
 	*/
-	virtual void Skip() {};
+	virtual void Skip(UDialogueSession* Session) {};
 
 	/**
 	* Retrieves the id for the node in dialogue
@@ -105,6 +268,36 @@ public:
 	*/
 	void SetNodeID(FName InID);
 
+	/**
+	* Retrieves the node's stable identity, which unlike its ID survives 
+	* the node being renamed.
+	* 
+	* @return const FGuid&, the node's GUID. Invalid for nodes compiled 
+	* before GUIDs were assigned.
+	*/
+	const FGuid& GetNodeGuid() const;
+
+	/**
+	* Sets the node's stable identity. Called when the dialogue compiles.
+	*
+	* @param InGuid - const FGuid&, the GUID.
+	*/
+	void SetNodeGuid(const FGuid& InGuid);
+
+	/**
+	* Retrieves the node's index in the dialogue's node table. 
+	* 
+	* @return int32, the index. INDEX_NONE if not compiled into a table.
+	*/
+	int32 GetNodeIndex() const;
+
+	/**
+	* Sets the node's index in the dialogue's node table.
+	* 
+	* @param InIndex - int32, the index.
+	*/
+	void SetNodeIndex(int32 InIndex);
+
 	/**
 	* Sets the node's graph location.
 	* 
@@ -128,6 +321,14 @@ protected:
 	UPROPERTY()
 	FName NodeID;
 
+	/** The identity of the node within the dialogue, kept across renames */
+	UPROPERTY()
+	FGuid NodeGuid;
+
+	/** The index of the node in the dialogue's node table */
+	UPROPERTY()
+	int32 NodeIndex = INDEX_NONE;
+
 	/** Any direct parent nodes in the dialogue */
 	UPROPERTY()
 	TArray<TObjectPtr<UDialogueNode>> Parents;
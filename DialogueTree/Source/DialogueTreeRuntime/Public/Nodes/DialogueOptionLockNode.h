@@ -19,8 +19,12 @@ class DIALOGUETREERUNTIME_API UDialogueOptionLockNode : public UDialogueNode
 	
 public:
 	/** UDialogueNode Implementation */
-	virtual FDialogueOption GetAsOption() override;
-	virtual void EnterNode() override;
+	virtual FDialogueOption GetAsOption(
+		UDialogueSession* Session) override;
+	virtual FDialogueNodeResult EnterNode(
+		UDialogueSession* Session) override;
+	virtual EDialogueNodeKind GetNodeKind() const override;
+	virtual void ReorderConditions() override;
 	/** End UDialogueNode */
 
 public:
@@ -66,28 +70,32 @@ public:
 	*/
 	const TArray<TObjectPtr<UDialogueCondition>>& GetConditions() const;
 
-private:
 	/**
-	* Determines if the branch node passes its conditions to
-	* transition to the "true" node.
+	* Determines if the lock node passes its conditions, leaving the 
+	* option unlocked.
 	*
+	* @param Session - UDialogueSession*, the session to evaluate for.
 	* @return bool - true if conditions are passed, false otherwise.
 	*/
-	bool PassesConditions() const;
+	bool PassesConditions(UDialogueSession* Session) const;
+
+private:
 
 	/**
 	* Determines if any condition in the conditions list is true.
 	*
+	* @param Session - UDialogueSession*, the session to evaluate for.
 	* @return bool - true if any condition is true, else false.
 	*/
-	bool AnyConditionsTrue() const;
+	bool AnyConditionsTrue(UDialogueSession* Session) const;
 
 	/**
 	* Determines if all conditions in the conditions list are true.
 	*
+	* @param Session - UDialogueSession*, the session to evaluate for.
 	* @return bool - true if all conditions are true, else false.
 	*/
-	bool AllConditionsTrue() const;
+	bool AllConditionsTrue(UDialogueSession* Session) const;
 
 private:
 	/** Conditions which govern branching */
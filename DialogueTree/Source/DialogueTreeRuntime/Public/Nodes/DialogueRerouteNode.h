@@ -16,7 +16,10 @@ class DIALOGUETREERUNTIME_API UDialogueRerouteNode : public UDialogueNode
 	
 public:
 	/** UDialogueNode Impl. */
-	virtual void EnterNode() override;
-	virtual FDialogueOption GetAsOption() override;
+	virtual FDialogueNodeResult EnterNode(
+		UDialogueSession* Session) override;
+	virtual EDialogueNodeKind GetNodeKind() const override;
+	virtual FDialogueOption GetAsOption(
+		UDialogueSession* Session) override;
 	/** End UDialogueNode */
 };
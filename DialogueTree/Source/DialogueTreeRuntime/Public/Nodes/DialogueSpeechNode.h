@@ -43,24 +43,42 @@ public:
 	/**
 	* Retrieves the details struct for the speech.
 	* 
-	* @return FSpeechDetails, details for the speech. 
+	* @return const FSpeechDetails&, details for the speech. 
 	*/
-	FSpeechDetails GetDetails() const;
+	const FSpeechDetails& GetDetails() const;
 
 	/**
 	* Retrieves the speaker component associated with the speech 
-	* in the dialogue. Nullptr if none found. 
+	* in the given session. Nullptr if none found. 
 	* 
+	* @param Session - const UDialogueSession*, the session playing the 
+	* speech.
 	* @return UDialogueSpeakerComponent*, associated speaker 
 	* component. 
 	*/
-	UDialogueSpeakerComponent* GetSpeaker() const;
+	UDialogueSpeakerComponent* GetSpeaker(
+		const UDialogueSession* Session) const;
+
+	/**
+	* Retrieves the audio of every variation of the speech, for streaming
+	* in before the speech plays.
+	*
+	* @param OutAudio - TArray<FSoftObjectPath>&, appended with the audio.
+	*/
+	void GetSpeechAudio(TArray<FSoftObjectPath>& OutAudio) const;
 
 	/** DialogueEventNode Impl. */
-	virtual void EnterNode() override;
-	virtual FDialogueOption GetAsOption() override;
-	virtual void SelectOption(int32 InOptionIndex) override;
-	virtual void Skip() override;
+	virtual FDialogueNodeResult EnterNode(
+		UDialogueSession* Session) override;
+	virtual EDialogueNodeKind GetNodeKind() const override;
+	virtual FName GetSpeakerRoleName() const override;
+	virtual void ResolveSpeakerSlots(
+		TConstArrayView<FName> RoleNames) override;
+	virtual FDialogueOption GetAsOption(
+		UDialogueSession* Session) override;
+	virtual void SelectOption(UDialogueSession* Session, 
+		int32 InOptionIndex) override;
+	virtual void Skip(UDialogueSession* Session) override;
 	/** End DialogueEventNode */
 
 	/**
@@ -72,15 +90,31 @@ public:
 
 protected:
 	/** DialogueEventNode Impl */
-	virtual void TransitionIfNotBlocking() const override;
+	virtual void TransitionIfNotBlocking(
+		UDialogueSession* Session) const override;
 	/** End DialogueEventNode */
 
 private:
 	/**
 	* Tells the active speaker component to start speaking and 
 	* sets any behavior flags associated with this speech. 
+	* 
+	* @param Session - UDialogueSession*, the session playing the speech.
+	* @param SpeechVariationIndex - int, the variation to play.
+	*/
+	void StartAudio(UDialogueSession* Session, int SpeechVariationIndex);
+
+	/**
+	* Retrieves the given speech audio, waiting briefly for it if it has
+	* not finished streaming in.
+	*
+	* @param Session - UDialogueSession*, the session playing the speech.
+	* @param SpeechAudio - const TSoftObjectPtr<USoundCue>&, the audio.
+	* @return USoundCue*, the loaded audio. Nullptr if it did not load in
+	* time.
 	*/
-	void StartAudio(int SpeechVariationIndex);
+	USoundCue* LoadSpeechAudio(UDialogueSession* Session,
+		const TSoftObjectPtr<USoundCue>& SpeechAudio) const;
 
 private:
 	/** The primary content of the speech */
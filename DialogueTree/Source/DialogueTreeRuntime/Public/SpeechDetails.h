@@ -38,6 +38,10 @@ struct DIALOGUETREERUNTIME_API FSpeechGestureData
 	UPROPERTY(BlueprintReadOnly)
 	FName SpeakerName;
 
+	/** Slot of the speaker's role, resolved when the dialogue compiles */
+	UPROPERTY()
+	int32 SpeakerSlot = INDEX_NONE;
+
 	UPROPERTY(BlueprintReadOnly)
 	FGameplayTag GestureTag_Obsolete;
 
@@ -62,9 +66,9 @@ struct DIALOGUETREERUNTIME_API FSpeechOptionData
 	UPROPERTY(BlueprintReadOnly)
 	FText SpeechText = FText();
 
-	/** The audio associated with the speech */
+	/** The audio associated with the speech. Streamed in when needed. */
 	UPROPERTY(BlueprintReadOnly)
-	TObjectPtr<USoundCue> SpeechAudio = nullptr;
+	TSoftObjectPtr<USoundCue> SpeechAudio = nullptr;
 };
 
 UENUM(BlueprintType)
@@ -117,6 +121,10 @@ struct DIALOGUETREERUNTIME_API FSpeechDetails
 	UPROPERTY(BlueprintReadOnly, Category = "Dialogue")
 	FName SpeakerName = NAME_None;
 
+	/** Slot of the speaker's role, resolved when the dialogue compiles */
+	UPROPERTY()
+	int32 SpeakerSlot = INDEX_NONE;
+
 	/** The base title for the speech (foundation of its ID) */
 	UPROPERTY(BlueprintReadOnly, Category = "Dialogue")
 	FName SpeechTitle = NAME_None; 
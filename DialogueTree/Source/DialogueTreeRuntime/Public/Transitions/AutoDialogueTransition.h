@@ -21,7 +21,7 @@ class DIALOGUETREERUNTIME_API UAutoDialogueTransition :
 
 public: 
 	/** DialogueTransition Implementation */
-	virtual void TransitionOut() override;
+	virtual void TransitionOut(UDialogueSession* Session) override;
 	virtual FText GetDisplayName() const override;
 	virtual FText GetNodeCreationTooltip() const override;
 	/** End DialogueTranstion */
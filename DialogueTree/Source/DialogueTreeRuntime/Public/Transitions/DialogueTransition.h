@@ -4,13 +4,13 @@
 
 //UE
 #include "CoreMinimal.h"
-#include "TimerManager.h"
 #include "UObject/NoExportTypes.h"
 //Plugin
 #include "DialogueConnectionLimit.h"
 //Generated
 #include "DialogueTransition.generated.h"
 
+class UDialogueSession;
 class UDialogueSpeechNode;
 
 /**
@@ -22,10 +22,6 @@ class DIALOGUETREERUNTIME_API UDialogueTransition : public UObject
 {
 	GENERATED_BODY()
 
-public:
-	//Constructor
-	UDialogueTransition();
-	
 public:
 	/**
 	* Sets the owning node. 
@@ -36,28 +32,36 @@ public:
 	/**
 	* Called when traversing a node. Performs any initial 
 	* behavior for the transition and queues up any deferred 
-	* actions. 
+	* actions on the session. 
+	* 
+	* @param Session - UDialogueSession*, the session entering the node.
 	*/
-	virtual void StartTransition();
+	virtual void StartTransition(UDialogueSession* Session);
 
 	/**
 	* Concludes the transition. Largely defined by child transitions.
+	* 
+	* @param Session - UDialogueSession*, the session leaving the node.
 	*/
-	virtual void TransitionOut() {};
+	virtual void TransitionOut(UDialogueSession* Session) {};
 
 	/**
 	* Called when the user selects an option. Transitions to the 
 	* option with the given index, if applicable. 
 	* 
+	* @param Session - UDialogueSession*, the session making the selection.
 	* @param InOptionIndex - int32, the index of the selection. 
 	*/
-	virtual void SelectOption(int32 InOptionIndex) {};
+	virtual void SelectOption(UDialogueSession* Session, 
+		int32 InOptionIndex) {};
 
 	/**
 	* Attemps to skip the currently playing speech. Base
 	* implementation stops the speech audio. 
+	* 
+	* @param Session - UDialogueSession*, the session requesting the skip.
 	*/
-	virtual void Skip();
+	virtual void Skip(UDialogueSession* Session);
 
 	/**
 	* Retrieves the display name for the transition. 
@@ -86,41 +90,36 @@ public:
 	/**
 	* Checks if the transition should exit, and triggers the transition out
 	* if so.
+	* 
+	* @param Session - UDialogueSession*, the session to check.
 	*/
-	void CheckTransitionConditions();
-
-private:
+	void CheckTransitionConditions(UDialogueSession* Session);
 
 	/**
 	* Called when the speech content has finished playing.
+	* 
+	* @param Session - UDialogueSession*, the session playing the speech.
 	*/
-	UFUNCTION()
-	void OnDonePlayingContent();
+	void OnDonePlayingContent(UDialogueSession* Session);
 
 	/**
 	* Called when the minimum play time has elapsed.
+	* 
+	* @param Session - UDialogueSession*, the session playing the speech.
+	*/
+	void OnMinPlayTimeElapsed(UDialogueSession* Session);
+
+protected:
+	/**
+	* Checks if the session is currently waiting on this transition.
+	* 
+	* @param Session - const UDialogueSession*, the session to check.
+	* @return bool - True if this is the session's active transition.
 	*/
-	UFUNCTION()
-	void OnMinPlayTimeElapsed();
+	bool IsActiveIn(const UDialogueSession* Session) const;
 
 protected:
 	/** The node upon which the transition operates*/
 	UPROPERTY()
 	TObjectPtr<UDialogueSpeechNode> OwningNode;
-
-	/** Whether the min play time has elapsed yet */
-	bool bMinPlayTimeElapsed = false;
-
-	/** Whether the audio content has finished playing yet */
-	bool bAudioFinished = false;
-
-private:
-	/** Delegate to call when the minimum play time for the node has elapsed */
-	FTimerDelegate OnTimerEnd;
-
-	/** Timer handle for timer that tracks minimum play time */
-	FTimerHandle MinPlayTimeHandle;
-
-	/** Delegate to call when the speech has finished playing */
-	FScriptDelegate OnContentEnd;
 };
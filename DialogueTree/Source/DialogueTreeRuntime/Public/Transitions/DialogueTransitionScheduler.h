@@ -0,0 +1,208 @@
+// Copyright Zachary Brett, 2024. All rights reserved.
+
+#pragma once
+
+//UE
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class UDialogueSession;
+class UDialogueSpeakerComponent;
+
+/**
+* Drives the speech transitions of every session in a world. Holds the
+* sessions' minimum play time deadlines in a single heap and collects the
+* audio finished signals pushed by speakers, then advances every session
+* they concern in one batched tick. Each session runs on its own clock,
+* which can be paused or dilated. Owned by the dialogue manager subsystem,
+* one per world.
+*/
+class DIALOGUETREERUNTIME_API FDialogueTransitionScheduler
+{
+public:
+	/**
+	* Arms the session's minimum play time, replacing any armed before.
+	*
+	* @param Session - UDialogueSession*, the session.
+	* @param Duration - float, the time to wait in seconds of session time.
+	*/
+	void ScheduleMinPlayTime(UDialogueSession* Session, float Duration);
+
+	/**
+	* Disarms the session's minimum play time, if armed.
+	*
+	* @param Session - const UDialogueSession*, the session.
+	*/
+	void CancelMinPlayTime(const UDialogueSession* Session);
+
+	/**
+	* Waits for the given speaker's audio to finish on the session's behalf,
+	* replacing any speaker waited on before.
+	*
+	* @param Session - UDialogueSession*, the session.
+	* @param Speaker - const UDialogueSpeakerComponent*, the speaker.
+	*/
+	void WaitForAudio(UDialogueSession* Session,
+		const UDialogueSpeakerComponent* Speaker);
+
+	/**
+	* Stops waiting for audio on the session's behalf, if waiting.
+	*
+	* @param Session - const UDialogueSession*, the session.
+	*/
+	void StopWaitingForAudio(const UDialogueSession* Session);
+
+	/**
+	* Called by speakers whenever their audio finishes. Queues the session
+	* waiting on the speaker, if any, for the next tick.
+	*
+	* @param Speaker - const UDialogueSpeakerComponent*, the speaker.
+	*/
+	void NotifyAudioFinished(const UDialogueSpeakerComponent* Speaker);
+
+	/**
+	* Re-reads the session's pause state and time dilation, moving its
+	* deadline to match. Time already waited is kept.
+	*
+	* @param Session - UDialogueSession*, the session.
+	*/
+	void RefreshClock(UDialogueSession* Session);
+
+	/**
+	* Advances every session's clock, and notifies each session whose audio
+	* finished or whose minimum play time elapsed.
+	*
+	* @param DeltaTime - float, the world time passed in seconds.
+	*/
+	void Tick(float DeltaTime);
+
+	/**
+	* Drops everything pending for the session.
+	*
+	* @param Session - const UDialogueSession*, the session.
+	*/
+	void ForgetSession(const UDialogueSession* Session);
+
+	/**
+	* Drops everything pending for every session.
+	*/
+	void Reset();
+
+private:
+	/**
+	* Struct holding what a single session's transition waits on.
+	*/
+	struct FPendingTransition
+	{
+		/** The session */
+		TWeakObjectPtr<UDialogueSession> Session;
+
+		/** The speaker whose audio the session waits on, if any */
+		TObjectKey<UDialogueSpeakerComponent> AudioSpeaker;
+
+		/** When the minimum play time elapses, in scheduler time. Only
+		* meaningful while armed and running. */
+		double Deadline = 0.0;
+
+		/** Session time left on the minimum play time when last armed or
+		* paused */
+		double Remaining = 0.0;
+
+		/** The session's time dilation when the deadline last started */
+		double Dilation = 1.0;
+
+		/** Matches the heap entry for the current deadline */
+		uint32 Serial = 0;
+
+		/** Whether the minimum play time is armed */
+		bool bHasDeadline = false;
+
+		/** Whether the deadline is counting down */
+		bool bRunning = false;
+
+		/** Whether the session waits on a speaker */
+		bool bWaitingForAudio = false;
+
+		/** Whether the speaker finished and the session is yet to hear */
+		bool bAudioFinished = false;
+	};
+
+	/**
+	* Struct holding a deadline in the heap. Entries whose serial no longer
+	* matches their session's are stale, and skipped when they come up.
+	*/
+	struct FHeapEntry
+	{
+		/** When the deadline falls, in scheduler time */
+		double Deadline = 0.0;
+
+		/** The session the deadline belongs to */
+		TObjectKey<UDialogueSession> Session;
+
+		/** The serial the deadline was armed under */
+		uint32 Serial = 0;
+
+		/** Orders the heap earliest first */
+		bool operator<(const FHeapEntry& Other) const
+		{
+			return Deadline < Other.Deadline;
+		}
+	};
+
+	/**
+	* Starts the pending transition's deadline counting down from its
+	* remaining time, if armed and the session's clock runs.
+	*
+	* @param Key - TObjectKey<UDialogueSession>, the session.
+	* @param Pending - FPendingTransition&, its pending transition.
+	*/
+	void StartDeadline(TObjectKey<UDialogueSession> Key,
+		FPendingTransition& Pending);
+
+	/**
+	* Stops the pending transition's deadline, keeping its remaining time.
+	*
+	* @param Pending - FPendingTransition&, the pending transition.
+	*/
+	void StopDeadline(FPendingTransition& Pending);
+
+	/**
+	* Stops waiting for audio on the session's behalf, if waiting.
+	*
+	* @param Key - TObjectKey<UDialogueSession>, the session.
+	*/
+	void ReleaseAudioWaiter(TObjectKey<UDialogueSession> Key);
+
+	/**
+	* Forgets a session's pending transition once it waits on nothing.
+	*
+	* @param Key - TObjectKey<UDialogueSession>, the session.
+	*/
+	void RemoveIfIdle(TObjectKey<UDialogueSession> Key);
+
+	/**
+	* Rebuilds the heap without its stale entries, once they outnumber the
+	* live ones.
+	*/
+	void CompactHeap();
+
+private:
+	/** What each session's transition waits on */
+	TMap<TObjectKey<UDialogueSession>, FPendingTransition> Pending;
+
+	/** Running deadlines, earliest first */
+	TArray<FHeapEntry> Heap;
+
+	/** The session each speaker's audio is awaited by */
+	TMap<TObjectKey<UDialogueSpeakerComponent>, TObjectKey<UDialogueSession>>
+		AudioWaiters;
+
+	/** Sessions whose speaker finished since the last tick */
+	TArray<TObjectKey<UDialogueSession>> FinishedAudio;
+
+	/** Time passed since the scheduler started, in seconds */
+	double Now = 0.0;
+
+	/** Source of deadline serials */
+	uint32 NextSerial = 0;
+};
@@ -22,9 +22,10 @@ class DIALOGUETREERUNTIME_API UInputDialogueTransition :
 	
 public:
 	/** DialogueTransition Implementation */
-	virtual void StartTransition() override;
-	virtual void TransitionOut() override;
-	virtual void SelectOption(int32 InOptionIndex);
+	virtual void StartTransition(UDialogueSession* Session) override;
+	virtual void TransitionOut(UDialogueSession* Session) override;
+	virtual void SelectOption(UDialogueSession* Session, 
+		int32 InOptionIndex) override;
 	virtual FText GetDisplayName() const override;
 	virtual FText GetNodeCreationTooltip() const override;
 	virtual EDialogueConnectionLimit GetConnectionLimit() const override;
@@ -32,19 +33,32 @@ public:
 
 private:
 	/**
-	* Displays the options for the user to select. 
+	* Displays the session's options for the user to select. 
+	* 
+	* @param Session - UDialogueSession*, the session to display for.
 	*/
-	UFUNCTION()
-	void ShowOptions();
+	void ShowOptions(UDialogueSession* Session) const;
 
 	/**
-	* Retrieves and caches the options for the transition. 
+	* Retrieves and caches the options for the transition on the session. 
+	* 
+	* @param Session - UDialogueSession*, the session to gather for.
 	*/
-	UFUNCTION()
-	void GetOptions();
+	void GetOptions(UDialogueSession* Session) const;
 
-private: 
-	/** The available options for the player to choose */
-	UPROPERTY()
-	TArray<FDialogueOption> Options;
+	/**
+	* Issues any async queries the options' branches and locks read.
+	* 
+	* @param Session - UDialogueSession*, the session to gather for.
+	* @return bool - True if the options must wait for the queries.
+	*/
+	bool IssueOptionQueries(UDialogueSession* Session);
+
+	/**
+	* Called once the async queries the options waited on have resolved.
+	* Gathers the options and carries on with the transition.
+	* 
+	* @param WeakSession - TWeakObjectPtr<UDialogueSession>, the session.
+	*/
+	void OnOptionQueriesResolved(TWeakObjectPtr<UDialogueSession> WeakSession);
 };